@@ -0,0 +1,398 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4bench.h"
+#include <cmath>
+#include <random>
+#include <set>
+
+using namespace std;
+
+/**
+	@brief Helper for emitting a synthetic netlist in the same JSON format Yosys writes
+ */
+class SyntheticNetlist
+{
+public:
+	SyntheticNetlist()
+	: m_nextNet(2)	//0 and 1 are reserved for the power rails
+	{}
+
+	int AllocateNet(string name);
+	void AddPort(string name, string direction, int net);
+	void AddCell(
+		string name,
+		string type,
+		const map<string, int>& connections,
+		const map<string, string>& parameters,
+		string loc = "");
+
+	string Serialize(string top);
+
+protected:
+	int m_nextNet;
+
+	vector<string> m_ports;
+	vector<string> m_cells;
+	vector<string> m_netnames;
+};
+
+int SyntheticNetlist::AllocateNet(string name)
+{
+	int net = m_nextNet ++;
+
+	char tmp[256];
+	snprintf(tmp, sizeof(tmp), "        \"%s\": { \"bits\": [ %d ] }", name.c_str(), net);
+	m_netnames.push_back(tmp);
+
+	return net;
+}
+
+void SyntheticNetlist::AddPort(string name, string direction, int net)
+{
+	char tmp[256];
+	snprintf(tmp, sizeof(tmp), "        \"%s\": { \"direction\": \"%s\", \"bits\": [ %d ] }",
+		name.c_str(), direction.c_str(), net);
+	m_ports.push_back(tmp);
+}
+
+void SyntheticNetlist::AddCell(
+	string name,
+	string type,
+	const map<string, int>& connections,
+	const map<string, string>& parameters,
+	string loc)
+{
+	string cell = "        \"" + name + "\": {\n";
+	cell += "          \"type\": \"" + type + "\",\n";
+
+	cell += "          \"parameters\": {";
+	bool first = true;
+	for(auto it : parameters)
+	{
+		if(!first)
+			cell += ",";
+		first = false;
+		cell += " \"" + it.first + "\": \"" + it.second + "\"";
+	}
+	cell += " },\n";
+
+	cell += "          \"attributes\": {";
+	if(loc != "")
+		cell += " \"LOC\": \"" + loc + "\"";
+	cell += " },\n";
+
+	cell += "          \"connections\": {";
+	first = true;
+	for(auto it : connections)
+	{
+		if(!first)
+			cell += ",";
+		first = false;
+
+		//Negative net numbers are constant zero
+		char tmp[32];
+		if(it.second < 0)
+			snprintf(tmp, sizeof(tmp), "\"0\"");
+		else
+			snprintf(tmp, sizeof(tmp), "%d", it.second);
+		cell += " \"" + it.first + "\": [ " + tmp + " ]";
+	}
+	cell += " }\n";
+	cell += "        }";
+
+	m_cells.push_back(cell);
+}
+
+/**
+	@brief Joins a list of JSON object members with commas
+ */
+static string JoinMembers(const vector<string>& members)
+{
+	string ret;
+	for(size_t i=0; i<members.size(); i++)
+	{
+		ret += members[i];
+		if(i+1 < members.size())
+			ret += ",";
+		ret += "\n";
+	}
+	return ret;
+}
+
+string SyntheticNetlist::Serialize(string top)
+{
+	string ret = "{\n";
+	ret += "  \"creator\": \"gp4bench\",\n";
+	ret += "  \"modules\": {\n";
+	ret += "    \"" + top + "\": {\n";
+	ret += "      \"attributes\": { \"top\": 1 },\n";
+	ret += "      \"ports\": {\n" + JoinMembers(m_ports) + "      },\n";
+	ret += "      \"cells\": {\n" + JoinMembers(m_cells) + "      },\n";
+	ret += "      \"netnames\": {\n" + JoinMembers(m_netnames) + "      }\n";
+	ret += "    }\n";
+	ret += "  }\n";
+	ret += "}\n";
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Standard benchmark set
+
+/**
+	@brief The default set of benchmarks run when no case is specified on the command line
+ */
+void GetStandardCases(vector<BenchmarkCase>& cases)
+{
+	Greenpak4Device::GREENPAK4_PART parts[] =
+	{
+		Greenpak4Device::GREENPAK4_SLG46620,
+		Greenpak4Device::GREENPAK4_SLG46621,
+		Greenpak4Device::GREENPAK4_SLG46140
+	};
+	const char* partnames[] = { "slg46620", "slg46621", "slg46140" };
+
+	for(int i=0; i<3; i++)
+	{
+		string prefix = partnames[i];
+		//                                                 LUT   DFF   COUNT CROSS LOC
+		cases.push_back(BenchmarkCase(prefix + "_sparse",  parts[i], 0.25, 0.25, 0.25, 0.10, 0.0));
+		cases.push_back(BenchmarkCase(prefix + "_medium",  parts[i], 0.50, 0.50, 0.50, 0.25, 0.0));
+		cases.push_back(BenchmarkCase(prefix + "_dense",   parts[i], 0.90, 0.90, 0.75, 0.25, 0.0));
+		cases.push_back(BenchmarkCase(prefix + "_cross",   parts[i], 0.75, 0.50, 0.50, 0.75, 0.5));
+		cases.push_back(BenchmarkCase(prefix + "_locked",  parts[i], 0.75, 0.75, 0.50, 0.25, 1.0));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Netlist generation
+
+/**
+	@brief Picks a driver for a cell input in half h of the design, crossing to the other half with the given ratio
+ */
+static int PickDriver(vector<int>* drivers, int h, float cross, mt19937& rng)
+{
+	if( ( (rng() % 1000) < cross * 1000) && !drivers[1-h].empty() )
+		h = 1-h;
+	if(drivers[h].empty())
+		h = 1-h;
+	return drivers[h][rng() % drivers[h].size()];
+}
+
+/**
+	@brief Picks a free pin for a LOC'd IOB, preferring one on the matrix of the given half of the design
+
+	@return Pin number, or 0 if no suitable pin is free
+ */
+static unsigned int PickPin(Greenpak4Device* device, set<unsigned int>& used, int h, bool output)
+{
+	for(int pass=0; pass<2; pass++)
+	{
+		for(auto it = device->iobbegin(); it != device->iobend(); it ++)
+		{
+			auto iob = it->second;
+			if(used.find(it->first) != used.end())
+				continue;
+			if(output && iob->IsInputOnly())
+				continue;
+			if( (pass == 0) && ((int)iob->GetMatrix() != h) )
+				continue;
+
+			used.insert(it->first);
+			return it->first;
+		}
+	}
+	return 0;
+}
+
+/**
+	@brief Decides whether the i'th IOB gets a LOC constraint, spreading them evenly for fractional ratios
+ */
+static bool IsLocked(unsigned int i, float ratio)
+{
+	return floor((i+1) * ratio) > floor(i * ratio);
+}
+
+/**
+	@brief Generates a random netlist for the given case, sized against the resources of the given device.
+
+	The design is split into two halves with IOBs of each half LOC'd (when requested) to pins on different routing
+	matrices. Every cell input is driven from its own half, except for a fraction m_crossRatio of inputs which are
+	driven from the other half and will most likely have to use a cross connection.
+
+	@return The netlist, in Yosys JSON format
+ */
+string GenerateNetlist(const BenchmarkCase& bcase, Greenpak4Device* device)
+{
+	SyntheticNetlist net;
+	mt19937 rng(bcase.m_seed);
+
+	//Drivers available to each half of the design
+	vector<int> drivers[2];
+
+	//Size the design against the device
+	unsigned int niob = device->GetIOBCount();
+	unsigned int ninputs = max(1u, niob / 2);
+	unsigned int noutputs = max(1u, niob / 2 - 1);
+	unsigned int nlut2 = device->GetLUT2Count() * bcase.m_lutDensity;
+	unsigned int nlut3 = device->GetLUT3Count() * bcase.m_lutDensity;
+	unsigned int nlut4 = device->GetLUT4Count() * bcase.m_lutDensity;
+	unsigned int ndff = device->GetTotalFFCount() * bcase.m_dffDensity;
+	unsigned int ncount8 = device->Get8BitCounterCount() * bcase.m_counterDensity;
+	unsigned int ncount14 = device->Get14BitCounterCount() * bcase.m_counterDensity;
+
+	set<unsigned int> usedPins;
+	unsigned int nio = 0;
+	char name[128];
+	char loc[32];
+	char tmp[32];
+
+	//Input buffers. Input 0 doubles as the clock for all sequential cells.
+	int clk = -1;
+	for(unsigned int i=0; i<ninputs; i++)
+	{
+		int h = i % 2;
+		snprintf(name, sizeof(name), "in%u", i);
+		int pad = net.AllocateNet(name);
+		net.AddPort(name, "input", pad);
+
+		snprintf(name, sizeof(name), "in%u_buf", i);
+		int out = net.AllocateNet(name);
+		drivers[h].push_back(out);
+		if(clk < 0)
+			clk = out;
+
+		loc[0] = '\0';
+		if(IsLocked(nio++, bcase.m_locRatio))
+		{
+			unsigned int pin = PickPin(device, usedPins, h, false);
+			if(pin)
+				snprintf(loc, sizeof(loc), "P%u", pin);
+		}
+
+		map<string, int> conns;
+		conns["IN"] = pad;
+		conns["OUT"] = out;
+		net.AddCell(string("ibuf_") + name, "GP_IBUF", conns, map<string, string>(), loc);
+	}
+
+	//Counters
+	for(unsigned int i=0; i<ncount8 + ncount14; i++)
+	{
+		int h = i % 2;
+		snprintf(name, sizeof(name), "count%u", i);
+		int out = net.AllocateNet(name);
+
+		map<string, int> conns;
+		conns["CLK"] = clk;
+		conns["RST"] = PickDriver(drivers, h, bcase.m_crossRatio, rng);
+		conns["OUT"] = out;
+
+		map<string, string> params;
+		bool wide = (i >= ncount8);
+		snprintf(tmp, sizeof(tmp), "%u", (unsigned int)(rng() % (wide ? 16383 : 255)) + 1);
+		params["COUNT_TO"] = tmp;
+		params["RESET_MODE"] = "RISING";
+		params["CLKIN_DIVIDE"] = "1";
+		net.AddCell(name, wide ? "GP_COUNT14" : "GP_COUNT8", conns, params);
+
+		drivers[h].push_back(out);
+	}
+
+	//Flipflop outputs are allocated now so LUTs can use them, inputs are hooked up after the LUTs exist.
+	//This allows sequential feedback without creating combinatorial loops.
+	vector<int> dffq;
+	for(unsigned int i=0; i<ndff; i++)
+	{
+		snprintf(name, sizeof(name), "dff%u", i);
+		int q = net.AllocateNet(name);
+		dffq.push_back(q);
+		drivers[i % 2].push_back(q);
+	}
+
+	//LUTs. Each one can only use drivers created before it so the logic is acyclic.
+	unsigned int nlut = 0;
+	unsigned int sizes[3] = { nlut2, nlut3, nlut4 };
+	for(int order=2; order<=4; order++)
+	{
+		for(unsigned int i=0; i<sizes[order-2]; i++)
+		{
+			int h = nlut % 2;
+			snprintf(name, sizeof(name), "lut%u", nlut++);
+
+			map<string, int> conns;
+			for(int j=0; j<order; j++)
+			{
+				char port[8];
+				snprintf(port, sizeof(port), "IN%d", j);
+				conns[port] = PickDriver(drivers, h, bcase.m_crossRatio, rng);
+			}
+			int out = net.AllocateNet(name);
+			conns["OUT"] = out;
+
+			map<string, string> params;
+			snprintf(tmp, sizeof(tmp), "%u", (unsigned int)(rng() % (1 << (1 << order))));
+			params["INIT"] = tmp;
+
+			char type[16];
+			snprintf(type, sizeof(type), "GP_%dLUT", order);
+			net.AddCell(name, type, conns, params);
+
+			drivers[h].push_back(out);
+		}
+	}
+
+	//Now hook up the flipflop inputs
+	for(unsigned int i=0; i<ndff; i++)
+	{
+		map<string, int> conns;
+		conns["D"] = PickDriver(drivers, i % 2, bcase.m_crossRatio, rng);
+		conns["CLK"] = clk;
+		conns["Q"] = dffq[i];
+
+		map<string, string> params;
+		params["INIT"] = "0";
+
+		snprintf(name, sizeof(name), "dff%u_cell", i);
+		net.AddCell(name, "GP_DFF", conns, params);
+	}
+
+	//Output buffers
+	for(unsigned int i=0; i<noutputs; i++)
+	{
+		int h = i % 2;
+		snprintf(name, sizeof(name), "out%u", i);
+		int pad = net.AllocateNet(name);
+		net.AddPort(name, "output", pad);
+
+		loc[0] = '\0';
+		if(IsLocked(nio++, bcase.m_locRatio))
+		{
+			unsigned int pin = PickPin(device, usedPins, h, true);
+			if(pin)
+				snprintf(loc, sizeof(loc), "P%u", pin);
+		}
+
+		map<string, int> conns;
+		conns["IN"] = PickDriver(drivers, h, bcase.m_crossRatio, rng);
+		conns["OUT"] = pad;
+		net.AddCell(string("obuf_") + name, "GP_OBUF", conns, map<string, string>(), loc);
+	}
+
+	return net.Serialize(bcase.m_name);
+}
@@ -0,0 +1,117 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef gp4bench_h
+#define gp4bench_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <gp4par.h>
+
+/**
+	@brief Parameters for one synthetic PAR benchmark
+
+	Densities are fractions (0 to 1) of the corresponding resource available in the target device.
+ */
+class BenchmarkCase
+{
+public:
+	BenchmarkCase(
+		std::string name = "",
+		Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620,
+		float luts = 0.5,
+		float dffs = 0.5,
+		float counters = 0.5,
+		float cross = 0.25,
+		float locs = 0)
+	: m_name(name)
+	, m_part(part)
+	, m_lutDensity(luts)
+	, m_dffDensity(dffs)
+	, m_counterDensity(counters)
+	, m_crossRatio(cross)
+	, m_locRatio(locs)
+	, m_seed(1)
+	{}
+
+	std::string m_name;
+	Greenpak4Device::GREENPAK4_PART m_part;
+
+	float m_lutDensity;
+	float m_dffDensity;
+	float m_counterDensity;
+
+	///Probability that a cell input is driven from the other half of the design (and thus likely the other matrix)
+	float m_crossRatio;
+
+	///Fraction of IOB cells carrying a LOC constraint
+	float m_locRatio;
+
+	///Seed for both the netlist generator and the PAR engine
+	uint32_t m_seed;
+};
+
+/**
+	@brief Measurements from one benchmark case
+ */
+class BenchmarkResult
+{
+public:
+	BenchmarkResult()
+	: m_wallTime(0)
+	, m_cpuTime(0)
+	, m_iterations(0)
+	, m_costEvaluations(0)
+	, m_finalCost(0)
+	, m_peakRSS(0)
+	, m_routed(false)
+	{}
+
+	std::string m_name;
+
+	///Best-of-N wall-clock and CPU time for graph construction plus PAR, in ms
+	double m_wallTime;
+	double m_cpuTime;
+
+	uint64_t m_iterations;
+	uint64_t m_costEvaluations;
+	uint32_t m_finalCost;
+
+	///Process peak RSS after this case ran, in kB (monotonic across cases)
+	uint64_t m_peakRSS;
+
+	bool m_routed;
+};
+
+typedef std::map<std::string, BenchmarkResult> baselinemap;
+
+//Case generation
+void GetStandardCases(std::vector<BenchmarkCase>& cases);
+std::string GenerateNetlist(const BenchmarkCase& bcase, Greenpak4Device* device);
+
+//Running
+bool RunBenchmark(const BenchmarkCase& bcase, unsigned int runs, BenchmarkResult& result);
+
+//Baselines
+bool WriteBaseline(std::string fname, const std::vector<BenchmarkResult>& results);
+bool LoadBaseline(std::string fname, baselinemap& baseline);
+bool CompareToBaseline(const BenchmarkResult& result, baselinemap& baseline, float tolerance);
+
+#endif
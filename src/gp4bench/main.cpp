@@ -0,0 +1,313 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4bench.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	//PAR is very chatty at notice level, and we want clean output for scripts
+	Severity console_verbosity = Severity::WARNING;
+
+	//Baseline to compare against, and/or to write
+	string baseline_in = "";
+	string baseline_out = "";
+
+	//Number of runs per case (fastest is reported)
+	unsigned int runs = 3;
+
+	//Allowed run time increase vs baseline before we call it a regression
+	float tolerance = 0.25;
+
+	//Only run standard cases whose name contains this string
+	string filter = "";
+
+	//Custom case, if any of its parameters were specified
+	BenchmarkCase custom("custom");
+	bool use_custom = false;
+
+	//Disables colored output
+	bool noColors = false;
+
+	//Parse command-line arguments
+	for(int i=1; i<argc; i++)
+	{
+		string s(argv[i]);
+
+		//Let the logger eat its args first
+		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
+			continue;
+
+		else if(s == "--help")
+		{
+			ShowUsage();
+			return 0;
+		}
+		else if(s == "--version")
+		{
+			ShowVersion();
+			return 0;
+		}
+		else if(s == "--nocolors")
+			noColors = true;
+		else if(s == "--baseline")
+		{
+			if(i+1 < argc)
+				baseline_in = argv[++i];
+			else
+			{
+				printf("ERROR: --baseline requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--write-baseline")
+		{
+			if(i+1 < argc)
+				baseline_out = argv[++i];
+			else
+			{
+				printf("ERROR: --write-baseline requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--runs")
+		{
+			if(i+1 < argc)
+				runs = max(1, atoi(argv[++i]));
+			else
+			{
+				printf("ERROR: --runs requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--tolerance")
+		{
+			if(i+1 < argc)
+				tolerance = atof(argv[++i]) / 100;
+			else
+			{
+				printf("ERROR: --tolerance requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--case")
+		{
+			if(i+1 < argc)
+				filter = argv[++i];
+			else
+			{
+				printf("ERROR: --case requires an argument\n");
+				return 1;
+			}
+		}
+		else if( (s == "--part") || (s == "-p") )
+		{
+			if(i+1 < argc)
+			{
+				int p;
+				sscanf(argv[++i], "SLG%d", &p);
+
+				switch(p)
+				{
+					case 46620:
+						custom.m_part = Greenpak4Device::GREENPAK4_SLG46620;
+						break;
+
+					case 46621:
+						custom.m_part = Greenpak4Device::GREENPAK4_SLG46621;
+						break;
+
+					case 46140:
+						custom.m_part = Greenpak4Device::GREENPAK4_SLG46140;
+						break;
+
+					default:
+						printf("ERROR: Invalid part (supported: SLG46620, SLG46621, SLG46140)\n");
+						return 1;
+				}
+				use_custom = true;
+			}
+			else
+			{
+				printf("ERROR: --part requires an argument\n");
+				return 1;
+			}
+		}
+		else if( (s == "--lut-density") || (s == "--dff-density") || (s == "--counter-density") ||
+				 (s == "--cross-ratio") || (s == "--loc-ratio") )
+		{
+			if(i+1 < argc)
+			{
+				float f = atof(argv[++i]);
+				if( (f < 0) || (f > 1) )
+				{
+					printf("ERROR: %s must be between 0 and 1\n", s.c_str());
+					return 1;
+				}
+
+				if(s == "--lut-density")
+					custom.m_lutDensity = f;
+				else if(s == "--dff-density")
+					custom.m_dffDensity = f;
+				else if(s == "--counter-density")
+					custom.m_counterDensity = f;
+				else if(s == "--cross-ratio")
+					custom.m_crossRatio = f;
+				else
+					custom.m_locRatio = f;
+				use_custom = true;
+			}
+			else
+			{
+				printf("ERROR: %s requires an argument\n", s.c_str());
+				return 1;
+			}
+		}
+		else if(s == "--seed")
+		{
+			if(i+1 < argc)
+				custom.m_seed = atoi(argv[++i]);
+			else
+			{
+				printf("ERROR: --seed requires an argument\n");
+				return 1;
+			}
+			use_custom = true;
+		}
+
+		else
+		{
+			printf("ERROR: Unrecognized command-line argument \"%s\", use --help\n", s.c_str());
+			return 1;
+		}
+	}
+
+	//Set up logging
+	if(noColors)
+		g_log_sinks.emplace(g_log_sinks.begin(), new STDLogSink(console_verbosity));
+	else
+		g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(console_verbosity));
+
+	//Figure out what to run
+	vector<BenchmarkCase> cases;
+	if(use_custom)
+		cases.push_back(custom);
+	else
+	{
+		vector<BenchmarkCase> all;
+		GetStandardCases(all);
+		for(auto& c : all)
+		{
+			if(c.m_name.find(filter) != string::npos)
+				cases.push_back(c);
+		}
+	}
+	if(cases.empty())
+	{
+		printf("ERROR: No benchmark cases matched \"%s\"\n", filter.c_str());
+		return 1;
+	}
+
+	baselinemap baseline;
+	if( (baseline_in != "") && !LoadBaseline(baseline_in, baseline) )
+		return 1;
+
+	//Run everything
+	printf("%-24s %10s %10s %10s %10s %8s %10s %s\n",
+		"case", "wall_ms", "cpu_ms", "iters", "evals", "cost", "rss_kb", "status");
+	bool ok = true;
+	vector<BenchmarkResult> results;
+	for(auto& c : cases)
+	{
+		BenchmarkResult r;
+		if(!RunBenchmark(c, runs, r))
+		{
+			ok = false;
+			continue;
+		}
+		results.push_back(r);
+
+		printf("%-24s %10.3f %10.3f %10lu %10lu %8u %10lu %s\n",
+			r.m_name.c_str(),
+			r.m_wallTime,
+			r.m_cpuTime,
+			(unsigned long)r.m_iterations,
+			(unsigned long)r.m_costEvaluations,
+			r.m_finalCost,
+			(unsigned long)r.m_peakRSS,
+			r.m_routed ? "routed" : "unroutable");
+		fflush(stdout);
+
+		if( (baseline_in != "") && !CompareToBaseline(r, baseline, tolerance) )
+			ok = false;
+	}
+
+	if( (baseline_out != "") && !WriteBaseline(baseline_out, results) )
+		return 1;
+
+	return ok ? 0 : 1;
+}
+
+void ShowUsage()
+{
+	printf(//                                                                               v 80th column
+		"Usage: gp4bench [options]\n"
+		"    --baseline           <file>\n"
+		"        Compares results against <file> and fails on regressions.\n"
+		"    --case               <name>\n"
+		"        Only runs the standard cases whose name contains <name>.\n"
+		"    --counter-density    <0-1>\n"
+		"    --cross-ratio        <0-1>\n"
+		"    --dff-density        <0-1>\n"
+		"    --loc-ratio          <0-1>\n"
+		"    --lut-density        <0-1>\n"
+		"        Runs a single custom case instead of the standard set. Densities are\n"
+		"        fractions of the device's resources. The cross ratio is the fraction of\n"
+		"        inputs driven from the other half of the design, and the LOC ratio is\n"
+		"        the fraction of IOBs with a LOC constraint.\n"
+		"    --debug\n"
+		"        Prints lots of internal debugging information.\n"
+		"    -l, --logfile        <file>\n"
+		"        Causes verbose log messages to be written to <file>.\n"
+		"    -L, --logfile-lines  <file>\n"
+		"        Causes verbose log messages to be written to <file>, flushing after\n"
+		"        each line.\n"
+		"    -p, --part\n"
+		"        Specifies the part for the custom case (SLG46620V, SLG46621V, or SLG46140V)\n"
+		"    --runs               <n>\n"
+		"        Runs each case <n> times and reports the fastest (default 3).\n"
+		"    --seed               <n>\n"
+		"        Seed for the custom case's netlist generator and PAR engine.\n"
+		"    --tolerance          <percent>\n"
+		"        Allowed run time increase vs the baseline (default 25).\n"
+		"    --verbose\n"
+		"        Prints additional information about the design.\n"
+		"    --write-baseline     <file>\n"
+		"        Writes results to <file> for use with --baseline.\n");
+}
+
+void ShowVersion()
+{
+	printf(
+		"GreenPAK 4 synthetic place-and-route benchmarks by Andrew D. Zonenberg.\n"
+		"\n"
+		"License: LGPL v2.1+\n"
+		"This is free software: you are free to change and redistribute it.\n"
+		"There is NO WARRANTY, to the extent permitted by law.\n");
+}
@@ -0,0 +1,218 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4bench.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Running
+
+/**
+	@brief Generates and place-and-routes one benchmark case, keeping the fastest of several runs
+
+	A fresh device and netlist are created for every run since BuildGraphs() attaches PAR nodes to both.
+ */
+bool RunBenchmark(const BenchmarkCase& bcase, unsigned int runs, BenchmarkResult& result)
+{
+	result = BenchmarkResult();
+	result.m_name = bcase.m_name;
+
+	for(unsigned int run=0; run<runs; run++)
+	{
+		Greenpak4Device device(bcase.m_part, Greenpak4IOB::PULL_NONE, Greenpak4IOB::PULL_1M);
+
+		//Generate the netlist
+		string json = GenerateNetlist(bcase, &device);
+		Greenpak4Netlist netlist;
+		if(!netlist.LoadFromString(json.c_str()))
+		{
+			LogError("Benchmark %s: generated netlist failed to parse\n", bcase.m_name.c_str());
+			return false;
+		}
+
+		double wall_start = PARStatistics::GetWallTime();
+		double cpu_start = PARStatistics::GetCPUTime();
+
+		//Build the graphs
+		labelmap lmap;
+		PARGraph* ngraph = NULL;
+		PARGraph* dgraph = NULL;
+		if(!BuildGraphs(&netlist, &device, ngraph, dgraph, lmap))
+		{
+			LogError("Benchmark %s: failed to build graphs\n", bcase.m_name.c_str());
+			delete ngraph;
+			delete dgraph;
+			return false;
+		}
+
+		//Run PAR. Failing to route is a legitimate outcome for the denser cases, so just record it.
+		Greenpak4PAREngine engine(ngraph, dgraph, lmap);
+		bool routed = engine.PlaceAndRoute(lmap, bcase.m_seed);
+
+		double wall = (PARStatistics::GetWallTime() - wall_start) * 1000;
+		double cpu = (PARStatistics::GetCPUTime() - cpu_start) * 1000;
+
+		if( (run == 0) || (wall < result.m_wallTime) )
+			result.m_wallTime = wall;
+		if( (run == 0) || (cpu < result.m_cpuTime) )
+			result.m_cpuTime = cpu;
+
+		//These are deterministic for a given seed, so just keep the last run's values
+		auto& stats = engine.GetStatistics();
+		result.m_iterations = stats.m_iterations;
+		result.m_costEvaluations = stats.m_costEvaluations;
+		result.m_finalCost = engine.ComputeCost();
+		result.m_routed = routed;
+
+		delete ngraph;
+		delete dgraph;
+	}
+
+	result.m_peakRSS = PARStatistics::GetPeakRSS();
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Baselines
+
+/**
+	@brief Writes results to a baseline file.
+
+	The format is one line per case, whitespace separated, with # comments:
+		name wall_ms cpu_ms iterations cost_evaluations final_cost peak_rss_kb routed
+ */
+bool WriteBaseline(string fname, const vector<BenchmarkResult>& results)
+{
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	fprintf(fp, "# gp4bench baseline\n");
+	fprintf(fp, "# name wall_ms cpu_ms iterations cost_evaluations final_cost peak_rss_kb routed\n");
+	for(auto& r : results)
+	{
+		fprintf(fp, "%s %.3f %.3f %lu %lu %u %lu %d\n",
+			r.m_name.c_str(),
+			r.m_wallTime,
+			r.m_cpuTime,
+			(unsigned long)r.m_iterations,
+			(unsigned long)r.m_costEvaluations,
+			r.m_finalCost,
+			(unsigned long)r.m_peakRSS,
+			r.m_routed ? 1 : 0);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+bool LoadBaseline(string fname, baselinemap& baseline)
+{
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+	{
+		LogError("Couldn't open baseline file %s\n", fname.c_str());
+		return false;
+	}
+
+	char line[1024];
+	while(NULL != fgets(line, sizeof(line), fp))
+	{
+		//Skip comments and blank lines
+		if( (line[0] == '#') || (line[0] == '\n') || (line[0] == '\0') )
+			continue;
+
+		char name[256];
+		BenchmarkResult r;
+		unsigned long iterations;
+		unsigned long evals;
+		unsigned long rss;
+		int routed;
+		if(8 != sscanf(line, "%255s %lf %lf %lu %lu %u %lu %d",
+			name, &r.m_wallTime, &r.m_cpuTime, &iterations, &evals, &r.m_finalCost, &rss, &routed))
+		{
+			LogWarning("Ignoring malformed baseline line %s", line);
+			continue;
+		}
+
+		r.m_name = name;
+		r.m_iterations = iterations;
+		r.m_costEvaluations = evals;
+		r.m_peakRSS = rss;
+		r.m_routed = (routed != 0);
+		baseline[r.m_name] = r;
+	}
+
+	fclose(fp);
+	return true;
+}
+
+/**
+	@brief Checks a result against the baseline
+
+	Iteration count, final cost and routability are deterministic so any change is reported. Run time is only a
+	regression if it exceeds the baseline by more than the given fractional tolerance.
+
+	@return True if no regression was found
+ */
+bool CompareToBaseline(const BenchmarkResult& result, baselinemap& baseline, float tolerance)
+{
+	if(baseline.find(result.m_name) == baseline.end())
+	{
+		LogWarning("%s: not in baseline\n", result.m_name.c_str());
+		return true;
+	}
+	auto& base = baseline[result.m_name];
+
+	bool ok = true;
+	if(result.m_routed != base.m_routed)
+	{
+		LogError("%s: routability changed (was %s, now %s)\n",
+			result.m_name.c_str(),
+			base.m_routed ? "routed" : "unroutable",
+			result.m_routed ? "routed" : "unroutable");
+		ok = false;
+	}
+	if(result.m_finalCost > base.m_finalCost)
+	{
+		LogError("%s: final cost regressed from %u to %u\n",
+			result.m_name.c_str(), base.m_finalCost, result.m_finalCost);
+		ok = false;
+	}
+	else if( (result.m_finalCost != base.m_finalCost) || (result.m_iterations != base.m_iterations) )
+	{
+		LogWarning("%s: results changed (cost %u -> %u, iterations %lu -> %lu), baseline may need updating\n",
+			result.m_name.c_str(),
+			base.m_finalCost,
+			result.m_finalCost,
+			(unsigned long)base.m_iterations,
+			(unsigned long)result.m_iterations);
+	}
+	if(result.m_wallTime > base.m_wallTime * (1 + tolerance))
+	{
+		LogError("%s: run time regressed from %.3f ms to %.3f ms\n",
+			result.m_name.c_str(), base.m_wallTime, result.m_wallTime);
+		ok = false;
+	}
+
+	return ok;
+}
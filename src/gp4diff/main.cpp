@@ -0,0 +1,408 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4diff.h"
+
+using namespace std;
+
+static bool ReadPairList(string fname, vector<DiffJob>& jobs);
+static string FormatBitRanges(const vector<unsigned int>& bits);
+static void PrintDiffs(const DiffJob& job, bool showBits);
+static bool WriteJSONReport(string fname, const vector<DiffJob>& jobs, bool pretty);
+
+int main(int argc, char* argv[])
+{
+	Severity console_verbosity = Severity::NOTICE;
+
+	//Bitstreams to compare
+	vector<DiffJob> jobs;
+	string oldfile = "";
+	string newfile = "";
+	string pairfile = "";
+
+	//Machine-readable report
+	string jsonfile = "";
+	bool compact = false;
+
+	//Print addresses of differing bits
+	bool showBits = false;
+
+	//Disables colored output
+	bool noColors = false;
+
+	//Target chip (only needed to tell SLG46620 and SLG46621 apart, otherwise detected from the first file)
+	Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
+	bool partSpecified = false;
+
+	//Parse command-line arguments
+	for(int i=1; i<argc; i++)
+	{
+		string s(argv[i]);
+
+		//Let the logger eat its args first
+		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
+			continue;
+
+		else if(s == "--bits")
+			showBits = true;
+		else if(s == "--compact")
+			compact = true;
+		else if(s == "--help")
+		{
+			ShowUsage();
+			return 0;
+		}
+		else if(s == "--version")
+		{
+			ShowVersion();
+			return 0;
+		}
+		else if(s == "--json")
+		{
+			if(i+1 < argc)
+				jsonfile = argv[++i];
+			else
+			{
+				printf("ERROR: --json requires an argument\n");
+				return 2;
+			}
+		}
+		else if(s == "--nocolors")
+			noColors = true;
+		else if(s == "--pairs")
+		{
+			if(i+1 < argc)
+				pairfile = argv[++i];
+			else
+			{
+				printf("ERROR: --pairs requires an argument\n");
+				return 2;
+			}
+		}
+		else if( (s == "--part") || (s == "-p") )
+		{
+			if(i+1 < argc)
+			{
+				string name(argv[++i]);
+
+				if(name == "SLG46620V")
+					part = Greenpak4Device::GREENPAK4_SLG46620;
+				else if(name == "SLG46621V")
+					part = Greenpak4Device::GREENPAK4_SLG46621;
+				else if(name == "SLG46140V")
+					part = Greenpak4Device::GREENPAK4_SLG46140;
+				else
+				{
+					printf("ERROR: Invalid part, should be SLG46620V, SLG46621V, or SLG46140V\n");
+					return 2;
+				}
+				partSpecified = true;
+			}
+			else
+			{
+				printf("ERROR: --part requires an argument\n");
+				return 2;
+			}
+		}
+
+		//first two non-switch arguments are the bitstreams
+		else if( (s[0] != '-') && (oldfile == "") )
+			oldfile = s;
+		else if( (s[0] != '-') && (newfile == "") )
+			newfile = s;
+
+		else
+		{
+			printf("ERROR: Unrecognized command-line argument \"%s\", use --help\n", s.c_str());
+			return 2;
+		}
+	}
+
+	//Need either a pair of files or a pair list
+	if( (pairfile == "") && ( (oldfile == "") || (newfile == "") ) )
+	{
+		ShowUsage();
+		return 2;
+	}
+
+	//Set up logging
+	if(noColors)
+		g_log_sinks.emplace(g_log_sinks.begin(), new STDLogSink(console_verbosity));
+	else
+		g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(console_verbosity));
+
+	//Collect the work
+	if(pairfile != "")
+	{
+		if(!ReadPairList(pairfile, jobs))
+			return 2;
+	}
+	if(oldfile != "")
+		jobs.push_back(DiffJob(oldfile, newfile));
+
+	//Compare each pair, keeping one diff engine per part so ownership is only worked out once
+	map<Greenpak4Device::GREENPAK4_PART, unique_ptr<Greenpak4BitstreamDiff> > engines;
+	bool errors = false;
+	unsigned int ndiffer = 0;
+	for(auto& job : jobs)
+	{
+		Greenpak4Device::GREENPAK4_PART jobpart = part;
+		if(!partSpecified && !Greenpak4Device::DetectPart(job.m_oldfile, jobpart))
+		{
+			errors = true;
+			continue;
+		}
+
+		auto& engine = engines[jobpart];
+		if(!engine)
+			engine.reset(new Greenpak4BitstreamDiff(jobpart));
+
+		job.m_ok = engine->Compare(job.m_oldfile, job.m_newfile, job.m_diffs);
+		if(!job.m_ok)
+		{
+			errors = true;
+			continue;
+		}
+
+		if(!job.m_diffs.empty())
+			ndiffer ++;
+		PrintDiffs(job, showBits);
+	}
+
+	if(jobs.size() > 1)
+		LogNotice("%u of %zu pairs differ\n", ndiffer, jobs.size());
+
+	if(jsonfile != "")
+	{
+		if(!WriteJSONReport(jsonfile, jobs, !compact))
+			return 2;
+	}
+
+	//Same convention as diff(1): 0 = identical, 1 = differences, 2 = trouble
+	if(errors)
+		return 2;
+	return (ndiffer != 0) ? 1 : 0;
+}
+
+/**
+	@brief Reads a list of bitstream pairs, one "old new" pair per line
+
+	Blank lines and lines starting with # are ignored.
+ */
+static bool ReadPairList(string fname, vector<DiffJob>& jobs)
+{
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+	{
+		LogError("Couldn't open pair list %s\n", fname.c_str());
+		return false;
+	}
+
+	char line[1024];
+	char a[512];
+	char b[512];
+	unsigned int nline = 0;
+	bool ok = true;
+	while(fgets(line, sizeof(line), fp))
+	{
+		nline ++;
+		if(line[0] == '#')
+			continue;
+
+		int n = sscanf(line, "%511s %511s", a, b);
+		if(n <= 0)
+			continue;
+		if(n != 2)
+		{
+			LogError("%s:%u: expected two filenames\n", fname.c_str(), nline);
+			ok = false;
+			continue;
+		}
+		jobs.push_back(DiffJob(a, b));
+	}
+	fclose(fp);
+
+	return ok;
+}
+
+/**
+	@brief Formats a sorted list of bit addresses as ranges, like "12-19, 40"
+ */
+static string FormatBitRanges(const vector<unsigned int>& bits)
+{
+	string ret;
+	char buf[32];
+	for(size_t i=0; i<bits.size(); )
+	{
+		size_t j = i;
+		while( (j+1 < bits.size()) && (bits[j+1] == bits[j] + 1) )
+			j ++;
+
+		if(j == i)
+			snprintf(buf, sizeof(buf), "%u", bits[i]);
+		else
+			snprintf(buf, sizeof(buf), "%u-%u", bits[i], bits[j]);
+		if(!ret.empty())
+			ret += ", ";
+		ret += buf;
+
+		i = j+1;
+	}
+	return ret;
+}
+
+static void PrintDiffs(const DiffJob& job, bool showBits)
+{
+	if(job.m_diffs.empty())
+	{
+		LogVerbose("%s and %s are identical\n", job.m_oldfile.c_str(), job.m_newfile.c_str());
+		return;
+	}
+
+	LogNotice("%s -> %s: %zu entities differ\n", job.m_oldfile.c_str(), job.m_newfile.c_str(), job.m_diffs.size());
+	LogIndenter li;
+
+	for(auto& d : job.m_diffs)
+	{
+		if(showBits || d.m_changes.empty())
+			LogNotice("%s: bits %s\n", d.m_description.c_str(), FormatBitRanges(d.m_bits).c_str());
+		else
+			LogNotice("%s:\n", d.m_description.c_str());
+
+		LogIndenter li2;
+		for(auto& c : d.m_changes)
+		{
+			LogNotice("%-9s %s: %s -> %s\n",
+				Greenpak4BitstreamDiff::GetChangeTypeName(c.m_type).c_str(),
+				c.m_name.c_str(),
+				c.m_old.c_str(),
+				c.m_new.c_str());
+		}
+	}
+}
+
+static bool WriteJSONReport(string fname, const vector<DiffJob>& jobs, bool pretty)
+{
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	Greenpak4JSONWriter json(fp, pretty);
+	json.BeginArray();
+	for(auto& job : jobs)
+	{
+		json.BeginObject();
+		json.Key("old");
+		json.String(job.m_oldfile);
+		json.Key("new");
+		json.String(job.m_newfile);
+		json.Key("ok");
+		json.Bool(job.m_ok);
+
+		json.Key("entities");
+		json.BeginArray();
+		for(auto& d : job.m_diffs)
+		{
+			json.BeginObject();
+			json.Key("entity");
+			json.String(d.m_description);
+
+			json.Key("bits");
+			json.BeginArray();
+			for(auto b : d.m_bits)
+				json.Int(b);
+			json.EndArray();
+
+			json.Key("changes");
+			json.BeginArray();
+			for(auto& c : d.m_changes)
+			{
+				json.BeginObject();
+				json.Key("kind");
+				json.String(Greenpak4BitstreamDiff::GetChangeTypeName(c.m_type));
+				json.Key("name");
+				json.String(c.m_name);
+				json.Key("old");
+				json.String(c.m_old);
+				json.Key("new");
+				json.String(c.m_new);
+				json.EndObject();
+			}
+			json.EndArray();
+
+			json.EndObject();
+		}
+		json.EndArray();
+
+		json.EndObject();
+	}
+	json.EndArray();
+
+	bool ok = json.Flush();
+	fclose(fp);
+	if(!ok)
+		LogError("Failed to write %s\n", fname.c_str());
+	return ok;
+}
+
+void ShowUsage()
+{
+	printf(//                                                                               v 80th column
+		"Usage: gp4diff [options] old.txt new.txt\n"
+		"       gp4diff [options] --pairs list.txt\n"
+		"    --bits\n"
+		"        Lists the address of every differing bit, not just decoded changes.\n"
+		"    --compact\n"
+		"        Writes the --json report without indentation or line breaks.\n"
+		"    --debug\n"
+		"        Prints lots of internal debugging information.\n"
+		"    --json               <file>\n"
+		"        Writes a machine-readable report of every pair to <file>.\n"
+		"    -l, --logfile        <file>\n"
+		"        Causes verbose log messages to be written to <file>.\n"
+		"    -L, --logfile-lines  <file>\n"
+		"        Causes verbose log messages to be written to <file>, flushing after\n"
+		"        each line.\n"
+		"    --nocolors\n"
+		"        Disables colored console output.\n"
+		"    -p, --part\n"
+		"        Specifies the part (SLG46620V, SLG46621V, or SLG46140V). Detected from\n"
+		"        the first bitstream of each pair if not specified.\n"
+		"    --pairs              <file>\n"
+		"        Compares every pair listed in <file>, one \"old new\" pair per line.\n"
+		"    -q, --quiet\n"
+		"        Causes only warnings and errors to be written to the console.\n"
+		"        Specify twice to also silence warnings.\n"
+		"    --verbose\n"
+		"        Prints additional information, including identical pairs.\n"
+		"\n"
+		"Exit status is 0 if all pairs are identical, 1 if any differ, 2 on error.\n");
+}
+
+void ShowVersion()
+{
+	printf(
+		"GreenPAK 4 semantic bitstream diff by Andrew D. Zonenberg.\n"
+		"\n"
+		"License: LGPL v2.1+\n"
+		"This is free software: you are free to change and redistribute it.\n"
+		"There is NO WARRANTY, to the extent permitted by law.\n");
+}
@@ -0,0 +1,239 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4par.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Indexes the nets and edges of a netlist graph. Call Rebuild() once every node has been placed.
+
+	@param netlist	The netlist graph
+	@param limit	Number of cross-connections available in each direction
+ */
+Greenpak4CongestionModel::Greenpak4CongestionModel(PARGraph* netlist, unsigned int limit)
+	: m_routeLimit(limit)
+{
+	m_routesUsed[0] = 0;
+	m_routesUsed[1] = 0;
+
+	map<pair<PARGraphNode*, string>, uint32_t> nets;
+	for(uint32_t i=0; i<netlist->GetNumNodes(); i++)
+	{
+		auto node = netlist->GetNodeByIndex(i);
+		for(uint32_t j=0; j<node->GetEdgeCount(); j++)
+		{
+			auto edge = node->GetEdgeByIndex(j);
+
+			//Find (or allocate) the source net
+			auto key = pair<PARGraphNode*, string>(node, edge->m_sourceport);
+			auto it = nets.find(key);
+			uint32_t net;
+			if(it != nets.end())
+				net = it->second;
+			else
+			{
+				net = m_netSources.size();
+				nets[key] = net;
+				m_netSources.push_back(node);
+			}
+
+			uint32_t index = m_edges.size();
+			m_edges.push_back(edge);
+			m_edgeNets.push_back(net);
+			m_nodeEdges[edge->m_sourcenode].push_back(index);
+			if(edge->m_destnode != edge->m_sourcenode)
+				m_nodeEdges[edge->m_destnode].push_back(index);
+		}
+	}
+
+	m_edgeCrossing.resize(m_edges.size(), false);
+	m_netCrossings.resize(m_netSources.size(), 0);
+	m_netMatrix.resize(m_netSources.size(), -1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Routing rules
+
+/**
+	@brief Returns the device entity a netlist node is placed at.
+
+	Paired sites resolve to the entity the cell will be committed as, since the inputs available depend on which half
+	of the pair is active and CommitChanges() hasn't selected it yet during PAR.
+ */
+Greenpak4BitstreamEntity* Greenpak4CongestionModel::GetSiteEntity(PARGraphNode* node)
+{
+	auto entity = static_cast<Greenpak4BitstreamEntity*>(node->GetMate()->GetData());
+
+	auto paired = dynamic_cast<Greenpak4PairedEntity*>(entity);
+	auto cell = dynamic_cast<Greenpak4NetlistCell*>(static_cast<Greenpak4NetlistEntity*>(node->GetData()));
+	if( (paired != NULL) && (cell != NULL) )
+	{
+		auto real = paired->GetEntityForType(cell->m_type);
+		if(real != NULL)
+			return real;
+	}
+
+	return entity;
+}
+
+/**
+	@brief Decides whether a netlist edge needs a cross-connection in the current placement.
+
+	This is the single definition of the rule shared by the PAR cost function and CommitRouting().
+
+	@param edge		The netlist edge
+	@param src		Entity to route the edge from: the source site, or its dual if the load is in the other matrix
+	@param cache	Optional cache for general-fabric-input lookups
+ */
+bool Greenpak4CongestionModel::NeedsCrossConnection(
+	const PARGraphEdge* edge,
+	Greenpak4BitstreamEntity*& src,
+	FabricInputCache* cache)
+{
+	src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
+	auto dst = GetSiteEntity(edge->m_destnode);
+
+	//If the source node has a dual, use the secondary output if needed so we don't waste cross connections
+	if( (src->GetDual() != NULL) && (dst->GetMatrix() != src->GetMatrix()) )
+		src = src->GetDual();
+
+	if(src->GetMatrix() == dst->GetMatrix())
+		return false;
+
+	//Dedicated routing can cross between the matrices freely
+	if(cache == NULL)
+		return dst->IsGeneralFabricInput(edge->m_destport);
+
+	auto key = pair<const Greenpak4BitstreamEntity*, string>(dst, edge->m_destport);
+	auto it = cache->find(key);
+	if(it != cache->end())
+		return it->second;
+	bool fabric = dst->IsGeneralFabricInput(edge->m_destport);
+	(*cache)[key] = fabric;
+	return fabric;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Incremental update
+
+/**
+	@brief Recomputes everything from the current placement
+ */
+void Greenpak4CongestionModel::Rebuild()
+{
+	m_routesUsed[0] = 0;
+	m_routesUsed[1] = 0;
+	for(size_t i=0; i<m_netSources.size(); i++)
+	{
+		m_netCrossings[i] = 0;
+		m_netMatrix[i] = -1;
+	}
+	for(size_t i=0; i<m_edges.size(); i++)
+		m_edgeCrossing[i] = false;
+
+	for(uint32_t i=0; i<m_edges.size(); i++)
+		UpdateEdge(i);
+	for(uint32_t i=0; i<m_netSources.size(); i++)
+		UpdateNet(i);
+}
+
+/**
+	@brief Updates usage after a netlist node has been moved to a new site
+ */
+void Greenpak4CongestionModel::NodeMoved(PARGraphNode* node)
+{
+	auto it = m_nodeEdges.find(node);
+	if(it == m_nodeEdges.end())
+		return;
+
+	for(auto e : it->second)
+		UpdateEdge(e);
+	for(auto e : it->second)
+		UpdateNet(m_edgeNets[e]);
+}
+
+void Greenpak4CongestionModel::UpdateEdge(uint32_t edge)
+{
+	//Edges to unplaced nodes (during exact placement) don't need anything yet
+	auto e = m_edges[edge];
+	bool crossing = false;
+	if( (e->m_sourcenode->GetMate() != NULL) && (e->m_destnode->GetMate() != NULL) )
+	{
+		Greenpak4BitstreamEntity* src;
+		crossing = NeedsCrossConnection(e, src, &m_fabricInputs);
+	}
+	if(crossing == m_edgeCrossing[edge])
+		return;
+
+	m_edgeCrossing[edge] = crossing;
+	if(crossing)
+		m_netCrossings[m_edgeNets[edge]] ++;
+	else
+		m_netCrossings[m_edgeNets[edge]] --;
+}
+
+/**
+	@brief Charges a net to the right matrix once its edges are up to date
+ */
+void Greenpak4CongestionModel::UpdateNet(uint32_t net)
+{
+	int matrix = -1;
+	if( (m_netCrossings[net] != 0) && (m_netSources[net]->GetMate() != NULL) )
+		matrix = static_cast<Greenpak4BitstreamEntity*>(m_netSources[net]->GetMate()->GetData())->GetMatrix();
+
+	if(matrix == m_netMatrix[net])
+		return;
+	if(m_netMatrix[net] >= 0)
+		m_routesUsed[m_netMatrix[net]] --;
+	if(matrix >= 0)
+		m_routesUsed[matrix] ++;
+	m_netMatrix[net] = matrix;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Accessors
+
+uint32_t Greenpak4CongestionModel::GetCost() const
+{
+	//Squaring each half makes minimizing the larger one more important vs if we just summed.
+	//Every route over the limit adds a fixed penalty on top, since such a placement can't be committed at all.
+	uint32_t cost = 0;
+	for(unsigned int i=0; i<2; i++)
+	{
+		cost += m_routesUsed[i] * m_routesUsed[i];
+		if(m_routesUsed[i] > m_routeLimit)
+			cost += 20 * (m_routesUsed[i] - m_routeLimit);
+	}
+	return cost;
+}
+
+/**
+	@brief Gets every edge which needs a cross-connection in the current placement
+ */
+void Greenpak4CongestionModel::GetCrossingEdges(vector<const PARGraphEdge*>& edges) const
+{
+	for(size_t i=0; i<m_edges.size(); i++)
+	{
+		if(m_edgeCrossing[i])
+			edges.push_back(m_edges[i]);
+	}
+}
@@ -0,0 +1,104 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4CongestionModel_h
+#define Greenpak4CongestionModel_h
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+/**
+	@brief Cross-connection usage of a placement, counted exactly the way CommitRouting() allocates them.
+
+	Each source net (netlist node plus output port) which has a general fabric load in the other matrix needs one
+	cross-connection, no matter how many such loads it has. Sources with a dual drive the other matrix directly, and
+	inputs which aren't general fabric routing are reached through dedicated routing, so neither needs one.
+
+	Usage is updated incrementally: call NodeMoved() for each netlist node whose mate changed, or Rebuild() after
+	changing the placement wholesale.
+
+	Unplaced nodes are allowed. Edges touching them are counted as not crossing, so usage of a partial placement
+	never exceeds that of any complete placement extending it.
+ */
+class Greenpak4CongestionModel
+{
+public:
+	Greenpak4CongestionModel(PARGraph* netlist, unsigned int limit);
+
+	void Rebuild();
+	void NodeMoved(PARGraphNode* node);
+
+	unsigned int GetRoutesUsed(unsigned int matrix) const
+	{ return m_routesUsed[matrix]; }
+
+	unsigned int GetRouteLimit() const
+	{ return m_routeLimit; }
+
+	bool IsOverCapacity() const
+	{ return (m_routesUsed[0] > m_routeLimit) || (m_routesUsed[1] > m_routeLimit); }
+
+	uint32_t GetCost() const;
+
+	void GetCrossingEdges(std::vector<const PARGraphEdge*>& edges) const;
+
+	//Cache of Greenpak4BitstreamEntity::IsGeneralFabricInput() results
+	typedef std::map<std::pair<const Greenpak4BitstreamEntity*, std::string>, bool> FabricInputCache;
+
+	static bool NeedsCrossConnection(
+		const PARGraphEdge* edge,
+		Greenpak4BitstreamEntity*& src,
+		FabricInputCache* cache = NULL);
+
+	static Greenpak4BitstreamEntity* GetSiteEntity(PARGraphNode* node);
+
+protected:
+	void UpdateEdge(uint32_t edge);
+	void UpdateNet(uint32_t net);
+
+	///Number of cross-connections available in each direction
+	unsigned int m_routeLimit;
+
+	///Every edge in the netlist
+	std::vector<const PARGraphEdge*> m_edges;
+
+	///Source net of each edge
+	std::vector<uint32_t> m_edgeNets;
+
+	///True if the edge needs a cross-connection in the current placement
+	std::vector<bool> m_edgeCrossing;
+
+	///Edges with the given netlist node on either end
+	std::unordered_map<PARGraphNode*, std::vector<uint32_t> > m_nodeEdges;
+
+	///Number of edges of each net which need a cross-connection
+	std::vector<uint32_t> m_netCrossings;
+
+	///Matrix whose cross-connections each net is using, or -1 if none
+	std::vector<int> m_netMatrix;
+
+	///Driver of each net
+	std::vector<PARGraphNode*> m_netSources;
+
+	///Number of cross-connections used in each direction (indexed by source matrix)
+	unsigned int m_routesUsed[2];
+
+	FabricInputCache m_fabricInputs;
+};
+
+#endif
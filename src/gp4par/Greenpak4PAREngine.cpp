@@ -27,6 +27,7 @@ using namespace std;
 Greenpak4PAREngine::Greenpak4PAREngine(PARGraph* netlist, PARGraph* device, labelmap& lmap)
 	: PAREngine(netlist, device)
 	, m_lmap(lmap)
+	, m_congestion(netlist, GetCrossConnectionCount(device))
 {
 
 }
@@ -36,6 +37,17 @@ Greenpak4PAREngine::~Greenpak4PAREngine()
 
 }
 
+/**
+	@brief Gets the number of cross-connections in each direction for the device a graph was built from
+ */
+unsigned int Greenpak4PAREngine::GetCrossConnectionCount(PARGraph* device)
+{
+	if(device->GetNumNodes() == 0)
+		return 0;
+	return static_cast<Greenpak4BitstreamEntity*>(device->GetNodeByIndex(0)->GetData())->GetDevice()
+		->GetCrossConnectionCount();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Initial placement
 
@@ -105,6 +117,10 @@ bool Greenpak4PAREngine::InitialPlacement_core()
 		node->MateWith(spnode);
 	}
 
+	//Put cells back where the previous run had them, if we have one
+	if(!m_previousPlacement.empty())
+		ApplyPreviousPlacement(nmap);
+
 	//For each label, mate each node in the netlist with the first legal mate in the device.
 	//Simple and deterministic.
 	uint32_t nmax_net = m_netlist->GetMaxLabel();
@@ -161,49 +177,216 @@ bool Greenpak4PAREngine::InitialPlacement_core()
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Congestion metrics
+// Incremental placement
 
-uint32_t Greenpak4PAREngine::ComputeCongestionCost() const
+/**
+	@brief Loads a placement written by SavePlacement() on a previous run.
+
+	Cells whose names still match will start out at their old sites, and the anneal is shortened so that only new or
+	changed cells move unless that isn't enough to route the design.
+ */
+bool Greenpak4PAREngine::LoadPreviousPlacement(string fname)
 {
-	uint32_t costs[2] = {0};
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+	{
+		LogError("Failed to open placement file %s\n", fname.c_str());
+		return false;
+	}
 
-	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
+	char line[1024];
+	while(NULL != fgets(line, sizeof(line), fp))
 	{
-		//If no node in the netlist is assigned to us, nothing to do
-		PARGraphNode* node = m_device->GetNodeByIndex(i);
-		PARGraphNode* netnode = node->GetMate();
-		if(netnode == NULL)
+		//Skip comments and blank lines
+		string s = line;
+		while(!s.empty() && isspace(s[s.length()-1]))
+			s.resize(s.length()-1);
+		if(s.empty() || (s[0] == '#'))
 			continue;
 
-		//Find all edges crossing the central routing matrix
-		for(uint32_t i=0; i<netnode->GetEdgeCount(); i++)
+		//Cell names may contain just about anything, but site names never contain whitespace
+		size_t sep = s.find_last_of(" \t");
+		if(sep == string::npos)
 		{
-			auto edge = netnode->GetEdgeByIndex(i);
-			auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
-			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
-			uint32_t sm = src->GetMatrix();
-			uint32_t dm = dst->GetMatrix();
-
-			//If we're driving a port that isn't general fabric routing, then it doesn't compete for cross connections
-			if(!dst->IsGeneralFabricInput(edge->m_destport))
-				continue;
+			LogWarning("Ignoring malformed placement line %s\n", s.c_str());
+			continue;
+		}
+		m_previousPlacement[s.substr(0, sep)] = s.substr(sep + 1);
+	}
+	fclose(fp);
 
-			//If the source has a dual, don't count this in the cost since it can route anywhere
-			if(src->GetDual() != NULL)
-				continue;
+	//Shorter, colder anneal
+	m_initialTemperature = m_maxTemperature / 10;
 
-			//If matrices don't match, bump cost
-			if(sm != dm)
-				costs[sm] ++;
+	LogVerbose("Loaded previous placement of %zu cells from %s\n", m_previousPlacement.size(), fname.c_str());
+	return true;
+}
+
+/**
+	@brief Writes the best placement found as a list of cell name / site name pairs
+ */
+bool Greenpak4PAREngine::SavePlacement(string fname) const
+{
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	//Sort by cell name so the file is stable from run to run
+	map<string, string> placement;
+	for(auto it : m_bestPlacementFound)
+	{
+		auto cell = static_cast<Greenpak4NetlistEntity*>(it.first->GetData());
+		auto site = static_cast<Greenpak4BitstreamEntity*>(it.second->GetData());
+		placement[cell->m_name] = site->GetDescription();
+	}
+
+	fprintf(fp, "# gp4par placement: cell site\n");
+	for(auto it : placement)
+		fprintf(fp, "%s %s\n", it.first.c_str(), it.second.c_str());
+
+	fclose(fp);
+	return true;
+}
+
+/**
+	@brief Places cells at their sites from the previous run, where that's still legal.
+
+	Cells placed in a site whose primary type differs from their own (e.g. a DFF in a DFFSR site) are only kept if
+	enough sites of that type remain free for the netlist cells which need them.
+ */
+void Greenpak4PAREngine::ApplyPreviousPlacement(map<string, Greenpak4BitstreamEntity*>& nmap)
+{
+	LogVerbose("Restoring previous placement...\n");
+	LogIndenter li;
+
+	//Count spare sites of each type after LOC constraints have been applied
+	map<uint32_t, int> spare;
+	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
+	{
+		auto dnode = m_device->GetNodeByIndex(i);
+		if(dnode->GetMate() == NULL)
+			spare[dnode->GetLabel()] ++;
+	}
+	for(uint32_t i=0; i<m_netlist->GetNumNodes(); i++)
+	{
+		auto node = m_netlist->GetNodeByIndex(i);
+		if(node->GetMate() == NULL)
+			spare[node->GetLabel()] --;
+	}
+
+	unsigned int nkept = 0;
+	for(uint32_t i=0; i<m_netlist->GetNumNodes(); i++)
+	{
+		auto node = m_netlist->GetNodeByIndex(i);
+		if(node->GetMate() != NULL)
+			continue;
+
+		auto cell = static_cast<Greenpak4NetlistEntity*>(node->GetData());
+		auto it = m_previousPlacement.find(cell->m_name);
+		if(it == m_previousPlacement.end())
+			continue;
+
+		//Site must still exist, be free, and be legal for this cell
+		auto jt = nmap.find(it->second);
+		if(jt == nmap.end())
+			continue;
+		auto spnode = jt->second->GetPARNode();
+		if( (spnode->GetMate() != NULL) || !spnode->MatchesLabel(node->GetLabel()) )
+			continue;
+
+		//Don't steal a site that someone of its primary type will need
+		uint32_t slabel = spnode->GetLabel();
+		if(slabel != node->GetLabel())
+		{
+			if(spare[slabel] <= 0)
+				continue;
+			spare[slabel] --;
+			spare[node->GetLabel()] ++;
 		}
+
+		node->MateWith(spnode);
+		m_preservedNodes.insert(node);
+		nkept ++;
 	}
 
-	//Squaring each half makes minimizing the larger one more important
-	//vs if we just summed. Also add in a fixed penalty if we are using >100% resources
-	uint32_t cost = costs[0]*costs[0] + costs[1]*costs[1];
-	if( (costs[0] > 10) || (costs[1] > 10) )
-		cost += 20;
-	return cost;
+	LogVerbose("%u of %u cells kept their previous placement\n", nkept, m_netlist->GetNumNodes());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Congestion metrics
+
+/**
+	@brief Congestion cost, from the incrementally maintained cross-connection usage
+ */
+uint32_t Greenpak4PAREngine::ComputeCongestionCost() const
+{
+	return m_congestion.GetCost();
+}
+
+void Greenpak4PAREngine::OnNodeMoved(PARGraphNode* node)
+{
+	m_congestion.NodeMoved(node);
+}
+
+void Greenpak4PAREngine::OnPlacementReset()
+{
+	m_congestion.Rebuild();
+}
+
+/**
+	@brief Fails placements which CommitRouting() would run out of cross-connections for
+ */
+bool Greenpak4PAREngine::CheckFinalPlacement() const
+{
+	if(!m_congestion.IsOverCapacity())
+		return true;
+
+	LogError(
+		"More than 100%% of device resources are used "
+		"(cross connections: %u east, %u west, %u available in each direction)\n",
+		m_congestion.GetRoutesUsed(0),
+		m_congestion.GetRoutesUsed(1),
+		m_congestion.GetRouteLimit());
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Exact placement
+
+/**
+	@brief Sites are only interchangeable if they're the same primitive in the same matrix, with the same dual
+	(so they use cross-connections the same way)
+ */
+string Greenpak4PAREngine::GetSiteClass(PARGraphNode* site) const
+{
+	auto entity = static_cast<Greenpak4BitstreamEntity*>(site->GetData());
+	char matrix[32];
+	snprintf(matrix, sizeof(matrix), "/%u/%d",
+		entity->GetMatrix(),
+		(entity->GetDual() != NULL) ? static_cast<int>(entity->GetDual()->GetMatrix()) : -1);
+	return entity->GetPrimitiveName() + matrix;
+}
+
+/**
+	@brief Cross-connection usage only grows as more nodes are placed, so the partial cost bounds the final one
+ */
+uint32_t Greenpak4PAREngine::ComputeCostLowerBound() const
+{
+	return m_congestion.GetCost();
+}
+
+bool Greenpak4PAREngine::ExceedsCapacity() const
+{
+	return m_congestion.IsOverCapacity();
+}
+
+bool Greenpak4PAREngine::IsNodeFixed(PARGraphNode* node) const
+{
+	auto cell = dynamic_cast<Greenpak4NetlistCell*>(static_cast<Greenpak4NetlistEntity*>(node->GetData()));
+	return (cell != NULL) && cell->HasLOC();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -273,41 +456,18 @@ void Greenpak4PAREngine::FindSubOptimalPlacements(std::vector<PARGraphNode*>& ba
 {
 	std::set<PARGraphNode*> nodes;
 
-	//Find all nodes that have at least one cross-spine route
-	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
+	//Find all nodes driving a net which needs a cross-connection
+	vector<const PARGraphEdge*> crossing;
+	m_congestion.GetCrossingEdges(crossing);
+	for(auto edge : crossing)
 	{
-		//If no node in the netlist is assigned to us, nothing to do
-		PARGraphNode* node = m_device->GetNodeByIndex(i);
-		PARGraphNode* netnode = node->GetMate();
-		if(netnode == NULL)
+		//If there's nothing we can do about it, skip
+		if(CantMoveSrc(static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData())))
+			continue;
+		if(CantMoveDst(static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData())))
 			continue;
 
-		for(uint32_t i=0; i<netnode->GetEdgeCount(); i++)
-		{
-			auto edge = netnode->GetEdgeByIndex(i);
-			auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
-			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
-
-			//Cross connections
-			unsigned int srcmatrix = src->GetMatrix();
-			if(srcmatrix != dst->GetMatrix())
-			{
-				//If there's nothing we can do about it, skip
-				if(CantMoveSrc(src))
-					continue;
-				if(CantMoveDst(dst))
-					continue;
-				if(!dst->IsGeneralFabricInput(edge->m_destport))
-					continue;
-
-				//Anything with a dual is always in an optimal location as far as congestion goes
-				if(src->GetDual() != NULL)
-					continue;
-
-				//Add the node
-				nodes.insert(edge->m_sourcenode);
-			}
-		}
+		nodes.insert(edge->m_sourcenode);
 	}
 
 	//Find all nodes that are on one end of an unroutable edge
@@ -328,9 +488,18 @@ void Greenpak4PAREngine::FindSubOptimalPlacements(std::vector<PARGraphNode*>& ba
 		}
 	}
 
-	//Push into the final output list
+	//Push into the final output list.
+	//During incremental placement, leave cells from the previous run alone unless they're the only candidates.
 	for(auto x : nodes)
-		bad_nodes.push_back(x);
+	{
+		if(m_preservedNodes.find(x) == m_preservedNodes.end())
+			bad_nodes.push_back(x);
+	}
+	if(bad_nodes.empty())
+	{
+		for(auto x : nodes)
+			bad_nodes.push_back(x);
+	}
 
 	//DEBUG
 	/*
@@ -28,6 +28,9 @@ public:
 	Greenpak4PAREngine(PARGraph* netlist, PARGraph* device, labelmap& lmap);
 	virtual ~Greenpak4PAREngine();
 
+	bool LoadPreviousPlacement(std::string fname);
+	bool SavePlacement(std::string fname) const;
+
 protected:
 	virtual void PrintUnroutes(std::vector<const PARGraphEdge*>& unroutes) const override;
 
@@ -39,14 +42,36 @@ protected:
 
 	virtual bool CanMoveNode(PARGraphNode* node, PARGraphNode* old_mate, PARGraphNode* new_mate) const override;
 
+	virtual void OnNodeMoved(PARGraphNode* node) override;
+	virtual void OnPlacementReset() override;
+	virtual bool CheckFinalPlacement() const override;
+
+	virtual std::string GetSiteClass(PARGraphNode* site) const override;
+	virtual uint32_t ComputeCostLowerBound() const override;
+	virtual bool ExceedsCapacity() const override;
+	virtual bool IsNodeFixed(PARGraphNode* node) const override;
+
+	static unsigned int GetCrossConnectionCount(PARGraph* device);
+
 	bool CantMoveSrc(Greenpak4BitstreamEntity* src);
 	bool CantMoveDst(Greenpak4BitstreamEntity* dst);
 
+	void ApplyPreviousPlacement(std::map<std::string, Greenpak4BitstreamEntity*>& nmap);
+
 	//Cached list of unroutable nodes for the current iteration
 	std::set<PARGraphNode*> m_unroutableNodes;
 
+	//Cell name to site name mapping from a previous run (for incremental placement)
+	std::map<std::string, std::string> m_previousPlacement;
+
+	//Netlist nodes that were placed where the previous run put them
+	std::set<PARGraphNode*> m_preservedNodes;
+
 	//used for error messages only
 	labelmap m_lmap;
+
+	//Cross-connection usage of the current placement
+	Greenpak4CongestionModel m_congestion;
 };
 
 #endif
@@ -41,8 +41,10 @@ bool CommitChanges(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
 			continue;
 
 		//If any node fails to commit, abort
-		if(!static_cast<Greenpak4BitstreamEntity*>(node->GetData())->CommitChanges())
+		auto entity = static_cast<Greenpak4BitstreamEntity*>(node->GetData());
+		if(!entity->CommitChanges())
 			fail = true;
+		entity->MarkDirty();
 	}
 
 	if(fail)
@@ -82,26 +84,20 @@ bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
 		for(uint32_t i=0; i<netnode->GetEdgeCount(); i++)
 		{
 			auto edge = netnode->GetEdgeByIndex(i);
-			auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
 			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
 
-			//If the source node has a dual, use the secondary output if needed
-			//so we don't waste cross connections
-			if(src->GetDual())
-			{
-				if(dst->GetMatrix() != src->GetMatrix())
-					src = src->GetDual();
-			}
+			//Pick the source (or its dual) and check if we need a cross connection.
+			//This uses the same rules as the PAR engine's congestion model, so a successful PAR always commits.
+			Greenpak4BitstreamEntity* src;
+			bool crossing = Greenpak4CongestionModel::NeedsCrossConnection(edge, src);
 
 			//Look up the actual NET (not just the entity) for the source.
 			//If we don't do this we risk merging cross-connections that should not be (see github issue #13)
 			Greenpak4EntityOutput srcnet = src->GetOutput(edge->m_sourceport);
 
 			//Cross connections
-			//Only use these if destination node is general fabric routing; dedicated routing can cross between
-			//the matrices freely
 			unsigned int srcmatrix = src->GetMatrix();
-			if( (srcmatrix != dst->GetMatrix()) && dst->IsGeneralFabricInput(edge->m_destport) )
+			if(crossing)
 			{
 				//Reuse existing connections, if any
 				if(nodemap.find(srcnet) != nodemap.end())
@@ -112,8 +108,12 @@ bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
 				{
 					//We need to jump from one matrix to another!
 					//Make sure we have a free cross-connection to use
-					if(num_routes_used[srcmatrix] >= 10)
+					//(but keep counting each net only once, so the utilization report is accurate)
+					if(num_routes_used[srcmatrix] >= pdev->GetCrossConnectionCount())
+					{
 						ran_out = true;
+						nodemap[srcnet] = srcnet;
+					}
 
 					else
 					{
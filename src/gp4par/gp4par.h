@@ -29,6 +29,7 @@
 typedef std::map<uint32_t, std::string> labelmap;
 typedef std::map<std::string, uint32_t> ilabelmap;
 
+#include "Greenpak4CongestionModel.h"
 #include "Greenpak4PAREngine.h"
 
 //Console help
@@ -50,7 +51,13 @@ bool BuildGraphs(
 void ApplyLocConstraints(Greenpak4Netlist* netlist, PARGraph* ngraph, PARGraph* dgraph);
 
 //PAR core
-bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device);
+bool DoPAR(
+	Greenpak4Netlist* netlist,
+	Greenpak4Device* device,
+	PARStatistics& stats,
+	std::string placement_in = "",
+	std::string placement_out = "",
+	PAREngine::PlacementAlgorithm placer = PAREngine::PLACER_ANNEAL);
 
 //DRC
 bool PostPARDRC(PARGraph* netlist, Greenpak4Device* device);
@@ -59,6 +66,21 @@ bool PostPARDRC(PARGraph* netlist, Greenpak4Device* device);
 bool CommitChanges(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_routes_used);
 bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_routes_used);
 
+//Result caching
+std::string HashPARInputs(
+	Greenpak4Netlist* netlist,
+	std::string pcfname,
+	std::string tfname,
+	std::string placement_in,
+	std::string options);
+bool FetchCachedResult(std::string cachedir, std::string hash, std::string ofname);
+bool StoreCachedResult(
+	std::string cachedir,
+	std::string hash,
+	std::string bitfname,
+	std::string logfname,
+	uint64_t maxsize);
+
 //Reporting
 void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned int* num_routes_used);
 void PrintPlacementReport(PARGraph* netlist, Greenpak4Device* device);
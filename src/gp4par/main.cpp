@@ -17,6 +17,7 @@
  **********************************************************************************************************************/
 
 #include "gp4par.h"
+#include <sys/stat.h>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -75,6 +76,23 @@ int main(int argc, char* argv[])
 	unsigned int userid = 0;
 	bool readProtect = false;
 
+	//Output file for PAR statistics (if empty, don't write them)
+	string statsfname = "";
+
+	//Timing data (if empty, search for the part's compiled database)
+	string tfname = "";
+
+	//Placement files for incremental PAR
+	string placement_in = "";
+	string placement_out = "";
+
+	//Placement algorithm
+	PAREngine::PlacementAlgorithm placer = PAREngine::PLACER_ANNEAL;
+
+	//PAR result cache directory (if empty, don't cache) and its size limit
+	string cachedir = "";
+	uint64_t cachesize = 64 * 1024 * 1024;
+
 	//Parse command-line arguments
 	for(int i=1; i<argc; i++)
 	{
@@ -214,6 +232,87 @@ int main(int argc, char* argv[])
 				return 1;
 			}
 		}
+		else if(s == "--cache")
+		{
+			if(i+1 < argc)
+				cachedir = argv[++i];
+			else
+			{
+				printf("ERROR: --cache requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--cache-size")
+		{
+			if(i+1 < argc)
+				cachesize = static_cast<uint64_t>(atoi(argv[++i])) * 1024 * 1024;
+			else
+			{
+				printf("ERROR: --cache-size requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--placement-in")
+		{
+			if(i+1 < argc)
+				placement_in = argv[++i];
+			else
+			{
+				printf("ERROR: --placement-in requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--placement-out")
+		{
+			if(i+1 < argc)
+				placement_out = argv[++i];
+			else
+			{
+				printf("ERROR: --placement-out requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--placer")
+		{
+			if(i+1 < argc)
+			{
+				string algorithm = argv[++i];
+				if(algorithm == "anneal")
+					placer = PAREngine::PLACER_ANNEAL;
+				else if(algorithm == "exact")
+					placer = PAREngine::PLACER_EXACT;
+				else
+				{
+					printf("ERROR: --placer must be one of anneal, exact\n");
+					return 1;
+				}
+			}
+			else
+			{
+				printf("ERROR: --placer requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--timing")
+		{
+			if(i+1 < argc)
+				tfname = argv[++i];
+			else
+			{
+				printf("ERROR: --timing requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--stats-json")
+		{
+			if(i+1 < argc)
+				statsfname = argv[++i];
+			else
+			{
+				printf("ERROR: --stats-json requires an argument\n");
+				return 1;
+			}
+		}
 		else if(s == "-c" || s == "--constraints")
 		{
 			if(i+1 < argc)
@@ -389,6 +488,32 @@ int main(int argc, char* argv[])
 		LogNotice("Charge pump:     %s\n", disableChargePump ? "off" : "auto");
 		LogNotice("LDO:             %s\n", ldoBypass ? "bypassed" : "enabled");
 		LogNotice("Boot retry:      %d times\n", bootRetry);
+		LogNotice("Placer:          %s\n", (placer == PAREngine::PLACER_EXACT) ? "exact" : "anneal");
+	}
+
+	//Find the timing data for this part, unless we were told where it is
+	if(tfname == "")
+		tfname = Greenpak4TimingDatabase::Find(Greenpak4Device::GetPartAsString(part));
+
+	//If we've implemented this exact design before, reuse the result
+	string hash;
+	if(cachedir != "")
+	{
+		char options[256];
+		snprintf(options, sizeof(options), "part=%d pull=%d drive=%d precharge=%d nopump=%d ldobypass=%d "
+			"retry=%d userid=%x protect=%d placer=%d",
+			(int)part, (int)unused_pull, (int)unused_drive, ioPrecharge, disableChargePump, ldoBypass,
+			bootRetry, userid, readProtect, (int)placer);
+		hash = HashPARInputs(&netlist, pcfname, tfname, placement_in, options);
+
+#ifdef _WIN32
+		mkdir(cachedir.c_str());
+#else
+		mkdir(cachedir.c_str(), 0755);
+#endif
+		if(FetchCachedResult(cachedir, hash, ofname))
+			return 0;
+		LogVerbose("No cached PAR result for %s\n", hash.c_str());
 	}
 
 	//Create the device and initialize all IO pins
@@ -399,15 +524,47 @@ int main(int argc, char* argv[])
 	device.SetNVMRetryCount(bootRetry);
 
 	//Attempt to load the timing data file, if present
-	//FIXME: get this from a sane location and make it chip specific
-	string tfname = "../../../timing.json";
-	LogNotice("\nLoading timing data file \"%s\"\n", tfname.c_str());
-	if(!device.LoadTimingData(tfname))
-		LogWarning("Timing data file not found, unable to do timing-driven placement or evaluate post-PAR timing\n");
+	if(tfname == "")
+		LogWarning("No timing database found, unable to do timing-driven placement or evaluate post-PAR timing\n");
+	else
+	{
+		LogNotice("\nLoading timing data file \"%s\"\n", tfname.c_str());
+		if(!device.LoadTimingData(tfname))
+			LogWarning("Couldn't load timing data, unable to do timing-driven placement or evaluate post-PAR timing\n");
+	}
+
+	//Capture the PAR log so it can be replayed on a cache hit
+	string cachelog = "";
+	FILE* cachelogfp = NULL;
+	if(cachedir != "")
+	{
+		cachelog = cachedir + "/" + hash + ".log.tmp";
+		cachelogfp = fopen(cachelog.c_str(), "w");
+		if(cachelogfp)
+			g_log_sinks.emplace_back(new FILELogSink(cachelogfp, false, Severity::NOTICE));
+		else
+			cachelog = "";
+	}
 
 	//Do the actual P&R
 	LogNotice("\nImplementing top-level module \"%s\".\n", netlist.GetTopModule()->GetName().c_str());
-	if(!DoPAR(&netlist, &device))
+	PARStatistics stats;
+	bool ok = DoPAR(&netlist, &device, stats, placement_in, placement_out, placer);
+	if(cachelogfp)
+	{
+		fflush(cachelogfp);
+		g_log_sinks.pop_back();
+		if(!ok)
+			remove(cachelog.c_str());
+	}
+	stats.Print();
+	if(!statsfname.empty())
+	{
+		LogNotice("\nWriting PAR statistics to \"%s\"\n", statsfname.c_str());
+		if(!stats.WriteToJSON(statsfname))
+			return 1;
+	}
+	if(!ok)
 		return 1;
 
 	//Write the final bitstream
@@ -419,6 +576,10 @@ int main(int argc, char* argv[])
 			return 1;
 	}
 
+	//Save the result for next time
+	if(cachelog != "")
+		StoreCachedResult(cachedir, hash, ofname, cachelog, cachesize);
+
 	return 0;
 }
 
@@ -426,6 +587,12 @@ void ShowUsage()
 {
 	printf(//                                                                               v 80th column
 		"Usage: gp4par [options] -p part -o bitstream.txt netlist.json\n"
+		"    --cache              <dir>\n"
+		"        Caches PAR results in <dir>, keyed by a hash of the netlist, constraints,\n"
+		"        options and tool version. Unchanged designs reuse the cached bitstream.\n"
+		"    --cache-size         <MB>\n"
+		"        Maximum size of the PAR result cache (default 64). Least recently used\n"
+		"        entries are evicted first.\n"
 		"    -c, --constraints <file>\n"
 		"        Reads placement constraints from <file>\n"
 		"    --debug\n"
@@ -449,9 +616,26 @@ void ShowUsage()
 		"        Writes bitstream into the specified file.\n"
 		"    -p, --part\n"
 		"        Specifies the part to target (SLG46620V, SLG46621V, or SLG46140V)\n"
+		"    --placement-in       <file>\n"
+		"        Starts from a placement saved by --placement-out on a previous run. Cells\n"
+		"        whose names still match keep their sites and only new or changed cells\n"
+		"        are placed, using a shorter anneal.\n"
+		"    --placement-out      <file>\n"
+		"        Saves the final placement (cell and site names) to <file>.\n"
+		"    --placer             [anneal|exact]\n"
+		"        Selects the placement algorithm. anneal (the default) is fast but may give\n"
+		"        up on hard designs. exact searches every distinct placement and either\n"
+		"        finds the one using the fewest cross-connections or proves there is none.\n"
 		"    -q, --quiet\n"
 		"        Causes only warnings and errors to be written to the console.\n"
 		"        Specify twice to also silence warnings.\n"
+		"    --stats-json         <file>\n"
+		"        Writes run time, peak memory and annealer move statistics to <file>\n"
+		"        in JSON format.\n"
+		"    --timing             <file>\n"
+		"        Reads timing data from <file>, either a database compiled by gp4tdb or\n"
+		"        JSON from gp4tchar. By default <part>.gp4t is searched for in each\n"
+		"        directory of $GP4_TIMING_PATH, then in the install location.\n"
 		"    --unused-pull        [down|up|float]\n"
 		"        Specifies direction to pull unused pins.\n"
 		"    --unused-drive       [10k|100k|1m]\n"
@@ -111,14 +111,11 @@ void ReplicateVREF(
 	PARGraph*& ngraph,
 	ilabelmap& ilmap)
 {
-
-
-	//Monotonically increasing counter used to ensure unique node IDs
-	static unsigned int vref_id = 1;
+	auto netlist = module->GetNetlist();
 
 	//Create a new VREF and copy the input config
 	Greenpak4NetlistCell* vref = new Greenpak4NetlistCell(module);
-	vref->m_type = "GP_VREF";
+	vref->SetType("GP_VREF");
 	vref->m_connections["VIN"].push_back(cell->m_connections["VIN"][0]);
 	vref->m_parameters = cell->m_parameters;
 	vref->m_attributes = cell->m_attributes;
@@ -127,7 +124,7 @@ void ReplicateVREF(
 	char tmp[128];
 	snprintf(tmp, sizeof(tmp), "$auto$make_graphs.cpp:%d:vref$%u",
 		__LINE__,
-		vref_id ++);
+		netlist->AllocateAutoID("vref"));
 	vref->m_name = tmp;
 
 	//and add it to the module
@@ -136,7 +133,7 @@ void ReplicateVREF(
 	//Create a net for the output
 	snprintf(tmp, sizeof(tmp), "$auto$make_graphs.cpp:%d:vref$%u",
 		__LINE__,
-		vref_id ++);
+		netlist->AllocateAutoID("vref"));
 	Greenpak4NetlistNode* vout = new Greenpak4NetlistNode;
 	vout->m_name = tmp;
 	vout->m_src_locations = net->m_src_locations;
@@ -201,7 +198,7 @@ bool InferExtraNodes(
 	{
 		//Skip anything but DACs
 		Greenpak4NetlistCell* cell = it->second;
-		if(cell->m_type != "GP_DAC")
+		if(cell->m_typeId != GP_CELL_DAC)
 			continue;
 
 		//If we're driven by a power rail, skip it - input is constant
@@ -227,7 +224,7 @@ bool InferExtraNodes(
 		{
 			if(jt.IsNull())
 				continue;
-			if(jt.m_cell->m_type == "GP_DCMP")
+			if(jt.m_cell->m_typeId == GP_CELL_DCMP)
 				dcmps.push_back(jt.m_cell);
 		}
 
@@ -237,12 +234,9 @@ bool InferExtraNodes(
 			LogDebug("No DCMP driven by this cell, creating a dummy\n");
 			madeChanges = true;
 
-			//Monotonically increasing counter used to ensure unique node IDs
-			static unsigned int dcmp_id = 1;
-
 			//Create the cell
 			Greenpak4NetlistCell* dcmp = new Greenpak4NetlistCell(module);
-			dcmp->m_type = "GP_DCMP";
+			dcmp->SetType("GP_DCMP");
 
 			//Tie its negative input to our input
 			char tmp[128];
@@ -258,7 +252,7 @@ bool InferExtraNodes(
 			//Give it a name
 			snprintf(tmp, sizeof(tmp), "$auto$make_graphs.cpp:%d:dcmp$%u",
 				__LINE__,
-				dcmp_id ++);
+				netlist->AllocateAutoID("dcmp"));
 			dcmp->m_name = tmp;
 
 			//Set a special attribute on the cell so that we don't give a "has no loads" warning
@@ -328,7 +322,7 @@ bool InferExtraNodes(
 		auto driver = net->m_driver;
 		if(driver.IsNull())
 			continue;
-		if( (driver.m_cell->m_type != "GP_VREF") || (driver.m_portname != "VOUT") )
+		if( (driver.m_cell->m_typeId != GP_CELL_VREF) || (driver.m_portname != "VOUT") )
 			continue;
 		Greenpak4NetlistCell* vref = driver.m_cell;
 
@@ -342,7 +336,7 @@ bool InferExtraNodes(
 		{
 			if(jt.IsNull())
 				continue;
-			if(jt.m_cell->m_type == "GP_ACMP")
+			if(jt.m_cell->m_typeId == GP_CELL_ACMP)
 				acmps.push_back(jt.m_cell);
 		}
 
@@ -353,12 +347,9 @@ bool InferExtraNodes(
 			LogDebug("No comparator driven by this VREF, creating a dummy\n");
 			madeChanges = true;
 
-			//Monotonically increasing counter used to ensure unique node IDs
-			static unsigned int acmp_id = 1;
-
 			//Create the cell and tie its VREF to our input
 			Greenpak4NetlistCell* acmp = new Greenpak4NetlistCell(module);
-			acmp->m_type = "GP_ACMP";
+			acmp->SetType("GP_ACMP");
 			acmp->m_connections["VREF"].push_back(net);
 
 			//TODO: Determine whether we actually *need* to power on the comparator
@@ -370,7 +361,7 @@ bool InferExtraNodes(
 			char tmp[128];
 			snprintf(tmp, sizeof(tmp), "$auto$make_graphs.cpp:%d:acmp$%u",
 				__LINE__,
-				acmp_id ++);
+				netlist->AllocateAutoID("acmp"));
 			acmp->m_name = tmp;
 
 			//Set a special attribute so that we don't give a "has no loads" warning
@@ -413,7 +404,7 @@ bool InferExtraNodes(
 	{
 		//See if we're a VREF
 		Greenpak4NetlistCell* cell = it->second;
-		if(cell->m_type != "GP_VREF")
+		if(cell->m_typeId != GP_CELL_VREF)
 			continue;
 		//LogDebug("vref %s\n", cell->m_name.c_str());
 
@@ -427,7 +418,7 @@ bool InferExtraNodes(
 			//Skip anything not a comparator or DAC
 			auto load = net->m_nodeports[i].m_cell;
 			//LogDebug("    load %s type %s\n", load->m_name.c_str(), load->m_type.c_str());
-			if( (load->m_type != "GP_ACMP") && (load->m_type != "GP_DAC") )
+			if( (load->m_typeId != GP_CELL_ACMP) && (load->m_typeId != GP_CELL_DAC) )
 				continue;
 
 			//If this is the first one, flag it but don't do anything
@@ -490,6 +481,18 @@ bool MakeNetlistNodes(
 	ilmap["GP_DLATCHSR"] = ilmap["GP_DFFSR"];
 	ilmap["GP_DLATCHSRI"] = ilmap["GP_DFFSR"];
 
+	//Resolve the label for each interned primitive type once, so each cell is just an array lookup
+	vector<uint32_t> typeLabels(GP_CELL_TYPE_COUNT, 0);
+	vector<bool> typeValid(GP_CELL_TYPE_COUNT, false);
+	for(int i=GP_CELL_UNKNOWN+1; i<GP_CELL_TYPE_COUNT; i++)
+	{
+		auto it = ilmap.find(Greenpak4NetlistCell::GetTypeName((Greenpak4CellType)i));
+		if(it == ilmap.end())
+			continue;
+		typeLabels[i] = it->second;
+		typeValid[i] = true;
+	}
+
 	//Create the actual nodes in the netlist
 	Greenpak4NetlistModule* module = netlist->GetTopModule();
 	for(auto it = module->cell_begin(); it != module->cell_end(); it ++)
@@ -497,8 +500,8 @@ bool MakeNetlistNodes(
 		//Figure out the type of node
 		Greenpak4NetlistCell* cell = it->second;
 		uint32_t label = 0;
-		if(ilmap.find(cell->m_type) != ilmap.end())
-			label = ilmap[cell->m_type];
+		if(typeValid[cell->m_typeId])
+			label = typeLabels[cell->m_typeId];
 		else
 		{
 			LogError(
@@ -512,7 +515,7 @@ bool MakeNetlistNodes(
 		//TODO: see if any other pre-divider values are special?
 		//Note that GP_COUNT8_ADV always has a 4-bit input mux, as does a GP_COUNT14_ADV
 		//so no special casing needed for those
-		if(cell->m_type == "GP_COUNT8")
+		if(cell->m_typeId == GP_CELL_COUNT8)
 		{
 			//See if we have CLKIN_DIVIDE == 12
 			if(cell->m_parameters["CLKIN_DIVIDE"] == "12")
@@ -743,51 +746,62 @@ void MakeDeviceNodes(
 
 /**
 	@brief Make all of the edges in the netlist
+
+	Walks the flat netlist index, so port directions and names are already resolved for every pin.
  */
 bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 {
 	LogDebug("Creating PAR netlist...\n");
 	LogIndenter li;
 
-	for(auto it = netlist->nodebegin(); it != netlist->nodeend(); it ++)
+	auto& index = netlist->GetIndex();
+
+	//Unnamed nets have never had edges made for them, keep it that way
+	for(uint32_t net = 0; net < index.m_namedNetCount; net ++)
 	{
-		Greenpak4NetlistNode* node = *it;
+		Greenpak4NetlistNode* node = index.m_nets[net];
 
 		LogDebug("Node %s is sourced by:\n", node->m_name.c_str());
 		LogIndenter li;
 
-		PARGraphNode* source = NULL;
-		string sourceport = "";
-
 		//Nets sourced by port are special - no edges
 		bool sourced_by_port = false;
-		for(auto p : node->m_ports)
+		uint32_t nports = index.m_netPortStart[net+1] - index.m_netPortStart[net];
+		for(uint32_t i = index.m_netPortStart[net]; i < index.m_netPortStart[net+1]; i++)
 		{
-			if(p->m_direction != Greenpak4NetlistPort::DIR_OUTPUT)
-			{
-				//Greenpak4NetlistNet* net = netlist->GetTopModule()->GetNet(p->m_name);
-				//LogVerbose("        port %s (loc %s)\n", p->m_name.c_str(), net->m_attributes["LOC"].c_str());
+			if(index.m_netPorts[i]->m_direction != Greenpak4NetlistPort::DIR_OUTPUT)
 				sourced_by_port = true;
-			}
 		}
 
 		//See if it was sourced by a node
-		for(auto c : node->m_nodeports)
+		PARGraphNode* source = NULL;
+		uint32_t sourceCell = 0;
+		uint32_t sourcePort = 0;
+		for(auto p = index.net_pins_begin(net); p != index.net_pins_end(net); p++)
 		{
-			Greenpak4NetlistModule* module = netlist->GetModule(c.m_cell->m_type);
-			Greenpak4NetlistPort* port = module->GetPort(c.m_portname);
+			uint32_t pin = *p;
+			if(index.m_pinFlags[pin] & Greenpak4NetlistIndex::PIN_FLAG_UNKNOWN_PORT)
+			{
+				auto cell = index.m_cells[index.m_pinCell[pin]];
+				LogError(
+					"Cell \"%s\" (type %s) is connected to port \"%s\", which that type doesn't have\n",
+					cell->m_name.c_str(), cell->m_type.c_str(), index.GetString(index.m_pinPort[pin]).c_str());
+				return false;
+			}
 
-			if(port->m_direction == Greenpak4NetlistPort::DIR_INPUT)
+			if(source != NULL)
+				continue;
+			if( (index.m_pinFlags[pin] & Greenpak4NetlistIndex::PIN_FLAG_DRIVER) == 0)
 				continue;
 
-			source = c.m_cell->m_parnode;
-			sourceport = c.m_portname;
-			LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
-
-			node->m_driver = c;
+			sourceCell = index.m_pinCell[pin];
+			sourcePort = index.m_pinPort[pin];
+			source = index.m_cells[sourceCell]->m_parnode;
+			LogDebug("cell %s port %s\n",
+				index.m_cells[sourceCell]->m_name.c_str(), index.GetString(sourcePort).c_str());
 
 			//TODO: detect multiple drivers and complain
-			break;
+			node->m_driver = index.GetNodePoint(pin);
 		}
 
 		if((source == NULL) && !sourced_by_port)
@@ -799,7 +813,7 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 		bool has_loads = false;
 		if(sourced_by_port)
 		{
-			if(node->m_ports.size() != 1)
+			if(nports != 1)
 			{
 				LogError(
 					"Net \"%s\" is connected directly to multiple top-level ports (need an IOB)\n",
@@ -807,25 +821,29 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 				return false;
 			}
 
-			for(auto c : node->m_nodeports)
+			for(auto p = index.net_pins_begin(net); p != index.net_pins_end(net); p++)
 			{
+				uint32_t pin = *p;
+				uint32_t ncell = index.m_pinCell[pin];
+				auto cell = index.m_cells[ncell];
+
 				//Don't add edges to ourself (happens with inouts etc)
-				if( (source == c.m_cell->m_parnode) && (sourceport == c.m_portname) )
+				if( source && (ncell == sourceCell) && (index.m_pinPort[pin] == sourcePort) )
 					continue;
 
 				has_loads = true;
-				LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
+				LogDebug("cell %s port %s\n", cell->m_name.c_str(), index.GetString(index.m_pinPort[pin]).c_str());
 
 				//Verify the type is IBUF/IOBUF
-				if( (c.m_cell->m_type == "GP_IBUF") || (c.m_cell->m_type == "GP_IOBUF") )
+				if( cell->IsIbuf() )
 					continue;
 
 				LogError(
 					"Net \"%s\" directly drives cell %s port %s (type %s, should be IOB)\n",
 					node->m_name.c_str(),
-					c.m_cell->m_name.c_str(),
-					c.m_portname.c_str(),
-					c.m_cell->m_type.c_str()
+					cell->m_name.c_str(),
+					index.GetString(index.m_pinPort[pin]).c_str(),
+					cell->m_type.c_str()
 					);
 				return false;
 			}
@@ -834,32 +852,33 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 		//Create edges from this source node to all sink nodes
 		else
 		{
-			for(auto c : node->m_nodeports)
+			const string& sourceportname = index.GetString(sourcePort);
+			for(auto p = index.net_pins_begin(net); p != index.net_pins_end(net); p++)
 			{
-				Greenpak4NetlistModule* module = netlist->GetModule(c.m_cell->m_type);
-				Greenpak4NetlistPort* port = module->GetPort(c.m_portname);
+				uint32_t pin = *p;
+				uint32_t ncell = index.m_pinCell[pin];
 
 				//Don't add edges to ourself (happens with inouts etc)
-				if( (source == c.m_cell->m_parnode) && (sourceport == c.m_portname) )
+				if( source && (ncell == sourceCell) && (index.m_pinPort[pin] == sourcePort) )
 					continue;
 
-				if(port->m_direction == Greenpak4NetlistPort::DIR_OUTPUT)
+				if( (index.m_pinFlags[pin] & Greenpak4NetlistIndex::PIN_FLAG_LOAD) == 0)
 					continue;
 
 				//Name the net
-				string nname = c.m_portname;
-				if(c.m_vector)
+				string nname = index.GetString(index.m_pinPort[pin]);
+				if(index.m_pinFlags[pin] & Greenpak4NetlistIndex::PIN_FLAG_VECTOR)
 				{
 					char tmp[256];
-					snprintf(tmp, sizeof(tmp), "%s[%u]", c.m_portname.c_str(), c.m_nbit);
+					snprintf(tmp, sizeof(tmp), "%s[%u]", nname.c_str(), index.m_pinBit[pin]);
 					nname = tmp;
 				}
 
 				//Use the new name
 				has_loads = true;
-				LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), nname.c_str());
+				LogDebug("cell %s port %s\n", index.m_cells[ncell]->m_name.c_str(), nname.c_str());
 				if(source)
-					source->AddEdge(sourceport, c.m_cell->m_parnode, nname);
+					source->AddEdge(sourceportname, index.m_cells[ncell]->m_parnode, nname);
 			}
 		}
 
@@ -952,461 +971,27 @@ void MakeDeviceEdges(Greenpak4Device* device)
 		}
 	}
 
-	//Add dedicated routing between hard IP
-	if( (device->GetPart() == Greenpak4Device::GREENPAK4_SLG46620) ||
-		(device->GetPart() == Greenpak4Device::GREENPAK4_SLG46621) )
+	//Add dedicated routing between hard IP, as described by the device table.
+	//Endpoints the part doesn't have (e.g. pin 14 on the SLG46621) are skipped.
+	char portname[32];
+	for(auto& r : device->GetTable()->m_routes)
 	{
-		auto lfosc = device->GetLFOscillator()->GetPARNode();
-		auto rosc = device->GetRingOscillator()->GetPARNode();
-		auto rcosc = device->GetRCOscillator()->GetPARNode();
-
-		//TODO: Disable clock outputs to dedicated routing in matrix 1 if SPI slave is enabled?
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// Cache some commonly used stuff
-
-		auto pin2 = device->GetIOB(2)->GetPARNode();
-		auto pin3 = device->GetIOB(3)->GetPARNode();
-		auto pin4 = device->GetIOB(4)->GetPARNode();
-		auto pin5 = device->GetIOB(5)->GetPARNode();
-		auto pin6 = device->GetIOB(6)->GetPARNode();
-		auto pin7 = device->GetIOB(7)->GetPARNode();
-		auto pin8 = device->GetIOB(8)->GetPARNode();
-		auto pin9 = device->GetIOB(9)->GetPARNode();
-		auto pin10 = device->GetIOB(10)->GetPARNode();
-		auto pin12 = device->GetIOB(12)->GetPARNode();
-		auto pin13 = device->GetIOB(13)->GetPARNode();
-		auto pin15 = device->GetIOB(15)->GetPARNode();
-		auto pin16 = device->GetIOB(16)->GetPARNode();
-		auto pin18 = device->GetIOB(18)->GetPARNode();
-		auto pin19 = device->GetIOB(19)->GetPARNode();
-
-		//SLG46621 is missing pin 14 so don't die if it's not there
-		PARGraphNode* pin14 = NULL;
-		if(device->GetPart() == Greenpak4Device::GREENPAK4_SLG46620)
-			pin14 = device->GetIOB(14)->GetPARNode();
-
-		auto vdd = device->GetPowerRail(true)->GetPARNode();
-		auto gnd = device->GetPowerRail(false)->GetPARNode();
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// CLOCK INPUTS TO COUNTERS
-
-		PARGraphNode* cnodes[] =
-		{
-			device->GetCounter(0)->GetPARNode(),
-			device->GetCounter(1)->GetPARNode(),
-			device->GetCounter(2)->GetPARNode(),
-			device->GetCounter(3)->GetPARNode(),
-			device->GetCounter(4)->GetPARNode(),
-			device->GetCounter(5)->GetPARNode(),
-			device->GetCounter(6)->GetPARNode(),
-			device->GetCounter(7)->GetPARNode(),
-			device->GetCounter(8)->GetPARNode(),
-			device->GetCounter(9)->GetPARNode()
-		};
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[0], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[0], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[0], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[1], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[1], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[1], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[2], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[2], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[2], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[3], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[3], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[3], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[4], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[4], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[4], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[5], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[5], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[5], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[6], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[6], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[6], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[7], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[7], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[7], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[8], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[8], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[8], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[9], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[9], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[9], "CLK");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// SYSTEM RESET
-
-		//Can drive reset with ground or pin 2 only
-		auto sysrst = device->GetSystemReset()->GetPARNode();
-		pin2->AddEdge("OUT", sysrst, "RST");
-		gnd->AddEdge("OUT", sysrst, "RST");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// REFERENCE OUT
-
-		PARGraphNode* vrefs[] =
-		{
-			device->GetVref(0)->GetPARNode(),
-			device->GetVref(1)->GetPARNode(),
-			device->GetVref(2)->GetPARNode(),
-			device->GetVref(3)->GetPARNode(),
-			device->GetVref(4)->GetPARNode(),
-			device->GetVref(5)->GetPARNode(),
-
-			//DAC references
-			device->GetVref(6)->GetPARNode(),
-			device->GetVref(7)->GetPARNode()
-		};
-
-		//VREF0/1 can drive pin 19
-		vrefs[0]->AddEdge("VOUT", pin19, "IN");
-		vrefs[1]->AddEdge("VOUT", pin19, "IN");
-
-		//VREF2/3 can drive pin 18
-		vrefs[2]->AddEdge("VOUT", pin18, "IN");
-		vrefs[3]->AddEdge("VOUT", pin18, "IN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO REFERENCES
-
-		//All comparator references can be driven by Vdd (for Vdd/3 and Vdd/4) and Vss (for constant voltages)
-		for(auto i=0; i<=5; i++)
-		{
-			vdd->AddEdge("OUT", vrefs[i], "VIN");
-			gnd->AddEdge("OUT", vrefs[i], "VIN");
-		}
-
-		//DAC references can be driven by Vss only
-		gnd->AddEdge("OUT", vrefs[6], "VIN");
-		gnd->AddEdge("OUT", vrefs[7], "VIN");
-
-		//External pins
-		pin7->AddEdge("OUT", vrefs[0], "VIN");
-		pin10->AddEdge("OUT", vrefs[0], "VIN");
-
-		pin7->AddEdge("OUT", vrefs[1], "VIN");
-		pin10->AddEdge("OUT", vrefs[1], "VIN");
-
-		pin10->AddEdge("OUT", vrefs[2], "VIN");
-		if(pin14)
-			pin14->AddEdge("OUT", vrefs[2], "VIN");
-
-		pin10->AddEdge("OUT", vrefs[3], "VIN");
-		if(pin14)
-			pin14->AddEdge("OUT", vrefs[3], "VIN");
-
-		pin10->AddEdge("OUT", vrefs[4], "VIN");
-		if(pin14)
-			pin14->AddEdge("OUT", vrefs[4], "VIN");
-
-		pin10->AddEdge("OUT", vrefs[5], "VIN");
-		pin5->AddEdge("OUT", vrefs[5], "VIN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// REFERENCE TO COMPARATORS
-
-		PARGraphNode* acmps[] =
-		{
-			device->GetAcmp(0)->GetPARNode(),
-			device->GetAcmp(1)->GetPARNode(),
-			device->GetAcmp(2)->GetPARNode(),
-			device->GetAcmp(3)->GetPARNode(),
-			device->GetAcmp(4)->GetPARNode(),
-			device->GetAcmp(5)->GetPARNode()
-		};
-
-		//Only allow one VREF to drive its attached comparator.
-		for(unsigned int i=0; i<6; i++)
-			vrefs[i]->AddEdge("VOUT", acmps[i], "VREF");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO COMPARATORS
-
-		auto pga = device->GetPGA()->GetPARNode();
-		auto abuf = device->GetAbuf()->GetPARNode();
-
-		//Input to buffer
-		pin6->AddEdge("OUT", abuf, "IN");
-
-		//Dedicated inputs for ACMP0 (none)
-
-		//Dedicated inputs for acmps[1]
-		pin12->AddEdge("OUT", acmps[1], "VIN");
-		pga->AddEdge("VOUT", acmps[1], "VIN");
-
-		//Dedicated inputs for acmps[2]
-		pin13->AddEdge("OUT", acmps[2], "VIN");
-
-		//Dedicated inputs for acmps[3]
-		pin15->AddEdge("OUT", acmps[3], "VIN");
-		pin13->AddEdge("OUT", acmps[3], "VIN");
-
-		//Dedicated inputs for acmps[4]
-		pin3->AddEdge("OUT", acmps[4], "VIN");
-		pin15->AddEdge("OUT", acmps[4], "VIN");
-
-		//Dedicated inputs for acmps[5]
-		pin4->AddEdge("OUT", acmps[5], "VIN");
-
-		//acmps[0] input before gain stage is fed to everything but acmps[5]
-		pin6->AddEdge("OUT", acmps[0], "VIN");
-		vdd->AddEdge("OUT", acmps[0], "VIN");
-		abuf->AddEdge("OUT", acmps[0], "VIN");
-
-		pin6->AddEdge("OUT", acmps[1], "VIN");
-		vdd->AddEdge("OUT", acmps[1], "VIN");
-		abuf->AddEdge("OUT", acmps[1], "VIN");
-
-		pin6->AddEdge("OUT", acmps[2], "VIN");
-		vdd->AddEdge("OUT", acmps[2], "VIN");
-		abuf->AddEdge("OUT", acmps[2], "VIN");
-
-		pin6->AddEdge("OUT", acmps[3], "VIN");
-		vdd->AddEdge("OUT", acmps[3], "VIN");
-		abuf->AddEdge("OUT", acmps[3], "VIN");
-
-		pin6->AddEdge("OUT", acmps[4], "VIN");
-		vdd->AddEdge("OUT", acmps[4], "VIN");
-		abuf->AddEdge("OUT", acmps[4], "VIN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// SPI
-
-		auto spi = device->GetSPI()->GetPARNode();
-
-		PARGraphNode* clkbufs[]=
-		{
-			device->GetClockBuffer(0)->GetPARNode(),
-			device->GetClockBuffer(1)->GetPARNode(),
-			device->GetClockBuffer(2)->GetPARNode(),
-			device->GetClockBuffer(3)->GetPARNode(),
-			device->GetClockBuffer(4)->GetPARNode(),
-		};
-
-		//Pin 10 IOB can drive SPI as MOSI
-		pin10->AddEdge("OUT", spi, "SDAT");
-
-		//SPI can drive pin 10 IOB as MISO
-		spi->AddEdge("SDAT", pin10, "IN");
-
-		//Routes to TX data:
-		//* ground (unused, for RX mode)
-		char txname[16];
-		for(int i=0; i<8; i++)
-		{
-			snprintf(txname, sizeof(txname), "TXD_LOW[%d]", i);
-			gnd->AddEdge("OUT", spi, txname);
-
-			snprintf(txname, sizeof(txname), "TXD_HIGH[%d]", i);
-			gnd->AddEdge("OUT", spi, txname);
-		}
-
-		//Routes to SPI SCK: dedicated routing from clkbuf4
-		clkbufs[4]->AddEdge("OUT", spi, "SCK");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO DIGITAL COMPARATORS
-
-		PARGraphNode* dcmps[]=
-		{
-			device->GetDcmp(0)->GetPARNode(),
-			device->GetDcmp(1)->GetPARNode(),
-			device->GetDcmp(2)->GetPARNode()
-		};
-
-		PARGraphNode* dcrefs[]=
-		{
-			device->GetDcmpRef(0)->GetPARNode(),
-			device->GetDcmpRef(1)->GetPARNode(),
-			device->GetDcmpRef(2)->GetPARNode(),
-			device->GetDcmpRef(3)->GetPARNode()
-		};
-
-		auto dcmux = device->GetDCMPMux()->GetPARNode();
-
-		//Inputs to DCMPMUX
-		char inname[16];
-		for(int j=0; j<4; j++)
-		{
-			for(int i=0; i<8; i++)
-			{
-				snprintf(inname, sizeof(inname), "IN%d[%d]", j, i);
-				dcrefs[j]->AddEdge("OUT", dcmux, inname);
-			}
-		}
-
-		//Mux driving DCMP0/1
-		for(int i=0; i<8; i++)
-		{
-			snprintf(inname, sizeof(inname), "INP[%d]", i);
-			dcmux->AddEdge("OUTA", dcmps[0], inname);
-			snprintf(inname, sizeof(inname), "INN[%d]", i);
-			dcmux->AddEdge("OUTB", dcmps[1], inname);
-		}
-
-		//Constant inputs from DCREF to DCMP
-		for(int i=0; i<8; i++)
-		{
-			snprintf(inname, sizeof(inname), "INN[%d]", i);
-			dcrefs[0]->AddEdge("OUT", dcmps[0], inname);
-			dcrefs[2]->AddEdge("OUT", dcmps[2], inname);
-
-			snprintf(inname, sizeof(inname), "INP[%d]", i);
-			dcrefs[1]->AddEdge("OUT", dcmps[1], inname);
-			dcrefs[3]->AddEdge("OUT", dcmps[2], inname);
-		}
-
-		//SPI data lines
-		for(int i=0; i<8; i++)
-		{
-			snprintf(inname, sizeof(inname), "INP[%d]", i);
-			spi->AddEdge("RXD_HIGH", dcmps[0], inname);
-			spi->AddEdge("RXD_HIGH", dcmps[1], inname);
-
-			snprintf(inname, sizeof(inname), "INN[%d]", i);
-			spi->AddEdge("RXD_LOW", dcmps[0], inname);
-			spi->AddEdge("RXD_LOW", dcmps[1], inname);
-			spi->AddEdge("RXD_LOW", dcmps[2], inname);
-		}
-
-		//Add inputs from counters to DCMP
-		//TODO: read input mux entries so we don't have to do this by hand? Seems error prone
-		for(int i=0; i<8; i++)
-		{
-			snprintf(inname, sizeof(inname), "INN[%d]", i);
-			cnodes[8]->AddEdge("POUT", dcmps[0], inname);
-			cnodes[4]->AddEdge("POUT", dcmps[0], inname);
-			cnodes[9]->AddEdge("POUT", dcmps[1], inname);
-			cnodes[2]->AddEdge("POUT", dcmps[1], inname);
-			cnodes[8]->AddEdge("POUT", dcmps[2], inname);
-			cnodes[2]->AddEdge("POUT", dcmps[2], inname);
-
-			snprintf(inname, sizeof(inname), "INP[%d]", i);
-			cnodes[2]->AddEdge("POUT", dcmps[0], inname);
-			cnodes[4]->AddEdge("POUT", dcmps[1], inname);
-			cnodes[4]->AddEdge("POUT", dcmps[2], inname);
-		}
-
-		//TODO: Inputs from ADC to DCMP
-
-		//ADC/DCMP clock mux routing
-		auto mbuf = dynamic_cast<Greenpak4MuxedClockBuffer*>(device->GetClockBuffer(5))->GetPARNode();
-		rosc->AddEdge("CLKOUT_HARDIP", mbuf, "IN");
-		rcosc->AddEdge("CLKOUT_HARDIP", mbuf, "IN");
-		clkbufs[2]->AddEdge("OUT", mbuf, "IN");
-		clkbufs[4]->AddEdge("OUT", mbuf, "IN");
-
-		//Clock inputs to DCMP
-		for(int i=0; i<3; i++)
-		{
-			clkbufs[1]->AddEdge("OUT", dcmps[i], "CLK");
-			mbuf->AddEdge("OUT", dcmps[i], "CLK");
-		}
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO PGA
-
-		vdd->AddEdge("OUT", pga, "VIN_P");
-		pin8->AddEdge("OUT", pga, "VIN_P");
-
-		pin9->AddEdge("OUT", pga, "VIN_N");
-		gnd->AddEdge("OUT", pga, "VIN_N");
-		//TODO: DAC output
-
-		pin16->AddEdge("OUT", pga, "VIN_SEL");
-		vdd->AddEdge("OUT", pga, "VIN_SEL");
-
-		//TODO: Output to ADC
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// PGA to IOB
-
-		pga->AddEdge("VOUT", pin7, "IN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO DAC
-
-		PARGraphNode* dacs[] =
-		{
-			device->GetDAC(0)->GetPARNode(),
-			device->GetDAC(1)->GetPARNode()
-		};
-
-		//DAC voltage references driving DAC inputs
-		vrefs[6]->AddEdge("VOUT", dacs[0], "VREF");
-		vrefs[7]->AddEdge("VOUT", dacs[1], "VREF");
-
-		//Static 1/0 for register configuration
-		for(size_t i=0; i<device->GetDACCount(); i++)
-		{
-			auto dac = device->GetDAC(i)->GetPARNode();
-
-			vdd->AddEdge("OUT", dac, "DIN[0]");
-			vdd->AddEdge("OUT", dac, "DIN[1]");
-			vdd->AddEdge("OUT", dac, "DIN[2]");
-			vdd->AddEdge("OUT", dac, "DIN[3]");
-			vdd->AddEdge("OUT", dac, "DIN[4]");
-			vdd->AddEdge("OUT", dac, "DIN[5]");
-			vdd->AddEdge("OUT", dac, "DIN[6]");
-			vdd->AddEdge("OUT", dac, "DIN[7]");
-
-			gnd->AddEdge("OUT", dac, "DIN[0]");
-			gnd->AddEdge("OUT", dac, "DIN[1]");
-			gnd->AddEdge("OUT", dac, "DIN[2]");
-			gnd->AddEdge("OUT", dac, "DIN[3]");
-			gnd->AddEdge("OUT", dac, "DIN[4]");
-			gnd->AddEdge("OUT", dac, "DIN[5]");
-			gnd->AddEdge("OUT", dac, "DIN[6]");
-			gnd->AddEdge("OUT", dac, "DIN[7]");
-		}
+		auto src = device->GetRouteEntity(r.m_src.m_type, r.m_src.m_index);
+		auto dst = device->GetRouteEntity(r.m_dst.m_type, r.m_dst.m_index);
+		if(!src || !dst)
+			continue;
+		auto snode = src->GetPARNode();
+		auto dnode = dst->GetPARNode();
 
-		//Add inputs from counters to each DAC (shared with DCMP mux)
-		for(size_t j=0; j<device->GetDACCount(); j++)
+		if(r.m_width == 0)
+			snode->AddEdge(r.m_src.m_port, dnode, r.m_dst.m_port);
+		else
 		{
-			auto dac = device->GetDAC(j)->GetPARNode();
-			for(int i=0; i<8; i++)
+			for(unsigned int i=0; i<r.m_width; i++)
 			{
-				snprintf(inname, sizeof(inname), "DIN[%d]", i);
-				cnodes[9]->AddEdge("POUT", dac, inname);
-				cnodes[2]->AddEdge("POUT", dac, inname);
+				snprintf(portname, sizeof(portname), r.m_dst.m_port, i);
+				snode->AddEdge(r.m_src.m_port, dnode, portname);
 			}
 		}
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// OUTPUTS FROM DAC
-
-		// Both DACs can drive to every comparator vref
-		for(int i=0; i<2; i++)
-		{
-			for(int j=0; j<6; j++)
-				dacs[i]->AddEdge("VOUT", vrefs[j], "VIN");
-		}
-
-		//DACs can drive I/O pins directly without going through a GP_VREF
-		dacs[0]->AddEdge("VOUT", pin19, "IN");
-		dacs[1]->AddEdge("VOUT", pin18, "IN");
 	}
 }
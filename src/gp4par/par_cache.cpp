@@ -0,0 +1,452 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4par.h"
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SHA-256 (FIPS 180-4), used to name cache entries
+
+/**
+	@brief Minimal streaming SHA-256 implementation
+ */
+class SHA256
+{
+public:
+	SHA256();
+
+	void Update(const void* data, size_t len);
+	void Update(string s);
+	string Finish();
+
+protected:
+	void Block(const uint8_t* p);
+
+	uint32_t m_state[8];
+	uint8_t m_buf[64];
+	size_t m_buflen;
+	uint64_t m_total;
+};
+
+static const uint32_t g_sha256k[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+SHA256::SHA256()
+	: m_buflen(0)
+	, m_total(0)
+{
+	static const uint32_t init[8] =
+	{
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	for(int i=0; i<8; i++)
+		m_state[i] = init[i];
+}
+
+static inline uint32_t RotateRight(uint32_t x, int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+void SHA256::Block(const uint8_t* p)
+{
+	uint32_t w[64];
+	for(int i=0; i<16; i++)
+		w[i] = (p[i*4] << 24) | (p[i*4 + 1] << 16) | (p[i*4 + 2] << 8) | p[i*4 + 3];
+	for(int i=16; i<64; i++)
+	{
+		uint32_t s0 = RotateRight(w[i-15], 7) ^ RotateRight(w[i-15], 18) ^ (w[i-15] >> 3);
+		uint32_t s1 = RotateRight(w[i-2], 17) ^ RotateRight(w[i-2], 19) ^ (w[i-2] >> 10);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	uint32_t a = m_state[0];
+	uint32_t b = m_state[1];
+	uint32_t c = m_state[2];
+	uint32_t d = m_state[3];
+	uint32_t e = m_state[4];
+	uint32_t f = m_state[5];
+	uint32_t g = m_state[6];
+	uint32_t h = m_state[7];
+	for(int i=0; i<64; i++)
+	{
+		uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+		uint32_t ch = (e & f) ^ (~e & g);
+		uint32_t t1 = h + s1 + ch + g_sha256k[i] + w[i];
+		uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+		uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+		uint32_t t2 = s0 + maj;
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	m_state[0] += a;
+	m_state[1] += b;
+	m_state[2] += c;
+	m_state[3] += d;
+	m_state[4] += e;
+	m_state[5] += f;
+	m_state[6] += g;
+	m_state[7] += h;
+}
+
+void SHA256::Update(const void* data, size_t len)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	m_total += len;
+	while(len)
+	{
+		size_t n = min(len, sizeof(m_buf) - m_buflen);
+		memcpy(m_buf + m_buflen, p, n);
+		m_buflen += n;
+		p += n;
+		len -= n;
+		if(m_buflen == sizeof(m_buf))
+		{
+			Block(m_buf);
+			m_buflen = 0;
+		}
+	}
+}
+
+/**
+	@brief Hashes a string, including its terminating null so that adjacent fields can't run together
+ */
+void SHA256::Update(string s)
+{
+	Update(s.c_str(), s.length() + 1);
+}
+
+string SHA256::Finish()
+{
+	uint64_t bits = m_total * 8;
+	uint8_t pad = 0x80;
+	Update(&pad, 1);
+	pad = 0;
+	while(m_buflen != 56)
+		Update(&pad, 1);
+	uint8_t len[8];
+	for(int i=0; i<8; i++)
+		len[i] = bits >> (56 - i*8);
+	Update(len, 8);
+
+	string ret;
+	char tmp[16];
+	for(int i=0; i<8; i++)
+	{
+		snprintf(tmp, sizeof(tmp), "%08x", m_state[i]);
+		ret += tmp;
+	}
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Input hashing
+
+/**
+	@brief Hashes the contents of a file, if it exists.
+
+	A missing file hashes differently from an empty one.
+ */
+static void HashFile(SHA256& hash, string fname)
+{
+	hash.Update(fname);
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(!fp)
+	{
+		hash.Update("<missing>");
+		return;
+	}
+
+	char buf[4096];
+	size_t len;
+	while( (len = fread(buf, 1, sizeof(buf), fp)) > 0)
+		hash.Update(buf, len);
+	fclose(fp);
+}
+
+static void HashStringMap(SHA256& hash, const map<string, string>& m)
+{
+	for(auto it : m)
+	{
+		hash.Update(it.first);
+		hash.Update(it.second);
+	}
+	hash.Update("<end>");
+}
+
+/**
+	@brief Computes a stable hash of everything that can affect the output of gp4par.
+
+	The netlist is hashed structurally after parsing, so whitespace or ordering changes in the JSON don't cause a
+	miss. Nets are identified by name plus the order in which they are first seen walking the cells (sorted by name),
+	so anonymous nets are still distinguished.
+
+	@param netlist		The parsed netlist (before constraints are applied)
+	@param pcfname		Constraint file (may be empty)
+	@param tfname		Timing data file (affects the timing report)
+	@param placement_in	Previous placement used as a starting point (may be empty)
+	@param options		Canonical string form of all device options and the tool version
+ */
+string HashPARInputs(Greenpak4Netlist* netlist, string pcfname, string tfname, string placement_in, string options)
+{
+	SHA256 hash;
+
+	hash.Update("gp4par cache v1");
+	hash.Update(GP4PAR_VERSION);
+	hash.Update(options);
+
+	if(pcfname != "")
+		HashFile(hash, pcfname);
+	else
+		hash.Update("<no pcf>");
+	HashFile(hash, tfname);
+	if(placement_in != "")
+		HashFile(hash, placement_in);
+	else
+		hash.Update("<no placement>");
+
+	auto module = netlist->GetTopModule();
+	hash.Update(module->GetName());
+	HashStringMap(hash, module->m_attributes);
+
+	//Canonical net numbering
+	map<Greenpak4NetlistNode*, unsigned int> netids;
+	char tmp[32];
+
+	//Cells, in name order
+	for(auto it = module->cell_begin(); it != module->cell_end(); it ++)
+	{
+		auto cell = it->second;
+		hash.Update(cell->m_name);
+		hash.Update(cell->m_type);
+		HashStringMap(hash, cell->m_parameters);
+		HashStringMap(hash, cell->m_attributes);
+
+		for(auto jt : cell->m_connections)
+		{
+			hash.Update(jt.first);
+			for(auto node : jt.second)
+			{
+				if(node == NULL)
+				{
+					hash.Update("<null>");
+					continue;
+				}
+				if(netids.find(node) == netids.end())
+				{
+					unsigned int id = netids.size();
+					netids[node] = id;
+				}
+				snprintf(tmp, sizeof(tmp), "%u", netids[node]);
+				hash.Update(tmp);
+				hash.Update(node->m_name);
+			}
+		}
+		hash.Update("<end cell>");
+	}
+
+	//Ports
+	for(auto it = module->port_begin(); it != module->port_end(); it ++)
+	{
+		auto port = it->second;
+		hash.Update(port->m_name);
+		snprintf(tmp, sizeof(tmp), "%d", (int)port->m_direction);
+		hash.Update(tmp);
+		for(auto node : port->m_nodes)
+			hash.Update( (node != NULL) ? node->m_name : "<null>");
+	}
+
+	//Net attributes (LOC constraints etc)
+	for(auto it = module->net_begin(); it != module->net_end(); it ++)
+	{
+		if( (it->second == NULL) || it->second->m_attributes.empty() )
+			continue;
+		hash.Update(it->first);
+		HashStringMap(hash, it->second->m_attributes);
+	}
+
+	return hash.Finish();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache storage
+
+static bool CopyFile(string src, string dst)
+{
+	FILE* in = fopen(src.c_str(), "rb");
+	if(!in)
+		return false;
+	FILE* out = fopen(dst.c_str(), "wb");
+	if(!out)
+	{
+		fclose(in);
+		return false;
+	}
+
+	bool ok = true;
+	char buf[4096];
+	size_t len;
+	while( (len = fread(buf, 1, sizeof(buf), in)) > 0)
+	{
+		if(len != fwrite(buf, 1, len, out))
+		{
+			ok = false;
+			break;
+		}
+	}
+
+	fclose(in);
+	if(0 != fclose(out))
+		ok = false;
+	return ok;
+}
+
+/**
+	@brief Looks up a cached result and, on a hit, writes the bitstream to ofname and replays the PAR log.
+
+	The entry's timestamps are refreshed so that eviction is least-recently-used rather than oldest-first.
+
+	@return True on a hit
+ */
+bool FetchCachedResult(string cachedir, string hash, string ofname)
+{
+	string base = cachedir + "/" + hash;
+	string bitfname = base + ".txt";
+	string logfname = base + ".log";
+
+	FILE* fp = fopen(logfname.c_str(), "r");
+	if(!fp)
+		return false;
+
+	if(!CopyFile(bitfname, ofname))
+	{
+		fclose(fp);
+		LogWarning("Cache entry %s is incomplete, ignoring it\n", hash.c_str());
+		return false;
+	}
+
+	LogNotice("\nFound cached PAR result %s, skipping place-and-route\n", hash.c_str());
+	char line[1024];
+	while(NULL != fgets(line, sizeof(line), fp))
+		LogNotice("%s", line);
+	fclose(fp);
+
+	//Mark as recently used
+	utime(bitfname.c_str(), NULL);
+	utime(logfname.c_str(), NULL);
+
+	return true;
+}
+
+/**
+	@brief Deletes least recently used cache entries until the cache is no bigger than maxsize bytes
+ */
+static void EvictCacheEntries(string cachedir, uint64_t maxsize)
+{
+	DIR* dir = opendir(cachedir.c_str());
+	if(!dir)
+		return;
+
+	//Total up the size and last use time of each entry (the bitstream and log share a hash)
+	map<string, uint64_t> sizes;
+	map<string, time_t> times;
+	uint64_t total = 0;
+	struct dirent* ent;
+	while( (ent = readdir(dir)) != NULL)
+	{
+		string name = ent->d_name;
+		size_t dot = name.find('.');
+		if( (dot != 64) || (name.substr(dot) != ".txt" && name.substr(dot) != ".log") )
+			continue;
+
+		struct stat st;
+		if(0 != stat( (cachedir + "/" + name).c_str(), &st))
+			continue;
+
+		string hash = name.substr(0, dot);
+		sizes[hash] += st.st_size;
+		if( (times.find(hash) == times.end()) || (st.st_mtime > times[hash]) )
+			times[hash] = st.st_mtime;
+		total += st.st_size;
+	}
+	closedir(dir);
+
+	//Evict oldest first
+	multimap<time_t, string> byage;
+	for(auto it : times)
+		byage.insert(pair<time_t, string>(it.second, it.first));
+	for(auto it = byage.begin(); (it != byage.end()) && (total > maxsize); it ++)
+	{
+		string base = cachedir + "/" + it->second;
+		LogVerbose("Evicting cache entry %s\n", it->second.c_str());
+		remove( (base + ".txt").c_str() );
+		remove( (base + ".log").c_str() );
+		total -= sizes[it->second];
+	}
+}
+
+/**
+	@brief Adds a PAR result to the cache, then trims the cache to size.
+
+	@param bitfname		The bitstream we just wrote
+	@param logfname		Captured log of the PAR run (moved into the cache)
+ */
+bool StoreCachedResult(string cachedir, string hash, string bitfname, string logfname, uint64_t maxsize)
+{
+	string base = cachedir + "/" + hash;
+
+	//Bitstream first, then the log, since the presence of the log is what marks an entry valid
+	if(!CopyFile(bitfname, base + ".txt"))
+	{
+		LogWarning("Couldn't write PAR result to cache directory %s\n", cachedir.c_str());
+		remove(logfname.c_str());
+		return false;
+	}
+	remove( (base + ".log").c_str() );
+	if(0 != rename(logfname.c_str(), (base + ".log").c_str()))
+	{
+		LogWarning("Couldn't write PAR log to cache directory %s\n", cachedir.c_str());
+		remove( (base + ".txt").c_str() );
+		remove(logfname.c_str());
+		return false;
+	}
+
+	EvictCacheEntries(cachedir, maxsize);
+	return true;
+}
@@ -24,8 +24,19 @@ bool CheckAnalogIbuf(Greenpak4BitstreamEntity* load, Greenpak4IOB* iob);
 
 /**
 	@brief The main place-and-route logic
+
+	@param stats			Receives timing and move statistics for the run
+	@param placement_in		Placement from a previous run to start from (may be empty)
+	@param placement_out	File to save the final placement to (may be empty)
+	@param placer			Placement algorithm to use
  */
-bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device)
+bool DoPAR(
+	Greenpak4Netlist* netlist,
+	Greenpak4Device* device,
+	PARStatistics& stats,
+	string placement_in,
+	string placement_out,
+	PAREngine::PlacementAlgorithm placer)
 {
 	labelmap lmap;
 
@@ -33,13 +44,23 @@ bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device)
 	LogNotice("\nCreating netlist graphs...\n");
 	PARGraph* ngraph = NULL;
 	PARGraph* dgraph = NULL;
-	if(!BuildGraphs(netlist, device, ngraph, dgraph, lmap))
+	stats.BeginPhase("build_graphs");
+	bool ok = BuildGraphs(netlist, device, ngraph, dgraph, lmap);
+	stats.EndPhase();
+	if(!ok)
 		return false;
 
 	//Create and run the PAR engine
 	Greenpak4PAREngine engine(ngraph, dgraph, lmap);
+	engine.SetPlacementAlgorithm(placer);
+	if( (placement_in != "") && !engine.LoadPreviousPlacement(placement_in) )
+		return false;
 	uint32_t seed = 0;
-	if(!engine.PlaceAndRoute(lmap, seed))
+	stats.BeginPhase("par");
+	ok = engine.PlaceAndRoute(lmap, seed);
+	stats.Merge(engine.GetStatistics());
+	stats.EndPhase();
+	if(!ok)
 	{
 		//Print the placement we have so far
 		PrintPlacementReport(ngraph, device);
@@ -48,9 +69,16 @@ bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device)
 		return false;
 	}
 
+	//Save the placement for incremental runs later on
+	if( (placement_out != "") && !engine.SavePlacement(placement_out) )
+		return false;
+
 	//Copy the netlist over
 	unsigned int num_routes_used[2];
-	if(!CommitChanges(dgraph, device, num_routes_used))
+	stats.BeginPhase("commit");
+	ok = CommitChanges(dgraph, device, num_routes_used);
+	stats.EndPhase();
+	if(!ok)
 	{
 		LogNotice("Final routing failed\n");
 
@@ -61,13 +89,18 @@ bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device)
 	}
 
 	//Final DRC to make sure the placement is sane
-	if(!PostPARDRC(ngraph, device))
+	stats.BeginPhase("drc");
+	ok = PostPARDRC(ngraph, device);
+	stats.EndPhase();
+	if(!ok)
 		return false;
 
 	//Print reports
+	stats.BeginPhase("reports");
 	PrintUtilizationReport(ngraph, device, num_routes_used);
 	PrintPlacementReport(ngraph, device);
 	PrintTimingReport(netlist, device);
+	stats.EndPhase();
 
 	//Final cleanup
 	delete ngraph;
@@ -116,7 +149,7 @@ bool PostPARDRC(PARGraph* netlist, Greenpak4Device* device)
 		//If the node is an IOB configured as an output, there's no internal load for its output.
 		//This is perfectly normal, obviously.
 		Greenpak4NetlistCell* cell = dynamic_cast<Greenpak4NetlistCell*>(src);
-		if( (cell != NULL) &&  ( (cell->m_type == "GP_IOBUF") || (cell->m_type == "GP_OBUF") ) )
+		if( (cell != NULL) &&  ( (cell->m_typeId == GP_CELL_IOBUF) || (cell->m_typeId == GP_CELL_OBUF) ) )
 			continue;
 
 		//If we have a magic attribute set, it's OK
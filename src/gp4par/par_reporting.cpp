@@ -206,9 +206,10 @@ void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned
 	PrintRow("SPI:",			spi_used,				1);
 	PrintRow("SYSRST:",			sysrst_used,			1);
 	PrintRow("VREF:",			vref_used,				device->GetVrefCount());
-	PrintRow("X-conn:",			total_routes_used,		20);
-	PrintRow("  East:",			num_routes_used[0],		10);
-	PrintRow("  West:",			num_routes_used[1],		10);
+	unsigned int xconns = device->GetCrossConnectionCount();
+	PrintRow("X-conn:",			total_routes_used,		xconns*2);
+	PrintRow("  East:",			num_routes_used[0],		xconns);
+	PrintRow("  West:",			num_routes_used[1],		xconns);
 }
 
 /**
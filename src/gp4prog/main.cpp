@@ -21,7 +21,7 @@
 #include <cmath>
 #include <unistd.h>
 #include <log.h>
-#include <gpdevboard.h>
+#include "gp4prog.h"
 #ifndef _WIN32
 #include <termios.h>
 #else
@@ -33,8 +33,6 @@ using namespace std;
 void ShowUsage();
 void ShowVersion();
 
-const char *BitFunction(SilegoPart part, size_t bitno);
-
 void WriteBitstream(string fname, vector<uint8_t> bitstream);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +57,10 @@ int main(int argc, char* argv[])
 	bool blink = false;
 	int nboard = 0;
 	bool lock = false;
+	unsigned int window = 0;
+	bool allBoards = false;
+	SilegoPart loopbackPart = SilegoPart::UNRECOGNIZED;
+	unsigned int loopbackCount = 1;
 
 	//Parse command-line arguments
 	for(int i=1; i<argc; i++)
@@ -172,6 +174,54 @@ int main(int argc, char* argv[])
 				return 1;
 			}
 		}
+		else if(s == "--download-window")
+		{
+			if(i+1 < argc)
+				window = atoi(argv[++i]);
+
+			else
+			{
+				printf("--download-window requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--loopback")
+		{
+			if(i+1 < argc)
+			{
+				string name(argv[++i]);
+
+				if(name == "SLG46620V")
+					loopbackPart = SLG46620V;
+				else if(name == "SLG46621V")
+					loopbackPart = SLG46621V;
+				else if(name == "SLG46140V")
+					loopbackPart = SLG46140V;
+				else
+				{
+					printf("--loopback argument must be SLG46620V, SLG46621V, or SLG46140V\n");
+					return 1;
+				}
+			}
+			else
+			{
+				printf("--loopback requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--loopback-boards")
+		{
+			if(i+1 < argc)
+				loopbackCount = atoi(argv[++i]);
+
+			else
+			{
+				printf("--loopback-boards requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--all-boards")
+			allBoards = true;
 		else if(s == "--pattern-id")
 		{
 			if(i+1 < argc)
@@ -293,10 +343,50 @@ int main(int argc, char* argv[])
 	if(console_verbosity >= Severity::NOTICE)
 		ShowVersion();
 
+	//Talk to software emulated boards, with one USB frame (1 ms) of latency per reply
+	if(loopbackPart != SilegoPart::UNRECOGNIZED)
+		UseLoopbackBoards(loopbackPart, 1000, loopbackCount);
+
+	//Run the same sequence on every board at once
+	if(allBoards)
+	{
+		if(voltage2 != 0.0 || !nets.empty() || lock || blink || hexdump || !uploadFilename.empty() || nboard != 0)
+		{
+			LogError("--all-boards can't be combined with --device, --voltage-2, --nets, --lock, --blink, "
+			         "--hexdump, or --read\n");
+			return 1;
+		}
+		if(voltage == 0.0 && !downloadFilename.empty() && !programNvram)
+		{
+			LogError("--emulate is specified but --voltage isn't; chip must be powered for emulation\n");
+			return 1;
+		}
+		if(rcOscFreq != 0 && voltage == 0.0)
+		{
+			LogError("Trimming oscillator requires specifying target voltage\n");
+			return 1;
+		}
+
+		ProgramOptions opts;
+		opts.reset = reset;
+		opts.test = test;
+		opts.rcOscFreq = rcOscFreq;
+		opts.downloadFilename = downloadFilename;
+		opts.programNvram = programNvram;
+		opts.force = force;
+		opts.patternId = patternId;
+		opts.readProtect = readProtect;
+		opts.voltage = voltage;
+		opts.window = window;
+		return ProgramAllBoards(opts);
+	}
+
 	//Open the dev board
 	hdevice hdev = OpenBoard(nboard);
 	if(!hdev)
 		return 1;
+	if(window)
+		hdev->SetDownloadWindow(window);
 
 	//Light up the status LED
 	if(!SetStatusLED(hdev, 1))
@@ -585,9 +675,23 @@ void ShowUsage()
 		"        Prints lots of internal debugging information.\n"
 		"    --force\n"
 		"        Perform actions that may be potentially inadvisable.\n"
+		"    --all-boards\n"
+		"        Runs the requested actions on every board that is plugged in, all at\n"
+		"        once, and prints a combined pass/fail report with per-board timings.\n"
+		"        Can't be used with --device, --lock, --blink, --read, --hexdump,\n"
+		"        --voltage-2 or --nets.\n"
 		"    -d, --device <board index>\n"
 		"        Specifies which board to connect to, if multiple units are plugged in.\n"
 		"        The first board is index 0.\n"
+		"    --download-window    <frames>\n"
+		"        Number of bitstream frames to keep in flight while downloading\n"
+		"        (default 4). 1 waits for each frame to be acknowledged before sending\n"
+		"        the next, which is slower but matches older firmware behavior.\n"
+		"    --loopback           [SLG46620V|SLG46621V|SLG46140V]\n"
+		"        Talks to a software emulated board with the given part in the socket\n"
+		"        instead of real hardware. Nothing leaves the process.\n"
+		"    --loopback-boards    <count>\n"
+		"        Number of emulated boards that --all-boards finds (default 1).\n"
 		"\n"
 		"    The following options are instructions for the developer board. They are\n"
 		"    executed in the order listed here, regardless of their order on command line.\n"
@@ -0,0 +1,313 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <log.h>
+#include <LogContext.h>
+#include "gp4prog.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Per-board state
+
+struct BoardStep
+{
+	const char* m_name;
+	double m_ms;
+};
+
+/**
+	@brief Everything one worker thread needs to know about, and report on, its board
+
+	Each worker only ever touches its own BoardResult, so no locking is needed.
+ */
+struct BoardResult
+{
+	hdevice m_hdev;
+	SilegoPart m_part;
+	bool m_ok;
+	std::string m_error;
+
+	std::vector<BoardStep> m_steps;
+	std::chrono::steady_clock::time_point m_stepStart;
+	double m_totalMs;
+
+	//Everything logged while working on this board
+	LogContext m_log;
+};
+
+/**
+	@brief Closes the step in progress (if any) and starts timing a new one
+ */
+static void BeginStep(BoardResult& result, const char* name)
+{
+	auto now = chrono::steady_clock::now();
+	if(!result.m_steps.empty())
+		result.m_steps.back().m_ms = chrono::duration<double, milli>(now - result.m_stepStart).count();
+
+	if(name != NULL)
+		result.m_steps.push_back(BoardStep{name, 0});
+	result.m_stepStart = now;
+}
+
+/**
+	@brief Records why the board failed, including the last error the board itself reported
+ */
+static bool Fail(BoardResult& result, const char* what)
+{
+	result.m_error = what;
+	const string& err = result.m_hdev->GetLastError();
+	if(!err.empty())
+		result.m_error += string(": ") + err;
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Worker thread
+
+/**
+	@brief Runs the requested sequence on one board, in the same order as single-board gp4prog does
+ */
+static bool RunBoard(const ProgramOptions& opts, BoardResult& result)
+{
+	hdevice hdev = result.m_hdev;
+
+	BeginStep(result, "detect");
+	if(!SetStatusLED(hdev, 1))
+		return Fail(result, "Couldn't set status LED");
+
+	vector<uint8_t> programmedBitstream;
+	BitstreamKind bitstreamKind;
+	if(!DetectPart(hdev, result.m_part, programmedBitstream, bitstreamKind))
+		return Fail(result, "Couldn't detect part");
+
+	if(opts.programNvram && (bitstreamKind != BitstreamKind::EMPTY) && !opts.force)
+		return Fail(result, "Non-empty part detected; refusing to program without --force");
+
+	if(opts.test)
+	{
+		BeginStep(result, "socket");
+		if(!SocketTest(hdev, result.m_part))
+			return Fail(result, "Socket test failed");
+	}
+
+	if(opts.reset)
+	{
+		BeginStep(result, "reset");
+		if(!Reset(hdev))
+			return Fail(result, "Reset failed");
+	}
+
+	uint8_t rcFtw = 0;
+	if(opts.rcOscFreq != 0)
+	{
+		BeginStep(result, "trim");
+		if(!TrimOscillator(hdev, result.m_part, opts.voltage, opts.rcOscFreq, rcFtw))
+			return Fail(result, "Oscillator trimming failed");
+	}
+
+	if(!opts.downloadFilename.empty())
+	{
+		BeginStep(result, "download");
+
+		//The file is re-read per board since its length is checked against the part in that board's socket
+		vector<uint8_t> newBitstream;
+		if(!ReadBitstream(opts.downloadFilename, newBitstream, result.m_part))
+		{
+			result.m_error = string("Couldn't load ") + opts.downloadFilename + " for " + PartName(result.m_part);
+			return false;
+		}
+		if(!TweakBitstream(newBitstream, result.m_part, rcFtw, opts.patternId, opts.readProtect))
+			return Fail(result, "Couldn't patch bitstream");
+
+		DownloadMode mode = opts.programNvram ? DownloadMode::PROGRAMMING : DownloadMode::EMULATION;
+		if(!DownloadBitstream(hdev, newBitstream, mode))
+			return Fail(result, "Download failed");
+
+		if(opts.programNvram)
+		{
+			BeginStep(result, "verify");
+
+			size_t bitstreamLength = BitstreamLength(result.m_part) / 8;
+			vector<uint8_t> bitstreamToVerify;
+			if(!UploadBitstream(hdev, bitstreamLength, bitstreamToVerify))
+				return Fail(result, "Upload for verification failed");
+
+			//Bits with a known undocumented function are mostly trim values, which vary from programming to
+			//programming; only count differences anywhere else
+			size_t mismatches = 0;
+			for(size_t i = 0; i < bitstreamLength * 8; i++)
+			{
+				bool expectedBit = ((newBitstream     [i/8] >> (i%8)) & 1) == 1;
+				bool actualBit   = ((bitstreamToVerify[i/8] >> (i%8)) & 1) == 1;
+				if( (expectedBit != actualBit) && (BitFunction(result.m_part, i) == NULL) )
+					mismatches ++;
+			}
+			if(mismatches)
+			{
+				char buf[128];
+				snprintf(buf, sizeof(buf), "Verification failed (%zu bits differ)", mismatches);
+				result.m_error = buf;
+				return false;
+			}
+		}
+
+		//Same as single-board mode: the I/O pins are stuck after programming until explicitly reset
+		IOConfig ioConfig;
+		for(size_t i = 2; i <= 20; i++)
+			ioConfig.driverConfigs[i] = TP_RESET;
+		if(!SetIOConfig(hdev, ioConfig))
+			return Fail(result, "Couldn't reset I/O after download");
+	}
+
+	BeginStep(result, "finish");
+	if(!ResetAllSiggens(hdev))
+		return Fail(result, "Couldn't reset signal generators");
+	if( (opts.voltage != 0.0) && !ConfigureSiggen(hdev, 1, opts.voltage) )
+		return Fail(result, "Couldn't set Vdd");
+	if(!CheckStatus(hdev))
+		return Fail(result, "Fault condition detected during final check");
+
+	SetStatusLED(hdev, 0);
+	return true;
+}
+
+static void BoardThread(const ProgramOptions* opts, BoardResult* result)
+{
+	auto start = chrono::steady_clock::now();
+
+	LogContext::Scope scope(result->m_log);
+	result->m_ok = RunBoard(*opts, *result);
+	BeginStep(*result, NULL);
+
+	result->m_totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Driver
+
+/**
+	@brief Runs the same sequence on every attached board, one thread per board, and prints a combined report
+
+	The boards share nothing but the (read only) options, so they are driven fully in parallel. Each worker logs into
+	its board's own LogContext; the full log of any board that failed is printed after the summary.
+
+	@return Process exit code: 0 if every board passed, 1 otherwise
+ */
+int ProgramAllBoards(const ProgramOptions& opts)
+{
+	vector<hdevice> boards = OpenAllBoards();
+	if(boards.empty())
+		return 1;
+
+	vector<BoardResult> results(boards.size());
+	for(size_t i=0; i<boards.size(); i++)
+	{
+		if(opts.window)
+			boards[i]->SetDownloadWindow(opts.window);
+
+		results[i].m_hdev = boards[i];
+		results[i].m_part = SilegoPart::UNRECOGNIZED;
+		results[i].m_ok = false;
+		results[i].m_totalMs = 0;
+	}
+
+	LogNotice("Running on %zu boards in parallel\n", boards.size());
+	auto start = chrono::steady_clock::now();
+
+	EnableLogContexts();
+	{
+		vector<thread> threads;
+		for(auto& r : results)
+			threads.push_back(thread(BoardThread, &opts, &r));
+		for(auto& t : threads)
+			t.join();
+	}
+
+	double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+	//Every board runs the same steps up to the one it failed in, so the longest list makes the header
+	vector<const char*> columns;
+	for(auto& r : results)
+	{
+		if(r.m_steps.size() > columns.size())
+		{
+			columns.clear();
+			for(auto& s : r.m_steps)
+				columns.push_back(s.m_name);
+		}
+	}
+
+	string header = "board  part       result";
+	for(auto c : columns)
+	{
+		char buf[32];
+		snprintf(buf, sizeof(buf), " %9s", c);
+		header += buf;
+	}
+	header += "      total";
+	LogNotice("%s\n", header.c_str());
+
+	size_t passed = 0;
+	for(size_t i=0; i<results.size(); i++)
+	{
+		auto& r = results[i];
+
+		char buf[64];
+		snprintf(buf, sizeof(buf), "%5zu  %-9s  %-6s",
+			i,
+			(r.m_part == SilegoPart::UNRECOGNIZED) ? "-" : PartName(r.m_part),
+			r.m_ok ? "PASS" : "FAIL");
+		string line = buf;
+		for(size_t j=0; j<columns.size(); j++)
+		{
+			if(j < r.m_steps.size())
+				snprintf(buf, sizeof(buf), " %7.1fms", r.m_steps[j].m_ms);
+			else
+				snprintf(buf, sizeof(buf), " %9s", "-");
+			line += buf;
+		}
+		snprintf(buf, sizeof(buf), " %8.1fms", r.m_totalMs);
+		line += buf;
+		LogNotice("%s\n", line.c_str());
+
+		if(r.m_ok)
+			passed ++;
+	}
+
+	for(size_t i=0; i<results.size(); i++)
+	{
+		if(results[i].m_ok)
+			continue;
+
+		LogError("Board %zu: %s (status LED left on)\n", i, results[i].m_error.c_str());
+		LogIndenter li;
+		results[i].m_log.Flush();
+	}
+
+	LogNotice("%zu of %zu boards passed in %.1f ms\n", passed, results.size(), wallMs);
+
+	for(size_t i=0; i+1<boards.size(); i++)
+		delete boards[i];
+	USBCleanup(boards.back());
+
+	return (passed == results.size()) ? 0 : 1;
+}
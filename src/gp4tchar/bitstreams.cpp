@@ -0,0 +1,334 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4tchar.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <sys/stat.h>
+
+using namespace std;
+
+#ifndef GP4TCHAR_VERSION
+#define GP4TCHAR_VERSION "unknown"
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction
+
+BitstreamCache::BitstreamCache(Greenpak4Device& device)
+	: m_device(device)
+	, m_hits(0)
+	, m_builds(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// On-disk entries
+
+/**
+	@brief Full description of a test point's bitstream: everything that would change its contents
+ */
+string BitstreamCache::GetFullKey(const TestPoint& tp)
+{
+	return string("gp4tchar ") + GP4TCHAR_VERSION + " " + m_device.GetPartAsString() + " " + tp.GetKey();
+}
+
+string BitstreamCache::GetFileName(const TestPoint& tp)
+{
+	//64-bit FNV-1a of the full key. The key is stored in the file too, so a collision can't hand back the wrong image
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(auto c : GetFullKey(tp))
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001b3ULL;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bit", static_cast<unsigned long long>(hash));
+	return m_dir + "/" + name;
+}
+
+bool BitstreamCache::Load(const TestPoint& tp, vector<uint8_t>& bitstream)
+{
+	if(m_dir.empty())
+		return false;
+
+	FILE* fp = fopen(GetFileName(tp).c_str(), "rb");
+	if(!fp)
+		return false;
+
+	//First line is the key, the rest is the raw bitstream
+	char key[256];
+	if( (NULL == fgets(key, sizeof(key), fp)) || (GetFullKey(tp) + "\n" != key) )
+	{
+		LogVerbose("Cache entry for %s is stale, ignoring it\n", tp.GetKey().c_str());
+		fclose(fp);
+		return false;
+	}
+
+	bitstream.resize(m_device.GetBitstreamLength() / 8);
+	size_t len = fread(&bitstream[0], 1, bitstream.size(), fp);
+	bool extra = (fgetc(fp) != EOF);
+	fclose(fp);
+
+	if( (len != bitstream.size()) || extra )
+	{
+		LogVerbose("Cache entry for %s is truncated, ignoring it\n", tp.GetKey().c_str());
+		return false;
+	}
+	return true;
+}
+
+bool BitstreamCache::Store(const TestPoint& tp, const vector<uint8_t>& bitstream)
+{
+	if(m_dir.empty())
+		return true;
+
+	//Write under a temporary name, then rename, so a bench sharing the cache never sees a partial entry
+	string fname = GetFileName(tp);
+	string tmpname = fname + ".tmp";
+	FILE* fp = fopen(tmpname.c_str(), "wb");
+	if(!fp)
+	{
+		LogWarning("Couldn't write to bitstream cache directory %s\n", m_dir.c_str());
+		return false;
+	}
+
+	string key = GetFullKey(tp) + "\n";
+	bool ok = (key.size() == fwrite(key.c_str(), 1, key.size(), fp));
+	ok &= (bitstream.size() == fwrite(&bitstream[0], 1, bitstream.size(), fp));
+	ok &= (0 == fclose(fp));
+	if(!ok || (0 != rename(tmpname.c_str(), fname.c_str())) )
+	{
+		LogWarning("Couldn't write %s\n", fname.c_str());
+		remove(tmpname.c_str());
+		return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache population
+
+/**
+	@brief Makes sure every bitstream in the plan is in memory, generating whatever isn't cached on disk yet
+
+	Generation is spread over a pool of worker threads; each test point is built on its own Greenpak4Device.
+
+	@param plan		Test points to prepare
+	@param nthreads	Number of workers, or 0 to use one per hardware thread
+	@param rebuild	Regenerate everything, ignoring (and overwriting) what's on disk
+
+	@return False if any bitstream couldn't be generated
+ */
+bool BitstreamCache::Prepare(const vector<TestPoint>& plan, unsigned int nthreads, bool rebuild)
+{
+	if(!m_dir.empty())
+	{
+#ifdef _WIN32
+		mkdir(m_dir.c_str());
+#else
+		mkdir(m_dir.c_str(), 0755);
+#endif
+	}
+
+	//Pick up whatever we already have
+	vector<const TestPoint*> pending;
+	set<string> seen;
+	for(auto& tp : plan)
+	{
+		string key = tp.GetKey();
+		if( (m_bitstreams.find(key) != m_bitstreams.end()) || (seen.find(key) != seen.end()) )
+			continue;
+		seen.insert(key);
+
+		vector<uint8_t> bitstream;
+		if(!rebuild && Load(tp, bitstream))
+		{
+			m_bitstreams[key] = bitstream;
+			m_hits ++;
+		}
+		else
+			pending.push_back(&tp);
+	}
+
+	if(pending.empty())
+	{
+		LogNotice("All %zu test bitstreams found in cache\n", seen.size());
+		return true;
+	}
+
+	//Generate the rest
+	if(nthreads == 0)
+		nthreads = thread::hardware_concurrency();
+	if(nthreads == 0)
+		nthreads = 1;
+	if(nthreads > pending.size())
+		nthreads = pending.size();
+
+	LogNotice("Generating %zu of %zu test bitstreams with %u worker threads\n",
+		pending.size(), seen.size(), nthreads);
+	auto start = chrono::steady_clock::now();
+
+	vector< vector<uint8_t> > results(pending.size());
+	vector<char> ok(pending.size(), 0);
+	atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		while(true)
+		{
+			size_t i = next ++;
+			if(i >= pending.size())
+				break;
+			ok[i] = BuildTestBitstream(*pending[i], results[i]);
+		}
+	};
+
+	vector<thread> workers;
+	for(unsigned int i=0; i<nthreads; i++)
+		workers.push_back(thread(worker));
+	for(auto& t : workers)
+		t.join();
+
+	bool allok = true;
+	for(size_t i=0; i<pending.size(); i++)
+	{
+		if(!ok[i])
+		{
+			LogError("Couldn't generate bitstream for %s\n", pending[i]->GetKey().c_str());
+			allok = false;
+			continue;
+		}
+
+		Store(*pending[i], results[i]);
+		m_bitstreams[pending[i]->GetKey()] = results[i];
+		m_builds ++;
+	}
+
+	LogNotice("Generated test bitstreams in %.1f ms\n",
+		chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+
+	return allok;
+}
+
+/**
+	@brief Gets the bitstream for a test point, generating (and caching) it if Prepare() didn't already
+ */
+bool BitstreamCache::Get(const TestPoint& tp, vector<uint8_t>& bitstream)
+{
+	string key = tp.GetKey();
+	auto it = m_bitstreams.find(key);
+	if(it != m_bitstreams.end())
+	{
+		bitstream = it->second;
+		return true;
+	}
+
+	if(Load(tp, bitstream))
+		m_hits ++;
+	else
+	{
+		LogVerbose("Test point %s isn't in the plan, generating it now\n", key.c_str());
+		if(!BuildTestBitstream(tp, bitstream))
+			return false;
+		Store(tp, bitstream);
+		m_builds ++;
+	}
+
+	m_bitstreams[key] = bitstream;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dry run
+
+/**
+	@brief Checks a test plan against the test fixture and the bitstream cache, without touching any hardware
+
+	Must be called after the context's BitstreamCache::Prepare() on the same plan.
+ */
+bool ValidateTestPlan(CharacterizationContext& ctx, const vector<TestPoint>& plan)
+{
+	LogNotice("Validating test plan\n");
+	LogIndenter li;
+
+	//Pins wired to the FPGA (see IOSetup() and CalibrateTraceDelays())
+	set<int> fixturePins = {3, 4, 5, 13, 14, 15};
+
+	static const char* names[] = {"pin-to-pin", "cross-connection", "LUT", "inverter", "delay line"};
+	map<int, size_t> counts;
+	set<string> keys;
+	bool ok = true;
+	for(auto& tp : plan)
+	{
+		string key = tp.GetKey();
+		counts[tp.m_type] ++;
+
+		if(keys.find(key) != keys.end())
+			LogWarning("%s is in the plan more than once\n", key.c_str());
+		keys.insert(key);
+
+		if( (fixturePins.find(tp.m_src) == fixturePins.end()) || (fixturePins.find(tp.m_dst) == fixturePins.end()) )
+		{
+			LogError("%s uses a pin that isn't connected to the FPGA\n", key.c_str());
+			ok = false;
+		}
+
+		//Only cross connections are allowed to go from one side of the device to the other
+		bool crosses = (tp.m_src < 10) != (tp.m_dst < 10);
+		if(crosses != (tp.m_type == TestPoint::CROSS_CONNECTION))
+		{
+			LogError("%s goes between the wrong halves of the device\n", key.c_str());
+			ok = false;
+		}
+
+		vector<uint8_t> bitstream;
+		if(!ctx.m_cache.Get(tp, bitstream))
+			ok = false;
+		else if(bitstream.size() != ctx.m_device.GetBitstreamLength() / 8)
+		{
+			LogError("%s has a %zu byte bitstream (expected %u)\n",
+				key.c_str(), bitstream.size(), ctx.m_device.GetBitstreamLength() / 8);
+			ok = false;
+		}
+	}
+
+	size_t nvolts = sizeof(g_testVoltages) / sizeof(g_testVoltages[0]);
+	for(auto it : counts)
+		LogNotice("%-16s %4zu test points\n", names[it.first], it.second);
+	LogNotice("%zu test points, %zu measurements over %zu voltages (%zu bitstreams cached, %zu generated)\n",
+		plan.size(), plan.size() * nvolts, nvolts, ctx.m_cache.GetHitCount(), ctx.m_cache.GetBuildCount());
+
+	//How much of it is left to do
+	size_t done = 0;
+	for(auto& tp : plan)
+	{
+		for(auto v : g_testVoltages)
+		{
+			if(ctx.m_journal.Contains(tp, PTVCorner(PTVCorner::SPEED_TYPICAL, 25, v)))
+				done ++;
+		}
+	}
+	LogNotice("%zu of %zu measurements already in the journal\n", done, plan.size() * nvolts);
+
+	if(ok)
+		LogNotice("Test plan is valid\n");
+	return ok;
+}
@@ -35,18 +35,165 @@ bool IOReset(hdevice hdev);
 bool IOSetup(hdevice hdev);
 bool PowerSetup(hdevice hdev, int voltage_mv = 3300);
 
-bool ReadTraceDelays();
-bool CalibrateTraceDelays(Socket& sock, hdevice hdev);
+/**
+	@brief One characterization configuration: a single path through the device, from pin m_src to pin m_dst
 
-bool MeasureLUTDelays(Socket& sock, hdevice hdev);
-bool MeasurePinToPinDelays(Socket& sock, hdevice hdev);
-bool MeasureCrossConnectionDelays(Socket& sock, hdevice hdev);
-bool MeasureInverterDelays(Socket& sock, hdevice hdev);
-bool MeasureDelayLineDelays(Socket& sock, hdevice hdev);
+	Everything needed to generate the test bitstream is in here, so test points can be built ahead of time (and in
+	parallel) and looked up again when it's time to measure them.
+ */
+class TestPoint
+{
+public:
+	enum TestType
+	{
+		PIN_TO_PIN,
+		CROSS_CONNECTION,
+		LUT,
+		INVERTER,
+		DELAY_LINE
+	};
+
+	TestPoint(TestType type, int src, int dst, int index = 0, int param = 0, bool flag = false)
+	: m_type(type)
+	, m_src(src)
+	, m_dst(dst)
+	, m_index(index)
+	, m_param(param)
+	, m_flag(flag)
+	{}
+
+	std::string GetKey() const;
+
+	TestType m_type;
+
+	int m_src;
+	int m_dst;
+
+	//LUT, inverter, delay line or cross-connection number
+	int m_index;
+
+	//LUT input, delay line tap, cross-connection matrix, or pin-to-pin drive strength
+	int m_param;
+
+	//Schmitt trigger (pin-to-pin) or glitch filter (delay line)
+	bool m_flag;
+};
+
+std::vector<TestPoint> GetTestPlan(Greenpak4Device& device);
+bool BuildTestBitstream(const TestPoint& tp, std::vector<uint8_t>& bitstream);
+
+/**
+	@brief On-disk cache of characterization bitstreams, so that measurement runs only have to stream them out
+
+	Entries are named by a hash of the part, the test point and the tool version, and hold a copy of the test point
+	key so a stale or colliding entry is never used.
+ */
+class BitstreamCache
+{
+public:
+	BitstreamCache(Greenpak4Device& device);
+
+	void SetDirectory(std::string dir)
+	{ m_dir = dir; }
+
+	bool Prepare(const std::vector<TestPoint>& plan, unsigned int nthreads, bool rebuild);
+	bool Get(const TestPoint& tp, std::vector<uint8_t>& bitstream);
+
+	size_t GetHitCount()
+	{ return m_hits; }
+
+	size_t GetBuildCount()
+	{ return m_builds; }
+
+protected:
+	std::string GetFullKey(const TestPoint& tp);
+	std::string GetFileName(const TestPoint& tp);
+	bool Load(const TestPoint& tp, std::vector<uint8_t>& bitstream);
+	bool Store(const TestPoint& tp, const std::vector<uint8_t>& bitstream);
+
+	//Device the bitstreams are for
+	Greenpak4Device& m_device;
+
+	std::string m_dir;
+	std::map<std::string, std::vector<uint8_t> > m_bitstreams;
+	size_t m_hits;
+	size_t m_builds;
+};
+
+/**
+	@brief Append-only record of every raw measurement taken, so an interrupted run can pick up where it left off
+
+	Measurements are stored before any fixture or pad delay corrections, keyed by test point and PTV corner. A rerun
+	only goes to the hardware for measurements that aren't in the journal yet; everything derived from them (pad
+	delay subtraction, equation systems) is recomputed from the journaled values.
+ */
+class MeasurementJournal
+{
+public:
+	MeasurementJournal();
+	~MeasurementJournal();
+
+	bool Open(std::string fname);
+	bool Merge(std::string fname);
+
+	bool Contains(const TestPoint& tp, const PTVCorner& corner)
+	{ return m_entries.find(GetKey(tp, corner)) != m_entries.end(); }
+
+	bool Lookup(const TestPoint& tp, const PTVCorner& corner, CombinatorialDelay& delay);
+	void Record(const TestPoint& tp, const PTVCorner& corner, CombinatorialDelay delay);
+
+	size_t GetReplayCount()
+	{ return m_replayed; }
+
+	size_t GetRecordCount()
+	{ return m_recorded; }
+
+protected:
+	static std::string GetKey(const TestPoint& tp, const PTVCorner& corner);
+
+	FILE* m_fp;
+	std::map<std::string, CombinatorialDelay> m_entries;
+	size_t m_replayed;
+	size_t m_recorded;
+};
+
+/**
+	@brief Everything one characterization run works on
+
+	There's no global state in the measurement code, so independent runs (say, one per dev board) can each have a
+	context and work side by side in one process.
+ */
+class CharacterizationContext
+{
+public:
+	CharacterizationContext();
+
+	/**
+		@brief The "calibration device"
+
+		We never actually modify the netlist or create a bitstream from this. It's just a convenient repository to
+		put timing data in before we serialize to disk.
+	 */
+	Greenpak4Device m_device;
+
+	DevkitCalibration m_devkitCal;
+	BitstreamCache m_cache;
+	MeasurementJournal m_journal;
+};
+
+bool ValidateTestPlan(CharacterizationContext& ctx, const std::vector<TestPoint>& plan);
+
+bool ReadTraceDelays(CharacterizationContext& ctx);
+bool CalibrateTraceDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
+
+bool MeasureLUTDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
+bool MeasurePinToPinDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
+bool MeasureCrossConnectionDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
+bool MeasureInverterDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
+bool MeasureDelayLineDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev);
 
 void WaitForKeyPress();
 
-extern DevkitCalibration g_devkitCal;
-extern Greenpak4Device g_calDevice;
+extern const int g_testVoltages[3];
 
 #endif
@@ -0,0 +1,146 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4tchar.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+MeasurementJournal::MeasurementJournal()
+	: m_fp(NULL)
+	, m_replayed(0)
+	, m_recorded(0)
+{
+}
+
+MeasurementJournal::~MeasurementJournal()
+{
+	if(m_fp)
+		fclose(m_fp);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Journal I/O
+
+/**
+	@brief Key a measurement is filed under: the test point and the corner it was measured at
+ */
+string MeasurementJournal::GetKey(const TestPoint& tp, const PTVCorner& corner)
+{
+	char tmp[64];
+	snprintf(tmp, sizeof(tmp), "%d %d %d", (int)corner.GetSpeed(), corner.GetTemp(), corner.GetVoltage());
+	return tp.GetKey() + "\t" + tmp;
+}
+
+/**
+	@brief Reads every entry of a journal file into memory
+
+	Lines are "test point<TAB>speed temp voltage<TAB>rising falling". Anything else (such as a line cut short by a
+	crash in the middle of a write) is skipped. Later entries override earlier ones.
+
+	@return False if the file doesn't exist
+ */
+bool MeasurementJournal::Merge(string fname)
+{
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+		return false;
+
+	char line[512];
+	size_t count = 0;
+	while(NULL != fgets(line, sizeof(line), fp))
+	{
+		string s(line);
+		size_t tab1 = s.find('\t');
+		size_t tab2 = (tab1 == string::npos) ? string::npos : s.find('\t', tab1 + 1);
+		if( (tab2 == string::npos) || (s.back() != '\n') )
+			continue;
+
+		float rising;
+		float falling;
+		if(2 != sscanf(s.c_str() + tab2 + 1, "%f %f", &rising, &falling))
+			continue;
+
+		m_entries[s.substr(0, tab2)] = CombinatorialDelay(rising, falling);
+		count ++;
+	}
+	fclose(fp);
+
+	LogNotice("Loaded %zu measurements from journal %s\n", count, fname.c_str());
+	return true;
+}
+
+/**
+	@brief Loads an existing journal (if there is one) and opens it for appending new measurements
+ */
+bool MeasurementJournal::Open(string fname)
+{
+	Merge(fname);
+
+	//If the last run died partway through a line, finish that line off so our first entry isn't glued onto it
+	bool partial = false;
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(fp)
+	{
+		if( (0 == fseek(fp, -1, SEEK_END)) && (fgetc(fp) != '\n') )
+			partial = true;
+		fclose(fp);
+	}
+
+	m_fp = fopen(fname.c_str(), "a");
+	if(!m_fp)
+	{
+		LogError("Couldn't open measurement journal %s for writing\n", fname.c_str());
+		return false;
+	}
+	if(partial)
+		fputc('\n', m_fp);
+	return true;
+}
+
+/**
+	@brief Looks up a measurement made by an earlier (or concurrent, merged) run
+ */
+bool MeasurementJournal::Lookup(const TestPoint& tp, const PTVCorner& corner, CombinatorialDelay& delay)
+{
+	auto it = m_entries.find(GetKey(tp, corner));
+	if(it == m_entries.end())
+		return false;
+
+	delay = it->second;
+	m_replayed ++;
+	LogVerbose("Using journaled measurement for %s at %d mV\n", tp.GetKey().c_str(), corner.GetVoltage());
+	return true;
+}
+
+/**
+	@brief Appends a completed measurement to the journal, and flushes it to disk right away
+ */
+void MeasurementJournal::Record(const TestPoint& tp, const PTVCorner& corner, CombinatorialDelay delay)
+{
+	string key = GetKey(tp, corner);
+	m_entries[key] = delay;
+	m_recorded ++;
+
+	if(!m_fp)
+		return;
+	fprintf(m_fp, "%s\t%.6f %.6f\n", key.c_str(), delay.m_rising, delay.m_falling);
+	fflush(m_fp);
+}
@@ -17,6 +17,7 @@
  **********************************************************************************************************************/
 
 #include "gp4tchar.h"
+#include <set>
 
 #ifndef _WIN32
 #include <termios.h>
@@ -26,7 +27,7 @@
 
 using namespace std;
 
-DevkitCalibration g_devkitCal;
+bool RunTests(CharacterizationContext& ctx, Socket& sock, hdevice hdev, const set<string>& tests);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Entry point
@@ -39,6 +40,16 @@ int main(int argc, char* argv[])
 	string server;
 	int port = 0;
 
+	string cachedir = "tchar-cache";
+	bool rebuildCache = false;
+	bool dryRun = false;
+	unsigned int nthreads = 0;
+
+	string journal = "tchar-journal.txt";
+	vector<string> mergeJournals;
+	bool offline = false;
+	set<string> tests;
+
 	//Parse command-line arguments
 	for(int i=1; i<argc; i++)
 	{
@@ -53,6 +64,85 @@ int main(int argc, char* argv[])
 		else if(s == "--server")
 			server = argv[++i];
 
+		else if(s == "--cache-dir")
+		{
+			if(i+1 < argc)
+				cachedir = argv[++i];
+
+			else
+			{
+				printf("--cache-dir requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--rebuild-cache")
+			rebuildCache = true;
+		else if(s == "--dry-run")
+			dryRun = true;
+		else if(s == "--journal")
+		{
+			if(i+1 < argc)
+				journal = argv[++i];
+
+			else
+			{
+				printf("--journal requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--merge-journal")
+		{
+			if(i+1 < argc)
+				mergeJournals.push_back(argv[++i]);
+
+			else
+			{
+				printf("--merge-journal requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--offline")
+			offline = true;
+		else if(s == "--tests")
+		{
+			if(i+1 < argc)
+			{
+				//Comma separated list of test passes
+				string list = argv[++i];
+				size_t start = 0;
+				while(start <= list.size())
+				{
+					size_t end = list.find(',', start);
+					if(end == string::npos)
+						end = list.size();
+					string name = list.substr(start, end - start);
+					if( (name != "pin") && (name != "xconn") && (name != "lut") && (name != "inv") && (name != "delay") )
+					{
+						printf("--tests must be a comma separated list of pin, xconn, lut, inv and delay\n");
+						return 1;
+					}
+					tests.insert(name);
+					start = end + 1;
+				}
+			}
+			else
+			{
+				printf("--tests requires an argument\n");
+				return 1;
+			}
+		}
+		else if( (s == "-j") || (s == "--jobs") )
+		{
+			if(i+1 < argc)
+				nthreads = atoi(argv[++i]);
+
+			else
+			{
+				printf("--jobs requires an argument\n");
+				return 1;
+			}
+		}
+
 		else if(s == "--device")
 		{
 			if(i+1 < argc)
@@ -75,13 +165,50 @@ int main(int argc, char* argv[])
 	//Set up logging
 	g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(console_verbosity));
 
+	//Generate every test bitstream up front, so the measurement loop only has to stream them to the board
+	CharacterizationContext ctx;
+	auto plan = GetTestPlan(ctx.m_device);
+	ctx.m_cache.SetDirectory(cachedir);
+	if(!ctx.m_cache.Prepare(plan, nthreads, rebuildCache))
+		return 1;
+
+	//Pick up measurements from earlier runs (ours, and any other bench's)
+	for(auto f : mergeJournals)
+	{
+		if(!ctx.m_journal.Merge(f))
+		{
+			LogError("Couldn't open journal %s\n", f.c_str());
+			return 1;
+		}
+	}
+	if(!ctx.m_journal.Open(journal))
+		return 1;
+
+	//In a dry run, check the plan and stop before touching any hardware
+	if(dryRun)
+		return ValidateTestPlan(ctx, plan) ? 0 : 1;
+
+	LogNotice("GreenPAK timing characterization helper v0.1 by Andrew Zonenberg\n");
+
+	//Offline runs only re-solve from the journal, so there's no hardware to set up
+	Socket sock(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+	hdevice hdev = NULL;
+	if(offline)
+	{
+		if(!ReadTraceDelays(ctx))
+		{
+			LogError("Offline runs need the devkit calibration in pincal.csv\n");
+			return 1;
+		}
+		return RunTests(ctx, sock, hdev, tests) ? 0 : 1;
+	}
+
 	//Connect to the server
 	if( (server == "") || (port == 0) )
 	{
 		LogError("No server or port name specified\n");
 		return 1;
 	}
-	Socket sock(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
 	if(!sock.Connect(server, port))
 	{
 		LogError("Failed to connect to GreenpakTimingTest server\n");
@@ -89,10 +216,8 @@ int main(int argc, char* argv[])
 	}
 	sock.DisableNagle();
 
-	LogNotice("GreenPAK timing characterization helper v0.1 by Andrew Zonenberg\n");
-
 	//Open the dev board
-	hdevice hdev = OpenBoard(nboard);
+	hdev = OpenBoard(nboard);
 	if(!hdev)
 		return 1;
 
@@ -100,9 +225,9 @@ int main(int argc, char* argv[])
 	SetStatusLED(hdev, 1);
 
 	//Do initial loopback characterization on the devkit and adapters before installing the chip
-	if(!ReadTraceDelays())
+	if(!ReadTraceDelays(ctx))
 	{
-		if(!CalibrateTraceDelays(sock, hdev))
+		if(!CalibrateTraceDelays(ctx, sock, hdev))
 		{
 			SetStatusLED(hdev, 0);
 			Reset(hdev);
@@ -124,44 +249,70 @@ int main(int argc, char* argv[])
 	//Read board temperature
 	
 
+	//Measure delay through each element
+	bool ok = RunTests(ctx, sock, hdev, tests);
+
+	//Done
+	LogNotice("Done, resetting board\n");
+	SetStatusLED(hdev, 0);
+	Reset(hdev);
+	USBCleanup(hdev);
+
+	return ok ? 0 : 1;
+}
+
+/**
+	@brief Runs the selected measurement passes, saving the timing data after each one
+
+	Every measurement is journaled as it completes (see MeasurementJournal), so if a pass fails partway the next
+	run only has to redo what's missing.
+ */
+bool RunTests(CharacterizationContext& ctx, Socket& sock, hdevice hdev, const set<string>& tests)
+{
 	//Load timing data from disk
 	LogNotice("Loading timing data...\n");
 	string tfname = "timing.json";
-	if(!g_calDevice.LoadTimingData(tfname))
+	if(!ctx.m_device.LoadTimingData(tfname))
 		LogWarning("Couldn't load existing timing data file\n");
 
-	//Measure delay through each element
-	/*
-	if(!MeasurePinToPinDelays(sock, hdev))
-		return 1;
-	if(!MeasureCrossConnectionDelays(sock, hdev))
-		return 1;
-	if(!MeasureLUTDelays(sock, hdev))
-		return 1;
-	if(!MeasureInverterDelays(sock, hdev))
-		return 1;
-	if(!MeasureDelayLineDelays(sock, hdev))
-		return 1;
-	*/
+	//Pin-to-pin goes first, since the others subtract I/O buffer delays from their measurements
+	typedef bool (*TestPass)(CharacterizationContext&, Socket&, hdevice);
+	pair<const char*, TestPass> passes[] =
+	{
+		make_pair("pin", MeasurePinToPinDelays),
+		make_pair("xconn", MeasureCrossConnectionDelays),
+		make_pair("lut", MeasureLUTDelays),
+		make_pair("inv", MeasureInverterDelays),
+		make_pair("delay", MeasureDelayLineDelays)
+	};
+
+	bool ok = true;
+	for(auto p : passes)
+	{
+		if(tests.find(p.first) == tests.end())
+			continue;
+
+		ok = p.second(ctx, sock, hdev);
+
+		//Save to disk
+		LogNotice("Saving timing data to file %s\n", tfname.c_str());
+		ctx.m_device.SaveTimingData(tfname.c_str());
+
+		if(!ok)
+			break;
+	}
 
-	//Save to disk
-	LogNotice("Saving timing data to file %s\n", tfname.c_str());
-	g_calDevice.SaveTimingData(tfname.c_str());
+	LogNotice("%zu measurements taken, %zu reused from journal\n",
+		ctx.m_journal.GetRecordCount(), ctx.m_journal.GetReplayCount());
 
 	//Print output
 	LogNotice("Dumping timing data...\n");
 	{
 		LogIndenter li;
-		//g_calDevice.PrintTimingData();
+		//ctx.m_device.PrintTimingData();
 	}
 
-	//Done
-	LogNotice("Done, resetting board\n");
-	SetStatusLED(hdev, 0);
-	Reset(hdev);
-	USBCleanup(hdev);
-
-	return 0;
+	return ok;
 }
 
 void WaitForKeyPress()
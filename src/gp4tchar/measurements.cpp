@@ -23,23 +23,22 @@
 using namespace std;
 
 //Device configuration
-Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
-Greenpak4IOB::PullDirection unused_pull = Greenpak4IOB::PULL_DOWN;
-Greenpak4IOB::PullStrength  unused_drive = Greenpak4IOB::PULL_1M;
+static const Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
+static const Greenpak4IOB::PullDirection unused_pull = Greenpak4IOB::PULL_DOWN;
+static const Greenpak4IOB::PullStrength  unused_drive = Greenpak4IOB::PULL_1M;
 
-/**
-	@brief The "calibration device"
-
-	We never actually modify the netlist or create a bitstream from this. It's just a convenient repository to put
-	timing data in before we serialize to disk.
- */
-Greenpak4Device g_calDevice(part, unused_pull, unused_drive);
+CharacterizationContext::CharacterizationContext()
+	: m_device(part, unused_pull, unused_drive)
+	, m_cache(m_device)
+{
+}
 
 bool MeasureDelay(Socket& sock, int src, int dst, CombinatorialDelay& delay, bool invertOutput = false);
 
 bool PromptAndMeasureDelay(Socket& sock, int src, int dst, CombinatorialDelay& value);
 
 bool MeasureCrossConnectionDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	unsigned int matrix,
@@ -50,6 +49,7 @@ bool MeasureCrossConnectionDelay(
 	map<PTVCorner, CombinatorialDelay>& delays);
 
 bool MeasurePinToPinDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int src,
@@ -60,6 +60,7 @@ bool MeasurePinToPinDelay(
 	CombinatorialDelay& delay);
 
 bool MeasureLUTDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int nlut,
@@ -68,6 +69,7 @@ bool MeasureLUTDelay(
 	map<PTVCorner, CombinatorialDelay>& delays);
 
 bool MeasureInverterDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int ninv,
@@ -75,6 +77,7 @@ bool MeasureInverterDelay(
 	map<PTVCorner, CombinatorialDelay>& delays);
 
 bool MeasureDelayLineDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int ndel,
@@ -84,26 +87,25 @@ bool MeasureDelayLineDelay(
 	map<PTVCorner, CombinatorialDelay>& delays);
 
 bool ProgramAndMeasureDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
-	vector<uint8_t>& bitstream,
-	int src,
-	int dst,
+	const TestPoint& tp,
 	int voltage_mv,
 	CombinatorialDelay& delay);
 
 bool ProgramAndMeasureDelayAcrossVoltageCorners(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
-	vector<uint8_t>& bitstream,
-	int src,
-	int dst,
+	const TestPoint& tp,
 	PTVCorner corner,
 	bool subtractPadDelay,
 	map<PTVCorner, CombinatorialDelay>& delays,
 	bool invertOutput = false);
 
 CombinatorialDelay GetRoundTripDelayWith2x(
+	CharacterizationContext& ctx,
 	int src,
 	int dst,
 	PTVCorner corner,
@@ -111,6 +113,8 @@ CombinatorialDelay GetRoundTripDelayWith2x(
 
 Greenpak4LUT* GetRealLUT(Greenpak4BitstreamEntity* lut);
 
+void GetTestPins(unsigned int matrix, int& src, int& dst);
+
 //Voltages to test at
 //For now, 3.3 +/- 150 mV
 const int g_testVoltages[] = {3150, 3300, 3450};
@@ -118,7 +122,7 @@ const int g_testVoltages[] = {3150, 3300, 3450};
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Initial measurement calibration
 
-bool CalibrateTraceDelays(Socket& sock, hdevice hdev)
+bool CalibrateTraceDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Calibrate FPGA-to-DUT trace delays\n");
 	LogIndenter li;
@@ -222,12 +226,12 @@ bool CalibrateTraceDelays(Socket& sock, hdevice hdev)
 		return false;
 
 	//Extract the values
-	g_devkitCal.pinDelays[3] = CombinatorialDelay(r3.m_value, f3.m_value);
-	g_devkitCal.pinDelays[4] = CombinatorialDelay(r4.m_value, f4.m_value);
-	g_devkitCal.pinDelays[5] = CombinatorialDelay(r5.m_value, f5.m_value);
-	g_devkitCal.pinDelays[13] = CombinatorialDelay(r13.m_value, f13.m_value);
-	g_devkitCal.pinDelays[14] = CombinatorialDelay(r14.m_value, f14.m_value);
-	g_devkitCal.pinDelays[15] = CombinatorialDelay(r15.m_value, f15.m_value);
+	ctx.m_devkitCal.pinDelays[3] = CombinatorialDelay(r3.m_value, f3.m_value);
+	ctx.m_devkitCal.pinDelays[4] = CombinatorialDelay(r4.m_value, f4.m_value);
+	ctx.m_devkitCal.pinDelays[5] = CombinatorialDelay(r5.m_value, f5.m_value);
+	ctx.m_devkitCal.pinDelays[13] = CombinatorialDelay(r13.m_value, f13.m_value);
+	ctx.m_devkitCal.pinDelays[14] = CombinatorialDelay(r14.m_value, f14.m_value);
+	ctx.m_devkitCal.pinDelays[15] = CombinatorialDelay(r15.m_value, f15.m_value);
 
 	//Print results
 	{
@@ -237,15 +241,15 @@ bool CalibrateTraceDelays(Socket& sock, hdevice hdev)
 		{
 			LogNotice("FPGA pin %2d to DUT: %.3f ns rising, %.3f ns falling\n",
 				i,
-				g_devkitCal.pinDelays[i].m_rising,
-				g_devkitCal.pinDelays[i].m_falling);
+				ctx.m_devkitCal.pinDelays[i].m_rising,
+				ctx.m_devkitCal.pinDelays[i].m_falling);
 		}
 		for(int i=13; i<=15; i++)
 		{
 			LogNotice("FPGA pin %2d to DUT: %.3f ns rising, %.3f ns falling\n",
 				i,
-				g_devkitCal.pinDelays[i].m_rising,
-				g_devkitCal.pinDelays[i].m_falling);
+				ctx.m_devkitCal.pinDelays[i].m_rising,
+				ctx.m_devkitCal.pinDelays[i].m_falling);
 		}
 	}
 
@@ -253,9 +257,9 @@ bool CalibrateTraceDelays(Socket& sock, hdevice hdev)
 	LogNotice("Writing calibration to file pincal.csv\n");
 	FILE* fp = fopen("pincal.csv", "w");
 	for(int i=3; i<=5; i++)
-		fprintf(fp, "%d,%.3f,%.3f\n", i, g_devkitCal.pinDelays[i].m_rising, g_devkitCal.pinDelays[i].m_falling);
+		fprintf(fp, "%d,%.3f,%.3f\n", i, ctx.m_devkitCal.pinDelays[i].m_rising, ctx.m_devkitCal.pinDelays[i].m_falling);
 	for(int i=13; i<=15; i++)
-		fprintf(fp, "%d,%.3f,%.3f\n", i, g_devkitCal.pinDelays[i].m_rising, g_devkitCal.pinDelays[i].m_falling);
+		fprintf(fp, "%d,%.3f,%.3f\n", i, ctx.m_devkitCal.pinDelays[i].m_rising, ctx.m_devkitCal.pinDelays[i].m_falling);
 	fclose(fp);
 
 	//Prompt to put the actual DUT in
@@ -265,7 +269,7 @@ bool CalibrateTraceDelays(Socket& sock, hdevice hdev)
 	return true;
 }
 
-bool ReadTraceDelays()
+bool ReadTraceDelays(CharacterizationContext& ctx)
 {
 	FILE* fp = fopen("pincal.csv", "r");
 	if(!fp)
@@ -281,7 +285,7 @@ bool ReadTraceDelays()
 		if( (i > 20) || (i < 1) )
 			continue;
 
-		g_devkitCal.pinDelays[i] = CombinatorialDelay(r, f);
+		ctx.m_devkitCal.pinDelays[i] = CombinatorialDelay(r, f);
 
 		LogNotice("FPGA pin %2d to DUT: %.3f ns rising, %.3f ns falling\n", i, r, f);
 	}
@@ -340,15 +344,28 @@ bool MeasureDelay(Socket& sock, int src, int dst, CombinatorialDelay& delay, boo
 // Load the bitstream onto the device and measure a pin-to-pin delay
 
 bool ProgramAndMeasureDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
-	vector<uint8_t>& bitstream,
-	int src,
-	int dst,
+	const TestPoint& tp,
 	int voltage_mv,
 	CombinatorialDelay& delay)
 {
+	//Skip the hardware entirely if an earlier run already did this
+	PTVCorner corner(PTVCorner::SPEED_TYPICAL, 25, voltage_mv);
+	if(ctx.m_journal.Lookup(tp, corner, delay))
+		return true;
+
+	if(!hdev)
+	{
+		LogError("No measurement of %s at %d mV in the journal\n", tp.GetKey().c_str(), voltage_mv);
+		return false;
+	}
+
 	//Emulate the device
+	vector<uint8_t> bitstream;
+	if(!ctx.m_cache.Get(tp, bitstream))
+		return false;
 	LogVerbose("Loading new bitstream\n");
 	if(!DownloadBitstream(hdev, bitstream, DownloadMode::EMULATION))
 		return false;
@@ -358,44 +375,68 @@ bool ProgramAndMeasureDelay(
 	usleep (1000 * 10);
 
 	//Measure delay between the affected pins
-	return MeasureDelay(sock, src, dst, delay);
+	if(!MeasureDelay(sock, tp.m_src, tp.m_dst, delay))
+		return false;
+	ctx.m_journal.Record(tp, corner, delay);
+	return true;
 }
 
 bool ProgramAndMeasureDelayAcrossVoltageCorners(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
-	vector<uint8_t>& bitstream,
-	int src,
-	int dst,
+	const TestPoint& tp,
 	PTVCorner corner,
 	bool subtractPadDelay,
 	map<PTVCorner, CombinatorialDelay>& delays,
 	bool invertOutput)
 {
-	//Emulate the device
-	LogVerbose("Loading new bitstream\n");
-	if(!DownloadBitstream(hdev, bitstream, DownloadMode::EMULATION))
-		return false;
+	int src = tp.m_src;
+	int dst = tp.m_dst;
 
+	bool loaded = false;
 	for(auto v : g_testVoltages)
 	{
 		corner.SetVoltage(v);
-		if(!PostProgramSetup(hdev, v))
-			return false;
-
-		//wait a bit to let voltages stabilize
-		usleep (1000 * 50);
 
-		//TODO: falling edge delays here!
 		CombinatorialDelay delay;
-		if(!MeasureDelay(sock, src, dst, delay, invertOutput))
-			return false;
+		if(!ctx.m_journal.Lookup(tp, corner, delay))
+		{
+			if(!hdev)
+			{
+				LogError("No measurement of %s at %d mV in the journal\n", tp.GetKey().c_str(), v);
+				return false;
+			}
+
+			//Emulate the device, the first time we actually need it
+			if(!loaded)
+			{
+				vector<uint8_t> bitstream;
+				if(!ctx.m_cache.Get(tp, bitstream))
+					return false;
+				LogVerbose("Loading new bitstream\n");
+				if(!DownloadBitstream(hdev, bitstream, DownloadMode::EMULATION))
+					return false;
+				loaded = true;
+			}
+
+			if(!PostProgramSetup(hdev, v))
+				return false;
+
+			//wait a bit to let voltages stabilize
+			usleep (1000 * 50);
+
+			//TODO: falling edge delays here!
+			if(!MeasureDelay(sock, src, dst, delay, invertOutput))
+				return false;
+			ctx.m_journal.Record(tp, corner, delay);
+		}
 
 		//Remove off-die delays if requested
 		if(subtractPadDelay)
 		{
 			//Subtract PCB trace and IO buffer delays
-			delay -= GetRoundTripDelayWith2x(src, dst, corner, invertOutput);
+			delay -= GetRoundTripDelayWith2x(ctx, src, dst, corner, invertOutput);
 		}
 
 		delays[corner] = delay;
@@ -407,7 +448,7 @@ bool ProgramAndMeasureDelayAcrossVoltageCorners(
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Characterize I/O buffers
 
-bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
+bool MeasurePinToPinDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Measuring pin-to-pin delays (through same crossbar)...\n");
 	LogIndenter li;
@@ -476,7 +517,7 @@ bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
 				e2.AddVariable(fobuf_x2, ibuf_to_obuf_ratio);
 
 				//Gather data from the DUT
-				if(!MeasurePinToPinDelay(sock, hdev, src, dst,
+				if(!MeasurePinToPinDelay(ctx, sock, hdev, src, dst,
 					Greenpak4IOB::DRIVE_1X, false, corner.GetVoltage(), delay))
 				{
 					return false;
@@ -488,7 +529,7 @@ bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
 				e4.AddVariable(fibuf);
 				e4.AddVariable(fobuf_x1);
 
-				if(!MeasurePinToPinDelay(sock, hdev, src, dst,
+				if(!MeasurePinToPinDelay(ctx, sock, hdev, src, dst,
 					Greenpak4IOB::DRIVE_2X, false, corner.GetVoltage(), delay))
 				{
 					return false;
@@ -500,7 +541,7 @@ bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
 				e6.AddVariable(fibuf);
 				e6.AddVariable(fobuf_x2);
 
-				if(!MeasurePinToPinDelay(sock, hdev, src, dst,
+				if(!MeasurePinToPinDelay(ctx, sock, hdev, src, dst,
 					Greenpak4IOB::DRIVE_2X, true, corner.GetVoltage(), delay))
 				{
 					return false;
@@ -528,7 +569,7 @@ bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
 					return false;
 
 				//Save combinatorial delays for these pins
-				auto iob = g_calDevice.GetIOB(src);
+				auto iob = ctx.m_device.GetIOB(src);
 				iob->AddCombinatorialDelay(
 					"IO",
 					"OUT",
@@ -556,6 +597,7 @@ bool MeasurePinToPinDelays(Socket& sock, hdevice hdev)
 	@brief Measure the delay for a single (src, dst) pin tuple
  */
 bool MeasurePinToPinDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int src,
@@ -567,40 +609,14 @@ bool MeasurePinToPinDelay(
 {
 	delay = -1;
 
-	//Create the device object
-	Greenpak4Device device(part, unused_pull, unused_drive);
-	device.SetIOPrecharge(false);
-	device.SetDisableChargePump(false);
-	device.SetLDOBypass(false);
-	device.SetNVMRetryCount(1);
-
-	//Configure the input pin
-	auto vss = device.GetGround();
-	auto srciob = device.GetIOB(src);
-	srciob->SetInput("OE", vss);
-	srciob->SetSchmittTrigger(schmitt);
-	auto din = srciob->GetOutput("OUT");
-
-	//Configure the output pin
-	auto vdd = device.GetPower();
-	auto dstiob = device.GetIOB(dst);
-	dstiob->SetInput("IN", din);
-	dstiob->SetInput("OE", vdd);
-	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
-	dstiob->SetDriveStrength(drive);
-
-	//Generate a bitstream
-	vector<uint8_t> bitstream;
-	device.WriteToBuffer(bitstream, 0, false);
-	//device.WriteToFile("/tmp/test.txt", 0, false);			//for debug in case of failure
-
 	//Get the delay
-	if(!ProgramAndMeasureDelay(sock, hdev, bitstream, src, dst, voltage_mv, delay))
+	TestPoint tp(TestPoint::PIN_TO_PIN, src, dst, 0, drive, schmitt);
+	if(!ProgramAndMeasureDelay(ctx, sock, hdev, tp, voltage_mv, delay))
 		return false;
 
 	//Subtract the PCB trace delay at each end of the line
-	delay -= g_devkitCal.pinDelays[src];
-	delay -= g_devkitCal.pinDelays[dst];
+	delay -= ctx.m_devkitCal.pinDelays[src];
+	delay -= ctx.m_devkitCal.pinDelays[dst];
 
 	return true;
 }
@@ -608,7 +624,7 @@ bool MeasurePinToPinDelay(
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Characterize cross-connections
 
-bool MeasureCrossConnectionDelays(Socket& sock, hdevice hdev)
+bool MeasureCrossConnectionDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Measuring cross-connection delays...\n");
 	LogIndenter li;
@@ -620,24 +636,25 @@ bool MeasureCrossConnectionDelays(Socket& sock, hdevice hdev)
 	for(int i=0; i<10; i++)
 	{
 		map<PTVCorner, CombinatorialDelay> delays;
-		if(!MeasureCrossConnectionDelay(sock, hdev, 0, i, 3, 13, corner, delays))
+		if(!MeasureCrossConnectionDelay(ctx, sock, hdev, 0, i, 3, 13, corner, delays))
 			return false;
 		for(auto it : delays)
-			g_calDevice.GetCrossConnection(0, i)->AddCombinatorialDelay("I", "O", it.first, it.second);
+			ctx.m_device.GetCrossConnection(0, i)->AddCombinatorialDelay("I", "O", it.first, it.second);
 	}
 
 	for(int i=0; i<10; i++)
 	{
 		map<PTVCorner, CombinatorialDelay> delays;
-		if(!MeasureCrossConnectionDelay(sock, hdev, 1, i, 13, 3, corner, delays))
+		if(!MeasureCrossConnectionDelay(ctx, sock, hdev, 1, i, 13, 3, corner, delays))
 			return false;
 		for(auto it : delays)
-			g_calDevice.GetCrossConnection(1, i)->AddCombinatorialDelay("I", "O", it.first, it.second);
+			ctx.m_device.GetCrossConnection(1, i)->AddCombinatorialDelay("I", "O", it.first, it.second);
 	}
 	return true;
 }
 
 bool MeasureCrossConnectionDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	unsigned int matrix,
@@ -647,38 +664,9 @@ bool MeasureCrossConnectionDelay(
 	PTVCorner corner,
 	map<PTVCorner, CombinatorialDelay>& delays)
 {
-	//Create the device object
-	Greenpak4Device device(part, unused_pull, unused_drive);
-	device.SetIOPrecharge(false);
-	device.SetDisableChargePump(false);
-	device.SetLDOBypass(false);
-	device.SetNVMRetryCount(1);
-
-	//Configure the input pin
-	auto vss = device.GetGround();
-	auto srciob = device.GetIOB(src);
-	srciob->SetInput("OE", vss);
-	auto din = srciob->GetOutput("OUT");
-
-	//Configure the cross-connection
-	auto xc = device.GetCrossConnection(matrix, index);
-	xc->SetInput("I", din);
-
-	//Configure the output pin
-	auto vdd = device.GetPower();
-	auto dstiob = device.GetIOB(dst);
-	dstiob->SetInput("IN", xc->GetOutput("O"));
-	dstiob->SetInput("OE", vdd);
-	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
-	dstiob->SetDriveStrength(Greenpak4IOB::DRIVE_2X);
-
-	//Generate a bitstream
-	vector<uint8_t> bitstream;
-	device.WriteToBuffer(bitstream, 0, false);
-	//device.WriteToFile("/tmp/test.txt", 0, false);			//for debug in case of failure
-
 	//Get the delays
-	if(!ProgramAndMeasureDelayAcrossVoltageCorners(sock, hdev, bitstream, src, dst, corner, true, delays))
+	TestPoint tp(TestPoint::CROSS_CONNECTION, src, dst, index, matrix);
+	if(!ProgramAndMeasureDelayAcrossVoltageCorners(ctx, sock, hdev, tp, corner, true, delays))
 		return false;
 
 	return true;
@@ -688,27 +676,28 @@ bool MeasureCrossConnectionDelay(
 // Helper for subtracting I/O pad and test fixture delays from a measurement
 
 CombinatorialDelay GetRoundTripDelayWith2x(
+	CharacterizationContext& ctx,
 	int src,
 	int dst,
 	PTVCorner corner,
 	bool invertOutput)
 {
 	//PCB trace delay at each end of the line
-	CombinatorialDelay delay = g_devkitCal.pinDelays[dst];
+	CombinatorialDelay delay = ctx.m_devkitCal.pinDelays[dst];
 	if(invertOutput)
 		delay = CombinatorialDelay(delay.m_falling, delay.m_rising);
-	delay += g_devkitCal.pinDelays[src];
+	delay += ctx.m_devkitCal.pinDelays[src];
 
 	//I/O buffer delay at each end of the line
 	//TODO: import calibration from the Greenpak4Device and/or reset it?
 	CombinatorialDelay d;
-	auto srciob = g_calDevice.GetIOB(src);
+	auto srciob = ctx.m_device.GetIOB(src);
 	srciob->SetSchmittTrigger(false);
 	if(!srciob->GetCombinatorialDelay("IO", "OUT", corner, d))
 		return false;
 	delay += d;
 
-	auto dstiob = g_calDevice.GetIOB(dst);
+	auto dstiob = ctx.m_device.GetIOB(dst);
 	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
 	dstiob->SetDriveStrength(Greenpak4IOB::DRIVE_2X);
 	if(!dstiob->GetCombinatorialDelay("IN", "IO", corner, d))
@@ -748,16 +737,16 @@ Greenpak4LUT* GetRealLUT(Greenpak4BitstreamEntity* lut)
 	return NULL;
 }
 
-bool MeasureLUTDelays(Socket& sock, hdevice hdev)
+bool MeasureLUTDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Measuring LUT delays...\n");
 	LogIndenter li;
 
 	//Characterize each LUT
 	//Don't forget to only measure pins it actually has!
-	for(unsigned int nlut = 0; nlut < g_calDevice.GetLUTCount(); nlut++)
+	for(unsigned int nlut = 0; nlut < ctx.m_device.GetLUTCount(); nlut++)
 	{
-		auto baselut = g_calDevice.GetLUT(nlut);
+		auto baselut = ctx.m_device.GetLUT(nlut);
 		auto lut = GetRealLUT(baselut);
 		for(unsigned int npin = 0; npin < lut->GetOrder(); npin ++)
 		{
@@ -765,7 +754,7 @@ bool MeasureLUTDelays(Socket& sock, hdevice hdev)
 			PTVCorner corner(PTVCorner::SPEED_TYPICAL, 25, 3300);
 
 			map<PTVCorner, CombinatorialDelay> delays;
-			if(!MeasureLUTDelay(sock, hdev, nlut, npin, corner, delays))
+			if(!MeasureLUTDelay(ctx, sock, hdev, nlut, npin, corner, delays))
 				return false;
 
 			//For now, the parent (in case of a muxed lut etc) stores all timing data
@@ -783,6 +772,7 @@ bool MeasureLUTDelays(Socket& sock, hdevice hdev)
 }
 
 bool MeasureLUTDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int nlut,
@@ -790,56 +780,13 @@ bool MeasureLUTDelay(
 	PTVCorner corner,
 	map<PTVCorner, CombinatorialDelay>& delays)
 {
-	//Create the device object
-	Greenpak4Device device(part, unused_pull, unused_drive);
-	device.SetIOPrecharge(false);
-	device.SetDisableChargePump(false);
-	device.SetLDOBypass(false);
-	device.SetNVMRetryCount(1);
-
-	//Look up the LUT
-	auto lut = GetRealLUT(device.GetLUT(nlut));
-
-	//See which half of the device it's in. Use pins 3/4 or 13/14 as appropriate
-	int src = 3;
-	int dst = 4;
-	if(lut->GetMatrix() == 1)
-	{
-		src = 13;
-		dst = 14;
-	}
-
-	//Configure the input pin
-	auto vss = device.GetGround();
-	auto srciob = device.GetIOB(src);
-	srciob->SetInput("OE", vss);
-	auto din = srciob->GetOutput("OUT");
-
-	//Configure the LUT
-	lut->MakeXOR();
-	lut->SetInput("IN0", vss);
-	lut->SetInput("IN1", vss);
-	lut->SetInput("IN2", vss);
-	lut->SetInput("IN3", vss);
-	char portname[] = "IN0";
-	portname[2] += ninput;
-	lut->SetInput(portname, din);
-
-	//Configure the output pin
-	auto vdd = device.GetPower();
-	auto dstiob = device.GetIOB(dst);
-	dstiob->SetInput("IN", lut->GetOutput("OUT"));
-	dstiob->SetInput("OE", vdd);
-	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
-	dstiob->SetDriveStrength(Greenpak4IOB::DRIVE_2X);
-
-	//Generate a bitstream
-	vector<uint8_t> bitstream;
-	device.WriteToBuffer(bitstream, 0, false);
-	//device.WriteToFile("/tmp/test.txt", 0, false);			//for debug in case of failure
+	int src;
+	int dst;
+	GetTestPins(GetRealLUT(ctx.m_device.GetLUT(nlut))->GetMatrix(), src, dst);
 
 	//Get the delays
-	if(!ProgramAndMeasureDelayAcrossVoltageCorners(sock, hdev, bitstream, src, dst, corner, true, delays))
+	TestPoint tp(TestPoint::LUT, src, dst, nlut, ninput);
+	if(!ProgramAndMeasureDelayAcrossVoltageCorners(ctx, sock, hdev, tp, corner, true, delays))
 		return false;
 
 	return true;
@@ -848,7 +795,7 @@ bool MeasureLUTDelay(
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Characterize inverters
 
-bool MeasureInverterDelays(Socket& sock, hdevice hdev)
+bool MeasureInverterDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Measuring inverter delays...\n");
 	LogIndenter li;
@@ -856,69 +803,34 @@ bool MeasureInverterDelays(Socket& sock, hdevice hdev)
 	//Test conditions (TODO: pass this in from somewhere?)
 	PTVCorner corner(PTVCorner::SPEED_TYPICAL, 25, 3300);
 
-	for(unsigned int ninv = 0; ninv < g_calDevice.GetInverterCount(); ninv++)
+	for(unsigned int ninv = 0; ninv < ctx.m_device.GetInverterCount(); ninv++)
 	{
 		map<PTVCorner, CombinatorialDelay> delays;
-		if(!MeasureInverterDelay(sock, hdev, ninv, corner, delays))
+		if(!MeasureInverterDelay(ctx, sock, hdev, ninv, corner, delays))
 			return false;
 
 		for(auto it : delays)
-			g_calDevice.GetInverter(ninv)->AddCombinatorialDelay("IN", "OUT", it.first, it.second);
+			ctx.m_device.GetInverter(ninv)->AddCombinatorialDelay("IN", "OUT", it.first, it.second);
 	}
 
 	return true;
 }
 
 bool MeasureInverterDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int ninv,
 	PTVCorner corner,
 	map<PTVCorner, CombinatorialDelay>& delays)
 {
-	//Create the device object
-	Greenpak4Device device(part, unused_pull, unused_drive);
-	device.SetIOPrecharge(false);
-	device.SetDisableChargePump(false);
-	device.SetLDOBypass(false);
-	device.SetNVMRetryCount(1);
-
-	//Look up the DUT
-	auto inv = device.GetInverter(ninv);
-
-	//See which half of the device it's in. Use pins 3/4 or 13/14 as appropriate
-	int src = 3;
-	int dst = 4;
-	if(inv->GetMatrix() == 1)
-	{
-		src = 13;
-		dst = 14;
-	}
-
-	//Configure the input pin
-	auto vss = device.GetGround();
-	auto vdd = device.GetPower();
-	auto srciob = device.GetIOB(src);
-	srciob->SetInput("OE", vss);
-	auto din = srciob->GetOutput("OUT");
-
-	//Configure the inverter
-	inv->SetInput("IN", din);
-
-	//Configure the output pin
-	auto dstiob = device.GetIOB(dst);
-	dstiob->SetInput("IN", inv->GetOutput("OUT"));
-	dstiob->SetInput("OE", vdd);
-	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
-	dstiob->SetDriveStrength(Greenpak4IOB::DRIVE_2X);
-
-	//Generate a bitstream
-	vector<uint8_t> bitstream;
-	device.WriteToBuffer(bitstream, 0, false);
-	device.WriteToFile("/tmp/test.txt", 0, false);			//for debug in case of failure
+	int src;
+	int dst;
+	GetTestPins(ctx.m_device.GetInverter(ninv)->GetMatrix(), src, dst);
 
 	//Get the delays
-	if(!ProgramAndMeasureDelayAcrossVoltageCorners(sock, hdev, bitstream, src, dst, corner, true, delays, true))
+	TestPoint tp(TestPoint::INVERTER, src, dst, ninv);
+	if(!ProgramAndMeasureDelayAcrossVoltageCorners(ctx, sock, hdev, tp, corner, true, delays, true))
 		return false;
 
 	return true;
@@ -927,7 +839,7 @@ bool MeasureInverterDelay(
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Characterize delay lines
 
-bool MeasureDelayLineDelays(Socket& sock, hdevice hdev)
+bool MeasureDelayLineDelays(CharacterizationContext& ctx, Socket& sock, hdevice hdev)
 {
 	LogNotice("Measuring delay line delays...\n");
 	LogIndenter li;
@@ -935,22 +847,22 @@ bool MeasureDelayLineDelays(Socket& sock, hdevice hdev)
 	//Test conditions (TODO: pass this in from somewhere?)
 	PTVCorner corner(PTVCorner::SPEED_TYPICAL, 25, 3300);
 
-	for(unsigned int ndel = 0; ndel < g_calDevice.GetDelayCount(); ndel++)
+	for(unsigned int ndel = 0; ndel < ctx.m_device.GetDelayCount(); ndel++)
 	{
-		auto line = g_calDevice.GetDelay(ndel);
+		auto line = ctx.m_device.GetDelay(ndel);
 
 		for(unsigned int ntap=1; ntap<=4; ntap ++)
 		{
 			//First round: no glitch filter
 			map<PTVCorner, CombinatorialDelay> delays;
-			if(!MeasureDelayLineDelay(sock, hdev, ndel, ntap, false, corner, delays))
+			if(!MeasureDelayLineDelay(ctx, sock, hdev, ndel, ntap, false, corner, delays))
 				return false;
 			for(auto it : delays)
 				line->SetUnfilteredDelay(ntap, it.first, it.second);
 
 			//Do it again with the glitch filter on
 			delays.clear();
-			if(!MeasureDelayLineDelay(sock, hdev, ndel, ntap, true, corner, delays))
+			if(!MeasureDelayLineDelay(ctx, sock, hdev, ndel, ntap, true, corner, delays))
 				return false;
 			for(auto it : delays)
 				line->SetFilteredDelay(ntap, it.first, it.second);
@@ -961,6 +873,7 @@ bool MeasureDelayLineDelays(Socket& sock, hdevice hdev)
 }
 
 bool MeasureDelayLineDelay(
+	CharacterizationContext& ctx,
 	Socket& sock,
 	hdevice hdev,
 	int ndel,
@@ -969,52 +882,215 @@ bool MeasureDelayLineDelay(
 	PTVCorner corner,
 	map<PTVCorner, CombinatorialDelay>& delays)
 {
-	//Create the device object
-	Greenpak4Device device(part, unused_pull, unused_drive);
-	device.SetIOPrecharge(false);
-	device.SetDisableChargePump(false);
-	device.SetLDOBypass(false);
-	device.SetNVMRetryCount(1);
+	int src;
+	int dst;
+	GetTestPins(ctx.m_device.GetDelay(ndel)->GetMatrix(), src, dst);
+
+	//Get the delays
+	TestPoint tp(TestPoint::DELAY_LINE, src, dst, ndel, ntap, glitchFilter);
+	if(!ProgramAndMeasureDelayAcrossVoltageCorners(ctx, sock, hdev, tp, corner, true, delays))
+		return false;
 
-	//Look up the DUT
-	auto delay = device.GetDelay(ndel);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test plan
 
-	//See which half of the device it's in. Use pins 3/4 or 13/14 as appropriate
-	int src = 3;
-	int dst = 4;
-	if(delay->GetMatrix() == 1)
+/**
+	@brief Pins used to get in and out of blocks in the given half of the device
+ */
+void GetTestPins(unsigned int matrix, int& src, int& dst)
+{
+	src = 3;
+	dst = 4;
+	if(matrix == 1)
 	{
 		src = 13;
 		dst = 14;
 	}
+}
+
+string TestPoint::GetKey() const
+{
+	char key[128];
+	switch(m_type)
+	{
+		case PIN_TO_PIN:
+			snprintf(key, sizeof(key), "pin P%d P%d drive%d%s", m_src, m_dst, m_param, m_flag ? " schmitt" : "");
+			break;
+
+		case CROSS_CONNECTION:
+			snprintf(key, sizeof(key), "xconn %d.%d P%d P%d", m_param, m_index, m_src, m_dst);
+			break;
+
+		case LUT:
+			snprintf(key, sizeof(key), "lut %d IN%d P%d P%d", m_index, m_param, m_src, m_dst);
+			break;
+
+		case INVERTER:
+			snprintf(key, sizeof(key), "inv %d P%d P%d", m_index, m_src, m_dst);
+			break;
+
+		case DELAY_LINE:
+			snprintf(key, sizeof(key), "delay %d tap%d%s P%d P%d",
+				m_index, m_param, m_flag ? " filtered" : "", m_src, m_dst);
+			break;
+
+		default:
+			snprintf(key, sizeof(key), "unknown %d", m_type);
+			break;
+	}
+	return key;
+}
+
+/**
+	@brief Every configuration the Measure*Delays() functions will ask for, in the order they ask for it
+ */
+vector<TestPoint> GetTestPlan(Greenpak4Device& device)
+{
+	vector<TestPoint> plan;
+
+	//Pin-to-pin (see MeasurePinToPinDelays)
+	int pins[] = {3, 4, 5, 13, 14, 15};
+	for(auto src : pins)
+	{
+		for(auto dst : pins)
+		{
+			if( (src == dst) || (src < 10 && dst > 10) || (src > 10 && dst < 10) )
+				continue;
+
+			plan.push_back(TestPoint(TestPoint::PIN_TO_PIN, src, dst, 0, Greenpak4IOB::DRIVE_1X, false));
+			plan.push_back(TestPoint(TestPoint::PIN_TO_PIN, src, dst, 0, Greenpak4IOB::DRIVE_2X, false));
+			plan.push_back(TestPoint(TestPoint::PIN_TO_PIN, src, dst, 0, Greenpak4IOB::DRIVE_2X, true));
+		}
+	}
+
+	//Cross connections, east then west
+	for(int i=0; i<10; i++)
+		plan.push_back(TestPoint(TestPoint::CROSS_CONNECTION, 3, 13, i, 0));
+	for(int i=0; i<10; i++)
+		plan.push_back(TestPoint(TestPoint::CROSS_CONNECTION, 13, 3, i, 1));
+
+	int src;
+	int dst;
+	for(unsigned int nlut = 0; nlut < device.GetLUTCount(); nlut++)
+	{
+		auto lut = GetRealLUT(device.GetLUT(nlut));
+		GetTestPins(lut->GetMatrix(), src, dst);
+		for(unsigned int npin = 0; npin < lut->GetOrder(); npin ++)
+			plan.push_back(TestPoint(TestPoint::LUT, src, dst, nlut, npin));
+	}
+
+	for(unsigned int ninv = 0; ninv < device.GetInverterCount(); ninv++)
+	{
+		GetTestPins(device.GetInverter(ninv)->GetMatrix(), src, dst);
+		plan.push_back(TestPoint(TestPoint::INVERTER, src, dst, ninv));
+	}
+
+	for(unsigned int ndel = 0; ndel < device.GetDelayCount(); ndel++)
+	{
+		GetTestPins(device.GetDelay(ndel)->GetMatrix(), src, dst);
+		for(unsigned int ntap=1; ntap<=4; ntap ++)
+		{
+			plan.push_back(TestPoint(TestPoint::DELAY_LINE, src, dst, ndel, ntap, false));
+			plan.push_back(TestPoint(TestPoint::DELAY_LINE, src, dst, ndel, ntap, true));
+		}
+	}
+
+	return plan;
+}
+
+/**
+	@brief Generates the bitstream for one test point
+
+	Each call works on its own Greenpak4Device, so this is safe to call from several threads at once.
+ */
+bool BuildTestBitstream(const TestPoint& tp, vector<uint8_t>& bitstream)
+{
+	//Create the device object
+	Greenpak4Device device(part, unused_pull, unused_drive);
+	device.SetIOPrecharge(false);
+	device.SetDisableChargePump(false);
+	device.SetLDOBypass(false);
+	device.SetNVMRetryCount(1);
 
 	//Configure the input pin
 	auto vss = device.GetGround();
-	auto srciob = device.GetIOB(src);
+	auto vdd = device.GetPower();
+	auto srciob = device.GetIOB(tp.m_src);
+	auto dstiob = device.GetIOB(tp.m_dst);
+	if(!srciob || !dstiob)
+	{
+		LogError("Test point %s uses a pin with no IOB\n", tp.GetKey().c_str());
+		return false;
+	}
 	srciob->SetInput("OE", vss);
 	auto din = srciob->GetOutput("OUT");
 
-	//Configure the delay line
-	delay->SetInput("IN", din);
-	delay->SetTap(ntap);
-	delay->SetGlitchFilter(glitchFilter);
+	//Configure the block under test
+	Greenpak4EntityOutput dout = din;
+	Greenpak4IOB::DriveStrength drive = Greenpak4IOB::DRIVE_2X;
+	switch(tp.m_type)
+	{
+		case TestPoint::PIN_TO_PIN:
+			srciob->SetSchmittTrigger(tp.m_flag);
+			drive = static_cast<Greenpak4IOB::DriveStrength>(tp.m_param);
+			break;
+
+		case TestPoint::CROSS_CONNECTION:
+			{
+				auto xc = device.GetCrossConnection(tp.m_param, tp.m_index);
+				xc->SetInput("I", din);
+				dout = xc->GetOutput("O");
+			}
+			break;
+
+		case TestPoint::LUT:
+			{
+				auto lut = GetRealLUT(device.GetLUT(tp.m_index));
+				lut->MakeXOR();
+				lut->SetInput("IN0", vss);
+				lut->SetInput("IN1", vss);
+				lut->SetInput("IN2", vss);
+				lut->SetInput("IN3", vss);
+				char portname[] = "IN0";
+				portname[2] += tp.m_param;
+				lut->SetInput(portname, din);
+				dout = lut->GetOutput("OUT");
+			}
+			break;
+
+		case TestPoint::INVERTER:
+			{
+				auto inv = device.GetInverter(tp.m_index);
+				inv->SetInput("IN", din);
+				dout = inv->GetOutput("OUT");
+			}
+			break;
+
+		case TestPoint::DELAY_LINE:
+			{
+				auto delay = device.GetDelay(tp.m_index);
+				delay->SetInput("IN", din);
+				delay->SetTap(tp.m_param);
+				delay->SetGlitchFilter(tp.m_flag);
+				dout = delay->GetOutput("OUT");
+			}
+			break;
+
+		default:
+			LogError("Unknown test point type %d\n", tp.m_type);
+			return false;
+	}
 
 	//Configure the output pin
-	auto vdd = device.GetPower();
-	auto dstiob = device.GetIOB(dst);
-	dstiob->SetInput("IN", delay->GetOutput("OUT"));
+	dstiob->SetInput("IN", dout);
 	dstiob->SetInput("OE", vdd);
 	dstiob->SetDriveType(Greenpak4IOB::DRIVE_PUSHPULL);
-	dstiob->SetDriveStrength(Greenpak4IOB::DRIVE_2X);
+	dstiob->SetDriveStrength(drive);
 
 	//Generate a bitstream
-	vector<uint8_t> bitstream;
-	device.WriteToBuffer(bitstream, 0, false);
 	//device.WriteToFile("/tmp/test.txt", 0, false);			//for debug in case of failure
-
-	//Get the delays
-	if(!ProgramAndMeasureDelayAcrossVoltageCorners(sock, hdev, bitstream, src, dst, corner, true, delays))
-		return false;
-
-	return true;
+	return device.WriteToBuffer(bitstream, 0, false);
 }
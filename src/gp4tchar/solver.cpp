@@ -18,20 +18,31 @@
 
 #include "gp4tchar.h"
 #include "solver.h"
+#include <unordered_map>
 
 using namespace std;
 
-void PrintMatrix(float** rows, int numVars, int numEq);
+/**
+	@brief Finds the least-squares solution of the system
 
+	The equations are kept sparse (each one touches only a handful of the variables) and folded straight into the
+	normal equations A^T A x = A^T b, which are only numVars square no matter how many measurements there are. These are
+	then solved by Cholesky factorization, in double precision throughout. With exactly as many equations as
+	variables this gives the same answer as plain elimination; extra equations are averaged in rather than ignored.
+
+	Afterwards, every equation's residual is filled in, and every variable gets a standard error estimated from the
+	residuals (sigma^2 = SSR / (numEq - numVars), scaled by the diagonal of (A^T A)^-1).
+
+	@return False if some variable can't be determined from the equations given
+ */
 bool EquationSystem::Solve()
 {
 	//Create mapping of variables to column IDs
-	map<EquationVariable*, int> colmap;
-	map<int, string> nmap;
-	int numVars = 0;
+	unordered_map<EquationVariable*, size_t> colmap;
+	vector<EquationVariable*> vars;
 	for(auto e : m_equations)
 	{
-		for(auto it : e->m_variables)
+		for(auto& it : e->m_variables)
 		{
 			auto v = it.first;
 
@@ -40,156 +51,138 @@ bool EquationSystem::Solve()
 				continue;
 
 			//nope, allocate new ID
-			nmap[numVars] = v->m_name;
-			colmap[v] = numVars;
-			numVars ++;
-
-			//LogNotice("Variable %d = %s\n", colmap[v], v->m_name.c_str());
+			colmap[v] = vars.size();
+			vars.push_back(v);
 		}
 	}
 
 	//Sanity check
-	int numEq = m_equations.size();
+	size_t numVars = vars.size();
+	size_t numEq = m_equations.size();
 	if(numEq < numVars)
 	{
 		LogError("Cannot solve knapsack problem: more variables than equations\n");
 		return false;
 	}
 
-	//Create the matrix
-	//Column numVars is the sum
-	float** rows = new float*[numEq];
-	int j = 0;
+	//Accumulate the lower triangle of A^T A, and A^T b, one (sparse) equation at a time
+	vector<double> ata(numVars * numVars, 0);
+	vector<double> atb(numVars, 0);
+	vector<size_t> cols;
 	for(auto e : m_equations)
 	{
-		//Clear coefficients to zero in case some are missing
-		float* row = new float[numVars + 1];
-		for(int i=0; i<numVars; i++)
-			row[i] = 0;
+		cols.clear();
+		for(auto& it : e->m_variables)
+			cols.push_back(colmap[it.first]);
 
-		//Add variables (coefficient of 1 to start)
-		for(auto it : e->m_variables)
-			row[colmap[it.first]] = it.second;
-
-		//Patch in the sum
-		row[numVars] = e->m_sum;
+		for(size_t i=0; i<cols.size(); i++)
+		{
+			double ci = e->m_variables[i].second;
+			atb[cols[i]] += ci * e->m_sum;
 
-		rows[j++] = row;
+			for(size_t j=0; j<cols.size(); j++)
+			{
+				if(cols[j] <= cols[i])
+					ata[cols[i]*numVars + cols[j]] += ci * e->m_variables[j].second;
+			}
+		}
 	}
 
-	//Print out the matrix
-	//LogNotice("Solving system of %d equations in %d unknowns\n", numEq, numVars);
-	//PrintMatrix(rows, numEq, numVars);
+	//In-place Cholesky factorization A^T A = L L^T (L overwrites the lower triangle).
+	//A pivot that collapses to zero means that column is a combination of the earlier ones, i.e. the measurements
+	//don't pin that variable down.
+	double maxDiag = 0;
+	for(size_t i=0; i<numVars; i++)
+		maxDiag = max(maxDiag, ata[i*numVars + i]);
+	double epsilon = 1e-12 * maxDiag;
 
-	//Do the actual Gaussian elimination to produce an upper triangle matrix
-	float epsilon = 0.000001f;
-	for(int nvar = 0; nvar < numVars; nvar ++)
+	for(size_t j=0; j<numVars; j++)
 	{
-		//If we have a 0 at our diagonal location, look down until we find a row that has a nonzero value
-		if(fabs(rows[nvar][nvar]) < epsilon)
-		{
-			bool found = false;
-			for(int row=nvar+1; row<numEq; row ++)
-			{
-				if(fabs(rows[row][nvar]) > epsilon)
-				{
-					//LogNotice("Swapping rows %d and %d\n", row, nvar);
-					float* tmp = rows[nvar];
-					rows[nvar] = rows[row];
-					rows[row] = tmp;
-					found = true;
-					break;
-				}
-			}
-
-			if(!found)
-			{
-				LogError("Cannot solve for variable %d (%s)\n", nvar, nmap[nvar].c_str());
+		double* rowj = &ata[j*numVars];
 
-				for(int i=0; i<numEq; i++)
-					delete[] rows[i];
-				delete[] rows;
-				
-				return false;
-			}
+		double d = rowj[j];
+		for(size_t k=0; k<j; k++)
+			d -= rowj[k] * rowj[k];
+		if(d <= epsilon)
+		{
+			LogError("Cannot solve for variable %zu (%s)\n", j, vars[j]->m_name.c_str());
+			return false;
 		}
+		d = sqrt(d);
+		rowj[j] = d;
 
-		//If we don't have a 1 at our corner cell, divide everything by that
-		if( fabs(rows[nvar][nvar] - 1) > epsilon )
+		for(size_t i=j+1; i<numVars; i++)
 		{
-			float scale = 1.0f / rows[nvar][nvar];
-			//LogNotice("Multiplying row %d by %.3f\n", nvar, scale);
-			for(int i=0; i<= numVars; i++)
-				rows[nvar][i] *= scale;
+			double* rowi = &ata[i*numVars];
+			double s = rowi[j];
+			for(size_t k=0; k<j; k++)
+				s -= rowi[k] * rowj[k];
+			rowi[j] = s / d;
 		}
+	}
 
-		//Subtract us (multiplied, if necessary) from any rows below us
-		//in order to produce an upper triangle matrix
-		for(int row=nvar+1; row<numEq; row++)
-		{
-			//It's already zero, skip it
-			float rowval = rows[row][nvar];
-			if(fabs(rowval) < epsilon)
-				continue;
+	//Forward substitution (L y = A^T b), then back substitution (L^T x = y)
+	vector<double> x(atb);
+	for(size_t i=0; i<numVars; i++)
+	{
+		const double* rowi = &ata[i*numVars];
+		for(size_t k=0; k<i; k++)
+			x[i] -= rowi[k] * x[k];
+		x[i] /= rowi[i];
+	}
+	for(size_t i=numVars; i-- > 0; )
+	{
+		for(size_t k=i+1; k<numVars; k++)
+			x[i] -= ata[k*numVars + i] * x[k];
+		x[i] /= ata[i*numVars + i];
+	}
 
-			//Multiply us by that value, then subtract
-			//LogNotice("Subtracting %.3f * row %d from row %d\n", rowval, nvar, row);
-			for(int i=0; i <= numVars; i++)
-				rows[row][i] -= rows[nvar][i] * rowval;
-		}
+	for(size_t i=0; i<numVars; i++)
+	{
+		vars[i]->m_value = x[i];
+		vars[i]->m_stddev = 0;
+	}
 
-		//LogNotice("Variable %d done\n", nvar);
-		//PrintMatrix(rows, numVars, numEq);
+	//Residuals
+	double ssr = 0;
+	m_maxResidual = 0;
+	for(auto e : m_equations)
+	{
+		double lhs = 0;
+		for(auto& it : e->m_variables)
+			lhs += it.second * x[colmap[it.first]];
+		e->m_residual = lhs - e->m_sum;
+
+		ssr += e->m_residual * e->m_residual;
+		m_maxResidual = max(m_maxResidual, fabs(e->m_residual));
 	}
+	m_rmsResidual = (numEq > 0) ? sqrt(ssr / numEq) : 0;
 
-	//Back-substitute to solve the remaining variables
-	//Last row should already be in (x = y) form, so start one row above that
-	//LogNotice("Back-substitution\n");
-	for(int row = numVars - 2; row >= 0; row --)
+	//Per-variable confidence: var(x_i) = sigma^2 * [(A^T A)^-1]_ii, and (A^T A)^-1 = L^-T L^-1, so diagonal entry i
+	//is the squared norm of column i of L^-1. That column is found by forward substitution against unit vector e_i.
+	if(numEq > numVars)
 	{
-		//Remove all of the variables right of the diagonal
-		for(int nvar = row + 1; nvar < numVars; nvar ++)
+		double sigma2 = ssr / (numEq - numVars);
+
+		vector<double> z(numVars);
+		for(size_t i=0; i<numVars; i++)
 		{
-			float rowval = rows[row][nvar];
-			if(fabs(rowval) > epsilon)
+			double norm2 = 0;
+			for(size_t r=i; r<numVars; r++)
 			{
-				//LogNotice("Subtracting %.3f * row %d from row %d\n", rowval, nvar, row);
-				for(int i=0; i <= numVars; i++)
-					rows[row][i] -= rows[nvar][i] * rowval;
+				const double* rowr = &ata[r*numVars];
+				double s = (r == i) ? 1 : 0;
+				for(size_t k=i; k<r; k++)
+					s -= rowr[k] * z[k];
+				z[r] = s / rowr[r];
+				norm2 += z[r] * z[r];
 			}
+			vars[i]->m_stddev = sqrt(sigma2 * norm2);
 		}
-
-		//LogNotice("Variable %d done\n", row);
-		//PrintMatrix(rows, numVars, numEq);
 	}
 
-	//Print out final state
-	//LogNotice("Final state\n");
-	//PrintMatrix(rows, numVars, numEq);
-
-	//Export matrix to the rows
-	for(auto it : colmap)
-		it.first->m_value = rows[it.second][numVars];
-
-	//clean up
-	for(int i=0; i<numEq; i++)
-		delete[] rows[i];
-	delete[] rows;
+	LogVerbose("Solved %zu equations in %zu unknowns (rms residual %.3f, max %.3f)\n",
+		numEq, numVars, m_rmsResidual, m_maxResidual);
 
 	return true;
 }
-
-void PrintMatrix(float** rows, int numVars, int numEq)
-{
-	for(int row=0; row<numEq; row++)
-	{
-		LogNotice("        ");
-		for(int col=0; col <= numVars; col++)
-		{
-			if(col == numVars)
-				LogNotice(" | ");
-			LogNotice("%6.3f ", rows[row][col]);
-		}
-		LogNotice("\n");
-	}
-}
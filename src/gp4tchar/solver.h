@@ -28,12 +28,17 @@ public:
 	EquationVariable(std::string n)
 	: m_name(n)
 	, m_value(0)
+	, m_stddev(0)
 	{ }
 
 	std::string m_name;
 
 	//Final value (only valid after solver finishes)
-	float m_value;
+	double m_value;
+
+	//Standard error of m_value, estimated from the residuals of the fit (only valid after solver finishes).
+	//Zero if the system had no redundant equations, since there is nothing to estimate the error from.
+	double m_stddev;
 };
 
 /*
@@ -42,29 +47,57 @@ public:
 class Equation
 {
 public:
-	Equation(float sum = 0)
+	Equation(double sum = 0)
 	: m_sum(sum)
+	, m_residual(0)
 	{}
 
-	void AddVariable(EquationVariable& v, float coeff = 1)
-	{ m_variables[&v] = coeff; }
+	void AddVariable(EquationVariable& v, double coeff = 1)
+	{
+		for(auto& it : m_variables)
+		{
+			if(it.first == &v)
+			{
+				it.second = coeff;
+				return;
+			}
+		}
+		m_variables.push_back(std::pair<EquationVariable*, double>(&v, coeff));
+	}
+
+	//Sparse list of (variable, coefficient) terms; any variable not listed has a coefficient of zero
+	std::vector< std::pair<EquationVariable*, double> > m_variables;
+	double m_sum;
 
-	std::map<EquationVariable*, float> m_variables;
-	float m_sum;
+	//Left-hand side minus m_sum for the solved values (only valid after solver finishes)
+	double m_residual;
 };
 
 /**
 	@brief A system of linear equations of the form a*v1 + b*v2 + c*v3 = n
+
+	There may be more equations than variables (for example, the same path measured several times, or measured
+	through several different combinations of paths). Solve() then finds the least-squares fit instead of throwing
+	the extra measurements away.
  */
 class EquationSystem
 {
 public:
+	EquationSystem()
+	: m_rmsResidual(0)
+	, m_maxResidual(0)
+	{}
+
 	void AddEquation(Equation& e)
-	{ m_equations.emplace(&e); }
+	{ m_equations.push_back(&e); }
 
 	bool Solve();
 
-	std::set<Equation*> m_equations;
+	std::vector<Equation*> m_equations;
+
+	//Fit quality (only valid after solver finishes)
+	double m_rmsResidual;
+	double m_maxResidual;
 };
 
 #endif
@@ -0,0 +1,202 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4tdb.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	Severity console_verbosity = Severity::NOTICE;
+
+	//Timing data file (JSON, from gp4tchar)
+	string fname = "";
+
+	//Output file (defaults to <part>.gp4t)
+	string ofname = "";
+
+	//Disables colored output
+	bool noColors = false;
+
+	//Print the timing data after loading it
+	bool print = false;
+
+	//Target chip
+	Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
+
+	//Parse command-line arguments
+	for(int i=1; i<argc; i++)
+	{
+		string s(argv[i]);
+
+		//Let the logger eat its args first
+		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
+			continue;
+
+		else if(s == "--help")
+		{
+			ShowUsage();
+			return 0;
+		}
+		else if(s == "--version")
+		{
+			ShowVersion();
+			return 0;
+		}
+		else if( (s == "--part") || (s == "-p") )
+		{
+			if(i+1 < argc)
+			{
+				int p;
+				sscanf(argv[++i], "SLG%d", &p);
+
+				switch(p)
+				{
+					case 46620:
+						part = Greenpak4Device::GREENPAK4_SLG46620;
+						break;
+
+					case 46621:
+						part = Greenpak4Device::GREENPAK4_SLG46621;
+						break;
+
+					case 46140:
+						part = Greenpak4Device::GREENPAK4_SLG46140;
+						break;
+
+					default:
+						printf("ERROR: Invalid part (supported: SLG46620, SLG46621, SLG46140)\n");
+						return 1;
+				}
+			}
+			else
+			{
+				printf("ERROR: --part requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--nocolors")
+			noColors = true;
+		else if(s == "--print")
+			print = true;
+		else if(s == "-o" || s == "--output")
+		{
+			if(i+1 < argc)
+				ofname = argv[++i];
+			else
+			{
+				printf("ERROR: --output requires an argument\n");
+				return 1;
+			}
+		}
+
+		//assume it's the timing data file if it's the first non-switch argument
+		else if( (s[0] != '-') && (fname == "") )
+			fname = s;
+
+		else
+		{
+			printf("ERROR: Unrecognized command-line argument \"%s\", use --help\n", s.c_str());
+			return 1;
+		}
+	}
+
+	//Input filename must be specified
+	if(fname == "")
+	{
+		ShowUsage();
+		return 1;
+	}
+
+	//Set up logging
+	if(noColors)
+		g_log_sinks.emplace(g_log_sinks.begin(), new STDLogSink(console_verbosity));
+	else
+		g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(console_verbosity));
+
+	//Print header
+	if(console_verbosity >= Severity::NOTICE)
+		ShowVersion();
+
+	//Load the JSON (or an existing database, if we're just printing or re-targeting one)
+	Greenpak4Device device(part);
+	if(ofname == "")
+		ofname = Greenpak4Device::GetPartAsString(part) + ".gp4t";
+	LogNotice("\nLoading timing data file \"%s\"\n", fname.c_str());
+	if(!device.LoadTimingData(fname))
+	{
+		LogError("Couldn't load timing data\n");
+		return 1;
+	}
+	if(print)
+		device.PrintTimingData();
+
+	//Compile it
+	LogNotice("Writing timing database \"%s\"\n", ofname.c_str());
+	if(!device.SaveTimingDatabase(ofname))
+		return 1;
+
+	//Make sure it loads back
+	Greenpak4Device check(part);
+	if(!check.LoadTimingDatabase(ofname))
+	{
+		LogError("Couldn't load the database we just wrote\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+void ShowUsage()
+{
+	printf(//                                                                               v 80th column
+		"Usage: gp4tdb [options] -p part [-o SLG46620.gp4t] timing.json\n"
+		"    --debug\n"
+		"        Prints lots of internal debugging information.\n"
+		"    -l, --logfile        <file>\n"
+		"        Causes verbose log messages to be written to <file>.\n"
+		"    -L, --logfile-lines  <file>\n"
+		"        Causes verbose log messages to be written to <file>, flushing after\n"
+		"        each line.\n"
+		"    --nocolors\n"
+		"        Disables colored console output.\n"
+		"    -o, --output         <file>\n"
+		"        Writes the compiled database to <file> (default: <part>.gp4t in the\n"
+		"        current directory). gp4par looks for <part>.gp4t in each directory of\n"
+		"        $GP4_TIMING_PATH, then in the install location.\n"
+		"    -p, --part\n"
+		"        Specifies the part (SLG46620V, SLG46621V, or SLG46140V). Must match the\n"
+		"        part the timing data was characterized on.\n"
+		"    --print\n"
+		"        Prints the timing data after loading it.\n"
+		"    -q, --quiet\n"
+		"        Causes only warnings and errors to be written to the console.\n"
+		"        Specify twice to also silence warnings.\n"
+		"    --verbose\n"
+		"        Prints additional information.\n");
+}
+
+void ShowVersion()
+{
+	printf(
+		"GreenPAK 4 timing database compiler by Andrew D. Zonenberg.\n"
+		"\n"
+		"License: LGPL v2.1+\n"
+		"This is free software: you are free to change and redistribute it.\n"
+		"There is NO WARRANTY, to the extent permitted by law.\n");
+}
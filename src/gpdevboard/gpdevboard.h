@@ -24,17 +24,85 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <chrono>
 
 #include "hidapi.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// USB command wrappers
+// Transports
 
-typedef hid_device* hdevice;
+/**
+	@brief A connection to one dev board (or something pretending to be one)
+
+	Everything above this layer speaks in whole 64-byte interrupt transfers, so swapping the transport is enough to run
+	the protocol code without hardware.
+ */
+class BoardTransport
+{
+public:
+	BoardTransport();
+	virtual ~BoardTransport();
+
+	virtual bool Send(const uint8_t* buf, size_t size) =0;
+	virtual bool Receive(uint8_t* buf, size_t size) =0;
+	virtual bool GetStringDescriptor(uint8_t index, std::string& desc) =0;
+
+	//Discard any replies the host hasn't read yet
+	virtual void Flush() =0;
+
+	/**
+		@brief Number of bitstream frames DownloadBitstream() may have in flight before waiting for an ack
+
+		1 means lock-step (send a frame, wait for its ack, repeat).
+	 */
+	unsigned int GetDownloadWindow()
+	{ return m_downloadWindow; }
+
+	void SetDownloadWindow(unsigned int window)
+	{ m_downloadWindow = (window < 1) ? 1 : window; }
+
+	/**
+		@brief The most recent error reported against this board (see LogBoardError())
+
+		Kept per handle so that boards driven from different threads can each report what went wrong.
+	 */
+	const std::string& GetLastError()
+	{ return m_lastError; }
+
+	void SetLastError(std::string err)
+	{ m_lastError = err; }
+
+protected:
+	unsigned int m_downloadWindow;
+	std::string m_lastError;
+};
+
+/**
+	@brief A real dev board, talked to over hidapi
+ */
+class HIDTransport : public BoardTransport
+{
+public:
+	HIDTransport(hid_device* hdev);
+	virtual ~HIDTransport();
+
+	virtual bool Send(const uint8_t* buf, size_t size);
+	virtual bool Receive(uint8_t* buf, size_t size);
+	virtual bool GetStringDescriptor(uint8_t index, std::string& desc);
+	virtual void Flush();
+
+protected:
+	hid_device* m_hdev;
+};
+
+typedef BoardTransport* hdevice;
 
 bool USBSetup();
 void USBCleanup(hdevice hdev);
 
+void LogBoardError(hdevice hdev, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
 bool ResetDevicesInBootloader();
 hdevice OpenDevice(uint16_t idVendor, uint16_t idProduct, int nboard);
 bool GetStringDescriptor(hdevice hdev, uint8_t index, std::string &desc);
@@ -180,15 +248,19 @@ public:
 		TRIM_OSC					= 0x49
 	};
 
-	bool Send(hdevice hdev);
+	void Pack(uint8_t* data) const;
+	void Unpack(const uint8_t* data);
+
+	bool Send(hdevice hdev) const;
 	bool Receive(hdevice hdev);
 	bool Roundtrip(hdevice hdev);
 	bool Roundtrip(hdevice hdev, uint8_t ack_type);
+	bool IsAck(const DataFrame& ack, uint8_t ack_type) const;
 
-	bool IsEmpty()
+	bool IsEmpty() const
 	{ return m_payload.size() == 0; }
 
-	bool IsFull()
+	bool IsFull() const
 	{ return m_payload.size() == 60; }
 
 	void push_back(uint8_t b)
@@ -250,6 +322,111 @@ bool MeasureOscillatorFrequency(hdevice hdev, unsigned &freq);
 
 bool GetStatus(hdevice hdev, BoardStatus &status);
 
+//Scale of signal generator settings and supply monitor readings
+static const double VOLTAGE_FACTOR = 0.001362; //mV/LSB
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Software board emulator
+
+/**
+	@brief An in-process stand-in for a dev board with a part in the socket
+
+	Speaks the DataFrame protocol with the same ack sequencing as the real board, keeps emulated SRAM and NVM
+	bitstreams, and optionally delays every reply to model USB latency. Latency is per frame rather than per read, so
+	frames sent back to back overlap their round trips like they would on the wire. The analog side is a crude model, just
+	enough for part detection, socket testing and oscillator trimming to pass:
+	  * pins with a strong driver read back the driver level;
+	  * while a bitstream is loaded, all other pins follow TP2 (like the socket test loopback design);
+	  * otherwise they read back their pullup/pulldown;
+	  * the RC oscillator frequency rises linearly with the trim word.
+ */
+class LoopbackTransport : public BoardTransport
+{
+public:
+	LoopbackTransport(SilegoPart part, unsigned int latency_us = 0);
+	virtual ~LoopbackTransport();
+
+	virtual bool Send(const uint8_t* buf, size_t size);
+	virtual bool Receive(uint8_t* buf, size_t size);
+	virtual bool GetStringDescriptor(uint8_t index, std::string& desc);
+	virtual void Flush();
+
+	void SetLatency(unsigned int latency_us)
+	{ m_latency = latency_us; }
+
+	/**
+		@brief Limits how many unread replies the board can buffer (0 = unlimited)
+
+		Frames arriving while the buffer is full are dropped, like a board whose endpoint FIFO overflowed.
+	 */
+	void SetMaxInFlight(unsigned int frames)
+	{ m_maxInFlight = frames; }
+
+	const std::vector<uint8_t>& GetSRAM() const
+	{ return m_sram; }
+
+	const std::vector<uint8_t>& GetNVM() const
+	{ return m_nvm; }
+
+	void SetNVM(const std::vector<uint8_t>& nvm)
+	{ m_nvm = nvm; }
+
+	//Number of frames sent by the host / replies sent back
+	unsigned int GetFramesIn() const
+	{ return m_framesIn; }
+	unsigned int GetFramesOut() const
+	{ return m_framesOut; }
+
+protected:
+	void Reply(const DataFrame& frame);
+	void Ack(const DataFrame& request, uint8_t type);
+
+	void OnDownload(const DataFrame& frame);
+	void OnUpload(const DataFrame& frame);
+	void OnEnableSiggen(const DataFrame& frame);
+
+	double GetRailVoltage(unsigned int pin);
+	double GetDriverVoltage(unsigned int pin);
+	double GetPinVoltage(unsigned int pin);
+
+	//The part actually in the socket, and the one the host told us to talk to
+	SilegoPart m_part;
+	SilegoPart m_selectedPart;
+
+	//Delay between a frame arriving and its reply becoming readable
+	unsigned int m_latency;
+
+	//Reply buffer size (0 = unlimited)
+	unsigned int m_maxInFlight;
+
+	//Frames waiting for the host to read them, and when each one becomes readable
+	std::deque<DataFrame> m_replies;
+	std::deque<std::chrono::steady_clock::time_point> m_replyTimes;
+
+	//Configuration memories
+	std::vector<uint8_t> m_sram;
+	std::vector<uint8_t> m_nvm;
+	bool m_sramLoaded;
+
+	//Bitstream download in progress
+	std::vector<uint8_t> m_download;
+	size_t m_downloadLength;
+	bool m_downloadToNVM;
+
+	//Bitstream upload in progress
+	size_t m_uploadOffset;
+	size_t m_uploadLength;
+
+	//Board state
+	IOConfig m_ioConfig;
+	double m_siggen[21];
+	unsigned int m_adcChannel;
+	uint8_t m_ftw;
+
+	unsigned int m_framesIn;
+	unsigned int m_framesOut;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // High-level command helpers
 
@@ -262,6 +439,8 @@ enum class BitstreamKind
 
 bool CheckStatus(hdevice hdev);
 hdevice OpenBoard(int nboard, bool test = false);
+std::vector<hdevice> OpenAllBoards();
+void UseLoopbackBoards(SilegoPart part, unsigned int latency_us = 0, unsigned int count = 1);
 bool DetectPart(
 	hdevice hdev,
 	SilegoPart& detectedPart,
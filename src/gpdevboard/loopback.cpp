@@ -0,0 +1,441 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <unistd.h>
+#include <cmath>
+
+#include <log.h>
+#include "gpdevboard.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+LoopbackTransport::LoopbackTransport(SilegoPart part, unsigned int latency_us)
+	: m_part(part)
+	, m_selectedPart(SilegoPart::UNRECOGNIZED)
+	, m_latency(latency_us)
+	, m_maxInFlight(0)
+	, m_sramLoaded(false)
+	, m_downloadLength(0)
+	, m_downloadToNVM(false)
+	, m_uploadOffset(0)
+	, m_uploadLength(0)
+	, m_adcChannel(0)
+	, m_ftw(0x40)
+	, m_framesIn(0)
+	, m_framesOut(0)
+{
+	for(int i=0; i<21; i++)
+		m_siggen[i] = 0;
+
+	//Blank part: just the start/end markers the factory writes
+	m_nvm.resize(BitstreamLength(part) / 8);
+	if(part == SLG46140V)
+	{
+		m_nvm[0x7b] = 0x5a;
+		m_nvm[0x7f] = 0xa5;
+	}
+	else
+	{
+		m_nvm[0x7f] = 0x5a;
+		m_nvm[0xff] = 0xa5;
+	}
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Transport interface
+
+bool LoopbackTransport::GetStringDescriptor(uint8_t index, string &desc)
+{
+	switch(index)
+	{
+		case 1:
+			desc = string("Loopback emulator (") + PartName(m_part) + ")";
+			return true;
+
+		case 2:
+			desc = "openfpga";
+			return true;
+
+		default:
+			LogError("Invalid index %d\n", index);
+			return false;
+	}
+}
+
+bool LoopbackTransport::Receive(uint8_t* buf, size_t size)
+{
+	if(m_replies.empty())
+	{
+		LogBoardError(this, "Loopback board has nothing to send (a real board would time out here)\n");
+		return false;
+	}
+
+	auto now = chrono::steady_clock::now();
+	if(m_replyTimes.front() > now)
+		usleep(chrono::duration_cast<chrono::microseconds>(m_replyTimes.front() - now).count());
+
+	uint8_t data[64];
+	m_replies.front().Pack(data);
+	m_replies.pop_front();
+	m_replyTimes.pop_front();
+	m_framesOut ++;
+
+	for(size_t i=0; i<size && i<sizeof(data); i++)
+		buf[i] = data[i];
+	return true;
+}
+
+/**
+	@brief Handles one frame from the host, queueing any replies
+ */
+bool LoopbackTransport::Send(const uint8_t* buf, size_t size)
+{
+	if(size != 64)
+	{
+		LogError("Loopback board got a %zu byte transfer (expected 64)\n", size);
+		return false;
+	}
+	m_framesIn ++;
+
+	if(m_maxInFlight && (m_replies.size() >= m_maxInFlight) )
+	{
+		LogDebug("Loopback board reply buffer full, dropping frame\n");
+		return true;
+	}
+
+	DataFrame frame;
+	frame.Unpack(buf);
+
+	switch(frame.m_type)
+	{
+		//SwitchMode() is only meaningful for boards in the bootloader, which we never are
+		case 0x00:
+			break;
+
+		case DataFrame::SET_PART:
+			m_selectedPart = (SilegoPart)(frame.m_payload[0] << 4);
+			Ack(frame, frame.m_type);
+			break;
+
+		case DataFrame::RESET:
+			m_sramLoaded = false;
+			m_ioConfig = IOConfig();
+			for(int i=0; i<21; i++)
+				m_siggen[i] = 0;
+			Ack(frame, frame.m_type);
+			break;
+
+		case DataFrame::SET_STATUS_LED:
+			Ack(frame, frame.m_type);
+			break;
+
+		case DataFrame::CONFIG_IO:
+			{
+				//Driver configs are big-endian 16-bit words for TP2...TP20, skipping TP11
+				size_t n = 0;
+				for(unsigned int i=2; i<=20; i++)
+				{
+					m_ioConfig.driverConfigs[i] =
+						(TPConfig)( (frame.m_payload[n] << 8) | frame.m_payload[n+1] );
+					n += 2;
+					if(i == 10)
+						i++;
+				}
+			}
+			break;
+
+		case DataFrame::CONFIG_SIGGEN:
+			{
+				unsigned int chan = frame.m_payload[1];
+				uint16_t raw = (frame.m_payload[5] << 8) | frame.m_payload[6];
+				if(chan < 21)
+					m_siggen[chan] = raw * VOLTAGE_FACTOR;
+				Ack(frame, frame.m_type);
+			}
+			break;
+
+		case DataFrame::ENABLE_SIGGEN:
+			OnEnableSiggen(frame);
+			break;
+
+		case DataFrame::WRITE_BITSTREAM_SRAM:
+		case DataFrame::WRITE_BITSTREAM_NVRAM:
+			OnDownload(frame);
+			break;
+
+		case DataFrame::READ_BITSTREAM_START:
+		case DataFrame::READ_BITSTREAM_CONT:
+			OnUpload(frame);
+			break;
+
+		case DataFrame::GET_STATUS:
+			{
+				//Never any faults. Both supply monitors read Vdd.
+				DataFrame reply(frame.m_type);
+				reply.m_sequenceA = frame.m_sequenceA;
+				reply.m_payload.resize(16);
+				uint16_t raw = m_siggen[1] * 2 / VOLTAGE_FACTOR;
+				reply.m_payload[12] = raw >> 8;
+				reply.m_payload[13] = raw & 0xff;
+				reply.m_payload[14] = raw >> 8;
+				reply.m_payload[15] = raw & 0xff;
+				Reply(reply);
+			}
+			break;
+
+		case DataFrame::CONFIG_ADC_MUX:
+			{
+				//Undo the channel numbering in SelectADCChannel()
+				unsigned int chan = frame.m_payload[1];
+				if(chan <= 9)
+					m_adcChannel = chan + 1;
+				else
+					m_adcChannel = chan + 2;
+			}
+			break;
+
+		case DataFrame::READ_ADC:
+			{
+				//Full scale is the 1.024V reference
+				double value = GetPinVoltage(m_adcChannel);
+				if(value > 1.024)
+					value = 1.024;
+				if(value < 0)
+					value = 0;
+				int32_t raw = (int32_t)(value / 1.024 * 0x90000) << 8;
+
+				DataFrame reply(frame.m_type);
+				reply.m_sequenceA = frame.m_sequenceA;
+				reply.push_back(raw >> 24);
+				reply.push_back(raw >> 16);
+				reply.push_back(raw >> 8);
+				reply.push_back(raw);
+				Reply(reply);
+			}
+			break;
+
+		case DataFrame::TRIM_OSC:
+			m_ftw = frame.m_payload[1] & 0x7f;
+			Ack(frame, frame.m_type);
+			break;
+
+		case DataFrame::GET_OSC_FREQ:
+			{
+				//Nominal frequency at mid scale, +/- 25% across the trim range
+				bool fast = (m_sram.size() > 1650/8) && (m_sram[1650/8] & (1 << (1650%8)));
+				double nominal = fast ? 2000000 : 25000;
+				uint32_t freq = nominal * (0.75 + 0.5 * m_ftw / 127);
+
+				DataFrame reply(frame.m_type);
+				reply.m_sequenceA = frame.m_sequenceA;
+				reply.push_back(freq >> 24);
+				reply.push_back(freq >> 16);
+				reply.push_back(freq >> 8);
+				reply.push_back(freq);
+				Reply(reply);
+			}
+			break;
+
+		default:
+			LogWarning("Loopback board ignoring unknown frame type %02x\n", frame.m_type);
+			break;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Protocol helpers
+
+void LoopbackTransport::Reply(const DataFrame& frame)
+{
+	m_replies.push_back(frame);
+	m_replyTimes.push_back(chrono::steady_clock::now() + chrono::microseconds(m_latency));
+}
+
+void LoopbackTransport::Flush()
+{
+	m_replies.clear();
+	m_replyTimes.clear();
+}
+
+/**
+	@brief Acknowledges a frame the way the real board does: same sequence number, payload echoed and padded to 60 bytes
+ */
+void LoopbackTransport::Ack(const DataFrame& request, uint8_t type)
+{
+	DataFrame ack(type);
+	ack.m_sequenceA = request.m_sequenceA;
+	ack.m_sequenceB = request.m_sequenceB;
+	ack.m_payload = request.m_payload;
+	ack.m_payload.resize(60);
+	Reply(ack);
+}
+
+/**
+	@brief Handles one frame of a bitstream download (see DownloadBitstream())
+
+	The first frame (sequence A = 1) carries a 5-byte header: mode, two zero bytes, and the number of clock cycles
+	needed to shift the bitstream in. Every full frame is acked with ACK1 and the final partial frame with ACK2.
+ */
+void LoopbackTransport::OnDownload(const DataFrame& frame)
+{
+	bool nvm = (frame.m_type == DataFrame::WRITE_BITSTREAM_NVRAM);
+	size_t start = 0;
+
+	if(frame.m_sequenceA == 1)
+	{
+		if(frame.m_payload.size() < 5)
+		{
+			LogError("Loopback board got a truncated download header\n");
+			return;
+		}
+		uint16_t cycles = (frame.m_payload[3] << 8) | frame.m_payload[4];
+		m_downloadLength = (cycles - 34) / 8;
+		m_downloadToNVM = nvm;
+		m_download.clear();
+		start = 5;
+	}
+	else if( (nvm != m_downloadToNVM) || (m_download.size() >= m_downloadLength) )
+	{
+		LogError("Loopback board got download data with no download in progress\n");
+		return;
+	}
+
+	m_download.insert(m_download.end(), frame.m_payload.begin() + start, frame.m_payload.end());
+
+	//Ack. Full frames get ACK1, the final partial one ACK2.
+	uint8_t ack1 = nvm ? DataFrame::WRITE_BITSTREAM_NVRAM_ACK1 : DataFrame::WRITE_BITSTREAM_SRAM_ACK1;
+	uint8_t ack2 = nvm ? DataFrame::WRITE_BITSTREAM_NVRAM_ACK2 : DataFrame::WRITE_BITSTREAM_SRAM_ACK2;
+	Ack(frame, frame.IsFull() ? ack1 : ack2);
+
+	//Commit once everything has arrived
+	if(m_download.size() >= m_downloadLength)
+	{
+		m_download.resize(m_downloadLength);
+		if(nvm)
+			m_nvm = m_download;
+		m_sram = m_download;
+		m_sramLoaded = true;
+	}
+}
+
+/**
+	@brief Handles a request for the next chunk of a bitstream upload (see UploadBitstream())
+
+	Replies carry up to 60 bytes of NVM each, with sequence B counting the chunks still to come. If the host selected
+	a different part than the one in the socket, it reads back zeros, which no part recognizes.
+ */
+void LoopbackTransport::OnUpload(const DataFrame& frame)
+{
+	if(frame.m_type == DataFrame::READ_BITSTREAM_START)
+	{
+		uint16_t cycles = (frame.m_payload[3] << 8) | frame.m_payload[4];
+		m_uploadLength = (cycles - 34) / 8;
+		m_uploadOffset = 0;
+	}
+
+	//SetPart() only sends the top 8 bits, so SLG46620V and SLG46621V look the same here
+	bool sameFamily = ( (m_selectedPart >> 4) == (m_part >> 4) );
+
+	DataFrame reply(DataFrame::READ_BITSTREAM_ACK);
+	reply.m_sequenceA = frame.m_sequenceA;
+	while( (m_uploadOffset < m_uploadLength) && !reply.IsFull() )
+	{
+		if(sameFamily && (m_uploadOffset < m_nvm.size()) )
+			reply.push_back(m_nvm[m_uploadOffset]);
+		else
+			reply.push_back(0);
+		m_uploadOffset ++;
+	}
+	reply.m_sequenceB = (m_uploadLength - m_uploadOffset + 59) / 60;
+	Reply(reply);
+}
+
+void LoopbackTransport::OnEnableSiggen(const DataFrame& frame)
+{
+	for(size_t i=0; i<frame.m_payload.size(); i++)
+	{
+		if(frame.m_payload[i] == (int)SiggenCommand::RESET)
+			m_siggen[i+1] = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Analog model
+
+/**
+	@brief Gets the supply rail for a pin (pins 12-20 of a SLG46621 are on VCCIO2, powered through TP14)
+ */
+double LoopbackTransport::GetRailVoltage(unsigned int pin)
+{
+	if( (m_part == SLG46621V) && (pin >= 12) )
+	{
+		if(m_ioConfig.driverConfigs[14] == TP_VDD)
+			return m_siggen[1];
+		return m_siggen[14];
+	}
+	return m_siggen[1];
+}
+
+/**
+	@brief Gets the level a test point's own driver is trying to produce
+ */
+double LoopbackTransport::GetDriverVoltage(unsigned int pin)
+{
+	switch(m_ioConfig.driverConfigs[pin] & 0x0003)
+	{
+		case TP_1:
+			return GetRailVoltage(pin);
+
+		case TP_SIGGEN:
+			return m_siggen[pin];
+
+		default:
+			return 0;
+	}
+}
+
+double LoopbackTransport::GetPinVoltage(unsigned int pin)
+{
+	if( (pin < 2) || (pin > 20) || (pin == 11) )
+		return 0;
+
+	unsigned int cfg = m_ioConfig.driverConfigs[pin];
+	bool floating = (cfg == TP_FLOAT);
+	bool strong = !floating && ( (cfg & 0x0e00) == TP_STRONG );
+
+	if(strong)
+		return GetDriverVoltage(pin);
+
+	//Loaded design drives weak pins from TP2
+	if(m_sramLoaded)
+		return (GetDriverVoltage(2) > 0) ? GetRailVoltage(pin) : 0;
+
+	if(floating)
+		return 0;
+	return GetDriverVoltage(pin);
+}
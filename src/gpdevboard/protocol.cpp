@@ -18,6 +18,7 @@
 
 #include <log.h>
 #include <gpdevboard.h>
+#include <chrono>
 
 using namespace std;
 
@@ -81,9 +82,13 @@ DataFrame::DataFrame(const char *ascii)
 		m_payload.resize(size - 3);
 }
 
-bool DataFrame::Send(hdevice hdev)
+/**
+	@brief Serializes the frame into a 64-byte interrupt transfer
+ */
+void DataFrame::Pack(uint8_t* data) const
 {
-	uint8_t data[64] = {};
+	for(int i=0; i<64; i++)
+		data[i] = 0;
 
 	//Packet header
 	data[0] = m_sequenceA;
@@ -97,6 +102,35 @@ bool DataFrame::Send(hdevice hdev)
 	//Packet body
 	for(size_t i=0; i<m_payload.size(); i++)
 		data[4+i] = m_payload[i];
+}
+
+/**
+	@brief Deserializes the frame from a 64-byte interrupt transfer
+ */
+void DataFrame::Unpack(const uint8_t* data)
+{
+	//Packet header
+	uint8_t size = 0;
+	m_sequenceA = data[0];
+	m_type = data[1];
+	if(data[2] == 0x00)
+		size = 0;
+	else if(data[2] > 3)
+		size = data[2] - 3;
+	else
+		LogFatal("Unexpected size %d\n", data[2]);
+	m_sequenceB = data[3];
+
+	//Packet body
+	m_payload.resize(size);
+	for(size_t i=0; i<m_payload.size(); i++)
+		m_payload[i] = data[4+i];
+}
+
+bool DataFrame::Send(hdevice hdev) const
+{
+	uint8_t data[64];
+	Pack(data);
 
 	LogDebug("H→D: ");
 	for(int i=0; i<64; i++)
@@ -124,26 +158,23 @@ bool DataFrame::Receive(hdevice hdev)
 	}
 	LogDebug("\n");
 
-	//Packet header
-	uint8_t size;
-	m_sequenceA = data[0];
-	m_type = data[1];
-	if(data[2] == 0x00)
-		size = 0;
-	else if(data[2] > 3)
-		size = data[2] - 3;
-	else
-		LogFatal("Unexpected size %d\n", data[2]);
-	m_sequenceB = data[3];
-
-	//Packet body
-	m_payload.resize(size);
-	for(size_t i=0; i<m_payload.size(); i++)
-		m_payload[i] = data[4+i];
-
+	Unpack(data);
 	return true;
 }
 
+/**
+	@brief Checks if a received frame is the acknowledgement for this one
+ */
+bool DataFrame::IsAck(const DataFrame& ack, uint8_t ack_type) const
+{
+	// Received frame will usually have length 0x3f; it is unimportant.
+	// Received frame will sometimes have the same sequence number B, sometimes not. It is unimportant.
+	return (m_sequenceA == ack.m_sequenceA &&
+	        ack_type == ack.m_type &&
+	        m_payload.size() <= ack.m_payload.size() &&
+	        std::equal(m_payload.begin(), m_payload.end(), ack.m_payload.begin()));
+}
+
 bool DataFrame::Roundtrip(hdevice hdev, uint8_t ack_type)
 {
 	if(!Send(hdev))
@@ -154,16 +185,9 @@ bool DataFrame::Roundtrip(hdevice hdev, uint8_t ack_type)
 	if(!ack_frame.Receive(hdev))
 		return false;
 
-	// Compare the two frames.
-	// Received frame will usually have length 0x3f; it is unimportant.
-	// Received frame will sometimes have the same sequence number B, sometimes not. It is unimportant.
-	if(!(m_sequenceA == ack_frame.m_sequenceA &&
-	     ack_type == ack_frame.m_type &&
-	     m_payload.size() <= ack_frame.m_payload.size() &&
-	     std::equal(m_payload.begin(), m_payload.end(),
-	                ack_frame.m_payload.begin())))
+	if(!IsAck(ack_frame, ack_type))
 	{
-		LogError("Unexpected acknowledgement frame\n");
+		LogBoardError(hdev, "Unexpected acknowledgement frame\n");
 		return false;
 	}
 
@@ -310,8 +334,6 @@ bool SetIOConfig(hdevice hdev, IOConfig& config)
 	return frame.Send(hdev);
 }
 
-static const double VOLTAGE_FACTOR = 0.001362; //mV/LSB
-
 //ch1 = Vdd, CH2...20 = TP2...20
 bool ConfigureSiggen(hdevice hdev, uint8_t channel, double voltage)
 {
@@ -364,6 +386,50 @@ bool ControlSiggen(hdevice hdev, unsigned int chan, SiggenCommand cmd)
 	return frame.Send(hdev);
 }
 
+/**
+	@brief Sends a sequence of frames, keeping up to window of them in flight, and checks each ack in order
+
+	With window = 1 this is plain lock-step Roundtrip() on each frame.
+ */
+static bool SendWindowed(
+	hdevice hdev,
+	const vector<DataFrame>& frames,
+	const vector<uint8_t>& ackTypes,
+	unsigned int window)
+{
+	size_t sent = 0;
+	size_t acked = 0;
+	while(acked < frames.size())
+	{
+		//Top up the window
+		while( (sent < frames.size()) && (sent - acked < window) )
+		{
+			if(!frames[sent].Send(hdev))
+				return false;
+			sent ++;
+		}
+
+		//Then retire the oldest frame
+		DataFrame ack_frame;
+		if(!ack_frame.Receive(hdev))
+			return false;
+		if(!frames[acked].IsAck(ack_frame, ackTypes[acked]))
+		{
+			LogBoardError(hdev, "Unexpected acknowledgement frame (frame %zu of %zu)\n", acked + 1, frames.size());
+			return false;
+		}
+		acked ++;
+	}
+
+	return true;
+}
+
+/**
+	@brief Downloads a bitstream to the part's SRAM or NVM
+
+	Frames are pipelined according to hdev->GetDownloadWindow(). If a pipelined download fails, stale acks are
+	flushed, the handle is dropped to lock-step mode for good, and the download is retried once.
+ */
 bool DownloadBitstream(hdevice hdev, std::vector<uint8_t> bitstream, DownloadMode mode)
 {
 	DataFrame::PacketType reqType, ack1Type, ack2Type;
@@ -392,25 +458,47 @@ bool DownloadBitstream(hdevice hdev, std::vector<uint8_t> bitstream, DownloadMod
 
 	frame.m_sequenceB = (bitstream.size() + 3) / 60;
 
+	//Cut the bitstream into frames up front so they can be sent back to back
+	vector<DataFrame> frames;
+	vector<uint8_t> ackTypes;
 	for(size_t i = 0; i < bitstream.size(); i++)
 	{
 		frame.push_back(bitstream[i]);
 
 		if(frame.IsFull())
 		{
-			if(!frame.Roundtrip(hdev, ack1Type))
-				return false;
+			frames.push_back(frame);
+			ackTypes.push_back(ack1Type);
 			frame = frame.Next();
 		}
 	}
 
 	if(!frame.IsEmpty())
 	{
-		if(!frame.Roundtrip(hdev, ack2Type))
-			return false;
+		frames.push_back(frame);
+		ackTypes.push_back(ack2Type);
 	}
 
-	return true;
+	auto start = chrono::steady_clock::now();
+	unsigned int window = hdev->GetDownloadWindow();
+	bool ok = SendWindowed(hdev, frames, ackTypes, window);
+	if(!ok && (window > 1) )
+	{
+		LogWarning("Pipelined bitstream download failed, retrying in lock-step mode\n");
+		hdev->Flush();
+		hdev->SetDownloadWindow(1);
+		window = 1;
+		ok = SendWindowed(hdev, frames, ackTypes, window);
+	}
+
+	if(ok)
+	{
+		double dt = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		LogDebug("Downloaded %zu bytes in %zu frames in %.2f ms (window %u)\n",
+			bitstream.size(), frames.size(), dt * 1000, window);
+	}
+
+	return ok;
 }
 
 bool UploadBitstream(hdevice hdev, size_t octets, vector<uint8_t> &bitstream)
@@ -436,7 +524,7 @@ bool UploadBitstream(hdevice hdev, size_t octets, vector<uint8_t> &bitstream)
 		if(!(repFrame.m_sequenceA == reqFrame.m_sequenceA &&
 		     repFrame.m_type == DataFrame::READ_BITSTREAM_ACK))
 		{
-			LogError("Unexpected reply\n");
+			LogBoardError(hdev, "Unexpected reply\n");
 			return false;
 		}
 
@@ -451,7 +539,7 @@ bool UploadBitstream(hdevice hdev, size_t octets, vector<uint8_t> &bitstream)
 
 	if(bitstream.size() != octets)
 	{
-		LogError("Unexpected size of uploaded bitstream\n");
+		LogBoardError(hdev, "Unexpected size of uploaded bitstream\n");
 		return false;
 	}
 
@@ -467,7 +555,10 @@ bool SelectADCChannel(hdevice hdev, unsigned int chan)
 	else if(chan >= 12 && chan <= 20)
 		frame.push_back(chan - 2);
 	else
-		LogFatal("Unexpected ADC channel (%d)\n", chan);
+	{
+		LogBoardError(hdev, "Unexpected ADC channel (%d)\n", chan);
+		return false;
+	}
 	frame.push_back(0x00);
 	return frame.Send(hdev);
 }
@@ -483,7 +574,7 @@ bool ReadADC(hdevice hdev, double &value)
 		return false;
 	if(!(frame.m_type == DataFrame::READ_ADC))
 	{
-		LogError("Unexpected reply\n");
+		LogBoardError(hdev, "Unexpected reply\n");
 		return false;
 	}
 	uint32_t intValue =
@@ -519,7 +610,7 @@ bool TrimOscillator(hdevice hdev, uint8_t ftw)
 		return false;
 	if(!(repFrame.m_type == reqFrame.m_type))
 	{
-		LogError("Unexpected reply\n");
+		LogBoardError(hdev, "Unexpected reply\n");
 		return false;
 	}
 	return true;
@@ -537,7 +628,7 @@ bool MeasureOscillatorFrequency(hdevice hdev, unsigned &freq)
 		return false;
 	if(!(repFrame.m_type == reqFrame.m_type))
 	{
-		LogError("Unexpected reply\n");
+		LogBoardError(hdev, "Unexpected reply\n");
 		return false;
 	}
 
@@ -561,7 +652,7 @@ bool GetStatus(hdevice hdev, BoardStatus &status)
 		return false;
 	if(!(frame.m_type == DataFrame::GET_STATUS))
 	{
-		LogError("Unexpected reply\n");
+		LogBoardError(hdev, "Unexpected reply\n");
 		return false;
 	}
 
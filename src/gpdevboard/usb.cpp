@@ -27,13 +27,39 @@
 #include <unistd.h>
 #include <cstdlib>
 #include <cstring>
+#include <cstdarg>
 
 using namespace std;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// USB command helpers
+// Transport base class
 
-bool SendInterruptTransfer(hdevice hdev, const uint8_t* buf, size_t size)
+BoardTransport::BoardTransport()
+	: m_downloadWindow(4)
+{
+
+}
+
+BoardTransport::~BoardTransport()
+{
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// hidapi transport
+
+HIDTransport::HIDTransport(hid_device* hdev)
+	: m_hdev(hdev)
+{
+
+}
+
+HIDTransport::~HIDTransport()
+{
+	hid_close(m_hdev);
+}
+
+bool HIDTransport::Send(const uint8_t* buf, size_t size)
 {
 	//We need to prepend a zero byte here because this is the "report ID."
 	//There aren't actually report IDs in use, but the way hidapi works
@@ -41,26 +67,113 @@ bool SendInterruptTransfer(hdevice hdev, const uint8_t* buf, size_t size)
 	uint8_t *new_buf = (uint8_t *)malloc(size + 1);
 	new_buf[0] = 0x00;
 	memcpy(&new_buf[1], buf, size);
-	if(hid_write(hdev, new_buf, size + 1) < 0)
+	if(hid_write(m_hdev, new_buf, size + 1) < 0)
 	{
 		free(new_buf);
-		LogError("hid_write failed (%ls)\n", hid_error(hdev));
+		LogBoardError(this, "hid_write failed (%ls)\n", hid_error(m_hdev));
 		return false;
 	}
 	free(new_buf);
 	return true;
 }
 
-bool ReceiveInterruptTransfer(hdevice hdev, uint8_t* buf, size_t size)
+bool HIDTransport::Receive(uint8_t* buf, size_t size)
 {
-	if(hid_read_timeout(hdev, buf, size, 250) < 0)
+	int len = hid_read_timeout(m_hdev, buf, size, 250);
+	if(len < 0)
+	{
+		LogBoardError(this, "hid_read_timeout failed (%ls)\n", hid_error(m_hdev));
+		return false;
+	}
+	else if(len == 0)
 	{
-		LogError("hid_read_timeout failed (%ls)\n", hid_error(hdev));
+		LogBoardError(this, "Timed out waiting for the board\n");
 		return false;
 	}
 	return true;
 }
 
+void HIDTransport::Flush()
+{
+	uint8_t buf[64];
+	while(hid_read_timeout(m_hdev, buf, sizeof(buf), 10) > 0)
+	{}
+}
+
+//Gets a string descriptor as a STL string
+bool HIDTransport::GetStringDescriptor(uint8_t index, string &desc)
+{
+	char strbuf[128];
+	wchar_t wstrbuf[sizeof(strbuf)];
+
+	switch (index)
+	{
+		case 1:
+			if (hid_get_product_string(m_hdev, wstrbuf, sizeof(strbuf)) < 0)
+			{
+				LogFatal("hid_get_product_string failed\n");
+				return false;
+			}
+			break;
+
+		case 2:
+			if (hid_get_manufacturer_string(m_hdev, wstrbuf, sizeof(strbuf)) < 0)
+			{
+				LogFatal("hid_get_manufacturer_string failed\n");
+				return false;
+			}
+			break;
+
+		default:
+			LogFatal("Invalid index %d\n", index);
+			return false;
+	}
+
+	wcstombs(strbuf, wstrbuf, sizeof(strbuf));
+
+	desc = strbuf;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// USB command helpers
+
+/**
+	@brief Logs an error and also records it as the board's last error
+
+	The message should end in a newline, like any other log message. It's stripped for GetLastError().
+ */
+void LogBoardError(hdevice hdev, const char* format, ...)
+{
+	char buf[512];
+	va_list va;
+	va_start(va, format);
+	vsnprintf(buf, sizeof(buf), format, va);
+	va_end(va);
+
+	LogError("%s", buf);
+
+	string err(buf);
+	while(!err.empty() && (err.back() == '\n') )
+		err.pop_back();
+	hdev->SetLastError(err);
+}
+
+bool SendInterruptTransfer(hdevice hdev, const uint8_t* buf, size_t size)
+{
+	return hdev->Send(buf, size);
+}
+
+bool ReceiveInterruptTransfer(hdevice hdev, uint8_t* buf, size_t size)
+{
+	return hdev->Receive(buf, size);
+}
+
+bool GetStringDescriptor(hdevice hdev, uint8_t index, string &desc)
+{
+	return hdev->GetStringDescriptor(index, desc);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Enumeration / setup helpers
 
@@ -77,7 +190,7 @@ bool USBSetup()
 
 void USBCleanup(hdevice hdev)
 {
-	hid_close(hdev);
+	delete hdev;
 	hid_exit();
 }
 
@@ -111,7 +224,7 @@ hdevice OpenDevice(uint16_t idVendor, uint16_t idProduct, int nboard)
 		dev_index++;
 	}
 
-	hdevice hdev;
+	hid_device* hdev;
 	if (!cur_dev)
 	{
 		hid_free_enumeration(devs);
@@ -127,40 +240,5 @@ hdevice OpenDevice(uint16_t idVendor, uint16_t idProduct, int nboard)
 		return NULL;
 	}
 
-	return hdev;
-}
-
-//Gets a string descriptor as a STL string
-bool GetStringDescriptor(hdevice hdev, uint8_t index, string &desc)
-{
-	char strbuf[128];
-	wchar_t wstrbuf[sizeof(strbuf)];
-
-	switch (index)
-	{
-		case 1:
-			if (hid_get_product_string(hdev, wstrbuf, sizeof(strbuf)) < 0)
-			{
-				LogFatal("hid_get_product_string failed\n");
-				return false;
-			}
-			break;
-
-		case 2:
-			if (hid_get_manufacturer_string(hdev, wstrbuf, sizeof(strbuf)) < 0)
-			{
-				LogFatal("hid_get_manufacturer_string failed\n");
-				return false;
-			}
-			break;
-
-		default:
-			LogFatal("Invalid index %d\n", index);
-			return false;
-	}
-
-	wcstombs(strbuf, wstrbuf, sizeof(strbuf));
-
-	desc = strbuf;
-	return true;
+	return new HIDTransport(hdev);
 }
@@ -28,6 +28,12 @@
 using namespace std;
 
 static bool g_devicesResetFromBootloader = false;
+static size_t g_devicesSwitchedFromBootloader = 0;
+
+//If set, OpenBoard() hands out emulated boards instead of touching USB
+static SilegoPart g_loopbackPart = SilegoPart::UNRECOGNIZED;
+static unsigned int g_loopbackLatency = 0;
+static unsigned int g_loopbackCount = 1;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Status check
@@ -42,11 +48,11 @@ bool CheckStatus(hdevice hdev)
 	LogDebug("Board voltages: A = %.3f V, B = %.3f V\n", status.voltageA, status.voltageB);
 
 	if(status.externalOverCurrent)
-		LogError("Overcurrent condition detected on external supply\n");
+		LogBoardError(hdev, "Overcurrent condition detected on external supply\n");
 	if(status.internalOverCurrent)
-		LogError("Overcurrent condition detected on internal supply\n");
+		LogBoardError(hdev, "Overcurrent condition detected on internal supply\n");
 	if(status.internalUnderVoltage)
-		LogError("Undervoltage condition detected on internal supply\n");
+		LogBoardError(hdev, "Undervoltage condition detected on internal supply\n");
 
 	return !(status.externalOverCurrent &&
 			 status.internalOverCurrent &&
@@ -81,10 +87,37 @@ bool ResetDevicesInBootloader()
 	for(auto h : handles)
 	{
 		SwitchMode(h);
-		hid_close(h);
+		delete h;
 	}
 
 	g_devicesResetFromBootloader = true;
+	g_devicesSwitchedFromBootloader = handles.size();
+
+	return true;
+}
+
+/**
+	@brief Reads the descriptors of a freshly opened board and checks that it's in good standing
+ */
+static bool CheckBoard(hdevice hdev)
+{
+	//Get string descriptors
+	string name, vendor;
+	if(!GetStringDescriptor(hdev, 1, name) || //board name
+	   !GetStringDescriptor(hdev, 2, vendor)) //manufacturer
+	{
+		return false;
+	}
+	LogNotice("Found: %s %s\n", vendor.c_str(), name.c_str());
+	//string 0x80 is 02 03 for this board... what does that mean? firmware rev or something?
+	//it's read by emulator during startup but no "2" and "3" are printed anywhere...
+
+	//Check that we're in good standing
+	if(!CheckStatus(hdev))
+	{
+		LogError("Fault condition detected during initial check, exiting\n");
+		return false;
+	}
 
 	return true;
 }
@@ -98,6 +131,12 @@ bool ResetDevicesInBootloader()
  */
 hdevice OpenBoard(int nboard, bool test)
 {
+	if(g_loopbackPart != SilegoPart::UNRECOGNIZED)
+	{
+		LogNotice("Using emulated developer board at index %d\n", nboard);
+		return new LoopbackTransport(g_loopbackPart, g_loopbackLatency);
+	}
+
 	if(!g_devicesResetFromBootloader)
 	{
 		if(!ResetDevicesInBootloader())
@@ -128,26 +167,84 @@ hdevice OpenBoard(int nboard, bool test)
 		return NULL;
 	}
 
-	//Get string descriptors
-	string name, vendor;
-	if(!GetStringDescriptor(hdev, 1, name) || //board name
-	   !GetStringDescriptor(hdev, 2, vendor)) //manufacturer
+	if(!CheckBoard(hdev))
 	{
+		delete hdev;
 		return NULL;
 	}
-	LogNotice("Found: %s %s\n", vendor.c_str(), name.c_str());
-	//string 0x80 is 02 03 for this board... what does that mean? firmware rev or something?
-	//it's read by emulator during startup but no "2" and "3" are printed anywhere...
 
-	//Check that we're in good standing
-	if(!CheckStatus(hdev))
+	//Done
+	return hdev;
+}
+
+/**
+	@brief Connect to every attached board, but don't change anything
+
+	Boards that fail their initial check are closed and left out of the list. The returned handles are in
+	enumeration order, so index i corresponds to OpenBoard(i) as long as every board passed.
+ */
+vector<hdevice> OpenAllBoards()
+{
+	vector<hdevice> boards;
+
+	if(g_loopbackPart != SilegoPart::UNRECOGNIZED)
 	{
-		LogError("Fault condition detected during initial check, exiting\n");
-		return NULL;
+		for(unsigned int i=0; i<g_loopbackCount; i++)
+			boards.push_back(OpenBoard(i));
+		return boards;
 	}
 
-	//Done
-	return hdev;
+	if(!g_devicesResetFromBootloader)
+	{
+		if(!ResetDevicesInBootloader())
+			return boards;
+	}
+
+	LogNotice("Searching for developer boards\n");
+	LogIndenter li;
+
+	//Boards we just kicked out of the bootloader take a moment to come back on the bus
+	if(g_devicesSwitchedFromBootloader)
+	{
+		usleep(1000 * 1000 - 1);
+		g_devicesSwitchedFromBootloader = 0;
+	}
+
+	for(int i=0; ; i++)
+	{
+		hdevice hdev = OpenDevice(0x0f0f, 0x0006, i);
+		if(!hdev)
+			break;
+
+		LogNotice("Board %d:\n", i);
+		LogIndenter li2;
+		if(!CheckBoard(hdev))
+		{
+			LogWarning("Skipping board %d\n", i);
+			delete hdev;
+			continue;
+		}
+		boards.push_back(hdev);
+	}
+
+	if(boards.empty())
+		LogError("No device found, giving up\n");
+
+	return boards;
+}
+
+/**
+	@brief Makes OpenBoard() return software emulated boards (see LoopbackTransport) instead of real ones
+
+	@param part			Part in the emulated socket, or UNRECOGNIZED to go back to real hardware
+	@param latency_us	Delay added to every reply from the board, to model USB round trip time
+	@param count		Number of boards OpenAllBoards() finds
+ */
+void UseLoopbackBoards(SilegoPart part, unsigned int latency_us, unsigned int count)
+{
+	g_loopbackPart = part;
+	g_loopbackLatency = latency_us;
+	g_loopbackCount = count;
 }
 
 bool DistinguishSLG4662X(hdevice hdev, SilegoPart& detectedPart)
@@ -197,7 +294,7 @@ bool DistinguishSLG4662X(hdevice hdev, SilegoPart& detectedPart)
 	//If pin 10 is not saturated, something is wrong
 	if(pin10_value < 0.95)
 	{
-		LogError("Device didn't pull pin 10 high during device ID test\n");
+		LogBoardError(hdev, "Device didn't pull pin 10 high during device ID test\n");
 		return false;
 	}
 
@@ -285,7 +382,7 @@ bool DetectPart(
 
 	//If wre get here, no parts matched
 	detectedPart = SilegoPart::UNRECOGNIZED;
-	LogError("Could not detect a supported part\n");
+	LogBoardError(hdev, "Could not detect a supported part\n");
 	return false;
 }
 
@@ -473,7 +570,8 @@ bool SocketTest(hdevice hdev, SilegoPart part)
 			break;
 
 		default:
-			LogFatal("Unknown part\n");
+			LogBoardError(hdev, "Socket test: unknown part\n");
+			return false;
 	}
 
 	LogVerbose("Downloading test bitstream\n");
@@ -550,8 +648,8 @@ bool SocketTest(hdevice hdev, SilegoPart part)
 
 			if(fabs(value - get<2>(config)) > 0.01)
 			{
-				LogError("Socket functional test (%s level) test failed on pin P%d\n",
-				         (get<0>(config) == TP_GND) ? "low" : "high", i);
+				LogBoardError(hdev, "Socket functional test (%s level) test failed on pin P%d\n",
+				              (get<0>(config) == TP_GND) ? "low" : "high", i);
 				ok = false;
 			}
 		}
@@ -599,7 +697,9 @@ bool TrimOscillator(hdevice hdev, SilegoPart part, double voltage, unsigned freq
 			LogWarning("FIXME: not doing anything in SocketTest\n");
 			return true;
 
-		default: LogFatal("Unknown part\n");
+		default:
+			LogBoardError(hdev, "Oscillator trimming: unknown part\n");
+			return false;
 	}
 
 	LogVerbose("Resetting board before oscillator trimming\n");
@@ -631,8 +731,8 @@ bool TrimOscillator(hdevice hdev, SilegoPart part, double voltage, unsigned freq
 		return false;
 
 	//The frequency tuning word is 7-bit
-	uint8_t low = 0, high = 0x7f, mid;
-	unsigned actualFreq;
+	uint8_t low = 0, high = 0x7f, mid = 0;
+	unsigned actualFreq = 0;
 	while(low < high)
 	{
 		mid = low + (high - low) / 2;
@@ -0,0 +1,282 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gpkjson.h"
+#include <atomic>
+#include <memory>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifndef __EMSCRIPTEN__
+#include <thread>
+#endif
+
+using namespace std;
+
+static void DecodeJob(
+	BatchJob& job,
+	map<Greenpak4Device::GREENPAK4_PART, unique_ptr<Greenpak4Device> >& devices,
+	bool pretty,
+	bool prune);
+static string JSONEscape(string s);
+static string PartName(Greenpak4Device::GREENPAK4_PART part);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Input collection
+
+/**
+	@brief Builds the list of bitstreams to decode
+
+	@param path		Either a directory (every *.txt file in it is decoded) or a text file with one bitstream path per line
+	@param files	List of bitstreams, sorted so the manifest is stable from run to run
+ */
+bool CollectBatchInputs(string path, vector<string>& files)
+{
+	struct stat st;
+	if(0 != stat(path.c_str(), &st))
+	{
+		LogError("Couldn't stat batch input %s\n", path.c_str());
+		return false;
+	}
+
+	if(S_ISDIR(st.st_mode))
+	{
+		DIR* dir = opendir(path.c_str());
+		if(!dir)
+		{
+			LogError("Couldn't open directory %s\n", path.c_str());
+			return false;
+		}
+		struct dirent* ent;
+		while( (ent = readdir(dir)) != NULL)
+		{
+			string name = ent->d_name;
+			if( (name.length() > 4) && (name.substr(name.length() - 4) == ".txt") )
+				files.push_back(path + "/" + name);
+		}
+		closedir(dir);
+	}
+
+	else
+	{
+		FILE* fp = fopen(path.c_str(), "r");
+		if(!fp)
+		{
+			LogError("Couldn't open batch list %s\n", path.c_str());
+			return false;
+		}
+		char line[1024];
+		while(fgets(line, sizeof(line), fp))
+		{
+			string s = line;
+			while(!s.empty() && isspace(s[s.length()-1]))
+				s.resize(s.length() - 1);
+			if(s.empty() || (s[0] == '#'))
+				continue;
+			files.push_back(s);
+		}
+		fclose(fp);
+	}
+
+	sort(files.begin(), files.end());
+	return true;
+}
+
+/**
+	@brief Gets the output JSON path for a bitstream: outdir/basename.json
+ */
+string GetBatchOutputName(string infile, string outdir)
+{
+	string base = infile;
+	size_t slash = base.rfind('/');
+	if(slash != string::npos)
+		base = base.substr(slash + 1);
+	size_t dot = base.rfind('.');
+	if(dot != string::npos)
+		base = base.substr(0, dot);
+	return outdir + "/" + base + ".json";
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decoding
+
+/**
+	@brief Decodes a single bitstream using (and, if needed, creating) this worker's device for the detected part
+
+	ReadFromFile() reloads every entity from a freshly cleared bit array, so a device can be reused across files
+	without an explicit reset.
+ */
+static void DecodeJob(
+	BatchJob& job,
+	map<Greenpak4Device::GREENPAK4_PART, unique_ptr<Greenpak4Device> >& devices,
+	bool pretty,
+	bool prune)
+{
+	if(!Greenpak4Device::DetectPart(job.m_infile, job.m_part))
+	{
+		job.m_error = "part detection failed";
+		return;
+	}
+
+	auto& device = devices[job.m_part];
+	if(!device)
+		device.reset(new Greenpak4Device(job.m_part));
+
+	if(!device->ReadFromFile(job.m_infile))
+	{
+		job.m_error = "decode failed";
+		return;
+	}
+	job.m_userid = device->GetUserID();
+
+	if(!device->WriteToJSON(job.m_outfile, "Bitstream", pretty, prune))
+	{
+		job.m_error = "write failed";
+		return;
+	}
+
+	job.m_ok = true;
+}
+
+/**
+	@brief Decodes every job across a pool of worker threads
+
+	Each worker owns one Greenpak4Device per part and pulls files off a shared queue, so device construction happens
+	at most once per part per thread regardless of how many files are processed.
+
+	@param jobs		Jobs to run (m_infile, m_outfile and m_part must be filled in; results are written back)
+	@param nthreads	Number of workers, or 0 to use one per hardware thread
+	@param pretty	False to write compact JSON
+	@param prune	True to drop cells which cannot influence an output
+
+	@return True if every job succeeded
+ */
+bool RunBatch(vector<BatchJob>& jobs, unsigned int nthreads, bool pretty, bool prune)
+{
+	atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		map<Greenpak4Device::GREENPAK4_PART, unique_ptr<Greenpak4Device> > devices;
+		while(true)
+		{
+			size_t i = next ++;
+			if(i >= jobs.size())
+				break;
+			DecodeJob(jobs[i], devices, pretty, prune);
+		}
+	};
+
+#ifdef __EMSCRIPTEN__
+	//No threads available, just run inline
+	nthreads = 1;
+	worker();
+#else
+	if(nthreads == 0)
+		nthreads = thread::hardware_concurrency();
+	if(nthreads == 0)
+		nthreads = 1;
+	if(nthreads > jobs.size())
+		nthreads = jobs.size();
+
+	LogNotice("Decoding %zu bitstreams with %u worker threads\n", jobs.size(), nthreads);
+
+	vector<thread> workers;
+	for(unsigned int i=0; i<nthreads; i++)
+		workers.push_back(thread(worker));
+	for(auto& t : workers)
+		t.join();
+#endif
+
+	unsigned int nfail = 0;
+	for(auto& job : jobs)
+	{
+		if(!job.m_ok)
+		{
+			LogError("%s: %s\n", job.m_infile.c_str(), job.m_error.c_str());
+			nfail ++;
+		}
+	}
+	LogNotice("Decoded %zu of %zu bitstreams\n", jobs.size() - nfail, jobs.size());
+
+	return (nfail == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Manifest
+
+static string PartName(Greenpak4Device::GREENPAK4_PART part)
+{
+	switch(part)
+	{
+		case Greenpak4Device::GREENPAK4_SLG46140:
+			return "SLG46140";
+
+		case Greenpak4Device::GREENPAK4_SLG46620:
+			return "SLG46620";
+
+		case Greenpak4Device::GREENPAK4_SLG46621:
+			return "SLG46621";
+	}
+	return "unknown";
+}
+
+static string JSONEscape(string s)
+{
+	string ret;
+	for(auto c : s)
+	{
+		if( (c == '\"') || (c == '\\') )
+			ret += '\\';
+		ret += c;
+	}
+	return ret;
+}
+
+/**
+	@brief Writes a summary of a batch run: one record per input with the part, user ID and any error
+ */
+bool WriteBatchManifest(string fname, const vector<BatchJob>& jobs)
+{
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open manifest %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"creator\": \"gpkjson\",\n");
+	fprintf(fp, "  \"files\": [\n");
+	for(size_t i=0; i<jobs.size(); i++)
+	{
+		auto& job = jobs[i];
+		fprintf(fp, "    {\n");
+		fprintf(fp, "      \"input\": \"%s\",\n", JSONEscape(job.m_infile).c_str());
+		fprintf(fp, "      \"output\": \"%s\",\n", job.m_ok ? JSONEscape(job.m_outfile).c_str() : "");
+		fprintf(fp, "      \"part\": \"%s\",\n", PartName(job.m_part).c_str());
+		fprintf(fp, "      \"userid\": %d,\n", job.m_userid);
+		fprintf(fp, "      \"ok\": %s,\n", job.m_ok ? "true" : "false");
+		fprintf(fp, "      \"error\": \"%s\"\n", JSONEscape(job.m_error).c_str());
+		fprintf(fp, "    }%s\n", (i+1 < jobs.size()) ? "," : "");
+	}
+	fprintf(fp, "  ]\n");
+	fprintf(fp, "}\n");
+
+	fclose(fp);
+	return true;
+}
@@ -22,6 +22,7 @@
 #include <cstdio>
 #include <string>
 #include <map>
+#include <vector>
 #include <log.h>
 #include <xbpar.h>
 #include <Greenpak4.h>
@@ -30,4 +31,31 @@
 void ShowUsage();
 void ShowVersion();
 
+/**
+	@brief One bitstream to decode in batch mode, and what happened to it
+ */
+struct BatchJob
+{
+	BatchJob(std::string infile, std::string outfile, Greenpak4Device::GREENPAK4_PART part)
+		: m_infile(infile)
+		, m_outfile(outfile)
+		, m_part(part)
+		, m_userid(0)
+		, m_ok(false)
+	{}
+
+	std::string m_infile;
+	std::string m_outfile;
+	Greenpak4Device::GREENPAK4_PART m_part;
+	uint8_t m_userid;
+	bool m_ok;
+	std::string m_error;
+};
+
+//Batch mode
+bool CollectBatchInputs(std::string path, std::vector<std::string>& files);
+std::string GetBatchOutputName(std::string infile, std::string outdir);
+bool RunBatch(std::vector<BatchJob>& jobs, unsigned int nthreads, bool pretty, bool prune);
+bool WriteBatchManifest(std::string fname, const std::vector<BatchJob>& jobs);
+
 #endif
@@ -49,6 +49,17 @@ int main(int argc, char* argv[])
 	//Target chip
 	Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
 
+	//Batch mode: directory or list file of bitstreams, worker count, and summary file
+	string batchpath = "";
+	unsigned int jobs = 0;
+	string manifest = "";
+
+	//Emit compact (unindented) JSON
+	bool compact = false;
+
+	//Write cells that can't influence any output (normally pruned)
+	bool keepAll = false;
+
 	//Parse command-line arguments
 	for(int i=1; i<argc; i++)
 	{
@@ -58,6 +69,10 @@ int main(int argc, char* argv[])
 		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
 			continue;
 
+		else if(s == "--compact")
+			compact = true;
+		else if(s == "--keep-all")
+			keepAll = true;
 		else if(s == "--help")
 		{
 			ShowUsage();
@@ -100,6 +115,36 @@ int main(int argc, char* argv[])
 				return 1;
 			}
 		}
+		else if(s == "--batch")
+		{
+			if(i+1 < argc)
+				batchpath = argv[++i];
+			else
+			{
+				printf("ERROR: --batch requires an argument\n");
+				return 1;
+			}
+		}
+		else if( (s == "--jobs") || (s == "-j") )
+		{
+			if(i+1 < argc)
+				jobs = atoi(argv[++i]);
+			else
+			{
+				printf("ERROR: --jobs requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--manifest")
+		{
+			if(i+1 < argc)
+				manifest = argv[++i];
+			else
+			{
+				printf("ERROR: --manifest requires an argument\n");
+				return 1;
+			}
+		}
 		else if(s == "--nocolors")
 			noColors = true;
 		else if(s == "-o" || s == "--output")
@@ -124,8 +169,8 @@ int main(int argc, char* argv[])
 		}
 	}
 
-	//Netlist filenames must be specified
-	if( (fname == "") || (ofname == "") )
+	//Netlist filenames must be specified (in batch mode, the output is a directory)
+	if( (ofname == "") || ( (fname == "") && (batchpath == "") ) )
 	{
 		ShowUsage();
 		return 1;
@@ -141,6 +186,28 @@ int main(int argc, char* argv[])
 	if(console_verbosity >= Severity::NOTICE)
 		ShowVersion();
 
+	//Batch mode: decode everything, then write the summary
+	if(batchpath != "")
+	{
+		vector<string> files;
+		if(!CollectBatchInputs(batchpath, files))
+			return 1;
+
+		vector<BatchJob> batch;
+		for(auto f : files)
+			batch.push_back(BatchJob(f, GetBatchOutputName(f, ofname), part));
+
+		bool ok = RunBatch(batch, jobs, !compact, !keepAll);
+
+		if(manifest == "")
+			manifest = ofname + "/manifest.json";
+		LogNotice("Writing manifest to \"%s\"\n", manifest.c_str());
+		if(!WriteBatchManifest(manifest, batch))
+			return 1;
+
+		return ok ? 0 : 1;
+	}
+
 	//Initialize the device
 	Greenpak4Device device(part);
 	if(!device.ReadFromFile(fname))
@@ -184,7 +251,7 @@ int main(int argc, char* argv[])
 	LogNotice("\nWriting final bitstream to output file \"%s\"\n", ofname.c_str());
 	{
 		LogIndenter li;
-		if(!device.WriteToJSON(ofname, "Bitstream"))
+		if(!device.WriteToJSON(ofname, "Bitstream", !compact, !keepAll))
 			return 1;
 	}
 	return 0;
@@ -192,42 +259,42 @@ int main(int argc, char* argv[])
 
 void ShowUsage()
 {
-	/*
 	printf(//                                                                               v 80th column
-		"Usage: gp4par [options] -p part -o bitstream.txt netlist.json\n"
-		"    -c, --constraints <file>\n"
-		"        Reads placement constraints from <file>\n"
+		"Usage: gpkjson [options] -p part -o netlist.json bitstream.txt\n"
+		"       gpkjson [options] --batch <dir|list> -o outdir\n"
+		"    --batch              <dir|list>\n"
+		"        Decodes every *.txt bitstream in a directory, or every file named (one\n"
+		"        per line) in a list file. -o names the output directory, and one JSON\n"
+		"        netlist is written per input. The part is detected from each file.\n"
+		"    --compact\n"
+		"        Writes JSON without indentation or line breaks (smaller and faster).\n"
 		"    --debug\n"
 		"        Prints lots of internal debugging information.\n"
-		"    --disable-charge-pump\n"
-		"        Disables the on-die charge pump which powers the analog hard IP when the\n"
-		"        supply voltage drops below 2.7V. Provided for completeness since the\n"
-		"        Silego GUI lets you specify it; there's no obvious reason to use it.\n"
-		"    --io-precharge\n"
-		"        Hooks a 2K resistor in parallel with pullup/down resistors during POR.\n"
-		"        This can help external capacitive loads to reach a stable voltage faster.\n"
+		"    -j, --jobs           <n>\n"
+		"        Number of worker threads in batch mode (default: one per CPU).\n"
+		"    --keep-all\n"
+		"        Writes every configured cell, including logic that cannot influence any\n"
+		"        output pin (normally pruned). Useful for debugging.\n"
 		"    -l, --logfile        <file>\n"
 		"        Causes verbose log messages to be written to <file>.\n"
 		"    -L, --logfile-lines  <file>\n"
 		"        Causes verbose log messages to be written to <file>, flushing after\n"
 		"        each line.\n"
-		"    --ldo-bypass\n"
-		"        Disable the on-die LDO and use an external 1.8V Vdd as Vcore.\n"
-		"        May cause device damage if set with higher Vdd supply.\n"
-		"    -o, --output         <bitstream>\n"
-		"        Writes bitstream into the specified file.\n"
+		"    --manifest           <file>\n"
+		"        Writes the batch summary (part, user ID and errors per input) to <file>\n"
+		"        instead of outdir/manifest.json.\n"
+		"    --nocolors\n"
+		"        Disables colored console output.\n"
+		"    -o, --output         <file|dir>\n"
+		"        Writes the JSON netlist to the specified file (directory in batch mode).\n"
 		"    -p, --part\n"
-		"        Specifies the part to target (SLG46620V, SLG46621V, or SLG46140V)\n"
+		"        Specifies the part (SLG46620V, SLG46621V, or SLG46140V). In batch mode\n"
+		"        this only chooses between SLG46620V and SLG46621V.\n"
 		"    -q, --quiet\n"
 		"        Causes only warnings and errors to be written to the console.\n"
 		"        Specify twice to also silence warnings.\n"
-		"    --unused-pull        [down|up|float]\n"
-		"        Specifies direction to pull unused pins.\n"
-		"    --unused-drive       [10k|100k|1m]\n"
-		"        Specifies strength of pullup/down resistor on unused pins.\n"
 		"    --verbose\n"
 		"        Prints additional information about the design.\n");
-	*/
 }
 
 void ShowVersion()
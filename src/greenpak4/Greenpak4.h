@@ -22,8 +22,15 @@
 /**
 	@file
 	@brief Master include file for all Greenpak4 related stuff
+
+	Thread safety: a Greenpak4Device, Greenpak4Netlist, or PAR engine built on them only ever modifies itself (names
+	for inferred cells come from per-netlist counters, and the part and primitive tables are read-only). Independent
+	instances can therefore be loaded, placed, routed and written out from different threads at the same time. Any
+	one instance, including the netlist/device pair handed to a PAR engine, belongs to one thread at a time.
  */
 
+#include "Greenpak4JSONWriter.h"
+
 #include "Greenpak4BitstreamEntity.h"
 #include "Greenpak4EntityOutput.h"
 #include "Greenpak4DualEntity.h"
@@ -64,8 +71,12 @@
 #include "Greenpak4NetlistCell.h"
 #include "Greenpak4NetlistModule.h"
 #include "Greenpak4NetlistPort.h"
+#include "Greenpak4NetlistIndex.h"
 #include "Greenpak4Netlist.h"
 
+#include "Greenpak4DeviceTables.h"
+#include "Greenpak4TimingDatabase.h"
 #include "Greenpak4Device.h"
+#include "Greenpak4BitstreamDiff.h"
 
 #endif
@@ -53,6 +53,8 @@ vector<string> Greenpak4Abuf::GetInputPorts() const
 
 void Greenpak4Abuf::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_input = src;
 
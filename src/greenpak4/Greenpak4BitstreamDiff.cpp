@@ -0,0 +1,376 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4BitstreamDiff::Greenpak4BitstreamDiff(Greenpak4Device::GREENPAK4_PART part)
+	: m_part(part)
+{
+	m_devices[0] = new Greenpak4Device(part);
+	m_devices[1] = new Greenpak4Device(part);
+
+	m_bitlen = m_devices[0]->GetBitstreamLength();
+	m_wordlen = (m_bitlen + 63) / 64;
+
+	for(unsigned int i=0; i<2; i++)
+	{
+		m_bits[i] = new bool[m_bitlen];
+		m_probe[i] = new bool[m_bitlen];
+	}
+
+	//Default configuration of every entity, plus both halves of every paired site
+	FindOwners(m_devices[0], m_owners);
+	for(unsigned int i=0; i<m_devices[0]->GetEntityCount(); i++)
+	{
+		auto entity = m_devices[0]->GetEntity(i);
+		if(dynamic_cast<Greenpak4PairedEntity*>(entity) == NULL)
+			continue;
+
+		for(unsigned int j=0; j<m_bitlen; j++)
+			m_bits[0][j] = false;
+		m_bits[0][entity->GetConfigBase()] = true;
+		entity->Load(m_bits[0]);
+	}
+	FindOwners(m_devices[0], m_owners);
+}
+
+Greenpak4BitstreamDiff::~Greenpak4BitstreamDiff()
+{
+	for(unsigned int i=0; i<2; i++)
+	{
+		delete m_devices[i];
+		delete[] m_bits[i];
+		delete[] m_probe[i];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+/**
+	@brief Figures out which entity writes each bit of the bitstream, given the current state of the device
+
+	An entity owns every bit which comes out the same when it saves over an all-zeros and an all-ones buffer.
+	Bits which already have an owner are left alone, so this can be called repeatedly to merge in bits that are only
+	written in some configurations.
+
+	@param device	The device to probe
+	@param owners	Owning entity index for each bit (resized and filled with -1 if empty)
+ */
+void Greenpak4BitstreamDiff::FindOwners(Greenpak4Device* device, vector<int>& owners)
+{
+	if(owners.empty())
+		owners.resize(m_bitlen, -1);
+
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+
+		for(unsigned int j=0; j<m_bitlen; j++)
+		{
+			m_probe[0][j] = false;
+			m_probe[1][j] = true;
+		}
+		entity->Save(m_probe[0]);
+		entity->Save(m_probe[1]);
+
+		for(unsigned int j=0; j<m_bitlen; j++)
+		{
+			if( (owners[j] < 0) && (m_probe[0][j] == m_probe[1][j]) )
+				owners[j] = i;
+		}
+	}
+}
+
+void Greenpak4BitstreamDiff::Unpack(const PackedBitstream& packed, bool* bits)
+{
+	for(unsigned int i=0; i<m_bitlen; i++)
+		bits[i] = (packed[i / 64] >> (i % 64)) & 1;
+}
+
+string Greenpak4BitstreamDiff::GetChangeTypeName(Greenpak4FieldChange::ChangeType type)
+{
+	switch(type)
+	{
+		case Greenpak4FieldChange::CHANGE_TYPE:
+			return "type";
+
+		case Greenpak4FieldChange::CHANGE_PARAMETER:
+			return "parameter";
+
+		case Greenpak4FieldChange::CHANGE_ATTRIBUTE:
+			return "attribute";
+
+		case Greenpak4FieldChange::CHANGE_INPUT:
+			return "input";
+	}
+	return "unknown";
+}
+
+/**
+	@brief Compares two decoded copies of the same entity
+ */
+void Greenpak4BitstreamDiff::DescribeChanges(
+	Greenpak4BitstreamEntity* a,
+	Greenpak4BitstreamEntity* b,
+	vector<Greenpak4FieldChange>& changes)
+{
+	//If a paired site switched primitives, nothing else is comparable
+	string pa = a->GetPrimitiveName();
+	string pb = b->GetPrimitiveName();
+	if(pa != pb)
+	{
+		changes.push_back(Greenpak4FieldChange{Greenpak4FieldChange::CHANGE_TYPE, "", pa, pb});
+		return;
+	}
+
+	//Compare a pair of name-value maps, treating missing keys as empty
+	auto compareMaps = [&](
+		Greenpak4FieldChange::ChangeType type,
+		const map<string, string>& ma,
+		const map<string, string>& mb)
+	{
+		for(auto it : ma)
+		{
+			auto jt = mb.find(it.first);
+			string vb = (jt == mb.end()) ? "" : jt->second;
+			if(it.second != vb)
+				changes.push_back(Greenpak4FieldChange{type, it.first, it.second, vb});
+		}
+		for(auto jt : mb)
+		{
+			if(ma.find(jt.first) == ma.end())
+				changes.push_back(Greenpak4FieldChange{type, jt.first, "", jt.second});
+		}
+	};
+	compareMaps(Greenpak4FieldChange::CHANGE_PARAMETER, a->GetParameters(), b->GetParameters());
+	compareMaps(Greenpak4FieldChange::CHANGE_ATTRIBUTE, a->GetAttributes(), b->GetAttributes());
+
+	//Compare routing by the name of the driving port, since the two sides are different devices
+	map<string, string> ia;
+	map<string, string> ib;
+	for(auto port : a->GetAllInputPorts())
+	{
+		auto src = a->GetInput(port);
+		ia[port] = src.IsNull() ? "(none)" : src.GetOutputName();
+	}
+	for(auto port : b->GetAllInputPorts())
+	{
+		auto src = b->GetInput(port);
+		ib[port] = src.IsNull() ? "(none)" : src.GetOutputName();
+	}
+	compareMaps(Greenpak4FieldChange::CHANGE_INPUT, ia, ib);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File I/O
+
+/**
+	@brief Reads a bitstream file straight into packed form
+
+	@param fname	Name of the file to read
+	@param bits		Packed bitstream (one bit per address, unlisted addresses are zero)
+
+	@return True on success, false if the file couldn't be read or isn't for this part
+ */
+bool Greenpak4BitstreamDiff::ReadPacked(string fname, PackedBitstream& bits)
+{
+	bits.assign(m_wordlen, 0);
+
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for reading\n", fname.c_str());
+		return false;
+	}
+
+	char unused[128];
+	fgets(unused, sizeof(unused), fp);
+	int index;
+	int value;
+	unsigned int nlines = 0;
+	while(2 == fscanf(fp, "%d %d //\n", &index, &value))
+	{
+		if( ((size_t)index >= m_bitlen) || (index < 0) )
+		{
+			LogError("%s: bit %d is out of range for %s (%u bits)\n",
+				fname.c_str(), index, m_devices[0]->GetPartAsString().c_str(), m_bitlen);
+			fclose(fp);
+			return false;
+		}
+		if(value)
+			bits[index / 64] |= (1ULL << (index % 64));
+		nlines ++;
+	}
+	fclose(fp);
+
+	if(nlines != m_bitlen)
+		LogWarning("%s may be incomplete (read %u lines, expected %u)\n", fname.c_str(), nlines, m_bitlen);
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Comparison
+
+/**
+	@brief Compares two bitstream files
+
+	@param fa		First (old) bitstream
+	@param fb		Second (new) bitstream
+	@param diffs	One entry per entity with at least one differing bit (empty if the bitstreams are identical)
+
+	@return True on success, false if either file couldn't be read
+ */
+bool Greenpak4BitstreamDiff::Compare(string fa, string fb, vector<Greenpak4EntityDiff>& diffs)
+{
+	PackedBitstream a;
+	PackedBitstream b;
+	if(!ReadPacked(fa, a) || !ReadPacked(fb, b))
+		return false;
+	return Compare(a, b, diffs);
+}
+
+/**
+	@brief Compares two packed bitstreams
+
+	@param a		First (old) bitstream
+	@param b		Second (new) bitstream
+	@param diffs	One entry per entity with at least one differing bit, in entity order, followed by any bits that
+					no entity writes. Empty if the bitstreams are identical.
+
+	@return True on success, false if the bitstreams aren't the right size for this part
+ */
+bool Greenpak4BitstreamDiff::Compare(const PackedBitstream& a, const PackedBitstream& b, vector<Greenpak4EntityDiff>& diffs)
+{
+	diffs.clear();
+	if( (a.size() != m_wordlen) || (b.size() != m_wordlen) )
+	{
+		LogError("Greenpak4BitstreamDiff::Compare: bitstream size doesn't match part\n");
+		return false;
+	}
+
+	//Find the differing bits and group them by owner
+	map<int, vector<unsigned int> > changed;
+	for(unsigned int w=0; w<m_wordlen; w++)
+	{
+		uint64_t delta = a[w] ^ b[w];
+		for(unsigned int i=0; delta; i++, delta >>= 1)
+		{
+			if(delta & 1)
+			{
+				unsigned int bit = w*64 + i;
+				changed[m_owners[bit]].push_back(bit);
+			}
+		}
+	}
+	if(changed.empty())
+		return true;
+
+	//Decode the paired sites first since they decide which ports every other entity sees
+	Unpack(a, m_bits[0]);
+	Unpack(b, m_bits[1]);
+	for(unsigned int side=0; side<2; side++)
+	{
+		auto device = m_devices[side];
+		for(unsigned int i=0; i<device->GetEntityCount(); i++)
+		{
+			auto entity = device->GetEntity(i);
+			if(dynamic_cast<Greenpak4PairedEntity*>(entity) != NULL)
+				entity->Load(m_bits[side]);
+		}
+	}
+
+	//Some blocks only write their config when enabled (e.g. DCMP), so a blank device doesn't claim those bits.
+	//If anything is unclaimed, fully decode both sides and probe ownership again in the real configurations.
+	bool fullyLoaded = false;
+	auto uit = changed.find(-1);
+	if(uit != changed.end())
+	{
+		vector<int> owners[2];
+		for(unsigned int side=0; side<2; side++)
+		{
+			auto device = m_devices[side];
+			for(unsigned int i=0; i<device->GetEntityCount(); i++)
+				device->GetEntity(i)->Load(m_bits[side]);
+			FindOwners(device, owners[side]);
+		}
+		fullyLoaded = true;
+
+		vector<unsigned int> unowned;
+		for(auto bit : uit->second)
+		{
+			int owner = owners[0][bit];
+			if(owner < 0)
+				owner = owners[1][bit];
+			if(owner < 0)
+				unowned.push_back(bit);
+			else
+			{
+				auto& bits = changed[owner];
+				bits.insert(lower_bound(bits.begin(), bits.end(), bit), bit);
+			}
+		}
+		if(unowned.empty())
+			changed.erase(-1);
+		else
+			changed[-1] = unowned;
+	}
+
+	//Decode each entity with changed bits and describe the changes
+	for(auto& it : changed)
+	{
+		if(it.first < 0)
+			continue;
+
+		Greenpak4EntityDiff diff;
+		diff.m_index = it.first;
+		diff.m_bits = it.second;
+
+		auto ea = m_devices[0]->GetEntity(it.first);
+		auto eb = m_devices[1]->GetEntity(it.first);
+		if(!fullyLoaded)
+		{
+			ea->Load(m_bits[0]);
+			eb->Load(m_bits[1]);
+		}
+		diff.m_description = ea->GetDescription();
+		DescribeChanges(ea, eb, diff.m_changes);
+
+		diffs.push_back(diff);
+	}
+
+	//Chip-wide bits go last
+	auto git = changed.find(-1);
+	if(git != changed.end())
+	{
+		Greenpak4EntityDiff diff;
+		diff.m_index = -1;
+		diff.m_description = "(global)";
+		diff.m_bits = git->second;
+		diffs.push_back(diff);
+	}
+
+	return true;
+}
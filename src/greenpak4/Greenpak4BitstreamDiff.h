@@ -0,0 +1,121 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4BitstreamDiff_h
+#define Greenpak4BitstreamDiff_h
+
+#include <stdint.h>
+
+/**
+	@brief A single semantic difference within one entity
+ */
+struct Greenpak4FieldChange
+{
+	enum ChangeType
+	{
+		CHANGE_TYPE,		//Paired site switched primitives (e.g. counter vs pattern generator)
+		CHANGE_PARAMETER,	//HDL parameter (LUT INIT, counter COUNT_TO, etc) differs
+		CHANGE_ATTRIBUTE,	//HDL attribute (pin drive, pullup, etc) differs
+		CHANGE_INPUT		//Input is routed from a different source
+	};
+
+	ChangeType m_type;
+	std::string m_name;
+	std::string m_old;
+	std::string m_new;
+};
+
+/**
+	@brief All differences owned by one bitstream entity
+ */
+struct Greenpak4EntityDiff
+{
+	//Index of the entity in Greenpak4Device::GetEntity(), or -1 for bits no entity writes (user ID, trim etc)
+	int m_index;
+
+	//Description of the entity (as loaded from the first bitstream)
+	std::string m_description;
+
+	//Addresses of every differing bit, in ascending order
+	std::vector<unsigned int> m_bits;
+
+	//Decoded differences. May be empty if the bits don't map to anything in our data model.
+	std::vector<Greenpak4FieldChange> m_changes;
+};
+
+/**
+	@brief Compares two bitstreams for the same part and reports the differences per entity
+
+	Bitstreams are compared as packed 64-bit words, so identical files cost a few dozen XORs. Each differing bit is
+	mapped back to the entity whose Save() writes it, and only those entities are decoded to describe the change.
+
+	Bit ownership is found by saving every entity of a blank device twice (over all-zeros and all-ones buffers): bits
+	which come out the same both times were written by that entity. This is done once in the constructor, so create
+	one Greenpak4BitstreamDiff per part and reuse it for every pair.
+ */
+class Greenpak4BitstreamDiff
+{
+public:
+	Greenpak4BitstreamDiff(Greenpak4Device::GREENPAK4_PART part);
+	virtual ~Greenpak4BitstreamDiff();
+
+	//Bit i lives in word i/64, at position i%64
+	typedef std::vector<uint64_t> PackedBitstream;
+
+	bool ReadPacked(std::string fname, PackedBitstream& bits);
+
+	bool Compare(std::string fa, std::string fb, std::vector<Greenpak4EntityDiff>& diffs);
+	bool Compare(const PackedBitstream& a, const PackedBitstream& b, std::vector<Greenpak4EntityDiff>& diffs);
+
+	Greenpak4Device::GREENPAK4_PART GetPart()
+	{ return m_part; }
+
+	/**
+		@brief Returns the device holding the decoded entities of the first (0) or second (1) bitstream
+	 */
+	Greenpak4Device* GetDevice(unsigned int i)
+	{ return m_devices[i]; }
+
+	static std::string GetChangeTypeName(Greenpak4FieldChange::ChangeType type);
+
+protected:
+	void FindOwners(Greenpak4Device* device, std::vector<int>& owners);
+	void Unpack(const PackedBitstream& packed, bool* bits);
+	void DescribeChanges(
+		Greenpak4BitstreamEntity* a,
+		Greenpak4BitstreamEntity* b,
+		std::vector<Greenpak4FieldChange>& changes);
+
+	Greenpak4Device::GREENPAK4_PART m_part;
+
+	//Bitstream length, in bits and in packed words
+	unsigned int m_bitlen;
+	unsigned int m_wordlen;
+
+	//Scratch devices for decoding the entities of each side
+	Greenpak4Device* m_devices[2];
+
+	//Unpacked scratch bitstreams for each side (plus two more for ownership probing)
+	bool* m_bits[2];
+	bool* m_probe[2];
+
+	//Index of the entity writing each bit of a blank device, or -1 if none does
+	std::vector<int> m_owners;
+};
+
+#endif
@@ -40,6 +40,7 @@ Greenpak4BitstreamEntity::Greenpak4BitstreamEntity(
 	, m_parnode(NULL)
 	, m_dual(NULL)
 	, m_dualMaster(true)
+	, m_dirty(true)
 {
 
 }
@@ -292,29 +293,7 @@ bool Greenpak4BitstreamEntity::GetCombinatorialDelay(
 	PTVCorner corner,
 	CombinatorialDelay& delay) const
 {
-	//If this isn't a corner we know about, give up
-	auto pit = m_pinToPinDelays.find(corner);
-	if(pit == m_pinToPinDelays.end())
-	{
-		//LogWarning("Greenpak4BitstreamEntity::GetCombinatorialDelay: no delay for process corner %s\n",
-		//	corner.toString().c_str());
-		return false;
-	}
-
-	//If we don't have data for this pin pair, give up
-	PinPair pair(srcport, dstport);
-	auto& dmap = pit->second;
-	auto dit = dmap.find(pair);
-	if(dit == dmap.end())
-	{
-		//LogWarning("Greenpak4BitstreamEntity::GetCombinatorialDelay: no delay for path %s to %s\n",
-		//	srcport.c_str(), dstport.c_str());
-		return false;
-	}
-
-	//Got it
-	delay = dit->second;
-	return true;
+	return m_pinToPinDelays.GetDelay(srcport, dstport, corner, delay);
 }
 
 void Greenpak4BitstreamEntity::AddCombinatorialDelay(
@@ -323,7 +302,27 @@ void Greenpak4BitstreamEntity::AddCombinatorialDelay(
 	PTVCorner corner,
 	CombinatorialDelay delay)
 {
-	m_pinToPinDelays[corner][PinPair(srcport, dstport)] = delay;
+	m_pinToPinDelays.SetDelay(srcport, dstport, corner, delay);
+}
+
+/**
+	@brief Gets the port IDs of every arc in a delay table, sorted by (source, destination) name
+ */
+void Greenpak4BitstreamEntity::GetSortedArcs(
+	const PTVDelayTable& table,
+	vector< pair<unsigned int, unsigned int> >& arcs)
+{
+	map<pair<string, string>, pair<unsigned int, unsigned int> > sorted;
+	for(unsigned int src=0; src<table.GetPortCount(); src++)
+	{
+		for(unsigned int dst=0; dst<table.GetPortCount(); dst++)
+		{
+			sorted[pair<string, string>(table.GetPortName(src), table.GetPortName(dst))] =
+				pair<unsigned int, unsigned int>(src, dst);
+		}
+	}
+	for(auto it : sorted)
+		arcs.push_back(it.second);
 }
 
 void Greenpak4BitstreamEntity::PrintTimingData() const
@@ -334,24 +333,30 @@ void Greenpak4BitstreamEntity::PrintTimingData() const
 
 	LogNotice("%s\n", GetDescription().c_str());
 
+	vector<PTVCorner> corners;
+	m_pinToPinDelays.GetCorners(corners);
+	vector< pair<unsigned int, unsigned int> > arcs;
+	GetSortedArcs(m_pinToPinDelays, arcs);
+
 	//Combinatorial delays
 	LogIndenter li;
-	for(auto& it : m_pinToPinDelays)
+	for(auto& corner : corners)
 	{
-		LogNotice("%s\n", it.first.toString().c_str());
+		LogNotice("%s\n", corner.toString().c_str());
 		LogIndenter li2;
-		for(auto& jt : it.second)
+		for(auto& arc : arcs)
 		{
-			auto& pair = jt.first;
-			auto& time = jt.second;
+			CombinatorialDelay time;
+			if(!m_pinToPinDelays.GetExactDelay(arc.first, arc.second, corner, time))
+				continue;
 			LogNotice("%10s to %10s: %6.3f ns rising, %6.3f ns falling\n",
-				pair.first.c_str(),
-				pair.second.c_str(),
+				m_pinToPinDelays.GetPortName(arc.first).c_str(),
+				m_pinToPinDelays.GetPortName(arc.second).c_str(),
 				time.m_rising,
 				time.m_falling);
 		}
 
-		PrintExtraTimingData(it.first);
+		PrintExtraTimingData(corner);
 	}
 
 	//TODO: Setup/hold margins
@@ -366,70 +371,67 @@ void Greenpak4BitstreamEntity::PrintExtraTimingData(PTVCorner /*corner*/) const
 /**
 	@brief Writes the metadata around our actual timing numbers
  */
-void Greenpak4BitstreamEntity::SaveTimingData(FILE* fp, bool last)
+void Greenpak4BitstreamEntity::SaveTimingData(Greenpak4JSONWriter& json)
 {
-	fprintf(fp, "    \"%s\":\n    [\n", GetDescription().c_str());
+	json.Key(GetDescription());
+	json.BeginArray();
 
-	if(!m_pinToPinDelays.empty())
+	//Loop over each process corner and export the data
+	vector<PTVCorner> corners;
+	m_pinToPinDelays.GetCorners(corners);
+	for(auto& corner : corners)
 	{
-		//Loop over each process corner and export the data
-		auto end = m_pinToPinDelays.end();
-		end--;
-		for(auto it : m_pinToPinDelays)
-		{
-			fprintf(fp, "        {\n");
-			auto corner = it.first;
-			fprintf(fp, "            \"process\" : \"%s\",\n", corner.GetSpeedAsString().c_str());
-			fprintf(fp, "            \"temp\" : \"%d\",\n", corner.GetTemp());
-			fprintf(fp, "            \"voltage_mv\" : \"%d\",\n", corner.GetVoltage());
-
-			fprintf(fp, "            \"delays\" :\n            [\n");
-			SaveTimingData(fp, corner);
-			fprintf(fp, "            ]\n");
-
-			//key is last element, we're done
-			if(it.first == end->first)
-				fprintf(fp, "        }\n");
-			else
-				fprintf(fp, "        },\n");
-		}
+		json.BeginObject();
+		json.Key("process");
+		json.String(corner.GetSpeedAsString());
+		json.Key("temp");
+		json.FormattedString("%d", corner.GetTemp());
+		json.Key("voltage_mv");
+		json.FormattedString("%d", corner.GetVoltage());
+
+		json.Key("delays");
+		json.BeginArray();
+		SaveTimingData(json, corner);
+		json.EndArray();
+
+		json.EndObject();
 	}
 
-	if(last)
-		fprintf(fp, "    ]\n");
-	else
-		fprintf(fp, "    ],\n");
+	json.EndArray();
 }
 
 /**
 	@brief Write the timing numbers
  */
-void Greenpak4BitstreamEntity::SaveTimingData(FILE* fp, PTVCorner corner)
+void Greenpak4BitstreamEntity::SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner)
 {
-	auto& map = m_pinToPinDelays[corner];
-	if(map.empty())
-		return;
-
-	auto end = map.end();
-	end--;
-	for(auto it : map)
+	vector< pair<unsigned int, unsigned int> > arcs;
+	GetSortedArcs(m_pinToPinDelays, arcs);
+	for(auto& arc : arcs)
 	{
-		auto pins = it.first;
-		auto delay = it.second;
-		fprintf(fp, "                {\n");
-		fprintf(fp, "                    \"type\" : \"propagation\",\n");
-		fprintf(fp, "                    \"from\" : \"%s\",\n", pins.first.c_str());
-		fprintf(fp, "                    \"to\" : \"%s\",\n", pins.second.c_str());
-		fprintf(fp, "                    \"rising\" : \"%f\",\n", delay.m_rising);
-		fprintf(fp, "                    \"falling\" : \"%f\"\n", delay.m_falling);
-
-		if(it.first == end->first)
-			fprintf(fp, "                }\n");
-		else
-			fprintf(fp, "                },\n");
+		CombinatorialDelay delay;
+		if(!m_pinToPinDelays.GetExactDelay(arc.first, arc.second, corner, delay))
+			continue;
+		json.BeginObject();
+		json.Key("type");
+		json.String("propagation");
+		json.Key("from");
+		json.String(m_pinToPinDelays.GetPortName(arc.first));
+		json.Key("to");
+		json.String(m_pinToPinDelays.GetPortName(arc.second));
+		json.Key("rising");
+		json.FormattedString("%f", delay.m_rising);
+		json.Key("falling");
+		json.FormattedString("%f", delay.m_falling);
+		json.EndObject();
 	}
 }
 
+void Greenpak4BitstreamEntity::GetTimingTables(vector<PTVDelayTable*>& tables)
+{
+	tables.push_back(&m_pinToPinDelays);
+}
+
 /**
 	@brief Load our delay info
  */
@@ -565,7 +567,7 @@ bool Greenpak4BitstreamEntity::LoadPropagationDelay(PTVCorner corner, json_objec
 	float nfalling = json_object_get_double(falling);
 
 	//Finally, we can actually save the delay!
-	m_pinToPinDelays[corner][PinPair(sfrom, sto)] = CombinatorialDelay(nrising, nfalling);
+	m_pinToPinDelays.SetDelay(sfrom, sto, corner, CombinatorialDelay(nrising, nfalling));
 
 	return true;
 }
@@ -108,6 +108,21 @@ public:
 	Greenpak4Device* GetDevice()
 	{ return m_device; }
 
+	/**
+		@brief Flags this entity as needing to be re-serialized by the next Greenpak4Device::UpdateBitstream() call.
+
+		Called by SetInput() and the configuration setters of derived classes. Code which changes our configuration
+		some other way (CommitChanges(), Load()) must call it too, or the cached bitstream image will go stale.
+	 */
+	void MarkDirty()
+	{ m_dirty = true; }
+
+	virtual bool IsDirty() const
+	{ return m_dirty; }
+
+	virtual void ClearDirty()
+	{ m_dirty = false; }
+
 	/**
 		@brief Returns a human-readable description of this node (like LUT3_1)
 	 */
@@ -156,6 +171,8 @@ public:
 	/**
 		@brief Gets the combinatorial delay through the cell between a given set of ports
 
+		The corner need not have been characterized; delays are interpolated across temperature and voltage.
+
 		@return false if no timing data available, true if data was recovered
 	 */
 	virtual bool GetCombinatorialDelay(
@@ -173,14 +190,23 @@ public:
 		PTVCorner corner,
 		CombinatorialDelay delay);
 
+	///Pin-to-pin delay table, for repeated queries by port ID
+	const PTVDelayTable& GetDelayTable() const
+	{ return m_pinToPinDelays; }
+
 	//TODO: interface for serializing/deserializing combinatorial delays
 
 	virtual void PrintTimingData() const;
 	virtual void PrintExtraTimingData(PTVCorner corner) const;
 
-	virtual void SaveTimingData(FILE* fp, bool last);
+	virtual void SaveTimingData(Greenpak4JSONWriter& json);
 	virtual bool LoadTimingData(json_object* object);
 
+	/**
+		@brief Gets every delay table this cell has, always in the same order (used by the binary timing database)
+	 */
+	virtual void GetTimingTables(std::vector<PTVDelayTable*>& tables);
+
 protected:
 
 	///Return our assigned netlist entity, if we have one (or NULL if not)
@@ -234,18 +260,19 @@ protected:
 	///True if we're the master of a dual pair, or not a dual
 	bool m_dualMaster;
 
-	//A (srcport, dstport) tuple
-	typedef std::pair<std::string, std::string> PinPair;
-
-	//Delays at a specific process corner
-	typedef std::map<PinPair, CombinatorialDelay> DelayMap;
+	///True if our configuration changed since we were last serialized into the device's cached image
+	bool m_dirty;
 
 	//Combinatorial delays (only valid in the master of a dual)
 	//Derived classes are free to extend this to add support for more complex features
 	//(for example, Schmitt trigger or output drive strength in an IOB)
-	std::map<PTVCorner, DelayMap> m_pinToPinDelays;
+	PTVDelayTable m_pinToPinDelays;
+
+	static void GetSortedArcs(
+		const PTVDelayTable& table,
+		std::vector< std::pair<unsigned int, unsigned int> >& arcs);
 
-	virtual void SaveTimingData(FILE* fp, PTVCorner corner);
+	virtual void SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner);
 	virtual bool LoadTimingDataForCorner(json_object* object);
 	virtual bool LoadExtraTimingData(PTVCorner corner, std::string delaytype, json_object* object);
 	bool LoadPropagationDelay(PTVCorner corner, json_object* object);
@@ -60,6 +60,8 @@ vector<string> Greenpak4ClockBuffer::GetInputPorts() const
 
 void Greenpak4ClockBuffer::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_input = src;
 
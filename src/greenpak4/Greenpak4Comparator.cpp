@@ -79,6 +79,8 @@ vector<string> Greenpak4Comparator::GetInputPorts() const
 
 void Greenpak4Comparator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "PWREN")
 		m_pwren = src;
 	if(port == "VIN")
@@ -67,10 +67,16 @@ public:
 
 	//Helper used by DRC to poke ACMP0's config if necessary
 	void SetInput(Greenpak4EntityOutput input)
-	{ m_vin = input; }
+	{
+		m_vin = input;
+		MarkDirty();
+	}
 
 	void SetPowerEn(Greenpak4EntityOutput pwren)
-	{ m_pwren = pwren; }
+	{
+		m_pwren = pwren;
+		MarkDirty();
+	}
 
 	virtual std::string GetPrimitiveName() const;
 
@@ -216,6 +216,8 @@ vector<string> Greenpak4Counter::GetInputPorts() const
 
 void Greenpak4Counter::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "RST")
 		m_reset = src;
 	else if(port == "CLK")
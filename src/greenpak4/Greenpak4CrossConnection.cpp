@@ -52,6 +52,8 @@ string Greenpak4CrossConnection::GetDescription() const
 
 void Greenpak4CrossConnection::SetInput(std::string /*port*/, Greenpak4EntityOutput input)
 {
+	MarkDirty();
+
 	//Don't complain if input is a power rail, those are the sole exception
 	if(input.IsPowerRail())
 	{}
@@ -76,6 +76,8 @@ vector<string> Greenpak4DAC::GetInputPorts() const
 
 void Greenpak4DAC::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "VREF")
 		m_vref = src;
 
@@ -57,6 +57,8 @@ vector<string> Greenpak4DCMPMux::GetInputPorts() const
 
 void Greenpak4DCMPMux::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "SEL[0]")
 		m_sel0 = src;
 	else if(port == "SEL[1]")
@@ -62,6 +62,8 @@ vector<string> Greenpak4Delay::GetInputPorts() const
 
 void Greenpak4Delay::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_input = src;
 
@@ -150,7 +152,7 @@ bool Greenpak4Delay::CommitChanges()
 		return true;
 
 	//Delay line
-	if(ncell->m_type == "GP_DELAY")
+	if(ncell->m_typeId == GP_CELL_DELAY)
 		m_mode = DELAY;
 
 	//Edge detector
@@ -255,15 +257,34 @@ bool Greenpak4Delay::Save(bool* bitstream)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Timing analysis
 
+/**
+	@brief Gets every corner we have unfiltered delays for, at any tap
+ */
+void Greenpak4Delay::GetTimingCorners(vector<PTVCorner>& corners) const
+{
+	set<PTVCorner> found;
+	for(auto& it : m_unfilteredDelays)
+	{
+		vector<PTVCorner> tapcorners;
+		it.second.GetCorners(tapcorners);
+		for(auto& c : tapcorners)
+			found.insert(c);
+	}
+	for(auto& c : found)
+		corners.push_back(c);
+}
+
 void Greenpak4Delay::PrintTimingData() const
 {
 	LogNotice("%s\n", GetDescription().c_str());
 
+	vector<PTVCorner> corners;
+	GetTimingCorners(corners);
+
 	//Combinatorial delays
 	LogIndenter li;
-	for(auto& it : m_unfilteredDelays)
+	for(auto& corner : corners)
 	{
-		auto corner = it.first.second;
 		LogNotice("%s\n", corner.toString().c_str());
 
 		LogIndenter li2;
@@ -275,38 +296,36 @@ void Greenpak4Delay::PrintTimingData() const
 
 void Greenpak4Delay::PrintExtraTimingData(PTVCorner corner) const
 {
-	for(auto it : m_unfilteredDelays)
+	for(auto& it : m_unfilteredDelays)
 	{
-		//Skip results for other process corners
-		if(it.first.second != corner)
+		CombinatorialDelay time;
+		if(!it.second.GetExactDelay("IN", "OUT", corner, time))
 			continue;
 
-		char ntap[] = "0";
-		ntap[0] += it.first.first;
-		string ioname = string("OUT (T") + ntap + "/n)";
+		char ioname[16];
+		snprintf(ioname, sizeof(ioname), "OUT (T%d/n)", it.first);
 
 		LogNotice("%10s to %10s: %6.3f ns rising, %6.3f ns falling\n",
 			"IN",
-			ioname.c_str(),
-			it.second.m_rising,
-			it.second.m_falling);
+			ioname,
+			time.m_rising,
+			time.m_falling);
 	}
 
-	for(auto it : m_filteredDelays)
+	for(auto& it : m_filteredDelays)
 	{
-		//Skip results for other process corners
-		if(it.first.second != corner)
+		CombinatorialDelay time;
+		if(!it.second.GetExactDelay("IN", "OUT", corner, time))
 			continue;
 
-		char ntap[] = "0";
-		ntap[0] += it.first.first;
-		string ioname = string("OUT (T") + ntap + "/f)";
+		char ioname[16];
+		snprintf(ioname, sizeof(ioname), "OUT (T%d/f)", it.first);
 
 		LogNotice("%10s to %10s: %6.3f ns rising, %6.3f ns falling\n",
 			"IN",
-			ioname.c_str(),
-			it.second.m_rising,
-			it.second.m_falling);
+			ioname,
+			time.m_rising,
+			time.m_falling);
 	}
 }
 
@@ -319,94 +338,96 @@ bool Greenpak4Delay::GetCombinatorialDelay(
 	if( (srcport != "IN") || (dstport != "OUT") )
 		return false;
 
-	if(m_glitchFilter)
-	{
-		auto it = m_filteredDelays.find(TimingCondition(m_delayTap, corner));
-		if(it == m_filteredDelays.end())
-			return false;
-		delay = it->second;
-		return true;
-	}
-
-	else
-	{
-		auto it = m_unfilteredDelays.find(TimingCondition(m_delayTap, corner));
-		if(it == m_unfilteredDelays.end())
-			return false;
-		delay = it->second;
-		return true;
-	}
+	auto& delays = m_glitchFilter ? m_filteredDelays : m_unfilteredDelays;
+	auto it = delays.find(m_delayTap);
+	if(it == delays.end())
+		return false;
+	return it->second.GetDelay(srcport, dstport, corner, delay);
 
 	//Don't call base class, we handle everything here
 }
 
-void Greenpak4Delay::SaveTimingData(FILE* fp, bool last)
+void Greenpak4Delay::SaveTimingData(Greenpak4JSONWriter& json)
 {
-	if(m_unfilteredDelays.empty())
+	vector<PTVCorner> corners;
+	GetTimingCorners(corners);
+	if(corners.empty())
 		return;
 
-	fprintf(fp, "    \"%s\":\n    [\n", GetDescription().c_str());
+	json.Key(GetDescription());
+	json.BeginArray();
 
-	auto end = m_unfilteredDelays.end();
-	end--;
-	for(auto& it : m_unfilteredDelays)
+	for(auto& corner : corners)
 	{
-		auto corner = it.first.second;
-
 		//Loop over each process corner and export the data
+		json.BeginObject();
+		json.Key("process");
+		json.String(corner.GetSpeedAsString());
+		json.Key("temp");
+		json.FormattedString("%d", corner.GetTemp());
+		json.Key("voltage_mv");
+		json.FormattedString("%d", corner.GetVoltage());
+
+		json.Key("delays");
+		json.BeginArray();
+		SaveTimingData(json, corner);
+		json.EndArray();
+
+		json.EndObject();
+	}
 
-		fprintf(fp, "        {\n");
-		fprintf(fp, "            \"process\" : \"%s\",\n", corner.GetSpeedAsString().c_str());
-		fprintf(fp, "            \"temp\" : \"%d\",\n", corner.GetTemp());
-		fprintf(fp, "            \"voltage_mv\" : \"%d\",\n", corner.GetVoltage());
-
-		fprintf(fp, "            \"delays\" :\n            [\n");
-		SaveTimingData(fp, corner);
-		fprintf(fp, "            ]\n");
+	json.EndArray();
+}
 
-		//key is last element, we're done
-		if(it.first == end->first)
-			fprintf(fp, "        }\n");
-		else
-			fprintf(fp, "        },\n");
-	}
+/**
+	@brief Unfiltered then filtered delays for taps 1 through 4
+ */
+void Greenpak4Delay::GetTimingTables(vector<PTVDelayTable*>& tables)
+{
+	for(int tap=1; tap<=4; tap++)
+		tables.push_back(&m_unfilteredDelays[tap]);
+	for(int tap=1; tap<=4; tap++)
+		tables.push_back(&m_filteredDelays[tap]);
 
-	if(last)
-		fprintf(fp, "    ]\n");
-	else
-		fprintf(fp, "    ],\n");
+	//Don't call base class, we have no pin-to-pin delays
 }
 
-void Greenpak4Delay::SaveTimingData(FILE* fp, PTVCorner corner)
+void Greenpak4Delay::SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner)
 {
-	for(auto it : m_filteredDelays)
+	for(auto& it : m_filteredDelays)
 	{
-		auto cond = it.first;
-		auto delay = it.second;
-		if(cond.second != corner)
+		CombinatorialDelay delay;
+		if(!it.second.GetExactDelay("IN", "OUT", corner, delay))
 			continue;
 
-		fprintf(fp, "                {\n");
-		fprintf(fp, "                    \"type\" : \"filtered\",\n");
-		fprintf(fp, "                    \"tap\" : \"%d\",\n", cond.first);
-		fprintf(fp, "                    \"rising\" : \"%f\",\n", delay.m_rising);
-		fprintf(fp, "                    \"falling\" : \"%f\"\n", delay.m_falling);
-		fprintf(fp, "                },\n");
+		json.BeginObject();
+		json.Key("type");
+		json.String("filtered");
+		json.Key("tap");
+		json.FormattedString("%d", it.first);
+		json.Key("rising");
+		json.FormattedString("%f", delay.m_rising);
+		json.Key("falling");
+		json.FormattedString("%f", delay.m_falling);
+		json.EndObject();
 	}
 
-	for(auto it : m_unfilteredDelays)
+	for(auto& it : m_unfilteredDelays)
 	{
-		auto cond = it.first;
-		auto delay = it.second;
-		if(cond.second != corner)
+		CombinatorialDelay delay;
+		if(!it.second.GetExactDelay("IN", "OUT", corner, delay))
 			continue;
 
-		fprintf(fp, "                {\n");
-		fprintf(fp, "                    \"type\" : \"unfiltered\",\n");
-		fprintf(fp, "                    \"tap\" : \"%d\",\n", cond.first);
-		fprintf(fp, "                    \"rising\" : \"%f\",\n", delay.m_rising);
-		fprintf(fp, "                    \"falling\" : \"%f\"\n", delay.m_falling);
-		fprintf(fp, "                },\n");
+		json.BeginObject();
+		json.Key("type");
+		json.String("unfiltered");
+		json.Key("tap");
+		json.FormattedString("%d", it.first);
+		json.Key("rising");
+		json.FormattedString("%f", delay.m_rising);
+		json.Key("falling");
+		json.FormattedString("%f", delay.m_falling);
+		json.EndObject();
 	}
 
 	//don't call base class, nothing for it to do
@@ -52,18 +52,22 @@ public:
 	virtual bool CommitChanges();
 
 	void SetTap(int tap)
-	{ m_delayTap = tap; }
+	{
+		m_delayTap = tap;
+		MarkDirty();
+	}
 
 	void SetGlitchFilter(bool enable)
-	{ m_glitchFilter = enable; }
-
-	typedef std::pair<int, PTVCorner> TimingCondition;
+	{
+		m_glitchFilter = enable;
+		MarkDirty();
+	}
 
 	void SetUnfilteredDelay(int ntap, PTVCorner c, CombinatorialDelay d)
-	{ m_unfilteredDelays[TimingCondition(ntap, c)] = d; }
+	{ m_unfilteredDelays[ntap].SetDelay("IN", "OUT", c, d); }
 
 	void SetFilteredDelay(int ntap, PTVCorner c, CombinatorialDelay d)
-	{ m_filteredDelays[TimingCondition(ntap, c)] = d; }
+	{ m_filteredDelays[ntap].SetDelay("IN", "OUT", c, d); }
 
 	virtual std::string GetPrimitiveName() const;
 
@@ -73,7 +77,8 @@ public:
 	virtual void PrintTimingData() const;
 	virtual void PrintExtraTimingData(PTVCorner corner) const;
 
-	virtual void SaveTimingData(FILE* fp, bool last);
+	virtual void SaveTimingData(Greenpak4JSONWriter& json);
+	virtual void GetTimingTables(std::vector<PTVDelayTable*>& tables);
 
 	virtual bool GetCombinatorialDelay(
 		std::string srcport,
@@ -96,11 +101,13 @@ protected:
 
 	bool m_glitchFilter;
 
-	//Timing data
-	std::map<TimingCondition, CombinatorialDelay > m_unfilteredDelays;	//no glitch filter
-	std::map<TimingCondition, CombinatorialDelay > m_filteredDelays;	//with glitch filter
+	//Timing data, by tap
+	std::map<int, PTVDelayTable> m_unfilteredDelays;	//no glitch filter
+	std::map<int, PTVDelayTable> m_filteredDelays;		//with glitch filter
+
+	void GetTimingCorners(std::vector<PTVCorner>& corners) const;
 
-	virtual void SaveTimingData(FILE* fp, PTVCorner corner);
+	virtual void SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner);
 	virtual bool LoadExtraTimingData(PTVCorner corner, std::string delaytype, json_object* object);
 };
 
@@ -17,6 +17,8 @@
  **********************************************************************************************************************/
 
 #include <cassert>
+#include <cstring>
+#include <unordered_map>
 #include <log.h>
 #include <Greenpak4.h>
 
@@ -35,6 +37,13 @@ Greenpak4Device::Greenpak4Device(
 	, m_ldoBypass(false)
 	, m_nvmLoadRetryCount(1)
 	, m_hasTimingData(false)
+	, m_userid(0)
+	, m_table(NULL)
+	, m_imageBits(NULL)
+	, m_probeBits(NULL)
+	, m_chipConfigDirty(true)
+	, m_imageUserID(0)
+	, m_imageReadProtect(false)
 {
 	//Create power rails
 	//These have to come first, since all other nodes will refer to these during construction
@@ -93,103 +102,19 @@ Greenpak4Device::~Greenpak4Device()
 	for(auto x : m_bitstuff)
 		delete x;
 	m_bitstuff.clear();
+
+	//Only once nothing can refer to them any more
+	for(auto db : m_timingDatabases)
+		delete db;
+	m_timingDatabases.clear();
+
+	delete[] m_imageBits;
+	delete[] m_probeBits;
 }
 
 void Greenpak4Device::CreateDevice_SLG46140()
 {
-	//64 inputs per routing matrix
-	m_matrixBits = 6;
-
-	//Create the dedicated LUT2s (4 total)
-	for(int i=0; i<4; i++)
-	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//everything is in matrix 0
-			i*2,		//LUT2 base is row 0, then 2 inputs per LUT
-			i+1,		//First mux entry is ground, then the LUT2s
-			848 + i*4,	//LUT2s start at bitstream offset 848, 2^2 bits per LUT
-			2));		//this is a LUT2
-	}
-
-	//Create the dedicated LUT3s (4 total)
-	for(int i=0; i<4; i++)
-	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//everything is in matrix 0
-			i*3 + 12,	//LUT3 base is row 12, then 3 inputs per LUT
-			i+7,		//we come after the last LUT3
-			874 + i*8,	//LUT3s start at bitstream offset 874, 2^3 bits per LUT
-			3));		//this is a LUT3
-	}
-
-	/*
-	//Create the first LUT, and its pattern-generator alter ego
-	auto lut40 = new Greenpak4LUT(
-		this,
-		0,
-		0,		//Attached to crossbar #0
-		32,		//LUT4 base is row 32
-		13,		//we come after the last LUT3
-		656,	//LUT4 starts after last LUT3
-		4);	//this is a LUT4
-	auto pgen = new Greenpak4PatternGenerator(
-		this,
-		0,
-		32,
-		13,
-		656);
-
-	//Create the paired cell for them
-	auto lpgen = new Greenpak4PairedEntity(
-		this,
-		0,		//Attached to crossbar #0
-		676,	//Selector bit for LUT or PGEN mode
-		lut40,	//select=0 means we're a LUT
-		pgen);	//select=1 means we're a PGEN
-
-	lpgen->AddType("GP_INV", 0);	//Combinatorial logic all uses the LUT
-	lpgen->AddType("GP_2LUT", 0);
-	lpgen->AddType("GP_3LUT", 0);
-	lpgen->AddType("GP_4LUT", 0);
-	lpgen->AddType("GP_PGEN", 1);	//Pattern generator is the only block mapped to the PGEN
-
-	m_lut4s.push_back(lpgen);
-	*/
-
-	//Create the Type-A IOBs (with output enable).
-	m_iobs[2] =  new Greenpak4IOBTypeA(this, 2,  0, -1, 22, 761, Greenpak4IOB::IOB_FLAG_INPUTONLY);
-	m_iobs[3] =  new Greenpak4IOBTypeA(this, 3,  0, 44, 23, 766);
-	m_iobs[4] =  new Greenpak4IOBTypeA(this, 4,  0, 46, 24, 773);
-	m_iobs[5] =  new Greenpak4IOBTypeA(this, 5,  0, 48, 25, 780);
-	m_iobs[7] =  new Greenpak4IOBTypeA(this, 7,  0, 51, 27, 795);
-	m_iobs[9] =  new Greenpak4IOBTypeA(this, 9,  0, 53, 28, 802);
-	m_iobs[12] = new Greenpak4IOBTypeA(this, 12, 0, 57, 31, 827);
-	m_iobs[13] = new Greenpak4IOBTypeA(this, 13, 0, 59, 32, 834);
-	m_iobs[14] = new Greenpak4IOBTypeA(this, 14, 0, 61, 33, 841);
-
-	//m_iobs[19]->SetAnalogConfigBase(878);
-	//m_iobs[18]->SetAnalogConfigBase(876);
-
-	//Create the Type-B IOBs (no output enable)
-	m_iobs[6]  = new Greenpak4IOBTypeB(this,  6, 0, 50, 26, 788);
-	m_iobs[10] = new Greenpak4IOBTypeB(this, 10, 0, 55, 29, 811, Greenpak4IOB::IOB_FLAG_X4DRIVE);
-	m_iobs[11] = new Greenpak4IOBTypeB(this, 11, 0, 56, 30, 820);
-
-	//Dedicated DFF/latches (2 total)
-	//m_dffsr.push_back(new Greenpak4Flipflop(this, 2,  true,  0, 42, 16, 685));
-	//m_dffs.push_back( new Greenpak4Flipflop(this, 3,  false, 0, 45, 17, 689));
-
-	//Shift registers
-	//m_shregs.push_back(new Greenpak4ShiftRegister(this, 0, 40, 19, 750));
-
-	//Edge detector/prog delay line
-	m_delays.push_back(new Greenpak4Delay(this, 0, 43, 21, 486));
-
-	//No discrete inverters
+	CreateDevice_FromTable(false);
 
 	//TODO: External clocks??
 
@@ -202,115 +127,14 @@ void Greenpak4Device::CreateDevice_SLG46140()
 		562,	//bitstream location of power management stuff
 		560);	//bitstream location of clock divider
 
-	/*
-	//Ring oscillator
-	//TODO: Addresses are right, but bitstream coding is different
-	m_ringosc = new Greenpak4RingOscillator(
-		this,
-		0,		//everything is matrix 0
-		66,		//input base (single power-down input)
-		34,		//output word (plus dedicated routing to counters etc)
-		574);	//bitstream location
-	*/
-
-	/*
-	//RC oscillator
-	m_rcosc = new Greenpak4RCOscillator(
-		this,
-		0,		//Matrix applies to inputs, we can route output globally
-		84,		//input base (single power-down input)
-		49,		//output word (plus dedicated routing to counters etc)
-		1642);	//bitstream location
-	*/
+	//TODO: Ring oscillator (addresses are known but bitstream coding is different), RC oscillator, counters,
+	//slave SPI, ADC, DACs, comparators and PGA
 
-	//Counters
-	/*
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		true,	//we have wake-sleep powerdown
-		true,	//we have edge detector
-		false,	//no PWM
-		0,		//counter number
-		0,		//matrix
-		68,		//ibase
-		37,		//oword,
-		722));	//cbase
-	*/
-
-	/*
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		true,	//wake-sleep powerdown bit
-		false,	//no edge detector
-		false,	//no PWM
-		0,		//counter number
-		0,		//matrix
-		74,		//ibase
-		36,		//oword
-		1731));	//cbase
-	*/
-
-	//TODO: Slave SPI
-
-	//TODO: ADC
-
-	/*
-	//The DACs
-	m_dacs.push_back(new Greenpak4DAC(this, 844, 840, 843, 840, 0));
-	m_dacs.push_back(new Greenpak4DAC(this, 823, 834, 883, 840, 1));
-	*/
 	//Bandgap reference
 	m_bandgap = new Greenpak4Bandgap(this, 0, 0, 51, 507, 512, 0);
-	/*
-	//Voltage references for comparators
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 0, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 1, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 2, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 3, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 4));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 5));
-	*/
-	//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 3));
-	/*
-	//Analog comparators
-	//TODO speed doubler for ACMP5? Need to double check latest datasheet, this may have been changed
-	m_acmps.push_back(new Greenpak4Comparator(this, 0, 0, 69, 33, 832, 852, 853, 855, 934, 892));
-	m_acmps.push_back(new Greenpak4Comparator(this, 1, 1, 70, 33, 831, 861, 857, 859, 932, 897));
-	m_acmps.push_back(new Greenpak4Comparator(this, 2, 1, 71, 34,  0,  862, 864, 863, 930, 902));
-	m_acmps.push_back(new Greenpak4Comparator(this, 3, 1, 72, 35,  0,  866, 867, 869, 928, 907));
-	m_acmps.push_back(new Greenpak4Comparator(this, 4, 0, 70, 34,  0,  875, 871, 873, 926, 912));
-	m_acmps.push_back(new Greenpak4Comparator(this, 5, 0, 71, 35,  0,  880,  0,   0,  924, 917));
 
-	//PGA
-	m_pga = new Greenpak4PGA(this, 815);
-	*/
 	//No analog buffer in SLG46140
-	/*
-	//Comparator input routing
-	auto pin3 = m_iobs[3]->GetOutput("OUT");
-	auto pin4 = m_iobs[4]->GetOutput("OUT");
-	auto pin6 = m_iobs[6]->GetOutput("OUT");
-	auto pin12 = m_iobs[12]->GetOutput("OUT");
-	auto pin13 = m_iobs[13]->GetOutput("OUT");
-	auto pin15 = m_iobs[15]->GetOutput("OUT");
-	auto vdd = m_constantOne->GetOutput("OUT");
-	auto pga = m_pga->GetOutput("VOUT");
-	auto pin6_buf = m_abuf->GetOutput("OUT");
-	m_acmps[0]->AddInputMuxEntry(pin6, 0);
-	m_acmps[0]->AddInputMuxEntry(pin6_buf, 1);
-	m_acmps[0]->AddInputMuxEntry(vdd, 2);
-	m_acmps[1]->AddInputMuxEntry(pin12, 0);
-	m_acmps[1]->AddInputMuxEntry(pga, 1);
-	m_acmps[1]->AddInputMuxEntry(pin6, 2);
-	m_acmps[1]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[1]->AddInputMuxEntry(vdd, 2);
-	*/
+
 	//TODO: Vdd bypass
 
 	//Power-on reset
@@ -322,71 +146,13 @@ void Greenpak4Device::CreateDevice_SLG46140()
 	//System reset
 	m_sysrst = new Greenpak4SystemReset(this, 0, 22, -1, 1000);
 
-	//Total length of our bitstream
-	m_bitlen = 1024;
-
-	//Initialize matrix base addresses
-	m_matrixBase[0] = 0;
-	m_matrixBase[1] = 0;		//initialize for completeness's sake, but there is no matrix 1
-
-	//no cross connections
-
 	//Do final initialization
 	CreateDevice_common();
 }
 
 void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
 {
-	//64 inputs per routing matrix
-	m_matrixBits = 6;
-
-	//Create the LUT2s (4 per device half)
-	for(int i=0; i<4; i++)
-	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//First half of LUT2s are attached to crossbar #0
-			i*2,		//LUT2 base is row 0, then 2 inputs per LUT
-			i+1,		//First mux entry is ground, then the LUT2s
-			576 + i*4,	//LUT2s start at bitstream offset 576, 2^2 bits per LUT
-			2));		//this is a LUT2
-	}
-	for(int i=0; i<4; i++)
-	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i+4,
-			1,			//Second half are attached to crossbar #1
-			i*2,		//LUT2 base is row 0, then 2 inputs per LUT
-			i+1,		//First mux entry is ground, then the LUT2s
-			698 + i*4,	//LUT2s start at bitstream offset 698, 2^2 bits per LUT
-			2));		//this is a LUT2
-	}
-
-	//Create the LUT3s (8 per device half)
-	for(int i=0; i<8; i++)
-	{
-		m_lut3s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//First half of LUT3s are attached to crossbar #0
-			i*3 + 8,	//LUT3 base is row 8, then 3 inputs per LUT
-			i+5,		//we come after the last LUT2
-			592 + i*8,	//LUT2s start at bitstream offset 592, 2^3 bits per LUT
-			3));		//this is a LUT3
-	}
-	for(int i=0; i<8; i++)
-	{
-		m_lut3s.push_back(new Greenpak4LUT(
-			this,
-			i+8,
-			1,			//Second half are attached to crossbar #1
-			i*3 + 8,	//LUT3 base is row 8, then 3 inputs per LUT
-			i+5,		//we come after the last LUT2
-			714 + i*8,	//LUT3s start at bitstream offset 714, 2^3 bits per LUT
-			3));		//this is a LUT3
-	}
+	CreateDevice_FromTable(dual_rail);
 
 	//Create the second LUT4 (no special functionality)
 	//Put it FIRST in the array so that initial placement prefers it
@@ -432,63 +198,6 @@ void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
 
 	m_lut4s.push_back(lpgen);
 
-	//Create the Type-A IOBs (with output enable).
-	//Pin 14 is a used as VCCIO in the SLG46621, the GPIO driver is not bonded out
-	m_iobs[2] =  new Greenpak4IOBTypeA(this, 2,  0, -1, 24, 941, Greenpak4IOB::IOB_FLAG_INPUTONLY);
-	m_iobs[3] =  new Greenpak4IOBTypeA(this, 3,  0, 56, 25, 946);
-	m_iobs[5] =  new Greenpak4IOBTypeA(this, 5,  0, 59, 27, 960);
-	m_iobs[7] =  new Greenpak4IOBTypeA(this, 7,  0, 62, 29, 974);
-	m_iobs[9] =  new Greenpak4IOBTypeA(this, 9,  0, 65, 31, 988);
-	m_iobs[10] = new Greenpak4IOBTypeA(this, 10, 0, 67, 32, 995, Greenpak4IOB::IOB_FLAG_X4DRIVE);
-	m_iobs[13] = new Greenpak4IOBTypeA(this, 13, 1, 57, 25, 1919);
-	if(!dual_rail)
-		m_iobs[14] = new Greenpak4IOBTypeA(this, 14, 1, 59, 26, 1926);
-	m_iobs[16] = new Greenpak4IOBTypeA(this, 16, 1, 62, 28, 1940);
-	m_iobs[18] = new Greenpak4IOBTypeA(this, 18, 1, 65, 30, 1954);
-	m_iobs[19] = new Greenpak4IOBTypeA(this, 19, 1, 67, 31, 1961);
-
-	m_iobs[19]->SetAnalogConfigBase(878);
-	m_iobs[18]->SetAnalogConfigBase(876);
-
-	//Create the Type-B IOBs (no output enable)
-	m_iobs[4]  = new Greenpak4IOBTypeB(this,  4, 0, 58, 26, 953);
-	m_iobs[6]  = new Greenpak4IOBTypeB(this,  6, 0, 61, 28, 967);
-	m_iobs[8]  = new Greenpak4IOBTypeB(this,  8, 0, 64, 30, 981);
-	m_iobs[12] = new Greenpak4IOBTypeB(this, 12, 1, 56, 24, 1911, Greenpak4IOB::IOB_FLAG_X4DRIVE);
-	m_iobs[15] = new Greenpak4IOBTypeB(this, 15, 1, 61, 27, 1933);
-	m_iobs[17] = new Greenpak4IOBTypeB(this, 17, 1, 64, 29, 1947);
-	m_iobs[20] = new Greenpak4IOBTypeB(this, 20, 1, 69, 32, 1968);
-
-	//DFF/latches
-	//NOTE: Datasheet bug
-	//Figure 42 of SLG46620_DS_r075 (page 97) says DFF5 config range is bits 708-710
-	//but this collides with LUT2_7 and does not reflect actual silicon behavior.
-	//Actual range is bits 695-697 (listed on page 151)
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 0,  true,  0, 36, 14, 677));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 1,  true,  0, 39, 15, 681));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 2,  true,  0, 42, 16, 685));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 3,  false, 0, 45, 17, 689));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 4,  false, 0, 47, 18, 692));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 5,  false, 0, 49, 19, 695));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 6,  true,  1, 36, 14, 794));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 7,  true,  1, 39, 15, 798));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 8,  true,  1, 42, 16, 802));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 9,  false, 1, 45, 17, 806));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 10, false, 1, 47, 18, 809));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 11, false, 1, 49, 19, 812));
-
-	//Shift registers
-	m_shregs.push_back(new Greenpak4ShiftRegister(this, 0, 51, 20, 1610));
-	m_shregs.push_back(new Greenpak4ShiftRegister(this, 1, 51, 20, 1619));
-
-	//Edge detector/prog delays
-	m_delays.push_back(new Greenpak4Delay(this, 0, 54, 22, 1600));
-	m_delays.push_back(new Greenpak4Delay(this, 1, 54, 22, 1605));
-
-	//Inverters
-	m_inverters.push_back(new Greenpak4Inverter(this, 0, 55, 23));
-	m_inverters.push_back(new Greenpak4Inverter(this, 1, 55, 23));
-
 	//Low-frequency oscillator
 	m_lfosc = new Greenpak4LFOscillator(
 		this,
@@ -514,221 +223,19 @@ void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
 		49,		//output word (plus dedicated routing to counters etc)
 		1642);	//bitstream location
 
-	//Counters
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		true,	//wake-sleep powerdown bit
-		false,	//no edge detector
-		false,	//no PWM
-		0,		//counter number
-		0,		//matrix
-		74,		//ibase
-		36,		//oword
-		1731));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		1,		//counter number
-		1,		//matrix
-		75,		//ibase
-		36,		//oword
-		1753));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		true,	//we have FSM mode
-		false,	//no wake-sleep powerdown
-		true,	//we have edge detector
-		false,	//no PWM
-		2,		//counter number
-		0,		//matrix
-		75,		//ibase
-		37,		//oword
-		1774));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		3,		//counter number
-		1,		//matrix
-		76,		//ibase
-		37,		//oword
-		1799));	//cbase (datasheet has a typo, this is correct)
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		true,	//we have FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		4,		//counter number
-		1,		//matrix
-		77,		//ibase
-		38,		//oword,
-		1820));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		5,		//counter number
-		0,		//matrix
-		78,		//ibase
-		38,		//oword,
-		1838));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		6,		//counter number
-		0,		//matrix
-		79,		//ibase
-		39,		//oword,
-		1852));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		7,		//counter number
-		1,		//matrix (datasheet has a typo, this is correct)
-		80,		//ibase
-		39,		//oword,
-		1866));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		true,	//PWM mode
-		8,		//counter number
-		1,		//matrix
-		81,		//ibase
-		40,		//oword,
-		1880));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		true,	//PWM mode
-		9,		//counter number
-		0,		//matrix
-		80,		//ibase
-		40,		//oword,
-		1895));	//cbase
-
 	//Slave SPI
 	m_spi = new Greenpak4SPI(this, 0, 82, 44, 1656);
 
 	//TODO: ADC
 
-	//The DACs
-	m_dacs.push_back(new Greenpak4DAC(this, 844, 840, 843, 840, 0));
-	m_dacs.push_back(new Greenpak4DAC(this, 823, 834, 883, 840, 1));
-
 	//Bandgap reference
 	m_bandgap = new Greenpak4Bandgap(this, 0, 0, 41, 923, 936, 938);
 
-	//Voltage references for comparators
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 0, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 1, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 2, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 3, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 4));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 5));
-
-	//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 6));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 7));
-
-	//Analog comparators
-	//TODO speed doubler for ACMP5? Need to double check latest datasheet, this may have been changed
-	m_acmps.push_back(new Greenpak4Comparator(this, 0, 0, 69, 33, 832, 852, 853, 855, 934, 892));
-	m_acmps.push_back(new Greenpak4Comparator(this, 1, 1, 70, 33, 831, 861, 857, 859, 932, 897));
-	m_acmps.push_back(new Greenpak4Comparator(this, 2, 1, 71, 34,  0,  862, 864, 863, 930, 902));
-	m_acmps.push_back(new Greenpak4Comparator(this, 3, 1, 72, 35,  0,  866, 867, 869, 928, 907));
-	m_acmps.push_back(new Greenpak4Comparator(this, 4, 0, 70, 34,  0,  875, 871, 873, 926, 912));
-	m_acmps.push_back(new Greenpak4Comparator(this, 5, 0, 71, 35,  0,  880,  0,   0,  924, 917));
-
-	//Digital comparators
-	m_dcmps.push_back(new Greenpak4DigitalComparator(this, 0, 1, 82, 42, 1670));
-	m_dcmps.push_back(new Greenpak4DigitalComparator(this, 1, 1, 82, 44, 1691));
-	m_dcmps.push_back(new Greenpak4DigitalComparator(this, 2, 1, 82, 46, 1711));
-
-	//Digital comparator references
-	//SLG46620 datasheet r100 page 140-141 fig 94-95 are wrong.
-	//reg0 base is 1723, not 1725
-	m_dcmprefs.push_back(new Greenpak4DCMPRef(this, 0, 1723));
-	m_dcmprefs.push_back(new Greenpak4DCMPRef(this, 1, 1703));
-	m_dcmprefs.push_back(new Greenpak4DCMPRef(this, 2, 1683));
-	m_dcmprefs.push_back(new Greenpak4DCMPRef(this, 3, 1662));
-
 	//Digital comparator input mux
 	m_dcmpmux = new Greenpak4DCMPMux(this, 1, 83);
 
-	//Clock buffers
-	m_clkbufs.push_back(new Greenpak4ClockBuffer(this, 0, 0, 72));	//clk_matrix0
-	m_clkbufs.push_back(new Greenpak4ClockBuffer(this, 1, 0, 73));	//clk_matrix1
-	m_clkbufs.push_back(new Greenpak4ClockBuffer(this, 2, 1, 73));	//clk_matrix2
-	m_clkbufs.push_back(new Greenpak4ClockBuffer(this, 3, 1, 74));	//clk_matrix3
-	m_clkbufs.push_back(new Greenpak4ClockBuffer(this, 4, 0, 83));	//SPI SCK
-
-	//Clock mux buffer for ADC and PWM
-	auto mbuf = new Greenpak4MuxedClockBuffer(this, 5, 0, 1628);
-	m_clkbufs.push_back(mbuf);
-	mbuf->AddInputMuxEntry(m_ringosc->GetOutput("CLKOUT_HARDIP"), 0);
-	mbuf->AddInputMuxEntry(m_clkbufs[2]->GetOutput("OUT"), 1);
-	mbuf->AddInputMuxEntry(m_rcosc->GetOutput("CLKOUT_HARDIP"), 2);
-	mbuf->AddInputMuxEntry(m_clkbufs[4]->GetOutput("OUT"), 3);
-
-	//inp 0 is ADC, not implemented
-	m_dcmps[0]->AddInputPMuxEntry(m_spi->GetOutput("RXD_HIGH"), 1);
-	m_dcmps[0]->AddInputPMuxEntry(m_counters14bit[2]->GetOutput("POUT"), 2);
-	m_dcmps[0]->AddInputPMuxEntry(m_dcmpmux->GetOutput("OUTA"), 3);
-
-	m_dcmps[0]->AddInputNMuxEntry(m_counters8bit[4]->GetOutput("POUT"), 0);
-	m_dcmps[0]->AddInputNMuxEntry(m_dcmprefs[0]->GetOutput("OUT"), 1);
-	m_dcmps[0]->AddInputNMuxEntry(m_spi->GetOutput("RXD_LOW"), 2);
-	m_dcmps[0]->AddInputNMuxEntry(m_counters8bit[0]->GetOutput("POUT"), 3);
-
-	//in0 is ADC, not implemented
-	m_dcmps[1]->AddInputPMuxEntry(m_spi->GetOutput("RXD_LOW"), 1);
-	m_dcmps[1]->AddInputPMuxEntry(m_counters8bit[0]->GetOutput("POUT"), 2);
-	m_dcmps[1]->AddInputPMuxEntry(m_dcmprefs[1]->GetOutput("OUT"), 3);
-
-	m_dcmps[1]->AddInputNMuxEntry(m_counters8bit[5]->GetOutput("POUT"), 0);
-	m_dcmps[1]->AddInputNMuxEntry(m_dcmpmux->GetOutput("OUTB"), 1);
-	m_dcmps[1]->AddInputNMuxEntry(m_spi->GetOutput("RXD_LOW"), 2);
-	m_dcmps[1]->AddInputNMuxEntry(m_counters14bit[2]->GetOutput("POUT"), 3);
-
-	//in0 is ADC, not implemented
-	m_dcmps[2]->AddInputPMuxEntry(m_spi->GetOutput("RXD_HIGH"), 1);
-	m_dcmps[2]->AddInputPMuxEntry(m_counters8bit[0]->GetOutput("POUT"), 2);
-	m_dcmps[2]->AddInputPMuxEntry(m_dcmprefs[3]->GetOutput("OUT"), 3);
-
-	m_dcmps[2]->AddInputNMuxEntry(m_counters8bit[4]->GetOutput("POUT"), 0);
-	m_dcmps[2]->AddInputNMuxEntry(m_dcmprefs[2]->GetOutput("OUT"), 1);
-	m_dcmps[2]->AddInputNMuxEntry(m_spi->GetOutput("RXD_LOW"), 2);
-	m_dcmps[2]->AddInputNMuxEntry(m_counters14bit[2]->GetOutput("POUT"), 3);
+	//Clock mux buffer for ADC and PWM (inputs are in the device table)
+	m_clkbufs.push_back(new Greenpak4MuxedClockBuffer(this, 5, 0, 1628));
 
 	//PGA
 	m_pga = new Greenpak4PGA(this, 815);
@@ -736,40 +243,6 @@ void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
 	//Analog buffer
 	m_abuf = new Greenpak4Abuf(this, 836);
 
-	//Comparator input routing
-	auto pin3 = m_iobs[3]->GetOutput("OUT");
-	auto pin4 = m_iobs[4]->GetOutput("OUT");
-	auto pin6 = m_iobs[6]->GetOutput("OUT");
-	auto pin12 = m_iobs[12]->GetOutput("OUT");
-	auto pin13 = m_iobs[13]->GetOutput("OUT");
-	auto pin15 = m_iobs[15]->GetOutput("OUT");
-	auto vdd = m_constantOne->GetOutput("OUT");
-	auto pga = m_pga->GetOutput("VOUT");
-	auto pin6_buf = m_abuf->GetOutput("OUT");
-	m_acmps[0]->AddInputMuxEntry(pin6, 0);
-	m_acmps[0]->AddInputMuxEntry(pin6_buf, 1);
-	m_acmps[0]->AddInputMuxEntry(vdd, 2);
-	m_acmps[1]->AddInputMuxEntry(pin12, 0);
-	m_acmps[1]->AddInputMuxEntry(pga, 1);
-	m_acmps[1]->AddInputMuxEntry(pin6, 2);
-	m_acmps[1]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[1]->AddInputMuxEntry(vdd, 2);
-	m_acmps[2]->AddInputMuxEntry(pin13, 0);
-	m_acmps[2]->AddInputMuxEntry(pin6, 1);
-	m_acmps[2]->AddInputMuxEntry(pin6_buf, 1);
-	m_acmps[2]->AddInputMuxEntry(vdd, 1);
-	m_acmps[3]->AddInputMuxEntry(pin15, 0);
-	m_acmps[3]->AddInputMuxEntry(pin13, 1);
-	m_acmps[3]->AddInputMuxEntry(pin6, 2);
-	m_acmps[3]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[3]->AddInputMuxEntry(vdd, 2);
-	m_acmps[4]->AddInputMuxEntry(pin3, 0);
-	m_acmps[4]->AddInputMuxEntry(pin15, 1);
-	m_acmps[4]->AddInputMuxEntry(pin6, 2);
-	m_acmps[4]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[4]->AddInputMuxEntry(vdd, 2);
-	m_acmps[5]->AddInputMuxEntry(pin4, 0);
-
 	//Power-on reset
 	m_por = new Greenpak4PowerOnReset(this, 0, -1, 62, 2009);
 
@@ -779,31 +252,145 @@ void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
 	//System reset
 	m_sysrst = new Greenpak4SystemReset(this, 0, 24, -1, 2018);
 
-	//Total length of our bitstream
-	m_bitlen = 2048;
+	//Do final initialization
+	CreateDevice_common();
+}
+
+/**
+	@brief Creates every table-described entity for our part in a single pass
+
+	Singletons (oscillators, resets, etc.) and the paired LUT4/PGEN are not described by the table and must be created
+	by the caller afterwards. Hard-IP mux entries are applied by CreateDevice_common() once everything exists.
+
+	@param dual_rail	True if the package uses pin 14 as VCCIO rather than a GPIO
+ */
+void Greenpak4Device::CreateDevice_FromTable(bool dual_rail)
+{
+	m_table = GetDeviceTable(m_part);
+	if(!m_table)
+		LogFatal("No device table for part %s\n", GetPartAsString().c_str());
+	auto& t = *m_table;
+
+	m_matrixBits = t.m_matrixBits;
+	m_bitlen = t.m_bitlen;
+	m_matrixBase[0] = t.m_matrixBase[0];
+	m_matrixBase[1] = t.m_matrixBase[1];
+
+	//Size every list up front so construction doesn't reallocate
+	m_lut2s.reserve(t.m_lut2s.size());
+	m_lut3s.reserve(t.m_lut3s.size());
+	m_dffs.reserve(t.m_flipflops.size());
+	m_dffsr.reserve(t.m_flipflops.size());
+	m_shregs.reserve(t.m_shregs.size());
+	m_delays.reserve(t.m_delays.size());
+	m_inverters.reserve(t.m_inverters.size());
+	m_counters14bit.reserve(t.m_counters.size());
+	m_counters8bit.reserve(t.m_counters.size());
+	m_dacs.reserve(t.m_dacs.size());
+	m_vrefs.reserve(t.m_vrefs.size());
+	m_acmps.reserve(t.m_acmps.size());
+	m_dcmps.reserve(t.m_dcmps.size());
+	m_dcmprefs.reserve(t.m_dcmprefs.size());
+	m_clkbufs.reserve(t.m_clkbufs.size() + 1);
+
+	for(auto& l : t.m_lut2s)
+		m_lut2s.push_back(new Greenpak4LUT(this, l.m_lutnum, l.m_matrix, l.m_ibase, l.m_oword, l.m_cbase, l.m_order));
+	for(auto& l : t.m_lut3s)
+		m_lut3s.push_back(new Greenpak4LUT(this, l.m_lutnum, l.m_matrix, l.m_ibase, l.m_oword, l.m_cbase, l.m_order));
+
+	for(auto& p : t.m_iobs)
+	{
+		if(dual_rail && p.m_singleRailOnly)
+			continue;
+
+		Greenpak4IOB* iob;
+		if(p.m_typeA)
+			iob = new Greenpak4IOBTypeA(this, p.m_pin, p.m_matrix, p.m_ibase, p.m_oword, p.m_cbase, p.m_flags);
+		else
+			iob = new Greenpak4IOBTypeB(this, p.m_pin, p.m_matrix, p.m_ibase, p.m_oword, p.m_cbase, p.m_flags);
+		if(p.m_analogCbase != GP4_TABLE_NONE)
+			iob->SetAnalogConfigBase(p.m_analogCbase);
+		m_iobs[p.m_pin] = iob;
+	}
+
+	for(auto& f : t.m_flipflops)
+	{
+		auto ff = new Greenpak4Flipflop(this, f.m_ffnum, f.m_hasSR, f.m_matrix, f.m_ibase, f.m_oword, f.m_cbase);
+		if(f.m_hasSR)
+			m_dffsr.push_back(ff);
+		else
+			m_dffs.push_back(ff);
+	}
+
+	for(auto& b : t.m_shregs)
+		m_shregs.push_back(new Greenpak4ShiftRegister(this, b.m_matrix, b.m_ibase, b.m_oword, b.m_cbase));
+	for(auto& b : t.m_delays)
+		m_delays.push_back(new Greenpak4Delay(this, b.m_matrix, b.m_ibase, b.m_oword, b.m_cbase));
+	for(auto& b : t.m_inverters)
+		m_inverters.push_back(new Greenpak4Inverter(this, b.m_matrix, b.m_ibase, b.m_oword));
+
+	for(auto& c : t.m_counters)
+	{
+		auto counter = new Greenpak4Counter(
+			this,
+			c.m_depth,
+			c.m_hasFSM,
+			c.m_hasWakeSleepPowerdown,
+			c.m_hasEdgeDetect,
+			c.m_hasPWM,
+			c.m_countnum,
+			c.m_matrix,
+			c.m_ibase,
+			c.m_oword,
+			c.m_cbase);
+		if(c.m_depth == 14)
+			m_counters14bit.push_back(counter);
+		else
+			m_counters8bit.push_back(counter);
+	}
+
+	for(auto& d : t.m_dacs)
+		m_dacs.push_back(new Greenpak4DAC(this, d.m_cbaseReg, d.m_cbasePwr, d.m_cbaseInsel, d.m_cbaseAon, d.m_dacnum));
+	for(auto& v : t.m_vrefs)
+		m_vrefs.push_back(new Greenpak4VoltageReference(this, v.m_refnum, v.m_voutMuxsel));
 
-	//Initialize matrix base addresses
-	m_matrixBase[0] = 0;
-	m_matrixBase[1] = 1024;
+	for(auto& a : t.m_acmps)
+	{
+		m_acmps.push_back(new Greenpak4Comparator(
+			this,
+			a.m_cmpnum,
+			a.m_matrix,
+			a.m_ibase,
+			a.m_oword,
+			a.m_cbaseIsrc,
+			a.m_cbaseBw,
+			a.m_cbaseGain,
+			a.m_cbaseVin,
+			a.m_cbaseHyst,
+			a.m_cbaseVref));
+	}
+
+	for(auto& d : t.m_dcmps)
+		m_dcmps.push_back(new Greenpak4DigitalComparator(this, d.m_cmpnum, d.m_matrix, d.m_ibase, d.m_oword, d.m_cbase));
+	for(auto& r : t.m_dcmprefs)
+		m_dcmprefs.push_back(new Greenpak4DCMPRef(this, r.m_blocknum, r.m_cbase));
+	for(auto& c : t.m_clkbufs)
+		m_clkbufs.push_back(new Greenpak4ClockBuffer(this, c.m_bufnum, c.m_matrix, c.m_ibase));
 
 	//Create cross connections
 	for(unsigned int matrix=0; matrix<2; matrix++)
 	{
-		for(unsigned int i=0; i<10; i++)
+		for(unsigned int i=0; i<t.m_crossConnectionCount; i++)
 		{
-			auto cc = new Greenpak4CrossConnection(
+			m_crossConnections[matrix][i] = new Greenpak4CrossConnection(
 				this,
-				1 - matrix,	//invert, since matrix is OUTPUT location
-				85 + i,		//ibase
-				52 + i,		//oword
-				0			//cbase is invalid, we have no configuration at all
+				1 - matrix,							//invert, since matrix is OUTPUT location
+				t.m_crossConnectionIbase + i,		//ibase
+				t.m_crossConnectionOword + i,		//oword
+				0									//cbase is invalid, we have no configuration at all
 				);
-			m_crossConnections[matrix][i] = cc;
 		}
 	}
-
-	//Do final initialization
-	CreateDevice_common();
 }
 
 void Greenpak4Device::CreateDevice_common()
@@ -889,6 +476,107 @@ void Greenpak4Device::CreateDevice_common()
 			for(unsigned int i=0; i<10; i++)
 				m_bitstuff.push_back(m_crossConnections[matrix][i]);
 	}
+
+	//Now that every entity exists, hook up the hard-wired input muxes
+	for(auto& m : m_table->m_muxEntries)
+	{
+		auto src = GetRouteEntity(m.m_src.m_type, m.m_src.m_index);
+		auto dst = GetRouteEntity(m.m_dst.m_type, m.m_dst.m_index);
+		if(!src || !dst)
+			continue;
+		auto net = src->GetOutput(m.m_src.m_port);
+
+		string port = m.m_dst.m_port;
+		switch(m.m_dst.m_type)
+		{
+			case ROUTE_ACMP:
+				m_acmps[m.m_dst.m_index]->AddInputMuxEntry(net, m.m_sel);
+				break;
+
+			case ROUTE_DCMP:
+				if(port == "INP")
+					m_dcmps[m.m_dst.m_index]->AddInputPMuxEntry(net, m.m_sel);
+				else
+					m_dcmps[m.m_dst.m_index]->AddInputNMuxEntry(net, m.m_sel);
+				break;
+
+			case ROUTE_CLKBUF:
+				{
+					auto mbuf = dynamic_cast<Greenpak4MuxedClockBuffer*>(dst);
+					if(mbuf)
+						mbuf->AddInputMuxEntry(net, m.m_sel);
+				}
+				break;
+
+			default:
+				LogWarning("Device table has a mux entry on a block without an input mux\n");
+				break;
+		}
+	}
+}
+
+/**
+	@brief Looks up the entity referred to by a device table routing endpoint
+
+	@return The entity, or NULL if this part doesn't have it (for example pin 14 on the SLG46621)
+ */
+Greenpak4BitstreamEntity* Greenpak4Device::GetRouteEntity(Greenpak4RouteEntityType type, unsigned int index)
+{
+	switch(type)
+	{
+		case ROUTE_IOB:
+			return GetIOB(index);
+
+		case ROUTE_POWER:
+			return GetPowerRail(index != 0);
+
+		case ROUTE_COUNTER:
+			return (index < m_counters.size()) ? m_counters[index] : NULL;
+
+		case ROUTE_VREF:
+			return (index < m_vrefs.size()) ? m_vrefs[index] : NULL;
+
+		case ROUTE_ACMP:
+			return (index < m_acmps.size()) ? m_acmps[index] : NULL;
+
+		case ROUTE_DCMP:
+			return (index < m_dcmps.size()) ? m_dcmps[index] : NULL;
+
+		case ROUTE_DCMPREF:
+			return (index < m_dcmprefs.size()) ? m_dcmprefs[index] : NULL;
+
+		case ROUTE_CLKBUF:
+			return (index < m_clkbufs.size()) ? m_clkbufs[index] : NULL;
+
+		case ROUTE_DAC:
+			return (index < m_dacs.size()) ? m_dacs[index] : NULL;
+
+		case ROUTE_DCMPMUX:
+			return m_dcmpmux;
+
+		case ROUTE_LFOSC:
+			return m_lfosc;
+
+		case ROUTE_RINGOSC:
+			return m_ringosc;
+
+		case ROUTE_RCOSC:
+			return m_rcosc;
+
+		case ROUTE_SYSRST:
+			return m_sysrst;
+
+		case ROUTE_PGA:
+			return m_pga;
+
+		case ROUTE_ABUF:
+			return m_abuf;
+
+		case ROUTE_SPI:
+			return m_spi;
+	}
+
+	return NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -948,26 +636,30 @@ unsigned int Greenpak4Device::GetMatrixBase(unsigned int matrix)
 void Greenpak4Device::SetIOPrecharge(bool precharge)
 {
 	m_ioPrecharge = precharge;
+	m_chipConfigDirty = true;
 }
 
 void Greenpak4Device::SetDisableChargePump(bool disable)
 {
 	m_disableChargePump = disable;
+	m_chipConfigDirty = true;
 }
 
 void Greenpak4Device::SetLDOBypass(bool bypass)
 {
 	m_ldoBypass = bypass;
+	m_chipConfigDirty = true;
 }
 
 void Greenpak4Device::SetNVMRetryCount(int count)
 {
 	m_nvmLoadRetryCount = count;
+	m_chipConfigDirty = true;
 }
 
-string Greenpak4Device::GetPartAsString()
+string Greenpak4Device::GetPartAsString(GREENPAK4_PART part)
 {
-	switch(m_part)
+	switch(part)
 	{
 		case GREENPAK4_SLG46140:
 			return "SLG46140";
@@ -1038,6 +730,16 @@ bool Greenpak4Device::ReadFromFile(string fname)
 			ok = false;
 		}
 	}
+	InvalidateBitstream();
+
+	//Pull out the user ID code
+	unsigned int idbase = (m_part == GREENPAK4_SLG46140) ? 1007 : 2031;
+	m_userid = 0;
+	for(unsigned int i=0; i<8; i++)
+	{
+		if(bitstream[idbase + i])
+			m_userid |= (1 << i);
+	}
 
 	//TODO: Do some post-processing to create logical connections (e.g. infer VREF blocks)
 
@@ -1224,6 +926,52 @@ bool Greenpak4Device::ReadFromFile(string fname)
 	return ok;
 }
 
+/**
+	@brief Guesses the part a bitfile targets from the number of bits in it
+
+	The SLG46620 and SLG46621 share a bitstream format, so a 2048-bit file only tells us it's one of the two. If
+	part is already one of those it's left alone, otherwise SLG46620 is assumed.
+
+	@param fname		Bitfile to inspect
+	@param part			In: fallback part. Out: detected part
+
+	@return False if the file can't be read or has an unrecognized length
+ */
+bool Greenpak4Device::DetectPart(string fname, GREENPAK4_PART& part)
+{
+	FILE* fp = fopen(fname.c_str(), "r");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for reading\n", fname.c_str());
+		return false;
+	}
+
+	char unused[128];
+	fgets(unused, sizeof(unused), fp);
+	int index;
+	int value;
+	int maxindex = -1;
+	while(2 == fscanf(fp, "%d %d //\n", &index, &value))
+		maxindex = max(maxindex, index);
+	fclose(fp);
+
+	switch(maxindex + 1)
+	{
+		case 1024:
+			part = GREENPAK4_SLG46140;
+			return true;
+
+		case 2048:
+			if(part == GREENPAK4_SLG46140)
+				part = GREENPAK4_SLG46620;
+			return true;
+
+		default:
+			LogError("Couldn't detect part for %s (%d bits)\n", fname.c_str(), maxindex + 1);
+			return false;
+	}
+}
+
 /**
 	@brief Writes the bitstream to a file
 
@@ -1241,31 +989,31 @@ bool Greenpak4Device::WriteToFile(string fname, uint8_t userid, bool readProtect
 		return false;
 	}
 
-	//Allocate the bitstream and initialize to zero
-	//According to phone conversation w Silego FAE, 0 is legal default state for everything incl reserved bits
-	//All IOs will be floating digital inputs
-	bool* bitstream = new bool[m_bitlen];
-	for(unsigned int i=0; i<m_bitlen; i++)
-		bitstream[i] = false;
-
 	//Generate the bitstream, then write to file if successful
 	bool ok = true;
-	if(GenerateBitstream(bitstream, userid, readProtect))
+	if(UpdateBitstream(userid, readProtect))
 	{
 		fprintf(fp, "index\t\tvalue\t\tcomment\n");
 		for(unsigned int i=0; i<m_bitlen; i++)
-			fprintf(fp, "%u\t\t%d\t\t//\n", i, (int)bitstream[i]);
+			fprintf(fp, "%u\t\t%d\t\t//\n", i, (int)m_imageBits[i]);
 	}
 	else
 		ok = false;
 
 	//Done
-	delete[] bitstream;
 	fclose(fp);
 	return ok;
 }
 
-bool Greenpak4Device::WriteToJSON(string fname, string top)
+/**
+	@brief Writes our configuration as a Yosys-compatible cell-level JSON netlist
+
+	@param fname		Name of the file to write to
+	@param top			Name of the top-level module
+	@param pretty		True for indented output, false for compact output (faster, for machine consumption)
+	@param pruneUnused	True to only write cells which can influence a device output (see FindLiveEntities())
+ */
+bool Greenpak4Device::WriteToJSON(string fname, string top, bool pretty, bool pruneUnused)
 {
 	//Open the file
 	FILE* fp = fopen(fname.c_str(), "w");
@@ -1274,88 +1022,85 @@ bool Greenpak4Device::WriteToJSON(string fname, string top)
 		LogError("Couldn't open %s for writing\n", fname.c_str());
 		return false;
 	}
+	Greenpak4JSONWriter json(fp, pretty);
 
 	//Write the header
-	fprintf(fp, "{\n");
-	fprintf(fp, "  \"creator\": \"gpkjson\",\n");
-	fprintf(fp, "  \"modules\": {\n");
+	json.BeginObject();
+	json.Key("creator");
+	json.String("gpkjson");
+	json.Key("modules");
+	json.BeginObject();
 
 	//Write the top-level module header
-	fprintf(fp, "    \"%s\": {\n", top.c_str());
-	fprintf(fp, "      \"attributes\": {\n");
-	fprintf(fp, "        \"top\": 1\n");
-	fprintf(fp, "      },\n");
-
-	//Create mapping of cell outputs to net numbers in the JSON
+	json.Key(top);
+	json.BeginObject();
+	json.Key("attributes");
+	json.BeginObject();
+	json.Key("top");
+	json.Int(1);
+	json.EndObject();
+
+	//Create mapping of cell outputs to net numbers in the JSON.
+	//Keyed by output name (not Greenpak4EntityOutput) so both halves of a dual map to one net, and so each lookup
+	//builds the name once instead of once per tree comparison.
 	int nextNetnum = 2;
-	map<Greenpak4EntityOutput, int> netnums;
-	netnums[GetGround()] = 0;
-	netnums[GetPower()] = 1;
+	unordered_map<string, int> netnums;
+	netnums.reserve(m_bitstuff.size() * 4);
+	netnums[GetGround().GetOutputName()] = 0;
+	netnums[GetPower().GetOutputName()] = 1;
 
 	//Map of top level pad numbers to net numbers.
-	//Note, these net numbers are
 	map<int, int> padToNet;
 
-	//Set of named cell types we used
-	set<string> used_cells;
-
 	//Write ports
 	//For now, name one pin for each IOB that's used.
 	//We can group pins into buses later on during higher level analysis.
-	fprintf(fp, "      \"ports\": {\n");
-	bool first = true;
+	char name[64];
+	json.Key("ports");
+	json.BeginObject();
 	for(auto it : m_iobs)
 	{
 		auto iob = it.second;
 
 		auto oe = iob->GetOutputEnable();
 
-		//Add comma if we're not the first one
-		if(first)
-			first = false;
-		else
-			fprintf(fp, ",\n");
-
-		fprintf(fp, "        \"io_%d\": {\n",
-			iob->GetPinNumber());
+		snprintf(name, sizeof(name), "io_%d", iob->GetPinNumber());
+		json.Key(name);
+		json.BeginObject();
 
 		//Allocate a new net number for everything
 		int netnum = nextNetnum ++;
 		padToNet[iob->GetPinNumber()] = netnum;
 
 		//Figure out direction
+		json.Key("direction");
 		if(oe.IsPowerRail())
-		{
-			if(oe.GetPowerRailValue() == 0)
-			{
-				//LogNotice("Pin %s is input or unused\n", iob->GetDescription().c_str());
-				fprintf(fp, "          \"direction\": \"input\",\n");
-			}
-
-			else
-			{
-				//LogNotice("Pin %s is output\n", iob->GetDescription().c_str());
-				fprintf(fp, "          \"direction\": \"output\",\n");
-			}
-		}
-
+			json.String( (oe.GetPowerRailValue() == 0) ? "input" : "output");
 		else
-		{
-			//LogNotice("Pin %s is bidir\n", iob->GetDescription().c_str());
-			fprintf(fp, "          \"direction\": \"inout\",\n");
-		}
+			json.String("inout");
 
-		fprintf(fp, "          \"bits\": [ %d ]\n", netnum);
+		json.Key("bits");
+		json.BeginArray();
+		json.Int(netnum);
+		json.EndArray();
 
-		fprintf(fp, "        }");
+		json.EndObject();
 	}
-	fprintf(fp, "\n      },\n");
+	json.EndObject();
 
 	//Write cell instances.
-	//Don't worry about optimizing out unused cells!
+	//Unless asked to prune, don't worry about optimizing out unused cells!
 	//We can take care of this in Yosys once the raw netlist is generated.
-	fprintf(fp, "      \"cells\": {\n");
-	first = true;
+	unordered_set<const Greenpak4BitstreamEntity*> live;
+	if(pruneUnused)
+	{
+		FindLiveEntities(live);
+		LogVerbose("%zu of %zu entities can influence an output\n", live.size(), m_bitstuff.size());
+	}
+	json.Key("cells");
+	json.BeginObject();
+	vector<string> inputs;
+	vector<string> outputs;
 	for(auto cell : m_bitstuff)
 	{
 		//Skip cross-connections and power rails, these get turned into wires
@@ -1363,113 +1108,77 @@ bool Greenpak4Device::WriteToJSON(string fname, string top)
 			continue;
 		if(dynamic_cast<Greenpak4PowerRail*>(cell) != NULL)
 			continue;
+		if(pruneUnused && (live.find(cell) == live.end()) )
+			continue;
 
-		//Add comma if we're not the first one
-		if(first)
-			first = false;
-		else
-			fprintf(fp, ",\n");
-
-		vector<string> inputs = cell->GetAllInputPorts();
-		vector<string> outputs = cell->GetAllOutputPorts();
-		vector<string> inouts;
+		inputs = cell->GetAllInputPorts();
+		outputs = cell->GetAllOutputPorts();
 
 		//The only primitive with an inout port is GP_IOBUF.
 		//All other ports are unidirectional.
 		string type = cell->GetPrimitiveName();
-		if(type == "GP_IOBUF")
-			inouts.push_back("IO");
+		bool iobuf = (type == "GP_IOBUF");
 
 		//Cell header
-		fprintf(fp, "        \"%s\": {\n", cell->GetDescription().c_str());
-		fprintf(fp, "          \"hide_name\": 0,\n");
-		fprintf(fp, "          \"type\": \"%s\",\n", type.c_str());
+		json.Key(cell->GetDescription());
+		json.BeginObject();
+		json.Key("hide_name");
+		json.Int(0);
+		json.Key("type");
+		json.String(type);
 
 		//Parameters
-		bool pfirst = true;
-		fprintf(fp, "          \"parameters\": {\n");
-		auto params = cell->GetParameters();
-		for(auto it : params)
+		json.Key("parameters");
+		json.BeginObject();
+		for(auto& it : cell->GetParameters())
 		{
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			fprintf(fp, "            \"%s\": %s", it.first.c_str(), it.second.c_str());
+			json.Key(it.first);
+			json.Literal(it.second);
 		}
-		fprintf(fp, "\n          },\n");
+		json.EndObject();
 
 		//Attributes
-		pfirst = true;
-		fprintf(fp, "          \"attributes\": {\n");
-		auto attribs = cell->GetAttributes();
-		for(auto it : attribs)
+		json.Key("attributes");
+		json.BeginObject();
+		for(auto& it : cell->GetAttributes())
 		{
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			fprintf(fp, "            \"%s\": %s", it.first.c_str(), it.second.c_str());
+			json.Key(it.first);
+			json.Literal(it.second);
 		}
-		fprintf(fp, "\n          },\n");
+		json.EndObject();
 
 		//Port directions based on which list we're in
-		pfirst = true;
-		fprintf(fp, "          \"port_directions\": {\n");
-		for(auto i : inputs)
+		json.Key("port_directions");
+		json.BeginObject();
+		for(auto& i : inputs)
 		{
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			fprintf(fp, "            \"%s\": \"input\"", i.c_str());
+			json.Key(i);
+			json.String("input");
 		}
-		for(auto o : outputs)
+		for(auto& o : outputs)
 		{
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			fprintf(fp, "            \"%s\": \"output\"", o.c_str());
+			json.Key(o);
+			json.String("output");
 		}
-		for(auto io : inouts)
+		if(iobuf)
 		{
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			fprintf(fp, "            \"%s\": \"inout\"", io.c_str());
+			json.Key("IO");
+			json.String("inout");
 		}
-		fprintf(fp, "\n          },\n");
+		json.EndObject();
 
-		//Port connections for inputs
-		pfirst = true;
-		fprintf(fp, "          \"connections\": {\n");
+		//Port connections
+		json.Key("connections");
+		json.BeginObject();
 
 		//Inputs
-		for(auto i : inputs)
+		for(auto& i : inputs)
 		{
 			//Skip this port if nothing's hooked up
 			auto source = cell->GetInput(i);
 			if(source.IsNull())
 				continue;
 
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
 			//Handle cross-connections
 			auto entity = source.GetRealEntity();
 			auto xc = dynamic_cast<Greenpak4CrossConnection*>(entity);
@@ -1477,162 +1186,375 @@ bool Greenpak4Device::WriteToJSON(string fname, string top)
 				source = entity->GetInput("I");
 
 			//Look up the net number, allocate a new one if needed
-			int netnum;
-			if(netnums.find(source) != netnums.end())
-				netnum = netnums[source];
-			else
-			{
-				netnum = nextNetnum ++;
-				netnums[source] = netnum;
-			}
+			auto ins = netnums.insert(pair<string, int>(source.GetOutputName(), nextNetnum));
+			if(ins.second)
+				nextNetnum ++;
+			int netnum = ins.first->second;
 
 			//TODO: Get width of the signal and handle vectors properly!!
 
 			//Done, save it
 			//Special case for 0/1 constant nets!
+			json.Key(i);
+			json.BeginArray();
 			if( (netnum == 0) || (netnum == 1) )
-				fprintf(fp, "            \"%s\": [ \"%d\" ]", i.c_str(), netnum);
+				json.FormattedString("%d", netnum);
 			else
-				fprintf(fp, "            \"%s\": [ %d ]", i.c_str(), netnum);
+				json.Int(netnum);
+			json.EndArray();
 		}
 
 		//Outputs
-		for(auto o : outputs)
+		for(auto& o : outputs)
 		{
 			//Skip this port if nothing's hooked up
 			auto dest = cell->GetOutput(o);
 			if(dest.IsNull())
 				continue;
 
-			//Add comma if we're not the first one
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
 			//Look up the net number, allocate a new one if needed
-			int netnum;
-			if(netnums.find(dest) != netnums.end())
-				netnum = netnums[dest];
-			else
-			{
-				netnum = nextNetnum ++;
-				netnums[dest] = netnum;
-			}
+			auto ins = netnums.insert(pair<string, int>(dest.GetOutputName(), nextNetnum));
+			if(ins.second)
+				nextNetnum ++;
 
 			//TODO: Get width of the signal and handle vectors properly!!
 
 			//Done, save it
-			fprintf(fp, "            \"%s\": [ %d ]",
-				o.c_str(),
-				netnum);
+			json.Key(o);
+			json.BeginArray();
+			json.Int(ins.first->second);
+			json.EndArray();
 		}
 
 		//Hook up top level ports
+		const char* padport = NULL;
 		if(type == "GP_IBUF")
-		{
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			auto iob = dynamic_cast<Greenpak4IOB*>(cell);
-			fprintf(fp, "            \"IN\": [ %d ]\n", padToNet[iob->GetPinNumber()]);
-		}
+			padport = "IN";
 		else if(type == "GP_OBUF")
+			padport = "OUT";
+		else if(iobuf)
+			padport = "IO";
+		if(padport)
 		{
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
-			auto iob = dynamic_cast<Greenpak4IOB*>(cell);
-			fprintf(fp, "            \"OUT\": [ %d ]\n", padToNet[iob->GetPinNumber()]);
-		}
-		else if(type == "GP_IOBUF")
-		{
-			if(pfirst)
-				pfirst = false;
-			else
-				fprintf(fp, ",\n");
-
 			auto iob = dynamic_cast<Greenpak4IOB*>(cell);
-			fprintf(fp, "            \"IO\": [ %d ]\n", padToNet[iob->GetPinNumber()]);
+			json.Key(padport);
+			json.BeginArray();
+			json.Int(padToNet[iob->GetPinNumber()]);
+			json.EndArray();
 		}
 
 		//TODO: other connections to top level ports
 
-		fprintf(fp, "\n          }\n");
-		fprintf(fp, "        }");
+		json.EndObject();
+		json.EndObject();
 	}
-	fprintf(fp, "\n      },\n");
+	json.EndObject();
 
 	//Assign default auto-generated names to each net
-	fprintf(fp, "      \"netnames\": {\n");
-	fprintf(fp, "      },\n");
+	json.Key("netnames");
+	json.BeginObject();
+	json.EndObject();
 
 	//Done with module
-	fprintf(fp, "    }\n");
+	json.EndObject();
 
 	//Done
-	fprintf(fp, "  }\n");
-	fprintf(fp, "}\n");
+	json.EndObject();
+	json.EndObject();
+
+	bool ok = json.Flush() && json.IsOK();
 	fclose(fp);
-	return true;
+	if(!ok)
+		LogError("Failed to write %s\n", fname.c_str());
+	return ok;
 }
 
 /**
-	@brief Writes a bitstream to an in-memory netlist
+	@brief Finds every entity that can influence a device output
+
+	Walks the decoded routing backwards from the roots: IOBs whose output enable isn't tied low (they can drive their
+	pin) and the system reset (it affects the whole chip). Every entity driving an input of a live entity is live.
+	Cross connections and power rails are looked through, since they become wires in the netlist.
+
+	@param live		Set of live entities (masters only, never duals)
  */
-bool Greenpak4Device::WriteToBuffer(vector<uint8_t>& bitstream, uint8_t userid, bool readProtect)
+void Greenpak4Device::FindLiveEntities(unordered_set<const Greenpak4BitstreamEntity*>& live)
 {
-	bool* rawbits = new bool[m_bitlen];
-	for(unsigned int i=0; i<m_bitlen; i++)
-		rawbits[i] = false;
+	vector<Greenpak4BitstreamEntity*> worklist;
+	worklist.reserve(m_bitstuff.size());
+	auto mark = [&](Greenpak4BitstreamEntity* entity)
+	{
+		entity = entity->GetRealEntity();
+		if(live.insert(entity).second)
+			worklist.push_back(entity);
+	};
 
-	//Generate the bitstream, abort if it fails
-	if(!GenerateBitstream(rawbits, userid, readProtect))
+	//Find the roots
+	for(auto it : m_iobs)
 	{
-		delete[] rawbits;
-		return false;
+		auto oe = it.second->GetOutputEnable();
+		if(oe.IsPowerRail() && !oe.GetPowerRailValue())
+			continue;
+		mark(it.second);
 	}
+	if(m_sysrst)
+		mark(m_sysrst);
 
-	for(size_t index=0; index<m_bitlen; index++)
+	//Walk back through the drivers
+	while(!worklist.empty())
 	{
-		int byteindex = index / 8;
-		if(byteindex >= (int)bitstream.size())
-			bitstream.resize(byteindex + 1, 0);
-		bool value = rawbits[index];
-		bitstream[byteindex] |= (value << (index % 8));
+		auto entity = worklist.back();
+		worklist.pop_back();
+
+		for(auto& port : entity->GetAllInputPorts())
+		{
+			auto source = entity->GetInput(port);
+			if(source.IsNull() || source.IsPowerRail())
+				continue;
+
+			auto driver = source.GetRealEntity();
+			if(dynamic_cast<Greenpak4CrossConnection*>(driver))
+			{
+				source = driver->GetInput("I");
+				if(source.IsNull() || source.IsPowerRail())
+					continue;
+				driver = source.GetRealEntity();
+			}
+
+			mark(driver);
+		}
 	}
+}
+
+/**
+	@brief Writes a bitstream to an in-memory netlist
+ */
+bool Greenpak4Device::WriteToBuffer(vector<uint8_t>& bitstream, uint8_t userid, bool readProtect)
+{
+	//Generate the bitstream, abort if it fails
+	if(!UpdateBitstream(userid, readProtect))
+		return false;
+
+	if(bitstream.size() < m_image.size())
+		bitstream.resize(m_image.size(), 0);
+	for(size_t i=0; i<m_image.size(); i++)
+		bitstream[i] |= m_image[i];
 
-	//Clean up
-	delete[] rawbits;
 	return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Incremental bitstream generation
+
+//Filler for the probe buffer. Neither true (1) nor false (0), so any store by Save() shows up when read back as a byte.
+static const uint8_t g_probeFill = 0xa5;
+
+void Greenpak4Device::InvalidateBitstream()
+{
+	for(auto x : m_bitstuff)
+		x->MarkDirty();
+	m_chipConfigDirty = true;
+}
+
 /**
-	@brief Generates an in-memory bitstream image
+	@brief Brings the cached bitstream image up to date.
+
+	Only writers (see m_imageBits) which changed since the last call are re-serialized, along with any other writer
+	sharing a bit with one of them so that the image stays identical to one generated from scratch. Afterwards
+	GetBitstreamImage() holds the packed image and GetBitstreamDelta() the bytes which changed.
 
-	@param bitstream	Raw bit array
 	@param userid		ID code to write to the "user ID" area of the bitstream
 	@param readProtect	True to disable readout of the design
  */
-bool Greenpak4Device::GenerateBitstream(bool* bitstream, uint8_t userid, bool readProtect)
+bool Greenpak4Device::UpdateBitstream(uint8_t userid, bool readProtect)
 {
+	unsigned int chipWriter = m_bitstuff.size();
+	unsigned int nwriters = chipWriter + 1;
+
+	//First call: allocate the image and serialize everything
+	if(m_imageBits == NULL)
+	{
+		//According to phone conversation w Silego FAE, 0 is legal default state for everything incl reserved bits
+		//All IOs will be floating digital inputs
+		m_imageBits = new bool[m_bitlen];
+		for(unsigned int i=0; i<m_bitlen; i++)
+			m_imageBits[i] = false;
+
+		m_probeBits = new bool[m_bitlen];
+		memset(m_probeBits, g_probeFill, m_bitlen);
+
+		m_image.assign((m_bitlen + 7) / 8, 0);
+		m_writerBits.resize(nwriters);
+		m_bitWriters.resize(m_bitlen);
+		InvalidateBitstream();
+	}
+
+	if( (userid != m_imageUserID) || (readProtect != m_imageReadProtect) )
+	{
+		m_imageUserID = userid;
+		m_imageReadProtect = readProtect;
+		m_chipConfigDirty = true;
+	}
+
+	//Start with the writers which changed
+	vector<bool> pending(nwriters, false);
+	vector<unsigned int> worklist;
+	for(unsigned int i=0; i<chipWriter; i++)
+	{
+		if(m_bitstuff[i]->IsDirty())
+		{
+			pending[i] = true;
+			worklist.push_back(i);
+		}
+	}
+	if(m_chipConfigDirty)
+	{
+		pending[chipWriter] = true;
+		worklist.push_back(chipWriter);
+	}
+
+	//Serialize each of them into the probe buffer. Anyone else who wrote one of the bits they used to or now write
+	//has to be replayed as well, since the order of overlapping writes decides the final value.
 	bool ok = true;
+	vector<bool> failed(nwriters, false);
+	map<unsigned int, vector< pair<unsigned int, bool> > > newbits;
+	while(!worklist.empty())
+	{
+		unsigned int w = worklist.back();
+		worklist.pop_back();
 
-	//Get the config data from each of our blocks
-	for(auto x : m_bitstuff)
+		auto& bits = newbits[w];
+		if(!ProbeWriter(w, bits))
+		{
+			failed[w] = true;
+			ok = false;
+		}
+
+		vector<unsigned int> used = m_writerBits[w];
+		for(auto b : bits)
+			used.push_back(b.first);
+		for(auto b : used)
+		{
+			for(auto other : m_bitWriters[b])
+			{
+				if(!pending[other])
+				{
+					pending[other] = true;
+					worklist.push_back(other);
+				}
+			}
+		}
+	}
+
+	//Clear everything the replayed writers used to own
+	vector<unsigned int> touched;
+	for(auto& it : newbits)
+	{
+		unsigned int w = it.first;
+		for(auto b : m_writerBits[w])
+		{
+			m_imageBits[b] = false;
+			auto& writers = m_bitWriters[b];
+			writers.erase(remove(writers.begin(), writers.end(), w), writers.end());
+			touched.push_back(b / 8);
+		}
+		m_writerBits[w].clear();
+	}
+
+	//then replay them in order (map iteration is sorted by writer index)
+	for(auto& it : newbits)
+	{
+		unsigned int w = it.first;
+		for(auto b : it.second)
+		{
+			m_imageBits[b.first] = b.second;
+			m_bitWriters[b.first].push_back(w);
+			m_writerBits[w].push_back(b.first);
+			touched.push_back(b.first / 8);
+		}
+
+		//Failed writers stay dirty so they get retried (and complain again) next time
+		if(failed[w])
+			continue;
+		if(w == chipWriter)
+			m_chipConfigDirty = false;
+		else
+			m_bitstuff[w]->ClearDirty();
+	}
+
+	//Repack the bytes we touched and record which of them actually changed
+	sort(touched.begin(), touched.end());
+	touched.erase(unique(touched.begin(), touched.end()), touched.end());
+	m_imageDelta.clear();
+	for(auto i : touched)
+	{
+		uint8_t value = 0;
+		for(unsigned int j=0; (j < 8) && (i*8 + j < m_bitlen); j++)
+		{
+			if(m_imageBits[i*8 + j])
+				value |= (1 << j);
+		}
+		if(value == m_image[i])
+			continue;
+		m_image[i] = value;
+
+		if(!m_imageDelta.empty() && (m_imageDelta.back().m_offset + m_imageDelta.back().m_length == i) )
+			m_imageDelta.back().m_length ++;
+		else
+			m_imageDelta.push_back(ByteRange{i, 1});
+	}
+
+	return ok;
+}
+
+/**
+	@brief Serializes one writer into the probe buffer and collects the bits it stored to
+
+	The probe buffer is kept filled with g_probeFill. Save() only ever stores to the buffer, never reads it, so the
+	filler is never seen as a bool; reading the buffer back as bytes tells us exactly which bits were written.
+
+	@param writer	Index of the writer (see m_imageBits)
+	@param bits		(bit index, value) for every bit the writer stored to, sorted by bit index
+ */
+bool Greenpak4Device::ProbeWriter(unsigned int writer, vector< pair<unsigned int, bool> >& bits)
+{
+	bool ok = true;
+	if(writer < m_bitstuff.size())
 	{
-		if(!x->Save(bitstream))
+		auto x = m_bitstuff[writer];
+		if(!x->Save(m_probeBits))
 		{
 			LogError("Bitstream node %s failed to save\n", x->GetDescription().c_str());
 			ok = false;
 		}
 	}
+	else
+		ok = WriteChipConfig(m_probeBits, m_imageUserID, m_imageReadProtect);
+
+	auto raw = reinterpret_cast<uint8_t*>(m_probeBits);
+	bits.clear();
+	for(unsigned int i=0; i<m_bitlen; i++)
+	{
+		if(raw[i] == g_probeFill)
+			continue;
+		bits.push_back(pair<unsigned int, bool>(i, raw[i] != 0));
+		raw[i] = g_probeFill;
+	}
+
+	return ok;
+}
+
+/**
+	@brief Writes chip-wide tuning data and ID code
+
+	@param bitstream	Raw bit array
+	@param userid		ID code to write to the "user ID" area of the bitstream
+	@param readProtect	True to disable readout of the design
+ */
+bool Greenpak4Device::WriteChipConfig(bool* bitstream, uint8_t userid, bool readProtect)
+{
+	bool ok = true;
 
-	//Write chip-wide tuning data and ID code
 	switch(m_part)
 	{
 		case GREENPAK4_SLG46621:
@@ -1834,7 +1756,7 @@ void Greenpak4Device::PrintTimingData() const
 		b->PrintTimingData();
 }
 
-void Greenpak4Device::SaveTimingData(string fname)
+void Greenpak4Device::SaveTimingData(string fname, bool pretty)
 {
 	FILE* fp = fopen(fname.c_str(), "w");
 	if(!fp)
@@ -1842,22 +1764,32 @@ void Greenpak4Device::SaveTimingData(string fname)
 		LogError("Couldn't open timing data file %s\n", fname.c_str());
 		return;
 	}
+	Greenpak4JSONWriter json(fp, pretty, 4);
 
 	//Header
-	fprintf(fp, "{\n");
-	fprintf(fp, "    \"part\" : \"%s\",\n", GetPartAsString().c_str());
+	json.BeginObject();
+	json.Key("part");
+	json.String(GetPartAsString());
 
 	//Timing data for each IP block
-	for(size_t i=0; i<m_bitstuff.size(); i++)
-		m_bitstuff[i]->SaveTimingData(fp, (i+1) == m_bitstuff.size());
+	for(auto x : m_bitstuff)
+		x->SaveTimingData(json);
 
 	//Footer
-	fprintf(fp, "}\n");
+	json.EndObject();
+	if(!json.Flush())
+		LogError("Failed to write timing data file %s\n", fname.c_str());
 	fclose(fp);
 }
 
+/**
+	@brief Loads timing data from a file, which may be either JSON or a compiled database
+ */
 bool Greenpak4Device::LoadTimingData(string fname)
 {
+	if(Greenpak4TimingDatabase::IsDatabase(fname))
+		return LoadTimingDatabase(fname);
+
 	//Read it
 	FILE* fp = fopen(fname.c_str(), "rb");
 	if(fp == NULL)
@@ -1914,6 +1846,30 @@ bool Greenpak4Device::LoadTimingData(string fname)
 	return true;
 }
 
+/**
+	@brief Loads a compiled timing database (see Greenpak4TimingDatabase)
+ */
+bool Greenpak4Device::LoadTimingDatabase(string fname)
+{
+	Greenpak4TimingDatabase* db = new Greenpak4TimingDatabase;
+	if(!db->Load(fname, this))
+	{
+		delete db;
+		return false;
+	}
+	m_timingDatabases.push_back(db);
+	m_hasTimingData = true;
+	return true;
+}
+
+/**
+	@brief Compiles our current timing data into a database
+ */
+bool Greenpak4Device::SaveTimingDatabase(string fname)
+{
+	return Greenpak4TimingDatabase::Write(fname, this);
+}
+
 bool Greenpak4Device::LoadTimingData(json_object* object)
 {
 	//Make a map of description -> entity
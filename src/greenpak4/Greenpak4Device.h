@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <vector>
 #include <map>
+#include <unordered_set>
 
 /**
 	@brief Top level class for an entire Silego Greenpak4 device
@@ -47,24 +48,75 @@ public:
 	//Initialize this device from a bitfile
 	bool ReadFromFile(std::string fname);
 
+	//Guess which part a bitfile was generated for, from its length
+	static bool DetectPart(std::string fname, GREENPAK4_PART& part);
+
 	//Write our config to a bitfile
 	bool WriteToFile(std::string fname, uint8_t userid, bool readProtect);
 
 	//Write our config to a cell-level JSON netlist
-	bool WriteToJSON(std::string fname, std::string top);
+	bool WriteToJSON(std::string fname, std::string top, bool pretty = true, bool pruneUnused = false);
+
+	//Find every entity that can influence a device output
+	void FindLiveEntities(std::unordered_set<const Greenpak4BitstreamEntity*>& live);
 
 	//Write to an in-memory array
 	bool WriteToBuffer(std::vector<uint8_t>& bitstream, uint8_t userid, bool readProtect);
 
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Incremental bitstream generation
+
+	///A run of bytes in the packed bitstream
+	struct ByteRange
+	{
+		unsigned int m_offset;
+		unsigned int m_length;
+	};
+
+	//Bring the cached packed image up to date, re-serializing only entities marked dirty since the last call
+	bool UpdateBitstream(uint8_t userid, bool readProtect);
+
+	//Force the next UpdateBitstream() to re-serialize everything (needed after Load())
+	void InvalidateBitstream();
+
+	/**
+		@brief Returns the packed image from the last UpdateBitstream() call (bit i of the bitstream is bit i%8 of byte
+		i/8, same as WriteToBuffer()).
+	 */
+	const std::vector<uint8_t>& GetBitstreamImage() const
+	{ return m_image; }
+
+	/**
+		@brief Returns the bytes of the packed image which changed in the last UpdateBitstream() call.
+
+		The first call reports every nonzero byte, i.e. the delta against an all-zeros image.
+	 */
+	const std::vector<ByteRange>& GetBitstreamDelta() const
+	{ return m_imageDelta; }
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Config accessors
 
 	GREENPAK4_PART GetPart()
 	{ return m_part; }
 
-	std::string GetPartAsString();
+	std::string GetPartAsString()
+	{ return GetPartAsString(m_part); }
+
+	static std::string GetPartAsString(GREENPAK4_PART part);
+
+	unsigned int GetBitstreamLength()
+	{ return m_bitlen; }
+
+	//Static description of a part's resources and dedicated routing
+	static const Greenpak4DeviceTable* GetDeviceTable(GREENPAK4_PART part);
 
-	//TODO: save and query userid from bitstream
+	const Greenpak4DeviceTable* GetTable()
+	{ return m_table; }
+
+	//User ID code of the last bitstream loaded with ReadFromFile()
+	uint8_t GetUserID()
+	{ return m_userid; }
 
 	//TODO: read protection, precharge, etc, cal, etc status
 
@@ -111,6 +163,10 @@ public:
 	Greenpak4CrossConnection* GetCrossConnection(unsigned int src_matrix, unsigned int index)
 	{ return m_crossConnections[src_matrix][index]; }
 
+	//Number of cross connections from each matrix to the other
+	unsigned int GetCrossConnectionCount()
+	{ return m_table->m_crossConnectionCount; }
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// LUTS
 
@@ -329,6 +385,8 @@ public:
 	Greenpak4BitstreamEntity* GetEntity(unsigned int i)
 	{ return m_bitstuff[i]; }
 
+	Greenpak4BitstreamEntity* GetRouteEntity(Greenpak4RouteEntityType type, unsigned int index);
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// CONFIGURATION
 
@@ -345,19 +403,23 @@ public:
 	// TIMING
 
 	void PrintTimingData() const;
-	void SaveTimingData(std::string fname);
+	void SaveTimingData(std::string fname, bool pretty = true);
 	bool LoadTimingData(json_object* object);
 	bool LoadTimingData(std::string fname);
+	bool LoadTimingDatabase(std::string fname);
+	bool SaveTimingDatabase(std::string fname);
 
 	bool HasTimingData()
 	{ return m_hasTimingData; }
 
 protected:
 
-	bool GenerateBitstream(bool* bitstream, uint8_t userid, bool readProtect);
+	bool WriteChipConfig(bool* bitstream, uint8_t userid, bool readProtect);
+	bool ProbeWriter(unsigned int writer, std::vector< std::pair<unsigned int, bool> >& bits);
 
 	void CreateDevice_SLG46140();
 	void CreateDevice_SLG4662x(bool dual_rail);
+	void CreateDevice_FromTable(bool dual_rail);
 	void CreateDevice_common();
 
 	///The part number
@@ -517,6 +579,49 @@ protected:
 		@brief True if we have static timing data
 	 */
 	bool m_hasTimingData;
+
+	///Compiled timing databases our delay tables are attached to
+	std::vector<Greenpak4TimingDatabase*> m_timingDatabases;
+
+	///User ID code of the last bitstream we read
+	uint8_t m_userid;
+
+	///Static description of our part (owned by the table, never freed)
+	const Greenpak4DeviceTable* m_table;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Cached bitstream image
+
+	/*
+		The image is built by "writers": writer i < m_bitstuff.size() is m_bitstuff[i]->Save(), and the last writer is
+		the chip-wide configuration from WriteChipConfig(). Writers are applied in that order, so when two of them share
+		a bit the later one wins, exactly as if the whole bitstream had been generated from scratch.
+	 */
+
+	///Unpacked image, one bool per bit (NULL until the first UpdateBitstream() call)
+	bool* m_imageBits;
+
+	///Scratch buffer used by ProbeWriter() to find out which bits a writer touches
+	bool* m_probeBits;
+
+	///Packed image
+	std::vector<uint8_t> m_image;
+
+	///Bytes which changed in the last UpdateBitstream() call
+	std::vector<ByteRange> m_imageDelta;
+
+	///Bits each writer stored to when it was last serialized
+	std::vector< std::vector<unsigned int> > m_writerBits;
+
+	///Writers which stored to each bit when they were last serialized
+	std::vector< std::vector<unsigned int> > m_bitWriters;
+
+	///True if the chip-wide configuration changed since the image was last updated
+	bool m_chipConfigDirty;
+
+	///User ID and read protection flag the image was built with
+	uint8_t m_imageUserID;
+	bool m_imageReadProtect;
 };
 
 #endif
@@ -0,0 +1,609 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <Greenpak4.h>
+
+#define GP4_TABLE(x) { x, sizeof(x) / sizeof(x[0]) }
+#define GP4_TABLE_EMPTY { NULL, 0 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SLG46140
+
+//LUT2s (4 total) then LUT3s (4 total).
+//The LUT3s are kept in the LUT2 list for compatibility with existing bitstreams / placements.
+static const Greenpak4LUTInfo g_slg46140_lut2s[] =
+{
+	//num	matrix	ibase	oword	cbase	order
+	{ 0,	0,		0,		1,		848,	2 },
+	{ 1,	0,		2,		2,		852,	2 },
+	{ 2,	0,		4,		3,		856,	2 },
+	{ 3,	0,		6,		4,		860,	2 },
+	{ 0,	0,		12,		7,		874,	3 },
+	{ 1,	0,		15,		8,		882,	3 },
+	{ 2,	0,		18,		9,		890,	3 },
+	{ 3,	0,		21,		10,		898,	3 },
+};
+
+static const Greenpak4IOBInfo g_slg46140_iobs[] =
+{
+	//pin	typeA	matrix	ibase	oword	cbase	flags								1rail	analog
+	{ 2,	true,	0,		GP4_TABLE_NONE,	22,		761,	Greenpak4IOB::IOB_FLAG_INPUTONLY,	false,	GP4_TABLE_NONE },
+	{ 3,	true,	0,		44,		23,		766,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 4,	true,	0,		46,		24,		773,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 5,	true,	0,		48,		25,		780,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 7,	true,	0,		51,		27,		795,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 9,	true,	0,		53,		28,		802,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 12,	true,	0,		57,		31,		827,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 13,	true,	0,		59,		32,		834,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 14,	true,	0,		61,		33,		841,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 6,	false,	0,		50,		26,		788,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 10,	false,	0,		55,		29,		811,	Greenpak4IOB::IOB_FLAG_X4DRIVE,		false,	GP4_TABLE_NONE },
+	{ 11,	false,	0,		56,		30,		820,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+};
+
+//TODO: DFFs, shift registers, counters, DACs, comparators (offsets not yet verified on silicon)
+
+static const Greenpak4BlockInfo g_slg46140_delays[] =
+{
+	//matrix	ibase	oword	cbase
+	{ 0,		43,		21,		486 },
+};
+
+//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
+static const Greenpak4VrefInfo g_slg46140_vrefs[] =
+{
+	{ 2,	GP4_TABLE_NONE },
+	{ 3,	GP4_TABLE_NONE },
+};
+
+static const Greenpak4DeviceTable g_slg46140 =
+{
+	6,				//64 inputs per routing matrix
+	1024,			//bitstream length
+	{ 0, 0 },		//matrix base (no matrix 1, initialize for completeness's sake)
+	0, 0, 0,		//no cross connections
+
+	GP4_TABLE(g_slg46140_lut2s),
+	GP4_TABLE_EMPTY,
+	GP4_TABLE(g_slg46140_iobs),
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+	GP4_TABLE(g_slg46140_delays),
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+	GP4_TABLE(g_slg46140_vrefs),
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY,
+
+	GP4_TABLE_EMPTY,
+	GP4_TABLE_EMPTY
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SLG46620 / SLG46621
+
+static const Greenpak4LUTInfo g_slg4662x_lut2s[] =
+{
+	//num	matrix	ibase	oword	cbase	order
+	{ 0,	0,		0,		1,		576,	2 },
+	{ 1,	0,		2,		2,		580,	2 },
+	{ 2,	0,		4,		3,		584,	2 },
+	{ 3,	0,		6,		4,		588,	2 },
+	{ 4,	1,		0,		1,		698,	2 },
+	{ 5,	1,		2,		2,		702,	2 },
+	{ 6,	1,		4,		3,		706,	2 },
+	{ 7,	1,		6,		4,		710,	2 },
+};
+
+static const Greenpak4LUTInfo g_slg4662x_lut3s[] =
+{
+	//num	matrix	ibase	oword	cbase	order
+	{ 0,	0,		8,		5,		592,	3 },
+	{ 1,	0,		11,		6,		600,	3 },
+	{ 2,	0,		14,		7,		608,	3 },
+	{ 3,	0,		17,		8,		616,	3 },
+	{ 4,	0,		20,		9,		624,	3 },
+	{ 5,	0,		23,		10,		632,	3 },
+	{ 6,	0,		26,		11,		640,	3 },
+	{ 7,	0,		29,		12,		648,	3 },
+	{ 8,	1,		8,		5,		714,	3 },
+	{ 9,	1,		11,		6,		722,	3 },
+	{ 10,	1,		14,		7,		730,	3 },
+	{ 11,	1,		17,		8,		738,	3 },
+	{ 12,	1,		20,		9,		746,	3 },
+	{ 13,	1,		23,		10,		754,	3 },
+	{ 14,	1,		26,		11,		762,	3 },
+	{ 15,	1,		29,		12,		770,	3 },
+};
+
+//Pin 14 is a used as VCCIO in the SLG46621, the GPIO driver is not bonded out
+static const Greenpak4IOBInfo g_slg4662x_iobs[] =
+{
+	//pin	typeA	matrix	ibase	oword	cbase	flags								1rail	analog
+	{ 2,	true,	0,		GP4_TABLE_NONE,	24,		941,	Greenpak4IOB::IOB_FLAG_INPUTONLY,	false,	GP4_TABLE_NONE },
+	{ 3,	true,	0,		56,		25,		946,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 5,	true,	0,		59,		27,		960,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 7,	true,	0,		62,		29,		974,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 9,	true,	0,		65,		31,		988,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 10,	true,	0,		67,		32,		995,	Greenpak4IOB::IOB_FLAG_X4DRIVE,		false,	GP4_TABLE_NONE },
+	{ 13,	true,	1,		57,		25,		1919,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 14,	true,	1,		59,		26,		1926,	Greenpak4IOB::IOB_FLAG_NORMAL,		true,	GP4_TABLE_NONE },
+	{ 16,	true,	1,		62,		28,		1940,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 18,	true,	1,		65,		30,		1954,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	876 },
+	{ 19,	true,	1,		67,		31,		1961,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	878 },
+	{ 4,	false,	0,		58,		26,		953,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 6,	false,	0,		61,		28,		967,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 8,	false,	0,		64,		30,		981,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 12,	false,	1,		56,		24,		1911,	Greenpak4IOB::IOB_FLAG_X4DRIVE,		false,	GP4_TABLE_NONE },
+	{ 15,	false,	1,		61,		27,		1933,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 17,	false,	1,		64,		29,		1947,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+	{ 20,	false,	1,		69,		32,		1968,	Greenpak4IOB::IOB_FLAG_NORMAL,		false,	GP4_TABLE_NONE },
+};
+
+//NOTE: Datasheet bug
+//Figure 42 of SLG46620_DS_r075 (page 97) says DFF5 config range is bits 708-710
+//but this collides with LUT2_7 and does not reflect actual silicon behavior.
+//Actual range is bits 695-697 (listed on page 151)
+static const Greenpak4FlipflopInfo g_slg4662x_flipflops[] =
+{
+	//num	hasSR	matrix	ibase	oword	cbase
+	{ 0,	true,	0,		36,		14,		677 },
+	{ 1,	true,	0,		39,		15,		681 },
+	{ 2,	true,	0,		42,		16,		685 },
+	{ 3,	false,	0,		45,		17,		689 },
+	{ 4,	false,	0,		47,		18,		692 },
+	{ 5,	false,	0,		49,		19,		695 },
+	{ 6,	true,	1,		36,		14,		794 },
+	{ 7,	true,	1,		39,		15,		798 },
+	{ 8,	true,	1,		42,		16,		802 },
+	{ 9,	false,	1,		45,		17,		806 },
+	{ 10,	false,	1,		47,		18,		809 },
+	{ 11,	false,	1,		49,		19,		812 },
+};
+
+static const Greenpak4BlockInfo g_slg4662x_shregs[] =
+{
+	//matrix	ibase	oword	cbase
+	{ 0,		51,		20,		1610 },
+	{ 1,		51,		20,		1619 },
+};
+
+static const Greenpak4BlockInfo g_slg4662x_delays[] =
+{
+	//matrix	ibase	oword	cbase
+	{ 0,		54,		22,		1600 },
+	{ 1,		54,		22,		1605 },
+};
+
+static const Greenpak4BlockInfo g_slg4662x_inverters[] =
+{
+	//matrix	ibase	oword	cbase
+	{ 0,		55,		23,		GP4_TABLE_NONE },
+	{ 1,		55,		23,		GP4_TABLE_NONE },
+};
+
+static const Greenpak4CounterInfo g_slg4662x_counters[] =
+{
+	//depth	fsm		wspwrdn	edge	pwm		num		matrix	ibase	oword	cbase
+	{ 14,	false,	true,	false,	false,	0,		0,		74,		36,		1731 },
+	{ 14,	false,	false,	false,	false,	1,		1,		75,		36,		1753 },
+	{ 14,	true,	false,	true,	false,	2,		0,		75,		37,		1774 },
+	{ 14,	false,	false,	false,	false,	3,		1,		76,		37,		1799 },	//datasheet has a typo, cbase is correct
+	{ 8,	true,	false,	false,	false,	4,		1,		77,		38,		1820 },
+	{ 8,	false,	false,	false,	false,	5,		0,		78,		38,		1838 },
+	{ 8,	false,	false,	false,	false,	6,		0,		79,		39,		1852 },
+	{ 8,	false,	false,	false,	false,	7,		1,		80,		39,		1866 },	//datasheet has a typo, matrix is correct
+	{ 8,	false,	false,	false,	true,	8,		1,		81,		40,		1880 },
+	{ 8,	false,	false,	false,	true,	9,		0,		80,		40,		1895 },
+};
+
+static const Greenpak4DACInfo g_slg4662x_dacs[] =
+{
+	//reg	pwr		insel	aon		num
+	{ 844,	840,	843,	840,	0 },
+	{ 823,	834,	883,	840,	1 },
+};
+
+static const Greenpak4VrefInfo g_slg4662x_vrefs[] =
+{
+	//Voltage references for comparators
+	{ 0,	1 },
+	{ 1,	2 },
+	{ 2,	1 },
+	{ 3,	2 },
+	{ 4,	GP4_TABLE_NONE },
+	{ 5,	GP4_TABLE_NONE },
+
+	//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
+	{ 6,	GP4_TABLE_NONE },
+	{ 7,	GP4_TABLE_NONE },
+};
+
+//TODO speed doubler for ACMP5? Need to double check latest datasheet, this may have been changed
+static const Greenpak4ComparatorInfo g_slg4662x_acmps[] =
+{
+	//num	matrix	ibase	oword	isrc	bw		gain	vin		hyst	vref
+	{ 0,	0,		69,		33,		832,	852,	853,	855,	934,	892 },
+	{ 1,	1,		70,		33,		831,	861,	857,	859,	932,	897 },
+	{ 2,	1,		71,		34,		0,		862,	864,	863,	930,	902 },
+	{ 3,	1,		72,		35,		0,		866,	867,	869,	928,	907 },
+	{ 4,	0,		70,		34,		0,		875,	871,	873,	926,	912 },
+	{ 5,	0,		71,		35,		0,		880,	0,		0,		924,	917 },
+};
+
+static const Greenpak4DigitalComparatorInfo g_slg4662x_dcmps[] =
+{
+	//num	matrix	ibase	oword	cbase
+	{ 0,	1,		82,		42,		1670 },
+	{ 1,	1,		82,		44,		1691 },
+	{ 2,	1,		82,		46,		1711 },
+};
+
+//SLG46620 datasheet r100 page 140-141 fig 94-95 are wrong.
+//reg0 base is 1723, not 1725
+static const Greenpak4DCMPRefInfo g_slg4662x_dcmprefs[] =
+{
+	{ 0,	1723 },
+	{ 1,	1703 },
+	{ 2,	1683 },
+	{ 3,	1662 },
+};
+
+//Clock buffer 5 (the muxed clock buffer for ADC and PWM) is a singleton and created separately
+static const Greenpak4ClockBufferInfo g_slg4662x_clkbufs[] =
+{
+	//num	matrix	ibase
+	{ 0,	0,		72 },	//clk_matrix0
+	{ 1,	0,		73 },	//clk_matrix1
+	{ 2,	1,		73 },	//clk_matrix2
+	{ 3,	1,		74 },	//clk_matrix3
+	{ 4,	0,		83 },	//SPI SCK
+};
+
+static const Greenpak4MuxEntry g_slg4662x_muxes[] =
+{
+	//Clock mux buffer for ADC and PWM
+	{ { ROUTE_CLKBUF,	5,	"IN" },		{ ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	0 },
+	{ { ROUTE_CLKBUF,	5,	"IN" },		{ ROUTE_CLKBUF,		2,	"OUT" },			1 },
+	{ { ROUTE_CLKBUF,	5,	"IN" },		{ ROUTE_RCOSC,		0,	"CLKOUT_HARDIP" },	2 },
+	{ { ROUTE_CLKBUF,	5,	"IN" },		{ ROUTE_CLKBUF,		4,	"OUT" },			3 },
+
+	//DCMP0 (inp 0 is ADC, not implemented)
+	{ { ROUTE_DCMP,		0,	"INP" },	{ ROUTE_SPI,		0,	"RXD_HIGH" },		1 },
+	{ { ROUTE_DCMP,		0,	"INP" },	{ ROUTE_COUNTER,	2,	"POUT" },			2 },
+	{ { ROUTE_DCMP,		0,	"INP" },	{ ROUTE_DCMPMUX,	0,	"OUTA" },			3 },
+	{ { ROUTE_DCMP,		0,	"INN" },	{ ROUTE_COUNTER,	8,	"POUT" },			0 },
+	{ { ROUTE_DCMP,		0,	"INN" },	{ ROUTE_DCMPREF,	0,	"OUT" },			1 },
+	{ { ROUTE_DCMP,		0,	"INN" },	{ ROUTE_SPI,		0,	"RXD_LOW" },		2 },
+	{ { ROUTE_DCMP,		0,	"INN" },	{ ROUTE_COUNTER,	4,	"POUT" },			3 },
+
+	//DCMP1 (in0 is ADC, not implemented)
+	{ { ROUTE_DCMP,		1,	"INP" },	{ ROUTE_SPI,		0,	"RXD_LOW" },		1 },
+	{ { ROUTE_DCMP,		1,	"INP" },	{ ROUTE_COUNTER,	4,	"POUT" },			2 },
+	{ { ROUTE_DCMP,		1,	"INP" },	{ ROUTE_DCMPREF,	1,	"OUT" },			3 },
+	{ { ROUTE_DCMP,		1,	"INN" },	{ ROUTE_COUNTER,	9,	"POUT" },			0 },
+	{ { ROUTE_DCMP,		1,	"INN" },	{ ROUTE_DCMPMUX,	0,	"OUTB" },			1 },
+	{ { ROUTE_DCMP,		1,	"INN" },	{ ROUTE_SPI,		0,	"RXD_LOW" },		2 },
+	{ { ROUTE_DCMP,		1,	"INN" },	{ ROUTE_COUNTER,	2,	"POUT" },			3 },
+
+	//DCMP2 (in0 is ADC, not implemented)
+	{ { ROUTE_DCMP,		2,	"INP" },	{ ROUTE_SPI,		0,	"RXD_HIGH" },		1 },
+	{ { ROUTE_DCMP,		2,	"INP" },	{ ROUTE_COUNTER,	4,	"POUT" },			2 },
+	{ { ROUTE_DCMP,		2,	"INP" },	{ ROUTE_DCMPREF,	3,	"OUT" },			3 },
+	{ { ROUTE_DCMP,		2,	"INN" },	{ ROUTE_COUNTER,	8,	"POUT" },			0 },
+	{ { ROUTE_DCMP,		2,	"INN" },	{ ROUTE_DCMPREF,	2,	"OUT" },			1 },
+	{ { ROUTE_DCMP,		2,	"INN" },	{ ROUTE_SPI,		0,	"RXD_LOW" },		2 },
+	{ { ROUTE_DCMP,		2,	"INN" },	{ ROUTE_COUNTER,	2,	"POUT" },			3 },
+
+	//Comparator input routing
+	{ { ROUTE_ACMP,		0,	"VIN" },	{ ROUTE_IOB,		6,	"OUT" },			0 },
+	{ { ROUTE_ACMP,		0,	"VIN" },	{ ROUTE_ABUF,		0,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		0,	"VIN" },	{ ROUTE_POWER,		1,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		1,	"VIN" },	{ ROUTE_IOB,		12,	"OUT" },			0 },
+	{ { ROUTE_ACMP,		1,	"VIN" },	{ ROUTE_PGA,		0,	"VOUT" },			1 },
+	{ { ROUTE_ACMP,		1,	"VIN" },	{ ROUTE_IOB,		6,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		1,	"VIN" },	{ ROUTE_ABUF,		0,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		1,	"VIN" },	{ ROUTE_POWER,		1,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		2,	"VIN" },	{ ROUTE_IOB,		13,	"OUT" },			0 },
+	{ { ROUTE_ACMP,		2,	"VIN" },	{ ROUTE_IOB,		6,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		2,	"VIN" },	{ ROUTE_ABUF,		0,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		2,	"VIN" },	{ ROUTE_POWER,		1,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		3,	"VIN" },	{ ROUTE_IOB,		15,	"OUT" },			0 },
+	{ { ROUTE_ACMP,		3,	"VIN" },	{ ROUTE_IOB,		13,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		3,	"VIN" },	{ ROUTE_IOB,		6,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		3,	"VIN" },	{ ROUTE_ABUF,		0,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		3,	"VIN" },	{ ROUTE_POWER,		1,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		4,	"VIN" },	{ ROUTE_IOB,		3,	"OUT" },			0 },
+	{ { ROUTE_ACMP,		4,	"VIN" },	{ ROUTE_IOB,		15,	"OUT" },			1 },
+	{ { ROUTE_ACMP,		4,	"VIN" },	{ ROUTE_IOB,		6,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		4,	"VIN" },	{ ROUTE_ABUF,		0,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		4,	"VIN" },	{ ROUTE_POWER,		1,	"OUT" },			2 },
+	{ { ROUTE_ACMP,		5,	"VIN" },	{ ROUTE_IOB,		4,	"OUT" },			0 },
+};
+
+//TODO: Disable clock outputs to dedicated routing in matrix 1 if SPI slave is enabled?
+static const Greenpak4DedicatedRoute g_slg4662x_routes[] =
+{
+	//Clock inputs to counters
+	//TODO: other clock sources
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	0,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	0,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	0,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	1,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	1,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	1,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	2,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	2,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	2,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	3,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	3,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	3,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	4,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	4,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	4,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	5,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	5,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	5,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	6,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	6,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	6,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	7,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	7,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	7,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	8,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	8,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	8,	"CLK" },		0 },
+	{ { ROUTE_LFOSC,	0,	"CLKOUT" },			{ ROUTE_COUNTER,	9,	"CLK" },		0 },
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	9,	"CLK" },		0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_COUNTER,	9,	"CLK" },		0 },
+
+	//System reset: can drive reset with ground or pin 2 only
+	{ { ROUTE_IOB,		2,	"OUT" },			{ ROUTE_SYSRST,		0,	"RST" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_SYSRST,		0,	"RST" },		0 },
+
+	//Reference out: VREF0/1 can drive pin 19, VREF2/3 can drive pin 18
+	{ { ROUTE_VREF,		0,	"VOUT" },			{ ROUTE_IOB,		19,	"IN" },			0 },
+	{ { ROUTE_VREF,		1,	"VOUT" },			{ ROUTE_IOB,		19,	"IN" },			0 },
+	{ { ROUTE_VREF,		2,	"VOUT" },			{ ROUTE_IOB,		18,	"IN" },			0 },
+	{ { ROUTE_VREF,		3,	"VOUT" },			{ ROUTE_IOB,		18,	"IN" },			0 },
+
+	//All comparator references can be driven by Vdd (for Vdd/3 and Vdd/4) and Vss (for constant voltages)
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+
+	//DAC references can be driven by Vss only
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		6,	"VIN" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_VREF,		7,	"VIN" },		0 },
+
+	//External pins to references (pin 14 is skipped on the SLG46621)
+	{ { ROUTE_IOB,		7,	"OUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_IOB,		7,	"OUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_IOB,		14,	"OUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_IOB,		14,	"OUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_IOB,		14,	"OUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+	{ { ROUTE_IOB,		5,	"OUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+
+	//Only allow one VREF to drive its attached comparator
+	{ { ROUTE_VREF,		0,	"VOUT" },			{ ROUTE_ACMP,		0,	"VREF" },		0 },
+	{ { ROUTE_VREF,		1,	"VOUT" },			{ ROUTE_ACMP,		1,	"VREF" },		0 },
+	{ { ROUTE_VREF,		2,	"VOUT" },			{ ROUTE_ACMP,		2,	"VREF" },		0 },
+	{ { ROUTE_VREF,		3,	"VOUT" },			{ ROUTE_ACMP,		3,	"VREF" },		0 },
+	{ { ROUTE_VREF,		4,	"VOUT" },			{ ROUTE_ACMP,		4,	"VREF" },		0 },
+	{ { ROUTE_VREF,		5,	"VOUT" },			{ ROUTE_ACMP,		5,	"VREF" },		0 },
+
+	//Input to analog buffer
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ABUF,		0,	"IN" },			0 },
+
+	//Dedicated comparator inputs (none for ACMP0)
+	{ { ROUTE_IOB,		12,	"OUT" },			{ ROUTE_ACMP,		1,	"VIN" },		0 },
+	{ { ROUTE_PGA,		0,	"VOUT" },			{ ROUTE_ACMP,		1,	"VIN" },		0 },
+	{ { ROUTE_IOB,		13,	"OUT" },			{ ROUTE_ACMP,		2,	"VIN" },		0 },
+	{ { ROUTE_IOB,		15,	"OUT" },			{ ROUTE_ACMP,		3,	"VIN" },		0 },
+	{ { ROUTE_IOB,		13,	"OUT" },			{ ROUTE_ACMP,		3,	"VIN" },		0 },
+	{ { ROUTE_IOB,		3,	"OUT" },			{ ROUTE_ACMP,		4,	"VIN" },		0 },
+	{ { ROUTE_IOB,		15,	"OUT" },			{ ROUTE_ACMP,		4,	"VIN" },		0 },
+	{ { ROUTE_IOB,		4,	"OUT" },			{ ROUTE_ACMP,		5,	"VIN" },		0 },
+
+	//ACMP0 input before gain stage is fed to everything but ACMP5
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ACMP,		0,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_ACMP,		0,	"VIN" },		0 },
+	{ { ROUTE_ABUF,		0,	"OUT" },			{ ROUTE_ACMP,		0,	"VIN" },		0 },
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ACMP,		1,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_ACMP,		1,	"VIN" },		0 },
+	{ { ROUTE_ABUF,		0,	"OUT" },			{ ROUTE_ACMP,		1,	"VIN" },		0 },
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ACMP,		2,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_ACMP,		2,	"VIN" },		0 },
+	{ { ROUTE_ABUF,		0,	"OUT" },			{ ROUTE_ACMP,		2,	"VIN" },		0 },
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ACMP,		3,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_ACMP,		3,	"VIN" },		0 },
+	{ { ROUTE_ABUF,		0,	"OUT" },			{ ROUTE_ACMP,		3,	"VIN" },		0 },
+	{ { ROUTE_IOB,		6,	"OUT" },			{ ROUTE_ACMP,		4,	"VIN" },		0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_ACMP,		4,	"VIN" },		0 },
+	{ { ROUTE_ABUF,		0,	"OUT" },			{ ROUTE_ACMP,		4,	"VIN" },		0 },
+
+	//SPI: pin 10 IOB can be MOSI or MISO
+	{ { ROUTE_IOB,		10,	"OUT" },			{ ROUTE_SPI,		0,	"SDAT" },		0 },
+	{ { ROUTE_SPI,		0,	"SDAT" },			{ ROUTE_IOB,		10,	"IN" },			0 },
+
+	//SPI TX data can be tied to ground (unused, for RX mode)
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_SPI,		0,	"TXD_LOW[%d]" },	8 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_SPI,		0,	"TXD_HIGH[%d]" },	8 },
+
+	//SPI SCK: dedicated routing from clkbuf4
+	{ { ROUTE_CLKBUF,	4,	"OUT" },			{ ROUTE_SPI,		0,	"SCK" },		0 },
+
+	//Inputs to DCMPMUX
+	{ { ROUTE_DCMPREF,	0,	"OUT" },			{ ROUTE_DCMPMUX,	0,	"IN0[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	1,	"OUT" },			{ ROUTE_DCMPMUX,	0,	"IN1[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	2,	"OUT" },			{ ROUTE_DCMPMUX,	0,	"IN2[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	3,	"OUT" },			{ ROUTE_DCMPMUX,	0,	"IN3[%d]" },	8 },
+
+	//Mux driving DCMP0/1
+	{ { ROUTE_DCMPMUX,	0,	"OUTA" },			{ ROUTE_DCMP,		0,	"INP[%d]" },	8 },
+	{ { ROUTE_DCMPMUX,	0,	"OUTB" },			{ ROUTE_DCMP,		1,	"INN[%d]" },	8 },
+
+	//Constant inputs from DCREF to DCMP
+	{ { ROUTE_DCMPREF,	0,	"OUT" },			{ ROUTE_DCMP,		0,	"INN[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	2,	"OUT" },			{ ROUTE_DCMP,		2,	"INN[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	1,	"OUT" },			{ ROUTE_DCMP,		1,	"INP[%d]" },	8 },
+	{ { ROUTE_DCMPREF,	3,	"OUT" },			{ ROUTE_DCMP,		2,	"INP[%d]" },	8 },
+
+	//SPI data lines to DCMP
+	{ { ROUTE_SPI,		0,	"RXD_HIGH" },		{ ROUTE_DCMP,		0,	"INP[%d]" },	8 },
+	{ { ROUTE_SPI,		0,	"RXD_HIGH" },		{ ROUTE_DCMP,		1,	"INP[%d]" },	8 },
+	{ { ROUTE_SPI,		0,	"RXD_LOW" },		{ ROUTE_DCMP,		0,	"INN[%d]" },	8 },
+	{ { ROUTE_SPI,		0,	"RXD_LOW" },		{ ROUTE_DCMP,		1,	"INN[%d]" },	8 },
+	{ { ROUTE_SPI,		0,	"RXD_LOW" },		{ ROUTE_DCMP,		2,	"INN[%d]" },	8 },
+
+	//Counters to DCMP
+	//TODO: Inputs from ADC to DCMP
+	{ { ROUTE_COUNTER,	8,	"POUT" },			{ ROUTE_DCMP,		0,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	4,	"POUT" },			{ ROUTE_DCMP,		0,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	9,	"POUT" },			{ ROUTE_DCMP,		1,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	2,	"POUT" },			{ ROUTE_DCMP,		1,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	8,	"POUT" },			{ ROUTE_DCMP,		2,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	2,	"POUT" },			{ ROUTE_DCMP,		2,	"INN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	2,	"POUT" },			{ ROUTE_DCMP,		0,	"INP[%d]" },	8 },
+	{ { ROUTE_COUNTER,	4,	"POUT" },			{ ROUTE_DCMP,		1,	"INP[%d]" },	8 },
+	{ { ROUTE_COUNTER,	4,	"POUT" },			{ ROUTE_DCMP,		2,	"INP[%d]" },	8 },
+
+	//ADC/DCMP clock mux routing
+	{ { ROUTE_RINGOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_CLKBUF,		5,	"IN" },			0 },
+	{ { ROUTE_RCOSC,	0,	"CLKOUT_HARDIP" },	{ ROUTE_CLKBUF,		5,	"IN" },			0 },
+	{ { ROUTE_CLKBUF,	2,	"OUT" },			{ ROUTE_CLKBUF,		5,	"IN" },			0 },
+	{ { ROUTE_CLKBUF,	4,	"OUT" },			{ ROUTE_CLKBUF,		5,	"IN" },			0 },
+
+	//Clock inputs to DCMP
+	{ { ROUTE_CLKBUF,	1,	"OUT" },			{ ROUTE_DCMP,		0,	"CLK" },		0 },
+	{ { ROUTE_CLKBUF,	5,	"OUT" },			{ ROUTE_DCMP,		0,	"CLK" },		0 },
+	{ { ROUTE_CLKBUF,	1,	"OUT" },			{ ROUTE_DCMP,		1,	"CLK" },		0 },
+	{ { ROUTE_CLKBUF,	5,	"OUT" },			{ ROUTE_DCMP,		1,	"CLK" },		0 },
+	{ { ROUTE_CLKBUF,	1,	"OUT" },			{ ROUTE_DCMP,		2,	"CLK" },		0 },
+	{ { ROUTE_CLKBUF,	5,	"OUT" },			{ ROUTE_DCMP,		2,	"CLK" },		0 },
+
+	//Inputs to PGA
+	//TODO: DAC output to VIN_N, output to ADC
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_P" },		0 },
+	{ { ROUTE_IOB,		8,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_P" },		0 },
+	{ { ROUTE_IOB,		9,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_N" },		0 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_N" },		0 },
+	{ { ROUTE_IOB,		16,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_SEL" },	0 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_PGA,		0,	"VIN_SEL" },	0 },
+
+	//PGA to IOB
+	{ { ROUTE_PGA,		0,	"VOUT" },			{ ROUTE_IOB,		7,	"IN" },			0 },
+
+	//DAC voltage references driving DAC inputs
+	{ { ROUTE_VREF,		6,	"VOUT" },			{ ROUTE_DAC,		0,	"VREF" },		0 },
+	{ { ROUTE_VREF,		7,	"VOUT" },			{ ROUTE_DAC,		1,	"VREF" },		0 },
+
+	//Static 1/0 for DAC register configuration
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_DAC,		0,	"DIN[%d]" },	8 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_DAC,		0,	"DIN[%d]" },	8 },
+	{ { ROUTE_POWER,	1,	"OUT" },			{ ROUTE_DAC,		1,	"DIN[%d]" },	8 },
+	{ { ROUTE_POWER,	0,	"OUT" },			{ ROUTE_DAC,		1,	"DIN[%d]" },	8 },
+
+	//Counters to each DAC (shared with DCMP mux)
+	{ { ROUTE_COUNTER,	9,	"POUT" },			{ ROUTE_DAC,		0,	"DIN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	2,	"POUT" },			{ ROUTE_DAC,		0,	"DIN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	9,	"POUT" },			{ ROUTE_DAC,		1,	"DIN[%d]" },	8 },
+	{ { ROUTE_COUNTER,	2,	"POUT" },			{ ROUTE_DAC,		1,	"DIN[%d]" },	8 },
+
+	//Both DACs can drive to every comparator vref
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		0,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		1,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		2,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		3,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		4,	"VIN" },		0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_VREF,		5,	"VIN" },		0 },
+
+	//DACs can drive I/O pins directly without going through a GP_VREF
+	{ { ROUTE_DAC,		0,	"VOUT" },			{ ROUTE_IOB,		19,	"IN" },			0 },
+	{ { ROUTE_DAC,		1,	"VOUT" },			{ ROUTE_IOB,		18,	"IN" },			0 },
+};
+
+static const Greenpak4DeviceTable g_slg4662x =
+{
+	6,				//64 inputs per routing matrix
+	2048,			//bitstream length
+	{ 0, 1024 },	//matrix base
+	10, 85, 52,		//10 cross connections per direction, ibase 85, oword 52
+
+	GP4_TABLE(g_slg4662x_lut2s),
+	GP4_TABLE(g_slg4662x_lut3s),
+	GP4_TABLE(g_slg4662x_iobs),
+	GP4_TABLE(g_slg4662x_flipflops),
+	GP4_TABLE(g_slg4662x_shregs),
+	GP4_TABLE(g_slg4662x_delays),
+	GP4_TABLE(g_slg4662x_inverters),
+	GP4_TABLE(g_slg4662x_counters),
+	GP4_TABLE(g_slg4662x_dacs),
+	GP4_TABLE(g_slg4662x_vrefs),
+	GP4_TABLE(g_slg4662x_acmps),
+	GP4_TABLE(g_slg4662x_dcmps),
+	GP4_TABLE(g_slg4662x_dcmprefs),
+	GP4_TABLE(g_slg4662x_clkbufs),
+
+	GP4_TABLE(g_slg4662x_muxes),
+	GP4_TABLE(g_slg4662x_routes)
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup
+
+/**
+	@brief Gets the static description of a part
+ */
+const Greenpak4DeviceTable* Greenpak4Device::GetDeviceTable(GREENPAK4_PART part)
+{
+	switch(part)
+	{
+		case GREENPAK4_SLG46140:
+			return &g_slg46140;
+
+		case GREENPAK4_SLG46620:
+		case GREENPAK4_SLG46621:
+			return &g_slg4662x;
+	}
+	return NULL;
+}
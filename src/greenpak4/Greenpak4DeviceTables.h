@@ -0,0 +1,255 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4DeviceTables_h
+#define Greenpak4DeviceTables_h
+
+/**
+	@file
+	@brief Static per-part descriptions of the fabric resources, bitstream offsets and dedicated routing
+
+	Each supported part is described by one Greenpak4DeviceTable in Greenpak4DeviceTables.cpp. Greenpak4Device walks
+	the tables once at construction time, and gp4par walks the dedicated routing table to build the device graph, so
+	adding a part (or fixing an offset) only means editing data.
+
+	All offsets use the same conventions as the entity constructors they are passed to.
+ */
+
+///Placeholder for "no value" in unsigned table columns (matches the entity constructors' -1 defaults)
+#define GP4_TABLE_NONE ((unsigned int)-1)
+
+struct Greenpak4LUTInfo
+{
+	unsigned int m_lutnum;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+	unsigned int m_order;
+};
+
+struct Greenpak4IOBInfo
+{
+	unsigned int m_pin;
+	bool m_typeA;				//true for Greenpak4IOBTypeA (output enable), false for Greenpak4IOBTypeB
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+	unsigned int m_flags;
+	bool m_singleRailOnly;		//pin is used as VCCIO (not bonded out as a GPIO) in dual-rail packages
+	unsigned int m_analogCbase;	//GP4_TABLE_NONE if the pin has no analog configuration
+};
+
+struct Greenpak4FlipflopInfo
+{
+	unsigned int m_ffnum;
+	bool m_hasSR;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+};
+
+///Generic shape for blocks constructed as (matrix, ibase, oword, cbase): shift registers and delays
+struct Greenpak4BlockInfo
+{
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+};
+
+struct Greenpak4CounterInfo
+{
+	unsigned int m_depth;
+	bool m_hasFSM;
+	bool m_hasWakeSleepPowerdown;
+	bool m_hasEdgeDetect;
+	bool m_hasPWM;
+	unsigned int m_countnum;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+};
+
+struct Greenpak4DACInfo
+{
+	unsigned int m_cbaseReg;
+	unsigned int m_cbasePwr;
+	unsigned int m_cbaseInsel;
+	unsigned int m_cbaseAon;
+	unsigned int m_dacnum;
+};
+
+struct Greenpak4VrefInfo
+{
+	unsigned int m_refnum;
+	unsigned int m_voutMuxsel;
+};
+
+struct Greenpak4ComparatorInfo
+{
+	unsigned int m_cmpnum;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbaseIsrc;
+	unsigned int m_cbaseBw;
+	unsigned int m_cbaseGain;
+	unsigned int m_cbaseVin;
+	unsigned int m_cbaseHyst;
+	unsigned int m_cbaseVref;
+};
+
+struct Greenpak4DigitalComparatorInfo
+{
+	unsigned int m_cmpnum;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+};
+
+struct Greenpak4DCMPRefInfo
+{
+	unsigned int m_blocknum;
+	unsigned int m_cbase;
+};
+
+struct Greenpak4ClockBufferInfo
+{
+	unsigned int m_bufnum;
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+};
+
+/**
+	@brief Kinds of hard IP that can be the endpoint of a dedicated route or a hard-IP mux entry
+
+	The index of an endpoint is interpreted per kind: pin number for ROUTE_IOB, 0/1 for ROUTE_POWER, position in the
+	corresponding Greenpak4Device list otherwise (ROUTE_COUNTER uses the combined 14-then-8-bit counter list).
+	Singletons ignore the index.
+ */
+enum Greenpak4RouteEntityType
+{
+	ROUTE_IOB,
+	ROUTE_POWER,
+	ROUTE_COUNTER,
+	ROUTE_VREF,
+	ROUTE_ACMP,
+	ROUTE_DCMP,
+	ROUTE_DCMPREF,
+	ROUTE_DCMPMUX,
+	ROUTE_CLKBUF,
+	ROUTE_DAC,
+	ROUTE_LFOSC,
+	ROUTE_RINGOSC,
+	ROUTE_RCOSC,
+	ROUTE_SYSRST,
+	ROUTE_PGA,
+	ROUTE_ABUF,
+	ROUTE_SPI
+};
+
+struct Greenpak4RouteEndpoint
+{
+	Greenpak4RouteEntityType m_type;
+	unsigned int m_index;
+	const char* m_port;
+};
+
+/**
+	@brief A single dedicated (non-fabric) routing path between two pieces of hard IP
+
+	If m_width is nonzero, the destination port is a printf format with a single %d and the route is expanded into
+	m_width edges, one per bit of the destination bus.
+ */
+struct Greenpak4DedicatedRoute
+{
+	Greenpak4RouteEndpoint m_src;
+	Greenpak4RouteEndpoint m_dst;
+	unsigned int m_width;
+};
+
+/**
+	@brief A hard-wired input mux entry on a comparator or muxed clock buffer
+
+	The destination port selects which mux is being populated: "VIN" for analog comparators, "INP" / "INN" for
+	digital comparators and "IN" for muxed clock buffers.
+ */
+struct Greenpak4MuxEntry
+{
+	Greenpak4RouteEndpoint m_dst;
+	Greenpak4RouteEndpoint m_src;
+	unsigned int m_sel;
+};
+
+/**
+	@brief A (pointer, length) view of one static table
+ */
+template<class T> struct Greenpak4TableRange
+{
+	const T* m_entries;
+	unsigned int m_count;
+
+	const T* begin() const
+	{ return m_entries; }
+
+	const T* end() const
+	{ return m_entries + m_count; }
+
+	unsigned int size() const
+	{ return m_count; }
+};
+
+/**
+	@brief Complete static description of one part
+ */
+struct Greenpak4DeviceTable
+{
+	unsigned int m_matrixBits;
+	unsigned int m_bitlen;
+	unsigned int m_matrixBase[2];
+
+	//Cross connections: count per matrix (0 if single-matrix part), first ibase and first oword
+	unsigned int m_crossConnectionCount;
+	unsigned int m_crossConnectionIbase;
+	unsigned int m_crossConnectionOword;
+
+	Greenpak4TableRange<Greenpak4LUTInfo> m_lut2s;
+	Greenpak4TableRange<Greenpak4LUTInfo> m_lut3s;
+	Greenpak4TableRange<Greenpak4IOBInfo> m_iobs;
+	Greenpak4TableRange<Greenpak4FlipflopInfo> m_flipflops;
+	Greenpak4TableRange<Greenpak4BlockInfo> m_shregs;
+	Greenpak4TableRange<Greenpak4BlockInfo> m_delays;
+	Greenpak4TableRange<Greenpak4BlockInfo> m_inverters;		//cbase unused
+	Greenpak4TableRange<Greenpak4CounterInfo> m_counters;
+	Greenpak4TableRange<Greenpak4DACInfo> m_dacs;
+	Greenpak4TableRange<Greenpak4VrefInfo> m_vrefs;
+	Greenpak4TableRange<Greenpak4ComparatorInfo> m_acmps;
+	Greenpak4TableRange<Greenpak4DigitalComparatorInfo> m_dcmps;
+	Greenpak4TableRange<Greenpak4DCMPRefInfo> m_dcmprefs;
+	Greenpak4TableRange<Greenpak4ClockBufferInfo> m_clkbufs;
+
+	Greenpak4TableRange<Greenpak4MuxEntry> m_muxEntries;
+	Greenpak4TableRange<Greenpak4DedicatedRoute> m_routes;
+};
+
+#endif
@@ -77,6 +77,8 @@ vector<string> Greenpak4DigitalComparator::GetInputPorts() const
 
 void Greenpak4DigitalComparator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port.find("INP") != string::npos)
 	{
 		int i;
@@ -185,9 +187,9 @@ bool Greenpak4DigitalComparator::CommitChanges()
 		return true;
 
 	//Set primitive type
-	if(ncell->m_type == "GP_DCMP")
+	if(ncell->m_typeId == GP_CELL_DCMP)
 		m_dcmpMode = true;
-	else if(ncell->m_type == "GP_PWM")
+	else if(ncell->m_typeId == GP_CELL_PWM)
 		m_dcmpMode = false;
 	else
 	{
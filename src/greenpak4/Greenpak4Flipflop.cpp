@@ -66,6 +66,8 @@ vector<string> Greenpak4Flipflop::GetInputPorts() const
 
 void Greenpak4Flipflop::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if( (port == "CLK") || (port == "nCLK") )
 		m_clock = src;
 	else if(port == "D")
@@ -212,12 +214,12 @@ bool Greenpak4Flipflop::CommitChanges()
 	if(ncell == NULL)
 		return true;
 
-	//If our primitive name contains "LATCH" we're a latch, not a FF
-	if(ncell->m_type.find("LATCH") != string::npos)
+	//GP_DLATCH* primitives are latches, not FFs
+	if(ncell->HasTypeFlag(Greenpak4NetlistCell::CELL_FLAG_LATCH))
 		m_latchMode = true;
 
-	//If our primitive name ends in "I" we're inverting the output
-	if(ncell->m_type[ncell->m_type.length()-1] == 'I')
+	//Primitives whose name ends in "I" invert the output
+	if(ncell->HasTypeFlag(Greenpak4NetlistCell::CELL_FLAG_INVERTED))
 		m_outputInvert = true;
 
 	if(ncell->HasParameter("SRMODE"))
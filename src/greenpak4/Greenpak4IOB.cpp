@@ -153,11 +153,11 @@ bool Greenpak4IOB::CommitChanges()
 
 	//Get the net
 	Greenpak4NetlistNode* net = NULL;
-	if(cell->m_type == "GP_IBUF")
+	if(cell->m_typeId == GP_CELL_IBUF)
 		net = cell->m_connections["IN"][0];
-	else if(cell->m_type == "GP_OBUF")
+	else if(cell->m_typeId == GP_CELL_OBUF)
 		net = cell->m_connections["OUT"][0];
-	else if(cell->m_type == "GP_IOBUF")
+	else if(cell->m_typeId == GP_CELL_IOBUF)
 		net = cell->m_connections["IO"][0];
 	if(net == NULL)
 		return true;
@@ -280,11 +280,11 @@ bool Greenpak4IOB::CommitChanges()
 	}
 
 	//Configure output enable
-	if(cell->m_type == "GP_OBUF")
+	if(cell->m_typeId == GP_CELL_OBUF)
 		m_outputEnable = m_device->GetPower();
-	else if(cell->m_type == "GP_IBUF")
+	else if(cell->m_typeId == GP_CELL_IBUF)
 		m_outputEnable = m_device->GetGround();
-	else if(cell->m_type == "GP_IOBUF")
+	else if(cell->m_typeId == GP_CELL_IOBUF)
 	{
 		//output enable will be hooked up by SetInput()
 	}
@@ -299,6 +299,8 @@ bool Greenpak4IOB::CommitChanges()
 
 void Greenpak4IOB::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_outputSignal = src;
 	else if(port == "OE")
@@ -365,17 +367,45 @@ string Greenpak4IOB::GetPrimitiveName() const
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Timing analysis
 
+/**
+	@brief Gets a drive strength's multiplier (as used in the timing data)
+ */
+static int GetDriveMultiplier(Greenpak4IOB::DriveStrength drive)
+{
+	switch(drive)
+	{
+		case Greenpak4IOB::DRIVE_4X:
+			return 4;
+
+		case Greenpak4IOB::DRIVE_2X:
+			return 2;
+
+		case Greenpak4IOB::DRIVE_1X:
+		default:
+			return 1;
+	}
+}
+
+/**
+	@brief Pin-to-pin delays, then the Schmitt trigger, then output delays by drive strength
+ */
+void Greenpak4IOB::GetTimingTables(vector<PTVDelayTable*>& tables)
+{
+	Greenpak4BitstreamEntity::GetTimingTables(tables);
+	tables.push_back(&m_schmittTriggerDelays);
+	for(auto& t : m_outputDelays)
+		tables.push_back(&t);
+}
+
 void Greenpak4IOB::PrintExtraTimingData(PTVCorner corner) const
 {
 	//Schmitt trigger delay
-	auto sd = m_schmittTriggerDelays.find(corner);
-	if(sd != m_schmittTriggerDelays.end())
+	CombinatorialDelay time;
+	if(m_schmittTriggerDelays.GetExactDelay("IO", "OUT", corner, time))
 	{
-		auto time = sd->second;
-
 		//Look up normal buffer delay and add
 		CombinatorialDelay bd;
-		if(GetCombinatorialDelay("IO", "OUT", corner, bd))
+		if(Greenpak4BitstreamEntity::GetCombinatorialDelay("IO", "OUT", corner, bd))
 		{
 			LogNotice("%10s to %10s: %6.3f ns rising, %6.3f ns falling\n",
 				"IO (Sch)",
@@ -386,35 +416,19 @@ void Greenpak4IOB::PrintExtraTimingData(PTVCorner corner) const
 	}
 
 	//Output buffer delays
-	for(auto it : m_outputDelays)
+	for(int drive = DRIVE_1X; drive <= DRIVE_4X; drive ++)
 	{
-		//Skip results for other process corners
-		if(it.first.second != corner)
+		if(!m_outputDelays[drive].GetExactDelay("IN", "IO", corner, time))
 			continue;
 
-		string drive;
-		switch(it.first.first)
-		{
-			case DRIVE_4X:
-				drive = "4x";
-				break;
-
-			case DRIVE_2X:
-				drive = "2x";
-				break;
-
-			case DRIVE_1X:
-			default:
-				drive = "1x";
-				break;
-		}
-		string ioname = string("IO (") + drive + ")";
+		char ioname[16];
+		snprintf(ioname, sizeof(ioname), "IO (%dx)", GetDriveMultiplier(static_cast<DriveStrength>(drive)));
 
 		LogNotice("%10s to %10s: %6.3f ns rising, %6.3f ns falling\n",
 			"IN",
-			ioname.c_str(),
-			it.second.m_rising,
-			it.second.m_falling);
+			ioname,
+			time.m_rising,
+			time.m_falling);
 	}
 }
 
@@ -429,92 +443,63 @@ bool Greenpak4IOB::GetCombinatorialDelay(
 	{
 		//Get the baseline IO to OUT delay from the base class
 		if(!Greenpak4BitstreamEntity::GetCombinatorialDelay(srcport, dstport, corner, delay))
-		{
-			//LogWarning("Greenpak4IOB::GetCombinatorialDelay: no delay for process corner %s\n",
-			//	corner.toString().c_str());
 			return false;
-		}
 
 		//Add Schmitt trigger delay if needed
 		if(m_schmittTrigger)
 		{
-			auto it = m_schmittTriggerDelays.find(corner);
-			if(it == m_schmittTriggerDelays.end())
+			CombinatorialDelay sd;
+			if(!m_schmittTriggerDelays.GetDelay(srcport, dstport, corner, sd))
 				return false;
-			delay += it->second;
+			delay += sd;
 		}
 		return true;
 	}
 
 	//OUTPUT path: look up drive strength
 	else if( (srcport == "IN") && (dstport == "IO") )
-	{
-		auto it = m_outputDelays.find(DriveCondition(m_driveStrength, corner));
-		if(it == m_outputDelays.end())
-		{
-			//LogWarning("Greenpak4IOB::GetCombinatorialDelay: no delay for drive condition (strength=%d, corner=%s)\n",
-			//	m_driveStrength,
-			//	corner.toString().c_str());
-			return false;
-		}
-
-		delay = it->second;
-		return true;
-	}
+		return m_outputDelays[m_driveStrength].GetDelay(srcport, dstport, corner, delay);
 
 	//Default: return base class info
 	return Greenpak4BitstreamEntity::GetCombinatorialDelay(srcport, dstport, corner, delay);
 }
 
-void Greenpak4IOB::SaveTimingData(FILE* fp, PTVCorner corner)
+void Greenpak4IOB::SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner)
 {
-	if(m_schmittTriggerDelays.find(corner) != m_schmittTriggerDelays.end())
+	//Schmitt trigger delays
+	CombinatorialDelay delay;
+	if(m_schmittTriggerDelays.GetExactDelay("IO", "OUT", corner, delay))
 	{
-		//Schmitt trigger delays
-		fprintf(fp, "                {\n");
-		fprintf(fp, "                    \"type\" : \"schmitt\",\n");
-		auto sd = m_schmittTriggerDelays[corner];
-		fprintf(fp, "                    \"rising\" : \"%f\",\n", sd.m_rising);
-		fprintf(fp, "                    \"falling\" : \"%f\"\n", sd.m_falling);
-		fprintf(fp, "                },\n");
+		json.BeginObject();
+		json.Key("type");
+		json.String("schmitt");
+		json.Key("rising");
+		json.FormattedString("%f", delay.m_rising);
+		json.Key("falling");
+		json.FormattedString("%f", delay.m_falling);
+		json.EndObject();
 	}
 
 	//Output buffer delays
-	for(auto it : m_outputDelays)
+	for(int drive = DRIVE_1X; drive <= DRIVE_4X; drive ++)
 	{
-		auto cond = it.first;
-		auto delay = it.second;
-		if(cond.second != corner)
+		if(!m_outputDelays[drive].GetExactDelay("IN", "IO", corner, delay))
 			continue;
 
-		auto drive = cond.first;
-		int d;
-		switch(drive)
-		{
-			case DRIVE_4X:
-				d = 4;
-				break;
-
-			case DRIVE_2X:
-				d = 2;
-				break;
-
-			case DRIVE_1X:
-			default:
-				d = 1;
-				break;
-		}
-
-		fprintf(fp, "                {\n");
-		fprintf(fp, "                    \"type\" : \"obuf\",\n");
-		fprintf(fp, "                    \"drive\" : \"%d\",\n", d);
-		fprintf(fp, "                    \"rising\" : \"%f\",\n", delay.m_rising);
-		fprintf(fp, "                    \"falling\" : \"%f\"\n", delay.m_falling);
-		fprintf(fp, "                },\n");
+		json.BeginObject();
+		json.Key("type");
+		json.String("obuf");
+		json.Key("drive");
+		json.FormattedString("%d", GetDriveMultiplier(static_cast<DriveStrength>(drive)));
+		json.Key("rising");
+		json.FormattedString("%f", delay.m_rising);
+		json.Key("falling");
+		json.FormattedString("%f", delay.m_falling);
+		json.EndObject();
 	}
 
 	//do base class at end
-	Greenpak4BitstreamEntity::SaveTimingData(fp, corner);
+	Greenpak4BitstreamEntity::SaveTimingData(json, corner);
 }
 
 bool Greenpak4IOB::LoadExtraTimingData(PTVCorner corner, string delaytype, json_object* object)
@@ -539,7 +524,7 @@ bool Greenpak4IOB::LoadExtraTimingData(PTVCorner corner, string delaytype, json_
 
 	//Schmitt trigger has no further parameters
 	if(delaytype == "schmitt")
-		m_schmittTriggerDelays[corner] = delay;
+		SetSchmittTriggerDelay(corner, delay);
 
 	//Output buffers need drive strength
 	else if(delaytype == "obuf")
@@ -569,7 +554,7 @@ bool Greenpak4IOB::LoadExtraTimingData(PTVCorner corner, string delaytype, json_
 				break;
 		}
 
-		m_outputDelays[DriveCondition(st, corner)] = delay;
+		SetOutputDelay(st, corner, delay);
 	}
 
 	//Call base class and make it warn if we don't know what the signal does
@@ -120,22 +120,40 @@ public:
 
 	//Used to set defaults in Greenpak4Device constructor
 	void SetPullDirection(PullDirection dir)
-	{ m_pullDirection = dir; }
+	{
+		m_pullDirection = dir;
+		MarkDirty();
+	}
 
 	void SetPullStrength(PullStrength str)
-	{ m_pullStrength = str; }
+	{
+		m_pullStrength = str;
+		MarkDirty();
+	}
 
 	void SetAnalogConfigBase(unsigned int base)
-	{ m_analogConfigBase = base; }
+	{
+		m_analogConfigBase = base;
+		MarkDirty();
+	}
 
 	void SetDriveType(DriveType type)
-	{ m_driveType = type; }
+	{
+		m_driveType = type;
+		MarkDirty();
+	}
 
 	void SetDriveStrength(DriveStrength strength)
-	{ m_driveStrength = strength; }
+	{
+		m_driveStrength = strength;
+		MarkDirty();
+	}
 
 	void SetSchmittTrigger(bool schmitt)
-	{ m_schmittTrigger = schmitt; }
+	{
+		m_schmittTrigger = schmitt;
+		MarkDirty();
+	}
 
 	//Get our source (used for DRC)
 	Greenpak4EntityOutput GetOutputSignal()
@@ -153,15 +171,14 @@ public:
 	// Timing stuff
 
 	virtual void PrintExtraTimingData(PTVCorner corner) const;
+	virtual void GetTimingTables(std::vector<PTVDelayTable*>& tables);
 
 	void SetSchmittTriggerDelay(PTVCorner c, CombinatorialDelay d)
-	{ m_schmittTriggerDelays[c] = d; }
+	{ m_schmittTriggerDelays.SetDelay("IO", "OUT", c, d); }
 
 	//TODO: drive type should go in here too?
-	typedef std::pair<DriveStrength, PTVCorner> DriveCondition;
-
 	void SetOutputDelay(DriveStrength s, PTVCorner c, CombinatorialDelay d)
-	{ m_outputDelays[DriveCondition(s, c)] = d; }
+	{ m_outputDelays[s].SetDelay("IN", "IO", c, d); }
 
 	virtual bool GetCombinatorialDelay(
 		std::string srcport,
@@ -210,13 +227,13 @@ protected:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Timing data
 
-	//Schmitt trigger delays
-	std::map<PTVCorner, CombinatorialDelay> m_schmittTriggerDelays;
+	//Schmitt trigger delays (extra IO to OUT delay)
+	PTVDelayTable m_schmittTriggerDelays;
 
-	//Output propagation delay depends on drive strength
-	std::map< DriveCondition, CombinatorialDelay > m_outputDelays;
+	//Output propagation delay (IN to IO) depends on drive strength
+	PTVDelayTable m_outputDelays[DRIVE_4X + 1];
 
-	virtual void SaveTimingData(FILE* fp, PTVCorner corner);
+	virtual void SaveTimingData(Greenpak4JSONWriter& json, PTVCorner corner);
 	virtual bool LoadExtraTimingData(PTVCorner corner, std::string delaytype, json_object* object);
 };
 
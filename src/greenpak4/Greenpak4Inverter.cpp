@@ -58,6 +58,8 @@ vector<string> Greenpak4Inverter::GetInputPorts() const
 
 void Greenpak4Inverter::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_input = src;
 
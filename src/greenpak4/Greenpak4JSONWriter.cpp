@@ -0,0 +1,266 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <cstdarg>
+#include <cstring>
+#include "Greenpak4JSONWriter.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Creates a writer
+
+	@param fp		File to write to. Not closed by the writer.
+	@param pretty	True for indented, one-item-per-line output; false for compact output
+	@param indent	Spaces per nesting level in pretty mode
+	@param bufsize	Output buffer size in bytes
+ */
+Greenpak4JSONWriter::Greenpak4JSONWriter(FILE* fp, bool pretty, unsigned int indent, size_t bufsize)
+	: m_fp(fp)
+	, m_pretty(pretty)
+	, m_indent(indent)
+	, m_buffer(bufsize > 64 ? bufsize : 64)
+	, m_used(0)
+	, m_afterKey(false)
+	, m_ok(true)
+{
+	m_first.reserve(32);
+}
+
+Greenpak4JSONWriter::~Greenpak4JSONWriter()
+{
+	Flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Output buffering
+
+bool Greenpak4JSONWriter::Flush()
+{
+	if(m_used)
+	{
+		if(m_used != fwrite(&m_buffer[0], 1, m_used, m_fp))
+			m_ok = false;
+		m_used = 0;
+	}
+	return m_ok;
+}
+
+void Greenpak4JSONWriter::Write(const char* data, size_t len)
+{
+	//Big writes go straight to the file
+	if(len > m_buffer.size())
+	{
+		Flush();
+		if(len != fwrite(data, 1, len, m_fp))
+			m_ok = false;
+		return;
+	}
+
+	if(m_used + len > m_buffer.size())
+		Flush();
+	memcpy(&m_buffer[m_used], data, len);
+	m_used += len;
+}
+
+void Greenpak4JSONWriter::Write(const char* str)
+{
+	Write(str, strlen(str));
+}
+
+void Greenpak4JSONWriter::WriteEscaped(const char* str)
+{
+	Put('\"');
+	for(const char* p = str; *p; p++)
+	{
+		char c = *p;
+		switch(c)
+		{
+			case '\"':
+				Write("\\\"", 2);
+				break;
+
+			case '\\':
+				Write("\\\\", 2);
+				break;
+
+			case '\n':
+				Write("\\n", 2);
+				break;
+
+			case '\t':
+				Write("\\t", 2);
+				break;
+
+			default:
+				if( (unsigned char)c < 0x20)
+				{
+					char tmp[8];
+					snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+					Write(tmp);
+				}
+				else
+					Put(c);
+				break;
+		}
+	}
+	Put('\"');
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Structure
+
+void Greenpak4JSONWriter::NewLine()
+{
+	if(!m_pretty)
+		return;
+
+	Put('\n');
+	for(size_t i=0; i<m_first.size() * m_indent; i++)
+		Put(' ');
+}
+
+/**
+	@brief Emits whatever has to come between the previous token and a new value (or key)
+ */
+void Greenpak4JSONWriter::BeginValue()
+{
+	//Values after a key follow the colon directly
+	if(m_afterKey)
+	{
+		m_afterKey = false;
+		return;
+	}
+
+	//Top level
+	if(m_first.empty())
+		return;
+
+	if(m_first.back())
+		m_first.back() = false;
+	else
+		Put(',');
+	NewLine();
+}
+
+void Greenpak4JSONWriter::BeginObject()
+{
+	BeginValue();
+	Put('{');
+	m_first.push_back(true);
+}
+
+void Greenpak4JSONWriter::EndObject()
+{
+	bool empty = m_first.back();
+	m_first.pop_back();
+	if(!empty)
+		NewLine();
+	Put('}');
+
+	//Terminate the document
+	if(m_first.empty() && m_pretty)
+		Put('\n');
+}
+
+void Greenpak4JSONWriter::BeginArray()
+{
+	BeginValue();
+	Put('[');
+	m_first.push_back(true);
+}
+
+void Greenpak4JSONWriter::EndArray()
+{
+	bool empty = m_first.back();
+	m_first.pop_back();
+	if(!empty)
+		NewLine();
+	Put(']');
+
+	if(m_first.empty() && m_pretty)
+		Put('\n');
+}
+
+void Greenpak4JSONWriter::Key(const char* key)
+{
+	BeginValue();
+	WriteEscaped(key);
+	if(m_pretty)
+		Write(": ", 2);
+	else
+		Put(':');
+	m_afterKey = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Values
+
+void Greenpak4JSONWriter::String(const char* str)
+{
+	BeginValue();
+	WriteEscaped(str);
+}
+
+void Greenpak4JSONWriter::FormattedString(const char* format, ...)
+{
+	char tmp[256];
+	va_list list;
+	va_start(list, format);
+	vsnprintf(tmp, sizeof(tmp), format, list);
+	va_end(list);
+
+	String(tmp);
+}
+
+void Greenpak4JSONWriter::Int(long value)
+{
+	char tmp[32];
+	snprintf(tmp, sizeof(tmp), "%ld", value);
+	BeginValue();
+	Write(tmp);
+}
+
+void Greenpak4JSONWriter::Double(double value)
+{
+	char tmp[64];
+	snprintf(tmp, sizeof(tmp), "%.17g", value);
+	BeginValue();
+	Write(tmp);
+}
+
+void Greenpak4JSONWriter::Bool(bool value)
+{
+	BeginValue();
+	Write(value ? "true" : "false");
+}
+
+void Greenpak4JSONWriter::Null()
+{
+	BeginValue();
+	Write("null", 4);
+}
+
+void Greenpak4JSONWriter::Literal(const char* json)
+{
+	BeginValue();
+	Write(json);
+}
@@ -0,0 +1,113 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4JSONWriter_h
+#define Greenpak4JSONWriter_h
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+	@brief Streaming JSON emitter with a large output buffer
+
+	Commas, quoting and (in pretty mode) indentation are handled by the writer, so callers just describe structure:
+
+		json.BeginObject();
+		json.Key("creator");
+		json.String("gpkjson");
+		json.EndObject();
+
+	Output is accumulated in a fixed-size buffer and written with a single fwrite() whenever it fills, so emitting a
+	value never allocates. In compact mode no whitespace at all is emitted.
+ */
+class Greenpak4JSONWriter
+{
+public:
+	Greenpak4JSONWriter(FILE* fp, bool pretty = true, unsigned int indent = 2, size_t bufsize = 1024*1024);
+	~Greenpak4JSONWriter();
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	void Key(const char* key);
+	void Key(const std::string& key)
+	{ Key(key.c_str()); }
+
+	void String(const char* str);
+	void String(const std::string& str)
+	{ String(str.c_str()); }
+	void FormattedString(const char* format, ...)
+		__attribute__((format(printf, 2, 3)));
+
+	void Int(long value);
+	void Double(double value);
+	void Bool(bool value);
+	void Null();
+
+	///Emits a value which is already valid JSON (e.g. a netlist parameter literal)
+	void Literal(const char* json);
+	void Literal(const std::string& json)
+	{ Literal(json.c_str()); }
+
+	///Pushes any buffered output to the file. Returns false if a write has failed.
+	bool Flush();
+
+	///True if the structure was closed properly and every write succeeded
+	bool IsOK() const
+	{ return m_ok && m_first.empty(); }
+
+protected:
+	void BeginValue();
+	void NewLine();
+	void Write(const char* data, size_t len);
+	void Write(const char* str);
+	void Put(char c)
+	{
+		if(m_used == m_buffer.size())
+			Flush();
+		m_buffer[m_used++] = c;
+	}
+	void WriteEscaped(const char* str);
+
+	///The file we're writing to (not owned)
+	FILE* m_fp;
+
+	///True to emit newlines and indentation
+	bool m_pretty;
+
+	///Spaces per nesting level in pretty mode
+	unsigned int m_indent;
+
+	///Output buffer and number of bytes in it
+	std::vector<char> m_buffer;
+	size_t m_used;
+
+	///One entry per open object/array: true if nothing has been written into it yet
+	std::vector<bool> m_first;
+
+	///True if a key was just written and its value is next
+	bool m_afterKey;
+
+	///False once any write has failed
+	bool m_ok;
+};
+
+#endif
@@ -63,6 +63,8 @@ vector<string> Greenpak4LFOscillator::GetInputPorts() const
 
 void Greenpak4LFOscillator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "PWRDN")
 		m_powerDown = src;
 
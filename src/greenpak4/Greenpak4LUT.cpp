@@ -124,7 +124,7 @@ bool Greenpak4LUT::CommitChanges()
 		return true;
 
 	//If the cell is an inverter, we need special processing to up-map
-	if(ncell->m_type == "GP_INV")
+	if(ncell->m_typeId == GP_CELL_INV)
 	{
 		//Set up the truth table
 		m_truthtable[0] = true;
@@ -201,6 +201,8 @@ vector<string> Greenpak4LUT::GetAllInputPorts() const
 
 void Greenpak4LUT::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	//used for up-mapping GP_INV to GP_LUTx
 	if( (port == "IN0") || (port == "IN") )
 		m_inputs[0] = src;
@@ -240,6 +242,8 @@ void Greenpak4LUT::MakeXOR()
 
 		m_truthtable[i] = a ^ b ^ c ^ d;
 	}
+
+	MarkDirty();
 }
 
 void Greenpak4LUT::MakeNOT()
@@ -250,6 +254,8 @@ void Greenpak4LUT::MakeNOT()
 
 	for(int i=3; i<16; i++)
 		m_truthtable[i] = false;
+
+	MarkDirty();
 }
 
 vector<string> Greenpak4LUT::GetOutputPorts() const
@@ -18,6 +18,7 @@
 
 #include <log.h>
 #include <Greenpak4.h>
+#include <unordered_map>
 
 using namespace std;
 
@@ -68,14 +69,52 @@ Greenpak4Netlist::Greenpak4Netlist(string fname, string constraint_file)
 	}
 	fclose(fp);
 
+	//Parse the JSON
+	LoadFromString(json_string);
+
+	//Clean up
+	delete[] json_string;
+}
+
+/**
+	@brief Creates an empty netlist.
+
+	The caller must populate it with LoadFromString() before use. This is used by tools that generate netlists
+	in memory (e.g. the synthetic PAR benchmarks) rather than reading them from disk.
+ */
+Greenpak4Netlist::Greenpak4Netlist()
+	: m_topModule(NULL)
+	, m_parseOK(false)
+{
+}
+
+Greenpak4Netlist::~Greenpak4Netlist()
+{
+	//Delete modules
+	for(auto x : m_modules)
+		delete x.second;
+	m_modules.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Parsing stuff
+
+/**
+	@brief Loads a Yosys JSON netlist from an in-memory string
+
+	@return True on success, false if the netlist could not be parsed
+ */
+bool Greenpak4Netlist::LoadFromString(const char* json_string)
+{
+	m_parseOK = true;
+
 	//Parse the JSON
 	json_tokener* tok = json_tokener_new();
 	if(!tok)
 	{
 		LogError("Failed to create JSON tokenizer object\n");
 		m_parseOK = false;
-		delete[] json_string;
-		return;
+		return false;
 	}
 	json_tokener_error err;
 	json_object* object = json_tokener_parse_verbose(json_string, &err);
@@ -84,8 +123,8 @@ Greenpak4Netlist::Greenpak4Netlist(string fname, string constraint_file)
 		const char* desc = json_tokener_error_desc(err);
 		LogError("JSON parsing failed (err = %s)\n", desc);
 		m_parseOK = false;
-		delete[] json_string;
-		return;
+		json_tokener_free(tok);
+		return false;
 	}
 
 	//Read stuff from it
@@ -94,20 +133,10 @@ Greenpak4Netlist::Greenpak4Netlist(string fname, string constraint_file)
 	//Clean up
 	json_object_put(object);
 	json_tokener_free(tok);
-	delete[] json_string;
-}
 
-Greenpak4Netlist::~Greenpak4Netlist()
-{
-	//Delete modules
-	for(auto x : m_modules)
-		delete x.second;
-	m_modules.clear();
+	return m_parseOK;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Parsing stuff
-
 void Greenpak4Netlist::LoadConstraints()
 {
 	//Read the constraint file (if we have one)
@@ -224,13 +253,15 @@ void Greenpak4Netlist::Load(json_object* object)
  */
 void Greenpak4Netlist::ClearIndexes()
 {
-	for(auto node : m_nodes)
+	//Every net is in the flat index, including unnamed ones that m_nodes doesn't have
+	for(auto node : m_index.m_nets)
 	{
 		node->m_nodeports.clear();
 		node->m_ports.clear();
 	}
 
 	m_nodes.clear();
+	m_index.Clear();
 }
 
 /**
@@ -246,7 +277,9 @@ void Greenpak4Netlist::Reindex()
 	@brief Index the nets so that each net has a list of cell ports it connects to.
 
 	Has to be done as a second pass because there may be cycles in the netlist preventing us from resolving names
-	as we parse the JSON
+	as we parse the JSON.
+
+	Builds the flat Greenpak4NetlistIndex first, then fills in the per-net lists from it.
  */
 void Greenpak4Netlist::IndexNets()
 {
@@ -254,52 +287,140 @@ void Greenpak4Netlist::IndexNets()
 
 	LogIndenter li;
 
-	//Loop over all of our ports and add them to the associated nets
-	for(auto it = m_topModule->port_begin(); it != m_topModule->port_end(); it ++)
+	unordered_map<Greenpak4NetlistNode*, uint32_t> netIDs;
+	auto getNet = [&](Greenpak4NetlistNode* node) -> uint32_t
 	{
-		Greenpak4NetlistPort* port = it->second;
-		LogTrace("Port %s connects to:\n", it->first.c_str());
-		LogIndenter li;
-
-		for(unsigned int i=0; i<port->m_nodes.size(); i++)
-		{
-			auto x = port->m_nodes[i];
-			LogTrace("bit %u: node %s\n", i, port->m_nodes[i]->m_name.c_str());
-			x->m_ports.push_back(port);
-		}
+		auto it = netIDs.find(node);
+		if(it != netIDs.end())
+			return it->second;
+
+		uint32_t id = m_index.m_nets.size();
+		node->m_index = id;
+		m_index.m_nets.push_back(node);
+		netIDs[node] = id;
+		return id;
+	};
+
+	//Number the named nets first.
+	//Note that NULL is legal in vector nets if some bits were optimized out
+	for(auto it = m_topModule->net_begin(); it != m_topModule->net_end(); it ++)
+	{
+		if(it->second != NULL)
+			getNet(it->second);
 	}
+	m_index.m_namedNetCount = m_index.m_nets.size();
 
-	//Loop over all of our cells and add their connections
+	//Number the cells and enumerate their pins
 	for(auto it = m_topModule->cell_begin(); it != m_topModule->cell_end(); it ++)
 	{
 		Greenpak4NetlistCell* cell = it->second;
+		uint32_t ncell = m_index.m_cells.size();
+		cell->m_index = ncell;
+		m_index.m_cells.push_back(cell);
+		m_index.m_cellTypes.push_back(cell->m_typeId);
+		m_index.m_cellPinStart.push_back(m_index.m_pinCell.size());
+
+		//Look up port directions once per cell rather than once per pin
+		Greenpak4NetlistModule* module = NULL;
+		auto mit = m_modules.find(cell->m_type);
+		if(mit != m_modules.end())
+			module = mit->second;
+
 		LogTrace("Cell %s connects to:\n", it->first.c_str());
 		LogIndenter li;
-		for(auto jt : cell->m_connections)
+		for(auto& jt : cell->m_connections)
 		{
-			string cellname = jt.first;
-			auto net = jt.second;
-			bool vector = false;
-			if(net.size() != 1)
-				vector = true;
+			const string& cellname = jt.first;
+			auto& net = jt.second;
+			bool vector = (net.size() != 1);
+
+			uint8_t flags = vector ? Greenpak4NetlistIndex::PIN_FLAG_VECTOR : 0;
+			Greenpak4NetlistPort* port = module ? module->FindPort(cellname) : NULL;
+			if(port == NULL)
+				flags |= Greenpak4NetlistIndex::PIN_FLAG_UNKNOWN_PORT;
+			else
+			{
+				if(port->m_direction != Greenpak4NetlistPort::DIR_INPUT)
+					flags |= Greenpak4NetlistIndex::PIN_FLAG_DRIVER;
+				if(port->m_direction != Greenpak4NetlistPort::DIR_OUTPUT)
+					flags |= Greenpak4NetlistIndex::PIN_FLAG_LOAD;
+			}
+			uint32_t portname = m_index.Intern(cellname);
+
 			for(unsigned int i=0; i<net.size(); i++)
 			{
 				Greenpak4NetlistNode* node = net[i];
+				if(node == NULL)
+					continue;
 				if(vector)
 					LogTrace("%s[%u]: net %s\n", cellname.c_str(), i, node->m_name.c_str());
 				else
 					LogTrace("%s: net %s\n", cellname.c_str(), node->m_name.c_str());
-				node->m_nodeports.push_back(Greenpak4NetlistNodePoint(cell, cellname, i, vector));
+
+				m_index.m_pinCell.push_back(ncell);
+				m_index.m_pinPort.push_back(portname);
+				m_index.m_pinBit.push_back(i);
+				m_index.m_pinFlags.push_back(flags);
+				m_index.m_pinNet.push_back(getNet(node));
 			}
 		}
 	}
+	m_index.m_cellPinStart.push_back(m_index.m_pinCell.size());
 
-	//Make a set of the nodes to avoid duplication.
-	//Note that NULL is legal in vector nets if some bits were optimized out
-	for(auto it = m_topModule->net_begin(); it != m_topModule->net_end(); it ++)
+	//Top-level ports may be the only thing on an otherwise unnamed net
+	vector< pair<uint32_t, Greenpak4NetlistPort*> > portbits;
+	for(auto it = m_topModule->port_begin(); it != m_topModule->port_end(); it ++)
 	{
-		if(it->second != NULL)
-			m_nodes.insert(it->second);
+		Greenpak4NetlistPort* port = it->second;
+		LogTrace("Port %s connects to:\n", it->first.c_str());
+		LogIndenter li;
+
+		for(unsigned int i=0; i<port->m_nodes.size(); i++)
+		{
+			LogTrace("bit %u: node %s\n", i, port->m_nodes[i]->m_name.c_str());
+			portbits.push_back(make_pair(getNet(port->m_nodes[i]), port));
+		}
+	}
+
+	//Bucket pins and ports by net (counting sort, so each net's pins stay in cell order)
+	size_t nnets = m_index.m_nets.size();
+	m_index.m_netPinStart.assign(nnets + 1, 0);
+	for(auto net : m_index.m_pinNet)
+		m_index.m_netPinStart[net + 1] ++;
+	for(size_t i=0; i<nnets; i++)
+		m_index.m_netPinStart[i+1] += m_index.m_netPinStart[i];
+
+	m_index.m_netPins.resize(m_index.m_pinNet.size());
+	vector<uint32_t> fill(m_index.m_netPinStart.begin(), m_index.m_netPinStart.end() - 1);
+	for(uint32_t pin=0; pin<m_index.m_pinNet.size(); pin++)
+		m_index.m_netPins[fill[m_index.m_pinNet[pin]] ++] = pin;
+
+	m_index.m_netPortStart.assign(nnets + 1, 0);
+	for(auto& p : portbits)
+		m_index.m_netPortStart[p.first + 1] ++;
+	for(size_t i=0; i<nnets; i++)
+		m_index.m_netPortStart[i+1] += m_index.m_netPortStart[i];
+
+	m_index.m_netPorts.resize(portbits.size());
+	fill.assign(m_index.m_netPortStart.begin(), m_index.m_netPortStart.end() - 1);
+	for(auto& p : portbits)
+		m_index.m_netPorts[fill[p.first] ++] = p.second;
+
+	//Generate the per-net views
+	for(uint32_t net=0; net<nnets; net++)
+	{
+		Greenpak4NetlistNode* node = m_index.m_nets[net];
+
+		node->m_ports.assign(
+			m_index.m_netPorts.begin() + m_index.m_netPortStart[net],
+			m_index.m_netPorts.begin() + m_index.m_netPortStart[net+1]);
+
+		node->m_nodeports.reserve(m_index.net_pins_end(net) - m_index.net_pins_begin(net));
+		for(auto p = m_index.net_pins_begin(net); p != m_index.net_pins_end(net); p++)
+			node->m_nodeports.push_back(m_index.GetNodePoint(*p));
+
+		if(net < m_index.m_namedNetCount)
+			m_nodes.insert(node);
 	}
 
 	//Print them out
@@ -312,6 +433,8 @@ void Greenpak4Netlist::IndexNets()
 		for(auto c : node->m_nodeports)
 			LogTrace("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
 	}
+
+	LogTrace("%zu cells, %zu nets, %zu pins\n", m_index.GetCellCount(), m_index.GetNetCount(), m_index.GetPinCount());
 }
 
 /**
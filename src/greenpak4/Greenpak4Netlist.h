@@ -34,8 +34,11 @@ class Greenpak4Netlist
 {
 public:
 	Greenpak4Netlist(std::string fname, std::string constraint_file = "");
+	Greenpak4Netlist();
 	virtual ~Greenpak4Netlist();
 
+	bool LoadFromString(const char* json_string);
+
 	Greenpak4NetlistModule* GetTopModule()
 	{ return m_topModule; }
 
@@ -52,12 +55,25 @@ public:
 
 	void Reindex();
 
+	//Flat view of the top-level module (only valid after indexing)
+	const Greenpak4NetlistIndex& GetIndex()
+	{ return m_index; }
+
 	//Returns true if we're good, false if parsing failed for some reason
 	bool Validate()
 	{ return m_parseOK; }
 
 	void LoadConstraints();
 
+	/**
+		@brief Returns a fresh ID for naming an inferred cell or net of the given kind.
+
+		Counters are per netlist (rather than global) so that independent netlists can be processed concurrently
+		and names don't depend on what else the process has done before.
+	 */
+	unsigned int AllocateAutoID(std::string kind)
+	{ return ++ m_autoIDs[kind]; }
+
 protected:
 
 	void IndexNets();
@@ -80,9 +96,15 @@ protected:
 	//All of the nets in the netlist
 	nodeset m_nodes;
 
+	//Flat cell/net/pin arrays for the top-level module
+	Greenpak4NetlistIndex m_index;
+
 	std::string m_constraintFname;
 
 	bool m_parseOK;
+
+	//Last ID handed out by AllocateAutoID() for each kind of inferred object
+	std::map<std::string, unsigned int> m_autoIDs;
 };
 
 #endif
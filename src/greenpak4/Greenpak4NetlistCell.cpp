@@ -18,9 +18,89 @@
 
 #include <log.h>
 #include <Greenpak4.h>
+#include <unordered_map>
 
 using namespace std;
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Primitive type table
+
+typedef Greenpak4NetlistCell NC;
+
+struct Greenpak4CellTypeInfo
+{
+	Greenpak4CellType	type;
+	const char*			name;
+	unsigned int		flags;
+};
+
+//Must be in the same order as Greenpak4CellType
+static const Greenpak4CellTypeInfo g_cellTypes[] =
+{
+	{ GP_CELL_UNKNOWN,		"",					0 },
+
+	{ GP_CELL_2LUT,			"GP_2LUT",			0 },
+	{ GP_CELL_3LUT,			"GP_3LUT",			0 },
+	{ GP_CELL_4LUT,			"GP_4LUT",			0 },
+	{ GP_CELL_ABUF,			"GP_ABUF",			0 },
+	{ GP_CELL_ACMP,			"GP_ACMP",			0 },
+	{ GP_CELL_BANDGAP,		"GP_BANDGAP",		0 },
+	{ GP_CELL_CLKBUF,		"GP_CLKBUF",		0 },
+	{ GP_CELL_COUNT14,		"GP_COUNT14",		NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_COUNT14_ADV,	"GP_COUNT14_ADV",	NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_COUNT8,		"GP_COUNT8",		NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_COUNT8_ADV,	"GP_COUNT8_ADV",	NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_DAC,			"GP_DAC",			0 },
+	{ GP_CELL_DCMP,			"GP_DCMP",			0 },
+	{ GP_CELL_DCMPMUX,		"GP_DCMPMUX",		0 },
+	{ GP_CELL_DCMPREF,		"GP_DCMPREF",		0 },
+	{ GP_CELL_DELAY,		"GP_DELAY",			0 },
+	{ GP_CELL_DFF,			"GP_DFF",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_DFFI,			"GP_DFFI",			NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DFFR,			"GP_DFFR",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_DFFRI,		"GP_DFFRI",			NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DFFS,			"GP_DFFS",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_DFFSI,		"GP_DFFSI",			NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DFFSR,		"GP_DFFSR",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_DFFSRI,		"GP_DFFSRI",		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DLATCH,		"GP_DLATCH",		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH },
+	{ GP_CELL_DLATCHI,		"GP_DLATCHI",
+		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DLATCHR,		"GP_DLATCHR",		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH },
+	{ GP_CELL_DLATCHRI,		"GP_DLATCHRI",
+		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DLATCHS,		"GP_DLATCHS",		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH },
+	{ GP_CELL_DLATCHSI,		"GP_DLATCHSI",
+		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_DLATCHSR,		"GP_DLATCHSR",		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH },
+	{ GP_CELL_DLATCHSRI,	"GP_DLATCHSRI",
+		NC::CELL_FLAG_STATEFUL | NC::CELL_FLAG_LATCH | NC::CELL_FLAG_INVERTED },
+	{ GP_CELL_EDGEDET,		"GP_EDGEDET",		0 },
+	{ GP_CELL_IBUF,			"GP_IBUF",			NC::CELL_FLAG_IOB | NC::CELL_FLAG_IBUF },
+	{ GP_CELL_INV,			"GP_INV",			0 },
+	{ GP_CELL_IOBUF,		"GP_IOBUF",			NC::CELL_FLAG_IOB | NC::CELL_FLAG_IBUF | NC::CELL_FLAG_OBUF },
+	{ GP_CELL_LFOSC,		"GP_LFOSC",			0 },
+	{ GP_CELL_OBUF,			"GP_OBUF",			NC::CELL_FLAG_IOB | NC::CELL_FLAG_OBUF },
+	{ GP_CELL_OBUFT,		"GP_OBUFT",			NC::CELL_FLAG_IOB },	//IsObuf() has never included tristates
+	{ GP_CELL_PGA,			"GP_PGA",			0 },
+	{ GP_CELL_PGEN,			"GP_PGEN",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_POR,			"GP_POR",			0 },
+	{ GP_CELL_PWM,			"GP_PWM",			0 },
+	{ GP_CELL_PWRDET,		"GP_PWRDET",		0 },
+	{ GP_CELL_RCOSC,		"GP_RCOSC",			0 },
+	{ GP_CELL_RINGOSC,		"GP_RINGOSC",		0 },
+	{ GP_CELL_SHREG,		"GP_SHREG",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_SPI,			"GP_SPI",			NC::CELL_FLAG_STATEFUL },
+	{ GP_CELL_SYSRESET,		"GP_SYSRESET",		0 },
+	{ GP_CELL_VDD,			"GP_VDD",			NC::CELL_FLAG_POWER_RAIL },
+	{ GP_CELL_VREF,			"GP_VREF",			0 },
+	{ GP_CELL_VSS,			"GP_VSS",			NC::CELL_FLAG_POWER_RAIL }
+};
+
+static_assert(
+	sizeof(g_cellTypes) / sizeof(g_cellTypes[0]) == GP_CELL_TYPE_COUNT,
+	"g_cellTypes is out of sync with Greenpak4CellType");
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
@@ -29,6 +109,53 @@ Greenpak4NetlistCell::~Greenpak4NetlistCell()
 	//do not delete wires, module dtor handles that
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type interning
+
+/**
+	@brief Look up the interned ID for a primitive name, or GP_CELL_UNKNOWN if it isn't one
+ */
+Greenpak4CellType Greenpak4NetlistCell::LookupType(string type)
+{
+	//Built on first use, read-only afterwards
+	static const unordered_map<string, Greenpak4CellType> types = []
+	{
+		unordered_map<string, Greenpak4CellType> ret;
+		for(int i=GP_CELL_UNKNOWN+1; i<GP_CELL_TYPE_COUNT; i++)
+			ret[g_cellTypes[i].name] = g_cellTypes[i].type;
+		return ret;
+	}();
+
+	auto it = types.find(type);
+	if(it == types.end())
+		return GP_CELL_UNKNOWN;
+	return it->second;
+}
+
+const char* Greenpak4NetlistCell::GetTypeName(Greenpak4CellType type)
+{
+	if( (type < 0) || (type >= GP_CELL_TYPE_COUNT) )
+		return "";
+	return g_cellTypes[type].name;
+}
+
+unsigned int Greenpak4NetlistCell::GetTypeFlags(Greenpak4CellType type)
+{
+	if( (type < 0) || (type >= GP_CELL_TYPE_COUNT) )
+		return 0;
+	return g_cellTypes[type].flags;
+}
+
+/**
+	@brief Sets the type string and resolves the interned ID and predicate flags for it
+ */
+void Greenpak4NetlistCell::SetType(string type)
+{
+	m_type = type;
+	m_typeId = LookupType(type);
+	m_typeFlags = GetTypeFlags(m_typeId);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Accessors
 
@@ -41,11 +168,11 @@ string Greenpak4NetlistCell::GetLOC()
 	{
 		//Get the top-level pad signal as this is always the vector
 		string port;
-		if( (m_type == "GP_OBUF") || (m_type == "GP_OBUFT") )
+		if( (m_typeId == GP_CELL_OBUF) || (m_typeId == GP_CELL_OBUFT) )
 			port = "OUT";
-		else if(m_type == "GP_IBUF")
+		else if(m_typeId == GP_CELL_IBUF)
 			port = "IN";
-		else if(m_type == "GP_IOBUF")
+		else if(m_typeId == GP_CELL_IOBUF)
 			port = "IO";
 		auto cn = m_connections[port];
 
@@ -101,21 +228,3 @@ string Greenpak4NetlistCell::GetLOC()
 	else
 		return loc;
 }
-
-bool Greenpak4NetlistCell::IsStateful()
-{
-	if(m_type.find("GP_COUNT") == 0)
-		return true;
-	if(m_type.find("GP_DFF") == 0)
-		return true;
-	if(m_type.find("GP_DLATCH") == 0)
-		return true;
-	if(m_type == "GP_PGEN")
-		return true;
-	if(m_type.find("GP_SHREG") == 0)
-		return true;
-	if(m_type.find("GP_SPI") == 0)
-		return true;
-
-	return false;
-}
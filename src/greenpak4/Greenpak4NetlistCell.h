@@ -21,6 +21,72 @@
 
 class Greenpak4NetlistModule;
 
+/**
+	@brief Interned primitive type of a netlist cell
+
+	Resolved once from the type string when the netlist is loaded so that type checks during PAR and bitstream
+	generation are integer compares rather than string compares.
+ */
+enum Greenpak4CellType
+{
+	GP_CELL_UNKNOWN,		//not a GreenPak4 primitive (hierarchical module, or garbage)
+
+	GP_CELL_2LUT,
+	GP_CELL_3LUT,
+	GP_CELL_4LUT,
+	GP_CELL_ABUF,
+	GP_CELL_ACMP,
+	GP_CELL_BANDGAP,
+	GP_CELL_CLKBUF,
+	GP_CELL_COUNT14,
+	GP_CELL_COUNT14_ADV,
+	GP_CELL_COUNT8,
+	GP_CELL_COUNT8_ADV,
+	GP_CELL_DAC,
+	GP_CELL_DCMP,
+	GP_CELL_DCMPMUX,
+	GP_CELL_DCMPREF,
+	GP_CELL_DELAY,
+	GP_CELL_DFF,
+	GP_CELL_DFFI,
+	GP_CELL_DFFR,
+	GP_CELL_DFFRI,
+	GP_CELL_DFFS,
+	GP_CELL_DFFSI,
+	GP_CELL_DFFSR,
+	GP_CELL_DFFSRI,
+	GP_CELL_DLATCH,
+	GP_CELL_DLATCHI,
+	GP_CELL_DLATCHR,
+	GP_CELL_DLATCHRI,
+	GP_CELL_DLATCHS,
+	GP_CELL_DLATCHSI,
+	GP_CELL_DLATCHSR,
+	GP_CELL_DLATCHSRI,
+	GP_CELL_EDGEDET,
+	GP_CELL_IBUF,
+	GP_CELL_INV,
+	GP_CELL_IOBUF,
+	GP_CELL_LFOSC,
+	GP_CELL_OBUF,
+	GP_CELL_OBUFT,
+	GP_CELL_PGA,
+	GP_CELL_PGEN,
+	GP_CELL_POR,
+	GP_CELL_PWM,
+	GP_CELL_PWRDET,
+	GP_CELL_RCOSC,
+	GP_CELL_RINGOSC,
+	GP_CELL_SHREG,
+	GP_CELL_SPI,
+	GP_CELL_SYSRESET,
+	GP_CELL_VDD,
+	GP_CELL_VREF,
+	GP_CELL_VSS,
+
+	GP_CELL_TYPE_COUNT		//must be last
+};
+
 //only for RTTI support and naming
 class Greenpak4NetlistEntity
 {
@@ -40,10 +106,34 @@ class Greenpak4NetlistCell : public Greenpak4NetlistEntity
 {
 public:
 	Greenpak4NetlistCell(Greenpak4NetlistModule* module)
-	: m_parent(module)
+	: m_typeId(GP_CELL_UNKNOWN)
+	, m_typeFlags(0)
+	, m_index(0)
+	, m_parent(module)
 	{ m_parnode = NULL; }
 	virtual ~Greenpak4NetlistCell();
 
+	//Predicates precomputed for each primitive type
+	enum CellTypeFlags
+	{
+		CELL_FLAG_IOB			= 0x01,
+		CELL_FLAG_IBUF			= 0x02,
+		CELL_FLAG_OBUF			= 0x04,
+		CELL_FLAG_POWER_RAIL	= 0x08,
+		CELL_FLAG_STATEFUL		= 0x10,
+		CELL_FLAG_LATCH			= 0x20,		//GP_DLATCH*
+		CELL_FLAG_INVERTED		= 0x40		//flipflop or latch with inverted output
+	};
+
+	void SetType(std::string type);
+
+	static Greenpak4CellType LookupType(std::string type);
+	static const char* GetTypeName(Greenpak4CellType type);
+	static unsigned int GetTypeFlags(Greenpak4CellType type);
+
+	bool HasTypeFlag(unsigned int flag)
+	{ return (m_typeFlags & flag) ? true : false; }
+
 	bool HasParameter(std::string att)
 	{ return m_parameters.find(att) != m_parameters.end(); }
 
@@ -52,31 +142,38 @@ public:
 
 	//Indicates whether the cell is an I/O buffer
 	bool IsIOB()
-	{ return (m_type == "GP_IBUF") || (m_type == "GP_IOBUF") || (m_type == "GP_OBUF") || (m_type == "GP_OBUFT"); }
+	{ return HasTypeFlag(CELL_FLAG_IOB); }
 
 	//Indicates whether the cell is an input buffer
 	bool IsIbuf()
-	{ return (m_type == "GP_IBUF") || (m_type == "GP_IOBUF"); }
+	{ return HasTypeFlag(CELL_FLAG_IBUF); }
 
 	//Indicates whether the cell is an output buffer
 	bool IsObuf()
-	{ return (m_type == "GP_OBUF") || (m_type == "GP_IOBUF"); }
+	{ return HasTypeFlag(CELL_FLAG_OBUF); }
 
 	//Indicates whether the cell is a power rail
 	bool IsPowerRail()
-	{ return (m_type == "GP_VDD") || (m_type == "GP_VSS"); }
+	{ return HasTypeFlag(CELL_FLAG_POWER_RAIL); }
 
 	//Indicates whether the cell is stateful (can start or end a combinatorial path)
-	bool IsStateful();
+	bool IsStateful()
+	{ return HasTypeFlag(CELL_FLAG_STATEFUL); }
 
 	std::string GetLOC();
 
 	bool HasLOC()
 	{ return (m_attributes.find("LOC") != m_attributes.end()); }
 
-	///Module name
+	///Module name (call SetType() to change it so m_typeId stays in sync)
 	std::string m_type;
 
+	///Interned primitive type, GP_CELL_UNKNOWN if m_type isn't a primitive
+	Greenpak4CellType m_typeId;
+
+	///CELL_FLAG_* predicates for m_typeId
+	unsigned int m_typeFlags;
+
 	std::map<std::string, std::string> m_parameters;
 	std::map<std::string, std::string> m_attributes;
 
@@ -91,6 +188,9 @@ public:
 
 	PARGraphNode* m_parnode;
 
+	//Our position in Greenpak4NetlistIndex::m_cells (only valid after indexing)
+	uint32_t m_index;
+
 	//Parent module of the cell, not the module we're an instance of
 	Greenpak4NetlistModule* m_parent;
 };
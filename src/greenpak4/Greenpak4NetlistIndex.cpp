@@ -0,0 +1,71 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4NetlistIndex::Greenpak4NetlistIndex()
+	: m_namedNetCount(0)
+{
+}
+
+void Greenpak4NetlistIndex::Clear()
+{
+	m_cells.clear();
+	m_cellTypes.clear();
+	m_cellPinStart.clear();
+
+	m_nets.clear();
+	m_namedNetCount = 0;
+
+	m_pinCell.clear();
+	m_pinPort.clear();
+	m_pinBit.clear();
+	m_pinFlags.clear();
+	m_pinNet.clear();
+
+	m_netPinStart.clear();
+	m_netPins.clear();
+	m_netPortStart.clear();
+	m_netPorts.clear();
+
+	//Keep the string table, the same port names come back on every reindex
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// String interning
+
+/**
+	@brief Returns the ID of a string, adding it to the table if it's not already there
+ */
+uint32_t Greenpak4NetlistIndex::Intern(const string& str)
+{
+	auto it = m_stringIDs.find(str);
+	if(it != m_stringIDs.end())
+		return it->second;
+
+	uint32_t id = m_strings.size();
+	m_strings.push_back(str);
+	m_stringIDs[str] = id;
+	return id;
+}
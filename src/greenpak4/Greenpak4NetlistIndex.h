@@ -0,0 +1,122 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4NetlistIndex_h
+#define Greenpak4NetlistIndex_h
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/**
+	@brief Flat, index-based copy of the top-level module's connectivity
+
+	Cells, nets and cell pins (one per bit of every cell connection) are numbered densely and kept in arrays, port
+	names are interned, and the pins on each net are stored in CSR form. Passes that visit the whole netlist can walk
+	it linearly instead of chasing map entries and comparing port name strings.
+
+	The map-based module, cell and net objects remain the primary API. Every entry here points back at them, and the
+	per-net Greenpak4NetlistNode::m_nodeports / m_ports lists are generated from this index.
+
+	Built by Greenpak4Netlist::IndexNets(), so it must be rebuilt (Greenpak4Netlist::Reindex()) after the netlist is
+	modified.
+ */
+class Greenpak4NetlistIndex
+{
+public:
+	Greenpak4NetlistIndex();
+
+	void Clear();
+
+	uint32_t Intern(const std::string& str);
+
+	const std::string& GetString(uint32_t id) const
+	{ return m_strings[id]; }
+
+	enum PinFlags
+	{
+		PIN_FLAG_VECTOR			= 0x01,		//connection is more than one bit wide
+		PIN_FLAG_DRIVER			= 0x02,		//port is an output or inout
+		PIN_FLAG_LOAD			= 0x04,		//port is an input or inout
+		PIN_FLAG_UNKNOWN_PORT	= 0x08		//cell's module has no port by this name
+	};
+
+	//Marks a pin that isn't connected to any net
+	static const uint32_t NO_NET = 0xffffffff;
+
+	size_t GetCellCount() const
+	{ return m_cells.size(); }
+
+	size_t GetNetCount() const
+	{ return m_nets.size(); }
+
+	size_t GetPinCount() const
+	{ return m_pinCell.size(); }
+
+	//Pins on a net, as indexes into the m_pin* arrays
+	const uint32_t* net_pins_begin(uint32_t net) const
+	{ return m_netPins.data() + m_netPinStart[net]; }
+
+	const uint32_t* net_pins_end(uint32_t net) const
+	{ return m_netPins.data() + m_netPinStart[net+1]; }
+
+	Greenpak4NetlistNodePoint GetNodePoint(uint32_t pin) const
+	{
+		return Greenpak4NetlistNodePoint(
+			m_cells[m_pinCell[pin]],
+			m_strings[m_pinPort[pin]],
+			m_pinBit[pin],
+			(m_pinFlags[pin] & PIN_FLAG_VECTOR) != 0);
+	}
+
+	///Cells, in name order
+	std::vector<Greenpak4NetlistCell*> m_cells;
+
+	///Interned type of each cell
+	std::vector<Greenpak4CellType> m_cellTypes;
+
+	///Pins of cell i are [m_cellPinStart[i], m_cellPinStart[i+1])
+	std::vector<uint32_t> m_cellPinStart;
+
+	///Nets: the named ones first in name order (each only once, however many names it has), then any unnamed ones
+	std::vector<Greenpak4NetlistNode*> m_nets;
+
+	///Number of named nets at the start of m_nets
+	uint32_t m_namedNetCount;
+
+	//Pin table, one entry per pin, grouped by cell
+	std::vector<uint32_t> m_pinCell;
+	std::vector<uint32_t> m_pinPort;		//interned port name
+	std::vector<uint32_t> m_pinBit;
+	std::vector<uint8_t> m_pinFlags;
+	std::vector<uint32_t> m_pinNet;
+
+	///Pins of net i are m_netPins[m_netPinStart[i] ... m_netPinStart[i+1]-1], in the same order as m_pinCell
+	std::vector<uint32_t> m_netPinStart;
+	std::vector<uint32_t> m_netPins;
+
+	///Top-level ports on net i are m_netPorts[m_netPortStart[i] ... m_netPortStart[i+1]-1], one entry per port bit
+	std::vector<uint32_t> m_netPortStart;
+	std::vector<Greenpak4NetlistPort*> m_netPorts;
+
+protected:
+	std::vector<std::string> m_strings;
+	std::unordered_map<std::string, uint32_t> m_stringIDs;
+};
+
+#endif
@@ -165,13 +165,13 @@ void Greenpak4NetlistModule::CreatePowerNets()
 	//Create driver cells for them
 	Greenpak4NetlistCell* vcell = new Greenpak4NetlistCell(this);
 	vcell->m_name = vdd;
-	vcell->m_type = vdd;
+	vcell->SetType(vdd);
 	vcell->m_connections["OUT"].push_back(m_vdd);
 	m_cells[vdd] = vcell;
 
 	Greenpak4NetlistCell* gcell = new Greenpak4NetlistCell(this);
 	gcell->m_name = vss;
-	gcell->m_type = vss;
+	gcell->SetType(vss);
 	gcell->m_connections["OUT"].push_back(m_vss);
 	m_cells[vss] = gcell;
 }
@@ -215,12 +215,12 @@ void Greenpak4NetlistModule::AddWireAttribute(string target, string name, string
 		return;
 	}
 
-	if( (driver.m_portname == "IN") && (driver.m_cell->m_type == "GP_IBUF") )
+	if( (driver.m_portname == "IN") && (driver.m_cell->m_typeId == GP_CELL_IBUF) )
 	{
 		LogDebug("Wire drives input buffer %s, constraining that instead\n", driver.m_cell->m_name.c_str());
 		driver.m_cell->m_attributes[name] = value;
 	}
-	else if( (driver.m_portname == "IO") && (driver.m_cell->m_type == "GP_IOBUF") )
+	else if( (driver.m_portname == "IO") && (driver.m_cell->m_typeId == GP_CELL_IOBUF) )
 	{
 		LogDebug("Wire drives input/output buffer %s, constraining that instead\n", driver.m_cell->m_name.c_str());
 		driver.m_cell->m_attributes[name] = value;
@@ -299,7 +299,7 @@ void Greenpak4NetlistModule::LoadCell(std::string name, json_object* object)
 				return;
 			}
 
-			cell->m_type = json_object_get_string(child);
+			cell->SetType(json_object_get_string(child));
 		}
 
 		else if(cname == "attributes")
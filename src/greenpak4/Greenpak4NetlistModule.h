@@ -74,6 +74,15 @@ public:
 	Greenpak4NetlistPort* GetPort(std::string name)
 	{ return m_ports[name]; }
 
+	//Like GetPort(), but returns NULL instead of adding an empty entry if there's no such port
+	Greenpak4NetlistPort* FindPort(const std::string& name)
+	{
+		auto it = m_ports.find(name);
+		if(it == m_ports.end())
+			return NULL;
+		return it->second;
+	}
+
 	Greenpak4Netlist* GetNetlist()
 	{ return m_parent; }
 
@@ -72,6 +72,9 @@ public:
 
 	//List of ports we link to (only valid after indexing)
 	std::vector<Greenpak4NetlistPort*> m_ports;
+
+	//Our position in Greenpak4NetlistIndex::m_nets (only valid after indexing)
+	uint32_t m_index;
 };
 
 #endif
@@ -23,6 +23,7 @@ using namespace std;
 
 Greenpak4NetlistNode::Greenpak4NetlistNode()
 	: m_driver(NULL, "", -1, false)
+	, m_index(0)
 {
 }
 
@@ -59,6 +59,8 @@ vector<string> Greenpak4PGA::GetInputPorts() const
 
 void Greenpak4PGA::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "VIN_P")
 		m_vinp = src;
 	else if(port == "VIN_N")
@@ -138,6 +138,7 @@ bool Greenpak4PairedEntity::SetEntityType(string type)
 		return false;
 
 	m_activeEntity = m_emap[type];
+	MarkDirty();
 
 	//Need to copy the PAR node over so it can reference things
 	GetActiveEntity()->SetPARNode(m_parnode);
@@ -145,9 +146,35 @@ bool Greenpak4PairedEntity::SetEntityType(string type)
 	return true;
 }
 
+/**
+	@brief Returns the underlying entity which SetEntityType() would select for the given type, or NULL if unsupported
+ */
+Greenpak4BitstreamEntity* Greenpak4PairedEntity::GetEntityForType(string type) const
+{
+	auto it = m_emap.find(type);
+	if(it == m_emap.end())
+		return NULL;
+	return m_entities[it->second];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialization
 
+/**
+	@brief We're dirty if our select bit changed, or if either of our underlying entities was reconfigured directly
+ */
+bool Greenpak4PairedEntity::IsDirty() const
+{
+	return m_dirty || m_entities[0]->IsDirty() || m_entities[1]->IsDirty();
+}
+
+void Greenpak4PairedEntity::ClearDirty()
+{
+	m_dirty = false;
+	m_entities[0]->ClearDirty();
+	m_entities[1]->ClearDirty();
+}
+
 bool Greenpak4PairedEntity::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
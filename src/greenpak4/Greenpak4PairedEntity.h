@@ -54,6 +54,9 @@ public:
 
 	virtual bool CommitChanges();
 
+	virtual bool IsDirty() const;
+	virtual void ClearDirty();
+
 	Greenpak4BitstreamEntity* GetEntity(std::string type)
 	{ return m_entities[m_emap[type]]; }
 
@@ -62,6 +65,7 @@ public:
 
 	void AddType(std::string type, bool entity);
 	bool SetEntityType(std::string type);
+	Greenpak4BitstreamEntity* GetEntityForType(std::string type) const;
 
 	virtual std::string GetPrimitiveName() const;
 
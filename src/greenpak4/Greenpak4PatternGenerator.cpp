@@ -144,6 +144,8 @@ vector<string> Greenpak4PatternGenerator::GetInputPorts() const
 
 void Greenpak4PatternGenerator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "CLK")
 		m_clk = src;
 
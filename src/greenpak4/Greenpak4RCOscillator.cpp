@@ -63,6 +63,8 @@ vector<string> Greenpak4RCOscillator::GetInputPorts() const
 
 void Greenpak4RCOscillator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "PWRDN")
 		m_powerDown = src;
 
@@ -62,6 +62,8 @@ vector<string> Greenpak4RingOscillator::GetInputPorts() const
 
 void Greenpak4RingOscillator::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "PWRDN")
 		m_powerDown = src;
 
@@ -66,6 +66,8 @@ vector<string> Greenpak4SPI::GetInputPorts() const
 
 void Greenpak4SPI::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "CSN")
 		m_csn = src;
 
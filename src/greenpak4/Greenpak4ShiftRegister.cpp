@@ -66,6 +66,8 @@ vector<string> Greenpak4ShiftRegister::GetInputPorts() const
 
 void Greenpak4ShiftRegister::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "IN")
 		m_input = src;
 	else if(port == "nRST")
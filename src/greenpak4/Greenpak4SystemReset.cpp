@@ -73,6 +73,8 @@ unsigned int Greenpak4SystemReset::GetOutputNetNumber(string /*port*/)
 
 void Greenpak4SystemReset::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "RST")
 		m_reset = src;
 
@@ -48,7 +48,10 @@ public:
 	};
 
 	void SetResetMode(ResetMode mode)
-	{ m_resetMode = mode; }
+	{
+		m_resetMode = mode;
+		MarkDirty();
+	}
 
 	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
 	virtual Greenpak4EntityOutput GetInput(std::string port) const;
@@ -0,0 +1,469 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <log.h>
+#include <Greenpak4.h>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static_assert(sizeof(CombinatorialDelay) == 2*sizeof(float), "CombinatorialDelay must be two packed floats");
+
+static const char g_magic[8] = "GP4TDB";
+static const uint32_t g_byteOrder = 0x01020304;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4TimingDatabase::Greenpak4TimingDatabase()
+	: m_data(NULL)
+	, m_size(0)
+{
+}
+
+Greenpak4TimingDatabase::~Greenpak4TimingDatabase()
+{
+	Unmap();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Discovery
+
+/**
+	@brief Checks whether a file is a compiled timing database (as opposed to JSON)
+ */
+bool Greenpak4TimingDatabase::IsDatabase(string fname)
+{
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(!fp)
+		return false;
+	char magic[sizeof(g_magic)];
+	bool ok = (fread(magic, 1, sizeof(magic), fp) == sizeof(magic)) && (0 == memcmp(magic, g_magic, sizeof(magic)));
+	fclose(fp);
+	return ok;
+}
+
+/**
+	@brief Looks for the timing database for a part
+
+	Each directory in $GP4_TIMING_PATH (colon separated, or semicolon on Windows) is searched for <part>.gp4t, then
+	the install location (normally $prefix/share/openfpga/timing).
+
+	@return Path to the database, or an empty string if there isn't one
+ */
+string Greenpak4TimingDatabase::Find(string part)
+{
+#ifdef _WIN32
+	const char separator = ';';
+#else
+	const char separator = ':';
+#endif
+
+	vector<string> dirs;
+	const char* env = getenv("GP4_TIMING_PATH");
+	if(env)
+	{
+		string path = env;
+		size_t start = 0;
+		while(start <= path.length())
+		{
+			size_t end = path.find(separator, start);
+			if(end == string::npos)
+				end = path.length();
+			if(end > start)
+				dirs.push_back(path.substr(start, end - start));
+			start = end + 1;
+		}
+	}
+#ifdef GP4_TIMING_DIR
+	dirs.push_back(GP4_TIMING_DIR);
+#endif
+
+	for(auto dir : dirs)
+	{
+		string fname = dir + "/" + part + ".gp4t";
+		LogDebug("Looking for timing database %s\n", fname.c_str());
+		if(IsDatabase(fname))
+			return fname;
+	}
+	return "";
+}
+
+/**
+	@brief Hashes everything about how the device is modeled that the database layout depends on
+ */
+uint64_t Greenpak4TimingDatabase::GetModelHash(Greenpak4Device* device)
+{
+	//FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto update = [&hash](const string& s)
+	{
+		for(size_t i=0; i<=s.length(); i++)
+		{
+			hash ^= static_cast<uint8_t>(s.c_str()[i]);
+			hash *= 0x100000001b3ULL;
+		}
+	};
+
+	char tmp[32];
+	snprintf(tmp, sizeof(tmp), "%u", FORMAT_VERSION);
+	update(tmp);
+	update(device->GetPartAsString());
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+		vector<PTVDelayTable*> tables;
+		entity->GetTimingTables(tables);
+
+		update(entity->GetDescription());
+		snprintf(tmp, sizeof(tmp), "%zu", tables.size());
+		update(tmp);
+	}
+	return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Serialization
+
+static void Append(vector<uint8_t>& buf, const void* data, size_t len)
+{
+	const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+	buf.insert(buf.end(), p, p + len);
+}
+
+static void Align(vector<uint8_t>& buf, size_t alignment)
+{
+	while(buf.size() % alignment)
+		buf.push_back(0);
+}
+
+/**
+	@brief Compiles a device's timing data (normally just loaded from JSON) into a database
+ */
+bool Greenpak4TimingDatabase::Write(string fname, Greenpak4Device* device)
+{
+	//Figure out which tables have anything in them
+	vector<TableRecord> records;
+	vector<PTVDelayTable*> sources;
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		vector<PTVDelayTable*> tables;
+		device->GetEntity(i)->GetTimingTables(tables);
+		for(unsigned int j=0; j<tables.size(); j++)
+		{
+			if(tables[j]->empty())
+				continue;
+
+			TableRecord r;
+			memset(&r, 0, sizeof(r));
+			r.m_entity = i;
+			r.m_slot = j;
+			records.push_back(r);
+			sources.push_back(tables[j]);
+		}
+	}
+
+	//Header and table list go first, then the data for each table
+	vector<uint8_t> buf(sizeof(Header) + records.size()*sizeof(TableRecord), 0);
+	for(size_t i=0; i<records.size(); i++)
+	{
+		auto& r = records[i];
+		auto t = sources[i];
+
+		r.m_portCount = t->GetPortCount();
+		r.m_tempCount = t->GetTemps().size();
+		r.m_voltageCount = t->GetVoltages().size();
+		r.m_validCount = t->GetValidCount();
+
+		r.m_portsOffset = buf.size();
+		for(unsigned int j=0; j<r.m_portCount; j++)
+		{
+			auto& name = t->GetPortName(j);
+			Append(buf, name.c_str(), name.length() + 1);
+		}
+
+		Align(buf, 8);
+		r.m_tempsOffset = buf.size();
+		for(int temp : t->GetTemps())
+		{
+			int32_t v = temp;
+			Append(buf, &v, sizeof(v));
+		}
+		r.m_voltagesOffset = buf.size();
+		for(int voltage : t->GetVoltages())
+		{
+			int32_t v = voltage;
+			Append(buf, &v, sizeof(v));
+		}
+
+		Align(buf, 8);
+		r.m_delaysOffset = buf.size();
+		Append(buf, t->GetDelayData(), t->GetEntryCount() * sizeof(CombinatorialDelay));
+		r.m_validOffset = buf.size();
+		Append(buf, t->GetValidData(), t->GetEntryCount());
+	}
+	Align(buf, 8);
+
+	Header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.m_magic, g_magic, sizeof(h.m_magic));
+	h.m_version = FORMAT_VERSION;
+	h.m_byteOrder = g_byteOrder;
+	h.m_modelHash = GetModelHash(device);
+	strncpy(h.m_part, device->GetPartAsString().c_str(), sizeof(h.m_part) - 1);
+	h.m_entityCount = device->GetEntityCount();
+	h.m_tableCount = records.size();
+	h.m_fileSize = buf.size();
+	memcpy(&buf[0], &h, sizeof(h));
+	if(!records.empty())
+		memcpy(&buf[sizeof(h)], &records[0], records.size() * sizeof(TableRecord));
+
+	FILE* fp = fopen(fname.c_str(), "wb");
+	if(!fp)
+	{
+		LogError("Couldn't open timing database %s for writing\n", fname.c_str());
+		return false;
+	}
+	bool ok = (fwrite(&buf[0], 1, buf.size(), fp) == buf.size());
+	if(0 != fclose(fp))
+		ok = false;
+	if(!ok)
+		LogError("Failed to write timing database %s\n", fname.c_str());
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+
+bool Greenpak4TimingDatabase::Map(string fname)
+{
+	Unmap();
+
+#ifdef _WIN32
+	//No mmap, just read the whole thing
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(!fp)
+		return false;
+	fseek(fp, 0, SEEK_END);
+	long len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if(len <= 0)
+	{
+		fclose(fp);
+		return false;
+	}
+	uint8_t* data = new uint8_t[len];
+	if(fread(data, 1, len, fp) != static_cast<size_t>(len))
+	{
+		delete[] data;
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	m_data = data;
+	m_size = len;
+#else
+	int fd = open(fname.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+	struct stat st;
+	if( (0 != fstat(fd, &st)) || (st.st_size <= 0) )
+	{
+		close(fd);
+		return false;
+	}
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
+		return false;
+	m_data = reinterpret_cast<const uint8_t*>(data);
+	m_size = st.st_size;
+#endif
+
+	return true;
+}
+
+void Greenpak4TimingDatabase::Unmap()
+{
+	if(!m_data)
+		return;
+
+#ifdef _WIN32
+	delete[] m_data;
+#else
+	munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	m_data = NULL;
+	m_size = 0;
+}
+
+/**
+	@brief Maps a database and attaches every delay table in the device to it.
+
+	The database must stay alive as long as the device is using its timing data.
+ */
+bool Greenpak4TimingDatabase::Load(string fname, Greenpak4Device* device)
+{
+	if(!Map(fname))
+	{
+		LogError("Couldn't map timing database %s\n", fname.c_str());
+		return false;
+	}
+
+	//Sanity check the header
+	if(m_size < sizeof(Header))
+	{
+		LogError("Timing database %s is truncated\n", fname.c_str());
+		return false;
+	}
+	const Header* h = reinterpret_cast<const Header*>(m_data);
+	if(0 != memcmp(h->m_magic, g_magic, sizeof(g_magic)))
+	{
+		LogError("%s is not a timing database\n", fname.c_str());
+		return false;
+	}
+	if( (h->m_version != FORMAT_VERSION) || (h->m_byteOrder != g_byteOrder) )
+	{
+		LogError("Timing database %s was compiled by an incompatible version of gp4tdb or on another platform, "
+			"please regenerate it\n", fname.c_str());
+		return false;
+	}
+	if(h->m_fileSize != m_size)
+	{
+		LogError("Timing database %s is truncated\n", fname.c_str());
+		return false;
+	}
+	string part(h->m_part, strnlen(h->m_part, sizeof(h->m_part)));
+	if(part != device->GetPartAsString())
+	{
+		LogError("Timing data is for part %s but we're a %s\n", part.c_str(), device->GetPartAsString().c_str());
+		return false;
+	}
+	if( (h->m_modelHash != GetModelHash(device)) || (h->m_entityCount != device->GetEntityCount()) )
+	{
+		LogError("Timing database %s was compiled against a different device model, please regenerate it\n",
+			fname.c_str());
+		return false;
+	}
+	if(!InBounds(sizeof(Header), static_cast<uint64_t>(h->m_tableCount) * sizeof(TableRecord)))
+	{
+		LogError("Timing database %s is truncated\n", fname.c_str());
+		return false;
+	}
+
+	//Validate every table before attaching any of them, so a bad file can't leave the device half loaded
+	struct Attachment
+	{
+		PTVDelayTable* m_table;
+		vector<string> m_ports;
+		vector<int> m_temps;
+		vector<int> m_voltages;
+		const TableRecord* m_record;
+	};
+	vector<Attachment> attachments;
+
+	const TableRecord* records = reinterpret_cast<const TableRecord*>(m_data + sizeof(Header));
+	unsigned int entity = device->GetEntityCount();
+	vector<PTVDelayTable*> tables;
+	for(uint32_t i=0; i<h->m_tableCount; i++)
+	{
+		auto& r = records[i];
+
+		if(r.m_entity >= device->GetEntityCount())
+		{
+			LogError("Timing database %s is corrupt (bad entity %u)\n", fname.c_str(), r.m_entity);
+			return false;
+		}
+		if(r.m_entity != entity)
+		{
+			entity = r.m_entity;
+			tables.clear();
+			device->GetEntity(entity)->GetTimingTables(tables);
+		}
+		if(r.m_slot >= tables.size())
+		{
+			LogError("Timing database %s is corrupt (bad table %u)\n", fname.c_str(), r.m_slot);
+			return false;
+		}
+
+		Attachment a;
+		a.m_table = tables[r.m_slot];
+		a.m_record = &r;
+
+		//Port names
+		uint64_t off = r.m_portsOffset;
+		for(uint32_t j=0; j<r.m_portCount; j++)
+		{
+			const void* nul = InBounds(off, 1) ? memchr(m_data + off, 0, m_size - off) : NULL;
+			if(!nul)
+			{
+				LogError("Timing database %s is corrupt (bad port name)\n", fname.c_str());
+				return false;
+			}
+			a.m_ports.push_back(reinterpret_cast<const char*>(m_data + off));
+			off = reinterpret_cast<const uint8_t*>(nul) - m_data + 1;
+		}
+
+		//Grid axes
+		if(!InBounds(r.m_tempsOffset, r.m_tempCount * sizeof(int32_t)) ||
+			!InBounds(r.m_voltagesOffset, r.m_voltageCount * sizeof(int32_t)) )
+		{
+			LogError("Timing database %s is corrupt (bad grid)\n", fname.c_str());
+			return false;
+		}
+		const int32_t* t = reinterpret_cast<const int32_t*>(m_data + r.m_tempsOffset);
+		const int32_t* v = reinterpret_cast<const int32_t*>(m_data + r.m_voltagesOffset);
+		a.m_temps.assign(t, t + r.m_tempCount);
+		a.m_voltages.assign(v, v + r.m_voltageCount);
+
+		//The data itself
+		uint64_t entries = static_cast<uint64_t>(r.m_portCount) * r.m_portCount * PTVDelayTable::NUM_SPEEDS *
+			r.m_tempCount * r.m_voltageCount;
+		if( (r.m_delaysOffset % 8) ||
+			!InBounds(r.m_delaysOffset, entries * sizeof(CombinatorialDelay)) ||
+			!InBounds(r.m_validOffset, entries) )
+		{
+			LogError("Timing database %s is corrupt (bad delay table)\n", fname.c_str());
+			return false;
+		}
+		attachments.push_back(a);
+	}
+
+	for(auto& a : attachments)
+	{
+		a.m_table->Attach(
+			a.m_ports,
+			a.m_temps,
+			a.m_voltages,
+			reinterpret_cast<const CombinatorialDelay*>(m_data + a.m_record->m_delaysOffset),
+			m_data + a.m_record->m_validOffset,
+			a.m_record->m_validCount);
+	}
+
+	return true;
+}
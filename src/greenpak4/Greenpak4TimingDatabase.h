@@ -0,0 +1,102 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4TimingDatabase_h
+#define Greenpak4TimingDatabase_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Greenpak4Device;
+
+/**
+	@brief Compiled, memory-mapped timing data for one part
+
+	gp4tdb converts the JSON timing data written by gp4tchar into a flat binary file which is mmap()ed at load time.
+	Every delay table in the device is attached directly to the mapped delay and valid arrays, so nothing is parsed
+	or copied except port names and the (short) temperature and voltage axes.
+
+	File layout (native byte order, all offsets from the start of the file):
+
+		Header
+		TableRecord[m_tableCount]
+		per table: port names (NUL terminated), temperatures and voltages (int32), delays (float rising/falling
+		pairs, 8-byte aligned), valid flags (one byte each)
+
+	Tables are identified by (entity index, slot), where the entity index is the position in the device's bitstream
+	entity list and the slot is the position in that entity's GetTimingTables() list. Both depend on how the device
+	is modeled in this code, so the header carries a hash of the model and a database compiled against a different
+	model is rejected (and must be regenerated from the JSON).
+ */
+class Greenpak4TimingDatabase
+{
+public:
+	Greenpak4TimingDatabase();
+	~Greenpak4TimingDatabase();
+
+	static bool IsDatabase(std::string fname);
+	static bool Write(std::string fname, Greenpak4Device* device);
+	bool Load(std::string fname, Greenpak4Device* device);
+
+	static uint64_t GetModelHash(Greenpak4Device* device);
+	static std::string Find(std::string part);
+
+	///Bump whenever the file layout changes
+	static const uint32_t FORMAT_VERSION = 1;
+
+protected:
+	struct Header
+	{
+		char		m_magic[8];
+		uint32_t	m_version;
+		uint32_t	m_byteOrder;
+		uint64_t	m_modelHash;
+		char		m_part[16];
+		uint32_t	m_entityCount;
+		uint32_t	m_tableCount;
+		uint64_t	m_fileSize;
+	};
+
+	struct TableRecord
+	{
+		uint32_t	m_entity;
+		uint32_t	m_slot;
+		uint32_t	m_portCount;
+		uint32_t	m_tempCount;
+		uint32_t	m_voltageCount;
+		uint32_t	m_validCount;
+		uint64_t	m_portsOffset;
+		uint64_t	m_tempsOffset;
+		uint64_t	m_voltagesOffset;
+		uint64_t	m_delaysOffset;
+		uint64_t	m_validOffset;
+	};
+
+	bool Map(std::string fname);
+	void Unmap();
+
+	bool InBounds(uint64_t offset, uint64_t len) const
+	{ return (offset <= m_size) && (len <= m_size - offset); }
+
+	///The mapped file (or a heap copy of it, on platforms without mmap)
+	const uint8_t* m_data;
+	size_t m_size;
+};
+
+#endif
@@ -62,6 +62,8 @@ vector<string> Greenpak4VoltageReference::GetInputPorts() const
 
 void Greenpak4VoltageReference::SetInput(string port, Greenpak4EntityOutput src)
 {
+	MarkDirty();
+
 	if(port == "VIN")
 		m_vin = src;
 
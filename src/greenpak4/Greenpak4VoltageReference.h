@@ -54,7 +54,10 @@ public:
 	{ return m_voutMuxsel; }
 
 	void SetMuxSel(unsigned int i)
-	{ m_voutMuxsel = i; }
+	{
+		m_voutMuxsel = i;
+		MarkDirty();
+	}
 
 	//mux selector for ACMP voltage inputs
 	unsigned int GetACMPMuxSel();
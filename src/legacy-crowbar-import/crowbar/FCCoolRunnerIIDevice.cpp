@@ -40,6 +40,9 @@
 #include "FCCoolRunnerIIDevice.h"
 #include "FCCoolRunnerIIIOBank.h"
 #include "FCCoolRunnerIIMacrocell.h"
+#include <atomic>
+#include <exception>
+#include <thread>
 
 using namespace std;
 
@@ -410,9 +413,19 @@ FCCoolRunnerIINetSource* FCCoolRunnerIIDevice::DecodeZIAEntry(int row, string mu
 	return m_ziaEntryReverseMap[x];
 }
 
+/**
+	@brief Gets the legal ZIA entries for a net (empty if it can't be routed)
+	
+	Does not modify the device, so it is safe to call from concurrent function block fits.
+ */
 const vector<FCCoolRunnerIIZIAEntry>& FCCoolRunnerIIDevice::GetZIAEntriesForNetSource(FCCoolRunnerIINetSource* net)
 {
-	return m_legalZIAConnections[net];
+	static const vector<FCCoolRunnerIIZIAEntry> empty;
+	
+	auto it = m_legalZIAConnections.find(net);
+	if(it == m_legalZIAConnections.end())
+		return empty;
+	return it->second;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -774,9 +787,52 @@ void FCCoolRunnerIIDevice::Fit(FCCoolRunnerIINetlist* netlist)
 	printf("Macrocell fitting\n");
 	FitMacrocells(netlist);
 	
-	//Fit the function blocks
+	//Fit the function blocks.
+	//Each block only writes its own ZIA / PLA arrays, so they can be fitted in parallel and the bitstream is the same
+	//no matter which order the workers finish in.
+	unsigned int nthreads = thread::hardware_concurrency();
+	if(nthreads == 0)
+		nthreads = 1;
+	if(nthreads > m_fbs.size())
+		nthreads = m_fbs.size();
+		
+	vector<exception_ptr> errors(m_fbs.size());
+	atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		while(true)
+		{
+			size_t i = next ++;
+			if(i >= m_fbs.size())
+				break;
+				
+			try
+			{
+				m_fbs[i]->Fit();
+			}
+			catch(...)
+			{
+				errors[i] = current_exception();
+			}
+		}
+	};
+	
+	vector<thread> workers;
+	for(unsigned int i=0; i<nthreads; i++)
+		workers.push_back(thread(worker));
+	for(auto& t : workers)
+		t.join();
+		
+	//Print the logs in block order, and report the first block that failed
 	for(size_t i=0; i<m_fbs.size(); i++)
-		m_fbs[i]->Fit();
+	{
+		printf("%s", m_fbs[i]->GetFitLog().c_str());
+		if(errors[i])
+		{
+			printf("\n");
+			rethrow_exception(errors[i]);
+		}
+	}
 }
 
 void FCCoolRunnerIIDevice::FitMacrocells(FCCoolRunnerIINetlist* netlist)
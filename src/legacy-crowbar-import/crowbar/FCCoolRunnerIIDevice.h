@@ -72,6 +72,8 @@ public:
 
 	const std::vector<FCCoolRunnerIIZIAEntry>& GetZIAEntriesForNetSource(FCCoolRunnerIINetSource* net);
 
+	friend class FCCoolRunnerIISimulator;
+	
 protected:
 	void FitMacrocells(FCCoolRunnerIINetlist* netlist);
 	
@@ -39,6 +39,7 @@
 #include "FCCoolRunnerIIMacrocell.h"
 #include "../jtaghal/JEDFileWriter.h"
 #include <unordered_set>
+#include <stdarg.h>
 
 using namespace std;
 
@@ -503,10 +504,14 @@ void FCCoolRunnerIIFunctionBlock::SaveToBitstream(CPLDSerializer* writer)
 
 /**
 	@brief Fitting logic
+	
+	Only touches this block's own ZIA and PLA arrays (and reads the netlist and device tables), so different function
+	blocks may be fitted concurrently. Progress messages go to the fit log rather than stdout.
  */
 void FCCoolRunnerIIFunctionBlock::Fit()
 {
-	printf("Function block fitting (%d)\n", m_blocknum);
+	m_fitLog.clear();
+	FitLog("Function block fitting (%d)\n", m_blocknum);
 	
 	//Clear the ZIA
 	for(int i=0; i<INPUT_TERM_COUNT; i++)
@@ -524,18 +529,18 @@ void FCCoolRunnerIIFunctionBlock::Fit()
 			m_plaOr[j][i] = true;	
 	
 	//Assign ZIA rows to nets
-	printf("    Global routing\n");
+	FitLog("    Global routing\n");
 	map<FCCoolRunnerIINetSource*, FCCoolRunnerIIZIAEntry> net_assignments;
 	GlobalRouting(net_assignments);
 	
 	//Product term fitting
-	printf("    Product term fitting\n");
+	FitLog("    Product term fitting\n");
 	map<FCCoolRunnerIIProductTerm*, int> pterm_assignments;
 	FitProductTerms(pterm_assignments);
 	
 	//We should be fully constrained at this point
 	//Generate the PLA AND array
-	printf("    Generating PLA AND array bits\n");
+	FitLog("    Generating PLA AND array bits\n");
 	for(auto it = pterm_assignments.begin(); it!=pterm_assignments.end(); it++)
 	{
 		FCCoolRunnerIIProductTerm* pterm = it->first;
@@ -554,7 +559,7 @@ void FCCoolRunnerIIFunctionBlock::Fit()
 	}
 	
 	//Generate the PLA OR array
-	printf("    Generating PLA OR array bits\n");
+	FitLog("    Generating PLA OR array bits\n");
 	for(int i=0; i<MACROCELLS_PER_FB; i++)
 	{
 		//Skip macrocells not used in the netlist
@@ -597,7 +602,7 @@ void FCCoolRunnerIIFunctionBlock::GlobalRouting(map<FCCoolRunnerIINetSource*, FC
 				nets.emplace(pterm->m_inputs[k]);
 		}
 	}
-	printf("        %zu net(s) assigned to function block inputs\n", nets.size());
+	FitLog("        %zu net(s) assigned to function block inputs\n", nets.size());
 	
 	//DRC - input size has to be sane
 	if(nets.size() > INPUT_TERM_COUNT)
@@ -615,12 +620,19 @@ void FCCoolRunnerIIFunctionBlock::GlobalRouting(map<FCCoolRunnerIINetSource*, FC
 		Pass 1: Greedy assignment
 		Put each net in the first slot, allowing conflicts
 	 */
-	printf("        Pass 1: Greedy assignment  ");
+	FitLog("        Pass 1: Greedy assignment  ");
 	int unrouted = 0;
 	for(auto it = nets.begin(); it != nets.end(); it++)
 	{
 		FCCoolRunnerIINetSource* net = *it;
 		auto entries = m_device->GetZIAEntriesForNetSource(net);
+		if(entries.empty())
+		{
+			throw JtagExceptionWrapper(
+				"DRC error: Net cannot be routed to this function block",
+				"",
+				JtagException::EXCEPTION_TYPE_GIGO);
+		}
 		
 		FCCoolRunnerIIZIAEntry entry = entries[0];
 		net_assignments[net] = entry;
@@ -628,7 +640,7 @@ void FCCoolRunnerIIFunctionBlock::GlobalRouting(map<FCCoolRunnerIINetSource*, FC
 			unrouted++;
 		row_assignments[entry.m_row].push_back(net);
 	}
-	printf("        %d unrouted\n", unrouted);
+	FitLog("        %d unrouted\n", unrouted);
 	
 	//TODO: Conflict resolution
 	if(unrouted)
@@ -640,7 +652,7 @@ void FCCoolRunnerIIFunctionBlock::GlobalRouting(map<FCCoolRunnerIINetSource*, FC
 	}
 	
 	//The ZIA is now fully assigned, generate output
-	printf("        Generating ZIA bits\n");
+	FitLog("        Generating ZIA bits\n");
 	for(int i=0; i<40; i++)
 	{
 		if(row_assignments[i].size() == 0)
@@ -687,18 +699,18 @@ void FCCoolRunnerIIFunctionBlock::FitProductTerms(map<FCCoolRunnerIIProductTerm*
 			"",
 			JtagException::EXCEPTION_TYPE_GIGO);
 	}
-	printf("        %zu pterms used\n", pterms.size());
+	FitLog("        %zu pterms used\n", pterms.size());
 	
 	bool slot_used[PLA_PRODUCT_TERMS] = {0};
 	int slot_ptr = 0;
 		
 	//Constrained assignment
-	printf("        Pass 1: Constrained assignment     ");
+	FitLog("        Pass 1: Constrained assignment     ");
 	//TODO: assign and remove from unassigned list
-	printf("%zu unassigned\n", pterms.size());
+	FitLog("%zu unassigned\n", pterms.size());
 	
 	//Unconstrained assignment - fill in the first legal slot
-	printf("        Pass 2: Unconstrained assignment   ");
+	FitLog("        Pass 2: Unconstrained assignment   ");
 	for(auto it=pterms.begin(); it!=pterms.end(); it++)
 	{
 		//Find the next free slot (guaranteed to be one since we checked earlier)
@@ -713,5 +725,18 @@ void FCCoolRunnerIIFunctionBlock::FitProductTerms(map<FCCoolRunnerIIProductTerm*
 		slot_used[slot_ptr] = true;
 		slot_ptr++;
 	}
-	printf("0 unassigned\n");
+	FitLog("0 unassigned\n");
+}
+
+/**
+	@brief Appends a printf-style message to the fit log
+ */
+void FCCoolRunnerIIFunctionBlock::FitLog(const char* format, ...)
+{
+	char buf[256];
+	va_list list;
+	va_start(list, format);
+	vsnprintf(buf, sizeof(buf), format, list);
+	va_end(list);
+	m_fitLog += buf;
 }
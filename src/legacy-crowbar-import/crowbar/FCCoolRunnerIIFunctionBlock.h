@@ -117,14 +117,22 @@ public:
 	
 	void Fit();
 	
+	///@brief Progress messages from the last Fit(), buffered so that blocks can be fitted in parallel
+	const std::string& GetFitLog()
+	{ return m_fitLog; }
+	
 	int GetZiaWidth()
 	{ return m_ziaWidth; }
 	
+	friend class FCCoolRunnerIISimulator;
+	
 protected:
 	FCCoolRunnerIIDevice* m_device;
 	
 	void GlobalRouting(std::map<FCCoolRunnerIINetSource*, FCCoolRunnerIIZIAEntry>& net_assignments);
 	void FitProductTerms(std::map<FCCoolRunnerIIProductTerm*, int>& pterm_assignments);
+	void FitLog(const char* format, ...)
+		__attribute__((format(printf, 2, 3)));
 
 	///Number of this function block within the parent device (one based as per datasheet)
 	int m_blocknum;
@@ -166,6 +174,9 @@ protected:
 	bool* m_zia[INPUT_TERM_COUNT];
 	
 	int m_ziaWidth;
+	
+	///Buffered output of Fit()
+	std::string m_fitLog;
 };
 
 #endif
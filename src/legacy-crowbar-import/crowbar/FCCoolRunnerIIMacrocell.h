@@ -170,6 +170,8 @@ public:
 	
 	FCCoolRunnerIINetlistMacrocell* m_netlistcell;
 	
+	friend class FCCoolRunnerIISimulator;
+	
 protected:
 	///Index of this macrocell within the FB (one based as per datasheet)
 	int m_cellnum;
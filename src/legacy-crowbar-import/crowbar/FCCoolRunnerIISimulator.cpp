@@ -0,0 +1,680 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2016 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of FCCoolRunnerIISimulator
+ */
+
+#include "crowbar.h"
+#include "FCCoolRunnerIIDevice.h"
+#include "FCCoolRunnerIIFunctionBlock.h"
+#include "FCCoolRunnerIIMacrocell.h"
+#include "FCCoolRunnerIISimulator.h"
+
+using namespace std;
+
+///Upper bound on settling passes before we give up on a combinatorial loop (per pin)
+#define SETTLE_PASSES_PER_PIN 4
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Compiles the configuration of a device into packed PLA masks.
+
+	@param device	Device to simulate. Must have been loaded from a bitstream (or fitted).
+	@param mode		Simulation mode
+ */
+FCCoolRunnerIISimulator::FCCoolRunnerIISimulator(FCCoolRunnerIIDevice* device, Mode mode)
+	: m_mode(mode)
+{
+	//TODO: support devices other than XC2C32A
+	if( (device->GetBlockCount() != 2) || (device->GetFunctionBlock(0)->GetZiaWidth() != 8) )
+	{
+		throw JtagExceptionWrapper(
+			"Simulation is only supported for the XC2C32A",
+			"",
+			JtagException::EXCEPTION_TYPE_UNIMPLEMENTED);
+	}
+
+	m_pinCount = device->GetBlockCount() * FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB;
+	m_fbs.resize(device->GetBlockCount());
+	m_macrocells.resize(m_pinCount);
+	m_state.resize(m_pinCount);
+
+	for(size_t i=0; i<device->GetBlockCount(); i++)
+	{
+		FCCoolRunnerIIFunctionBlock* fb = device->GetFunctionBlock(i);
+		CompileFunctionBlock(device, fb);
+		for(int j=0; j<FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB; j++)
+			CompileMacrocell(fb->GetMacrocell(j));
+	}
+
+	//Global configuration, bit order as in the JED file (see XC2CBitstream.v)
+	m_globalClockEnable[0] = (device->m_gckMux & 4) ? true : false;
+	m_globalClockEnable[1] = (device->m_gckMux & 2) ? true : false;
+	m_globalClockEnable[2] = (device->m_gckMux & 1) ? true : false;
+	m_gsrInvert = (device->m_gsrMux & 2) ? false : true;
+	m_gsrEnable = (device->m_gsrMux & 1) ? true : false;
+	for(int i=0; i<4; i++)
+	{
+		m_gtsInvert[i] = (device->m_goeMux & (0x80 >> (2*i))) ? true : false;
+		m_gtsEnable[i] = (device->m_goeMux & (0x40 >> (2*i))) ? true : false;
+	}
+
+	//Global pins of the XC2C32A
+	m_globalClockPins[0] = 20;
+	m_globalClockPins[1] = 21;
+	m_globalClockPins[2] = 22;
+	m_gsrPin = 7;
+	m_gtsPins[0] = 4;
+	m_gtsPins[1] = 3;
+	m_gtsPins[2] = 6;
+	m_gtsPins[3] = 5;
+
+	Reset();
+}
+
+FCCoolRunnerIISimulator::~FCCoolRunnerIISimulator()
+{
+
+}
+
+/**
+	@brief Decodes the ZIA and packs the AND / OR arrays of one function block
+ */
+void FCCoolRunnerIISimulator::CompileFunctionBlock(FCCoolRunnerIIDevice* device, FCCoolRunnerIIFunctionBlock* fb)
+{
+	CompiledFunctionBlock& cfb = m_fbs[fb->GetBlockNumber() - 1];
+
+	//ZIA rows. Bit 7 (fuse 0) is active high and forces a 1, bit 6 is active low and forces a 0,
+	//the remaining bits are active-low mux selects with the highest bit taking priority.
+	for(int row=0; row<FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT; row++)
+	{
+		bool* fuses = fb->m_zia[row];
+		ZIARow& zr = cfb.rows[row];
+		zr.pin = 0;
+
+		int sel = -1;
+		for(int k=5; k>=0; k--)
+		{
+			if(!fuses[7-k])
+			{
+				sel = k;
+				break;
+			}
+		}
+
+		if(fuses[0])
+			zr.type = ZIA_ONE;
+		else if(!fuses[1] || (sel < 0) )
+			zr.type = ZIA_ZERO;
+		else
+		{
+			char muxsel[16];
+			snprintf(muxsel, sizeof(muxsel), "%02x", 0x80 | (1 << sel));
+			auto it = device->m_ziaEntryReverseMap.find(pair<int, string>(row, muxsel));
+			if(it == device->m_ziaEntryReverseMap.end())
+			{
+				printf("FB%d row %d muxsel %s\n", fb->GetBlockNumber(), row, muxsel);
+				throw JtagExceptionWrapper(
+					"Unknown ZIA entry, cannot simulate",
+					"",
+					JtagException::EXCEPTION_TYPE_UNIMPLEMENTED);
+			}
+
+			FCCoolRunnerIIMacrocell* mc = dynamic_cast<FCCoolRunnerIIMacrocell*>(it->second);
+			if(mc != NULL)
+				zr.type = ZIA_MACROCELL;
+			else
+			{
+				mc = dynamic_cast<FCCoolRunnerIIIOB*>(it->second)->GetMacrocell();
+				zr.type = ZIA_IBUF;
+			}
+			zr.pin = (mc->GetFunctionBlock()->GetBlockNumber() - 1) * FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB +
+				mc->GetCellNumber() - 1;
+		}
+	}
+
+	//AND array (false = connection present)
+	for(int pterm=0; pterm<FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS; pterm++)
+	{
+		cfb.andTrue[pterm] = 0;
+		cfb.andComplement[pterm] = 0;
+		for(int row=0; row<FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT; row++)
+		{
+			if(!fb->m_plaAnd[pterm][row*2])
+			{
+				cfb.andTrue[pterm] |= (1ULL << row);
+				cfb.andTrueRows[pterm].push_back(row);
+			}
+			if(!fb->m_plaAnd[pterm][row*2 + 1])
+			{
+				cfb.andComplement[pterm] |= (1ULL << row);
+				cfb.andComplementRows[pterm].push_back(row);
+			}
+		}
+	}
+
+	//OR array (false = connection present)
+	for(int mc=0; mc<FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB; mc++)
+	{
+		cfb.orMask[mc] = 0;
+		for(int pterm=0; pterm<FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS; pterm++)
+		{
+			if(!fb->m_plaOr[pterm][mc])
+			{
+				cfb.orMask[mc] |= (1ULL << pterm);
+				cfb.orTerms[mc].push_back(pterm);
+			}
+		}
+	}
+}
+
+void FCCoolRunnerIISimulator::CompileMacrocell(FCCoolRunnerIIMacrocell* mc)
+{
+	int pin = (mc->GetFunctionBlock()->GetBlockNumber() - 1) * FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB +
+		mc->GetCellNumber() - 1;
+	CompiledMacrocell& cmc = m_macrocells[pin];
+
+	cmc.xorin = mc->m_xorin;
+	cmc.clk = mc->m_clk;
+	cmc.aclk = mc->m_aclk;
+	cmc.risingEdge = (mc->m_clkEdge != FCCoolRunnerIIMacrocell::CLK_EDGE_FALLING);
+	cmc.fallingEdge = (mc->m_clkEdge != FCCoolRunnerIIMacrocell::CLK_EDGE_RISING);
+	cmc.latchPassHigh = (mc->m_clkEdge != FCCoolRunnerIIMacrocell::CLK_EDGE_FALLING);
+	cmc.regmod = mc->m_regmod;
+	cmc.r = mc->m_r;
+	cmc.p = mc->m_p;
+	cmc.inreg = mc->m_inreg;
+	cmc.fbval = mc->m_fbval;
+	cmc.inz = mc->m_iob.GetInZ();
+	cmc.direct = (mc->m_iob.m_outmode == FCCoolRunnerIIIOB::OUTPUT_DIRECT);
+	cmc.oe = mc->m_iob.GetOE();
+	cmc.powerUp = mc->m_ffResetState;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stimulus and results
+
+/**
+	@brief Returns every storage element to its power-up value and clears all inputs
+ */
+void FCCoolRunnerIISimulator::Reset()
+{
+	for(int i=0; i<m_pinCount; i++)
+	{
+		MacrocellState& s = m_state[i];
+		s.pad = 0;
+		s.storage = m_macrocells[i].powerUp ? ~(uint64_t)0 : 0;
+		s.lastClock = 0;
+	}
+
+	Settle();
+	for(int i=0; i<m_pinCount; i++)
+		m_state[i].lastClock = GetClock(i);
+}
+
+/**
+	@brief Sets the value on an input pin. Takes effect at the next Update().
+
+	In MODE_SCALAR, all lanes must be equal.
+ */
+void FCCoolRunnerIISimulator::SetInput(int pin, uint64_t lanes)
+{
+	if( (pin < 0) || (pin >= m_pinCount) )
+	{
+		throw JtagExceptionWrapper(
+			"Invalid pin number",
+			"",
+			JtagException::EXCEPTION_TYPE_GIGO);
+	}
+	m_state[pin].pad = lanes;
+}
+
+///@brief Value driven by the output buffer of a pin (meaningful only where GetOutputEnable() is set)
+uint64_t FCCoolRunnerIISimulator::GetOutput(int pin)
+{
+	return m_state[pin].toObuf;
+}
+
+///@brief Lanes in which the output buffer of a pin is driving
+uint64_t FCCoolRunnerIISimulator::GetOutputEnable(int pin)
+{
+	return ~m_state[pin].tristate;
+}
+
+///@brief Current value of a macrocell's storage element
+uint64_t FCCoolRunnerIISimulator::GetRegister(int pin)
+{
+	return m_state[pin].storage;
+}
+
+/**
+	@brief Propagates the current inputs through the device.
+
+	Combinatorial logic is settled, then every storage element that sees an active clock edge (or is a transparent
+	latch) is updated. This repeats until the state stops changing, so clocks derived from product terms ripple
+	through as they would in hardware.
+ */
+void FCCoolRunnerIISimulator::Update()
+{
+	int max_passes = m_pinCount * SETTLE_PASSES_PER_PIN;
+	for(int i=0; i<max_passes; i++)
+	{
+		Settle();
+		if(!ClockStorage())
+			return;
+	}
+
+	throw JtagExceptionWrapper(
+		"Sequential logic did not settle (oscillating latch or clock loop?)",
+		"",
+		JtagException::EXCEPTION_TYPE_GIGO);
+}
+
+/**
+	@brief Runs a list of test vectors, 64 at a time in MODE_SLICED.
+
+	Each vector is applied independently, starting from the power-up state, and followed by a single Update(). This is
+	intended for combinatorial regression; sequences of vectors should drive SetInput() / Update() directly.
+
+	@param inputs	One entry per vector, each containing one value per pin
+	@param outputs	Output pin values for each vector
+	@param enables	Output enables for each vector
+ */
+void FCCoolRunnerIISimulator::RunVectors(
+	const vector< vector<bool> >& inputs,
+	vector< vector<bool> >& outputs,
+	vector< vector<bool> >& enables)
+{
+	size_t lanes = (m_mode == MODE_SLICED) ? LANES : 1;
+
+	outputs.resize(inputs.size());
+	enables.resize(inputs.size());
+	for(size_t base=0; base<inputs.size(); base += lanes)
+	{
+		size_t count = min(lanes, inputs.size() - base);
+
+		Reset();
+		for(int pin=0; pin<m_pinCount; pin++)
+		{
+			uint64_t value = 0;
+			for(size_t lane=0; lane<count; lane++)
+			{
+				if( (pin < (int)inputs[base + lane].size()) && inputs[base + lane][pin])
+					value |= (1ULL << lane);
+			}
+			if( (m_mode == MODE_SCALAR) && value)
+				value = ~(uint64_t)0;
+			SetInput(pin, value);
+		}
+
+		Update();
+
+		for(size_t lane=0; lane<count; lane++)
+		{
+			vector<bool>& out = outputs[base + lane];
+			vector<bool>& en = enables[base + lane];
+			out.resize(m_pinCount);
+			en.resize(m_pinCount);
+			for(int pin=0; pin<m_pinCount; pin++)
+			{
+				out[pin] = GetOutputBit(pin, lane);
+				en[pin] = GetOutputEnableBit(pin, lane);
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Evaluation
+
+/**
+	@brief Evaluates all combinatorial logic until it stops changing.
+
+	@return True if the logic settled
+ */
+bool FCCoolRunnerIISimulator::Settle()
+{
+	EvaluateGlobals();
+
+	int max_passes = m_pinCount * SETTLE_PASSES_PER_PIN;
+	for(int i=0; i<max_passes; i++)
+	{
+		bool changed = false;
+		for(size_t nfb=0; nfb<m_fbs.size(); nfb++)
+		{
+			if(m_mode == MODE_SCALAR)
+				EvaluatePLAScalar(nfb);
+			else
+				EvaluatePLASliced(nfb);
+			changed |= EvaluateMacrocells(nfb);
+		}
+		if(!changed)
+			return true;
+	}
+
+	printf("Warning: combinatorial loop did not settle\n");
+	return false;
+}
+
+void FCCoolRunnerIISimulator::EvaluateGlobals()
+{
+	for(int i=0; i<3; i++)
+		m_globalClocks[i] = m_globalClockEnable[i] ? m_state[m_globalClockPins[i]].pad : 0;
+
+	uint64_t gsr = m_state[m_gsrPin].pad;
+	if(m_gsrInvert)
+		gsr = ~gsr;
+	m_gsr = m_gsrEnable ? gsr : 0;
+
+	for(int i=0; i<4; i++)
+	{
+		uint64_t gts = m_state[m_gtsPins[i]].pad;
+		if(m_gtsInvert[i])
+			gts = ~gts;
+		m_gts[i] = m_gtsEnable[i] ? gts : 0;
+	}
+}
+
+///@brief Current value of a ZIA row
+uint64_t FCCoolRunnerIISimulator::GetZIAValue(const ZIARow& row)
+{
+	switch(row.type)
+	{
+	case ZIA_ONE:
+		return ~(uint64_t)0;
+	case ZIA_IBUF:
+		return m_state[row.pin].ibufToZIA;
+	case ZIA_MACROCELL:
+		return m_state[row.pin].toZIA;
+	case ZIA_ZERO:
+	default:
+		return 0;
+	}
+}
+
+/**
+	@brief Evaluates a PLA with all lanes equal, using one mask compare per product term
+ */
+void FCCoolRunnerIISimulator::EvaluatePLAScalar(int nfb)
+{
+	CompiledFunctionBlock& cfb = m_fbs[nfb];
+
+	//Pack the ZIA rows into one word
+	uint64_t zia = 0;
+	for(int row=0; row<FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT; row++)
+	{
+		if(GetZIAValue(cfb.rows[row]) & 1)
+			zia |= (1ULL << row);
+	}
+
+	//AND array
+	uint64_t pterms = 0;
+	for(int pterm=0; pterm<FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS; pterm++)
+	{
+		bool value = ((zia & cfb.andTrue[pterm]) == cfb.andTrue[pterm]) && ((zia & cfb.andComplement[pterm]) == 0);
+		if(value)
+			pterms |= (1ULL << pterm);
+		cfb.pterms[pterm] = value ? ~(uint64_t)0 : 0;
+	}
+
+	//OR array
+	for(int mc=0; mc<FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB; mc++)
+		cfb.orterms[mc] = (pterms & cfb.orMask[mc]) ? ~(uint64_t)0 : 0;
+}
+
+/**
+	@brief Evaluates a PLA with each lane independent
+ */
+void FCCoolRunnerIISimulator::EvaluatePLASliced(int nfb)
+{
+	CompiledFunctionBlock& cfb = m_fbs[nfb];
+
+	for(int row=0; row<FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT; row++)
+		cfb.zia[row] = GetZIAValue(cfb.rows[row]);
+
+	//AND array
+	for(int pterm=0; pterm<FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS; pterm++)
+	{
+		uint64_t value = ~(uint64_t)0;
+		for(int row : cfb.andTrueRows[pterm])
+			value &= cfb.zia[row];
+		for(int row : cfb.andComplementRows[pterm])
+			value &= ~cfb.zia[row];
+		cfb.pterms[pterm] = value;
+	}
+
+	//OR array
+	for(int mc=0; mc<FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB; mc++)
+	{
+		uint64_t value = 0;
+		for(int pterm : cfb.orTerms[mc])
+			value |= cfb.pterms[pterm];
+		cfb.orterms[mc] = value;
+	}
+}
+
+/**
+	@brief Evaluates the combinatorial outputs of the macrocells in one function block
+
+	@return True if any value changed
+ */
+bool FCCoolRunnerIISimulator::EvaluateMacrocells(int nfb)
+{
+	CompiledFunctionBlock& cfb = m_fbs[nfb];
+	bool changed = false;
+
+	for(int i=0; i<FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB; i++)
+	{
+		int pin = nfb*FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB + i;
+		const CompiledMacrocell& cmc = m_macrocells[pin];
+		MacrocellState& s = m_state[pin];
+		uint64_t ptb = cfb.pterms[3*i + 9];
+		uint64_t ptc = cfb.pterms[3*i + 10];
+		uint64_t cte = cfb.pterms[7];
+
+		//XOR gate
+		uint64_t xor_out = cfb.orterms[i];
+		switch(cmc.xorin)
+		{
+		case FCCoolRunnerIIMacrocell::XORIN_NPTC:
+			xor_out ^= ~ptc;
+			break;
+		case FCCoolRunnerIIMacrocell::XORIN_PTC:
+			xor_out ^= ptc;
+			break;
+		case FCCoolRunnerIIMacrocell::XORIN_ONE:
+			xor_out = ~xor_out;
+			break;
+		default:
+			break;
+		}
+
+		//Feedback to the ZIA (bit 0 of FB / InZ is an active-low enable, bit 1 selects the storage element)
+		uint64_t to_zia = 0;
+		if(!(cmc.fbval & 1))
+			to_zia = (cmc.fbval & 2) ? s.storage : xor_out;
+		uint64_t ibuf_to_zia = 0;
+		if(!(cmc.inz & 1))
+			ibuf_to_zia = (cmc.inz & 2) ? s.storage : s.pad;
+
+		//Output buffer
+		uint64_t to_obuf = 0;
+		if(cmc.oe != FCCoolRunnerIIIOB::OE_CGND)
+			to_obuf = cmc.direct ? xor_out : s.storage;
+
+		uint64_t tristate;
+		switch(cmc.oe)
+		{
+		case FCCoolRunnerIIIOB::OE_OUTPUT:
+		case FCCoolRunnerIIIOB::OE_CGND:
+			tristate = 0;
+			break;
+		case FCCoolRunnerIIIOB::OE_OPENDRAIN:
+			tristate = to_obuf;
+			break;
+		case 2:
+			tristate = m_gts[1];
+			break;
+		case 4:
+			tristate = ptb;
+			break;
+		case 6:
+			tristate = m_gts[3];
+			break;
+		case FCCoolRunnerIIIOB::OE_TRISTATE:
+			tristate = cte;
+			break;
+		case 10:
+			tristate = m_gts[2];
+			break;
+		case 12:
+			tristate = m_gts[0];
+			break;
+		default:
+			tristate = ~(uint64_t)0;
+			break;
+		}
+
+		if( (s.xorOut != xor_out) || (s.toZIA != to_zia) || (s.ibufToZIA != ibuf_to_zia) )
+			changed = true;
+
+		s.xorOut = xor_out;
+		s.toZIA = to_zia;
+		s.ibufToZIA = ibuf_to_zia;
+		s.toObuf = to_obuf;
+		s.tristate = tristate;
+	}
+
+	return changed;
+}
+
+///@brief Current value of the clock net selected by a macrocell
+uint64_t FCCoolRunnerIISimulator::GetClock(int pin)
+{
+	const CompiledMacrocell& cmc = m_macrocells[pin];
+	const CompiledFunctionBlock& cfb = m_fbs[pin / FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB];
+	int i = pin % FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB;
+
+	switch(cmc.clk)
+	{
+	case FCCoolRunnerIIMacrocell::CLK_GCK0:
+		return m_globalClocks[0];
+	case FCCoolRunnerIIMacrocell::CLK_GCK1:
+		return m_globalClocks[1];
+	case FCCoolRunnerIIMacrocell::CLK_GCK2:
+		return m_globalClocks[2];
+	default:
+		return cmc.aclk ? cfb.pterms[4] : cfb.pterms[3*i + 10];
+	}
+}
+
+/**
+	@brief Updates every storage element from the settled combinatorial values.
+
+	All D inputs are sampled before any storage element changes, so register chains shift by one stage per edge.
+
+	@return True if any storage element or clock changed
+ */
+bool FCCoolRunnerIISimulator::ClockStorage()
+{
+	bool changed = false;
+
+	vector<uint64_t> next(m_pinCount);
+	vector<uint64_t> clocks(m_pinCount);
+	for(int pin=0; pin<m_pinCount; pin++)
+	{
+		const CompiledMacrocell& cmc = m_macrocells[pin];
+		const CompiledFunctionBlock& cfb = m_fbs[pin / FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB];
+		const MacrocellState& s = m_state[pin];
+		int i = pin % FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB;
+		uint64_t pta = cfb.pterms[3*i + 8];
+		uint64_t ptc = cfb.pterms[3*i + 10];
+
+		//Data input
+		uint64_t d = cmc.inreg ? s.xorOut : s.pad;
+		if(cmc.regmod == FCCoolRunnerIIMacrocell::REG_MODE_TFF)
+			d ^= s.storage;
+
+		//Which lanes load D
+		uint64_t clk = GetClock(pin);
+		uint64_t load;
+		if(cmc.regmod == FCCoolRunnerIIMacrocell::REG_MODE_LATCH)
+			load = cmc.latchPassHigh ? clk : ~clk;
+		else
+		{
+			load = 0;
+			if(cmc.risingEdge)
+				load |= clk & ~s.lastClock;
+			if(cmc.fallingEdge)
+				load |= ~clk & s.lastClock;
+			if(cmc.regmod == FCCoolRunnerIIMacrocell::REG_MODE_DFFCE)
+				load &= ptc;
+		}
+		uint64_t q = (s.storage & ~load) | (d & load);
+
+		//Asynchronous reset takes priority over set.
+		//R/P: 0 = PTA, 1 = GSR, 2 = CTR/CTS, 3 = unused. (XC2CMacrocell.v tests 2'b00 for the control terms,
+		//which collides with PTA; the control terms are selected by 2'b10 in real bitstreams.)
+		uint64_t reset = 0;
+		if(cmc.r == 0)
+			reset = pta;
+		else if(cmc.r == 1)
+			reset = m_gsr;
+		else if(cmc.r == 2)
+			reset = cfb.pterms[5];
+		uint64_t set = 0;
+		if(cmc.p == 0)
+			set = pta;
+		else if(cmc.p == 1)
+			set = m_gsr;
+		else if(cmc.p == 2)
+			set = cfb.pterms[6];
+		q = (q & ~reset) | (set & ~reset);
+
+		next[pin] = q;
+		clocks[pin] = clk;
+	}
+
+	for(int pin=0; pin<m_pinCount; pin++)
+	{
+		MacrocellState& s = m_state[pin];
+		if(s.storage != next[pin])
+			changed = true;
+		s.storage = next[pin];
+		s.lastClock = clocks[pin];
+	}
+
+	return changed;
+}
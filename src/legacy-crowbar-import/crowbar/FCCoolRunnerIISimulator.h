@@ -0,0 +1,225 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2016 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of FCCoolRunnerIISimulator
+ */
+
+#ifndef FCCoolRunnerIISimulator_h
+#define FCCoolRunnerIISimulator_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "FCCoolRunnerIIFunctionBlock.h"
+
+class FCCoolRunnerIIDevice;
+
+/**
+	@brief Native functional simulator for a CoolRunner-II bitstream.
+
+	The simulator is compiled from an FCCoolRunnerIIDevice after LoadFromBitstream() and follows the behavior of the
+	Verilog model in hdl/xc2c-model. The configuration is not referenced again after construction, so the device may
+	be modified or destroyed while the simulator is in use.
+
+	Every signal is a 64-bit word holding one bit per test vector ("lane"), so a single Update() advances 64
+	independent simulations at once. In MODE_SCALAR all lanes are assumed to carry the same value and each PLA is
+	evaluated with one mask comparison per product term over a packed word of the 40 ZIA rows. In MODE_SLICED each
+	lane is independent and each product term is the AND of the selected ZIA row words (or their complements).
+
+	Pins are numbered by global macrocell index: (function block number - 1) * 16 + (macrocell number - 1).
+
+	Limitations:
+		* Only the XC2C32A ZIA and global pin assignments are known (same as the rest of the crowbar model)
+		* The input-only pin is not part of the crowbar ZIA tables, so ZIA rows selecting it cannot be simulated
+		* Timing is not modeled: combinatorial logic settles instantly and storage elements update on clock edges
+ */
+class FCCoolRunnerIISimulator
+{
+public:
+	enum Mode
+	{
+		///All lanes carry the same vector, PLAs are evaluated with packed masks
+		MODE_SCALAR,
+
+		///Each lane carries an independent vector
+		MODE_SLICED
+	};
+
+	FCCoolRunnerIISimulator(FCCoolRunnerIIDevice* device, Mode mode = MODE_SLICED);
+	virtual ~FCCoolRunnerIISimulator();
+
+	///Number of test vectors simulated in parallel in MODE_SLICED
+	static const int LANES = 64;
+
+	Mode GetMode()
+	{ return m_mode; }
+
+	int GetPinCount()
+	{ return m_pinCount; }
+
+	void Reset();
+
+	void SetInput(int pin, uint64_t lanes);
+	void SetInputBit(int pin, bool value)
+	{ SetInput(pin, value ? ~(uint64_t)0 : (uint64_t)0); }
+
+	void Update();
+
+	uint64_t GetOutput(int pin);
+	uint64_t GetOutputEnable(int pin);
+	uint64_t GetRegister(int pin);
+
+	bool GetOutputBit(int pin, int lane = 0)
+	{ return (GetOutput(pin) >> lane) & 1; }
+	bool GetOutputEnableBit(int pin, int lane = 0)
+	{ return (GetOutputEnable(pin) >> lane) & 1; }
+
+	void RunVectors(
+		const std::vector< std::vector<bool> >& inputs,
+		std::vector< std::vector<bool> >& outputs,
+		std::vector< std::vector<bool> >& enables);
+
+protected:
+	void CompileFunctionBlock(FCCoolRunnerIIDevice* device, FCCoolRunnerIIFunctionBlock* fb);
+	void CompileMacrocell(FCCoolRunnerIIMacrocell* mc);
+
+	bool Settle();
+	void EvaluateGlobals();
+	void EvaluatePLAScalar(int nfb);
+	void EvaluatePLASliced(int nfb);
+	bool EvaluateMacrocells(int nfb);
+	bool ClockStorage();
+
+	enum ZIASourceType
+	{
+		ZIA_ZERO,
+		ZIA_ONE,
+		ZIA_IBUF,
+		ZIA_MACROCELL
+	};
+
+	///@brief Decoded ZIA row: constant or the ZIA output of a macrocell / IOB
+	struct ZIARow
+	{
+		ZIASourceType type;
+		int pin;
+	};
+
+	///@brief One function block's PLA, packed into bitmasks
+	struct CompiledFunctionBlock
+	{
+		ZIARow rows[FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT];
+
+		///Bit N set if the product term uses ZIA row N (true input)
+		uint64_t andTrue[FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS];
+
+		///Bit N set if the product term uses ZIA row N (complemented input)
+		uint64_t andComplement[FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS];
+
+		///Bit N set if product term N drives the OR term of the macrocell
+		uint64_t orMask[FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB];
+
+		///Rows / terms in the masks above, for MODE_SLICED
+		std::vector<int> andTrueRows[FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS];
+		std::vector<int> andComplementRows[FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS];
+		std::vector<int> orTerms[FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB];
+
+		///Current ZIA row, product term and OR term values
+		uint64_t zia[FCCoolRunnerIIFunctionBlock::INPUT_TERM_COUNT];
+		uint64_t pterms[FCCoolRunnerIIFunctionBlock::PLA_PRODUCT_TERMS];
+		uint64_t orterms[FCCoolRunnerIIFunctionBlock::MACROCELLS_PER_FB];
+	};
+
+	///@brief Configuration of one macrocell and its IOB
+	struct CompiledMacrocell
+	{
+		int xorin;
+		int clk;
+		bool aclk;
+		bool risingEdge;
+		bool fallingEdge;
+		bool latchPassHigh;
+		int regmod;
+		int r;
+		int p;
+		bool inreg;
+		int fbval;
+		int inz;
+		bool direct;
+		int oe;
+		bool powerUp;
+	};
+
+	///@brief Current values of one macrocell's signals
+	struct MacrocellState
+	{
+		uint64_t pad;
+		uint64_t xorOut;
+		uint64_t storage;
+		uint64_t lastClock;
+		uint64_t toZIA;
+		uint64_t ibufToZIA;
+		uint64_t toObuf;
+		uint64_t tristate;
+	};
+
+	uint64_t GetZIAValue(const ZIARow& row);
+	uint64_t GetClock(int pin);
+
+	Mode m_mode;
+
+	int m_pinCount;
+
+	std::vector<CompiledFunctionBlock> m_fbs;
+	std::vector<CompiledMacrocell> m_macrocells;
+	std::vector<MacrocellState> m_state;
+
+	///@brief Decoded global configuration (see XC2CBitstream.v)
+	bool m_globalClockEnable[3];
+	bool m_gsrInvert;
+	bool m_gsrEnable;
+	bool m_gtsInvert[4];
+	bool m_gtsEnable[4];
+
+	///@brief Pins driving the global nets
+	int m_globalClockPins[3];
+	int m_gsrPin;
+	int m_gtsPins[4];
+
+	///@brief Current values of the global nets
+	uint64_t m_globalClocks[3];
+	uint64_t m_gsr;
+	uint64_t m_gts[4];
+};
+
+#endif
@@ -0,0 +1,170 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <cstdarg>
+#include <cstdio>
+#include "LogContext.h"
+
+using namespace std;
+
+//The context the current thread is logging into, if any
+static thread_local LogContext* g_currentLogContext = NULL;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LogContext
+
+LogContext::LogContext()
+{
+}
+
+LogContext::Scope::Scope(LogContext& ctx)
+	: m_previous(g_currentLogContext)
+{
+	g_currentLogContext = &ctx;
+}
+
+LogContext::Scope::~Scope()
+{
+	g_currentLogContext = m_previous;
+}
+
+LogContext* LogContext::GetCurrent()
+{
+	return g_currentLogContext;
+}
+
+void LogContext::Append(Severity severity, const string& msg)
+{
+	m_messages.push_back(make_pair(severity, msg));
+}
+
+void LogContext::Clear()
+{
+	m_messages.clear();
+}
+
+/**
+	@brief Sends everything captured so far to the real sinks, in one block, and empties the context
+ */
+void LogContext::Flush()
+{
+	//Don't capture our own replay if we're flushing from inside a scope
+	LogContext* saved = g_currentLogContext;
+	g_currentLogContext = NULL;
+
+	LogContextSink* router = NULL;
+	for(auto& sink : g_log_sinks)
+	{
+		router = dynamic_cast<LogContextSink*>(sink.get());
+		if(router != NULL)
+			break;
+	}
+
+	if(router)
+		router->Replay(m_messages);
+	else
+	{
+		for(auto& m : m_messages)
+			Log(m.first, "%s", m.second.c_str());
+	}
+
+	g_currentLogContext = saved;
+	Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// LogContextSink
+
+LogContextSink::LogContextSink()
+{
+}
+
+LogContextSink::~LogContextSink()
+{
+}
+
+void LogContextSink::AddSink(LogSink* sink)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_sinks.emplace_back(sink);
+}
+
+void LogContextSink::Log(Severity severity, const string &msg)
+{
+	if(g_currentLogContext)
+	{
+		g_currentLogContext->Append(severity, msg);
+		return;
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+	for(auto& sink : m_sinks)
+		sink->Log(severity, msg);
+}
+
+void LogContextSink::Log(Severity severity, const char *format, va_list va)
+{
+	//Format once, then treat it like any other message
+	va_list va2;
+	va_copy(va2, va);
+	int len = vsnprintf(NULL, 0, format, va2);
+	va_end(va2);
+	if(len < 0)
+		return;
+
+	vector<char> buf(len + 1);
+	vsnprintf(&buf[0], buf.size(), format, va);
+	Log(severity, string(&buf[0], len));
+}
+
+/**
+	@brief Prints a batch of messages without letting anything else in between
+ */
+void LogContextSink::Replay(const vector< pair<Severity, string> >& messages)
+{
+	lock_guard<mutex> lock(m_mutex);
+	for(auto& m : messages)
+	{
+		for(auto& sink : m_sinks)
+			sink->Log(m.first, m.second);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Setup
+
+/**
+	@brief Moves all of the currently registered sinks behind a LogContextSink, so LogContexts can capture output
+
+	Call once, from the main thread, after setting up logging and before starting any workers. Calling it again is
+	harmless. Sinks added afterwards see every thread's output directly.
+ */
+void EnableLogContexts()
+{
+	for(auto& sink : g_log_sinks)
+	{
+		if(dynamic_cast<LogContextSink*>(sink.get()) != NULL)
+			return;
+	}
+
+	LogContextSink* router = new LogContextSink;
+	for(auto& sink : g_log_sinks)
+		router->AddSink(sink.release());
+	g_log_sinks.clear();
+	g_log_sinks.emplace_back(router);
+}
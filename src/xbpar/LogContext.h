@@ -0,0 +1,96 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef LogContext_h
+#define LogContext_h
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <log.h>
+
+/**
+	@brief Buffered log output for one job (a PAR run, a board, a function block...)
+
+	While a context is active on a thread (see LogContext::Scope), everything that thread logs through the normal
+	Log*() functions is captured here instead of going to the console, so several jobs can run side by side without
+	their output interleaving. Flush() then prints the whole job's output as one contiguous block.
+
+	Capturing requires the process's sinks to have been wrapped by EnableLogContexts(). A context is owned by one
+	job at a time and is not itself locked.
+ */
+class LogContext
+{
+public:
+	LogContext();
+
+	/**
+		@brief Routes the calling thread's log output into a context for as long as the Scope lives
+	 */
+	class Scope
+	{
+	public:
+		Scope(LogContext& ctx);
+		~Scope();
+
+	protected:
+		LogContext* m_previous;
+	};
+
+	static LogContext* GetCurrent();
+
+	void Append(Severity severity, const std::string& msg);
+	void Flush();
+	void Clear();
+
+	bool IsEmpty() const
+	{ return m_messages.empty(); }
+
+	///Captured messages, oldest first
+	std::vector< std::pair<Severity, std::string> > m_messages;
+};
+
+/**
+	@brief Log sink that owns the real sinks and diverts messages from threads with an active LogContext
+
+	Messages from threads without a context are passed straight through (serialized, so lines from different
+	threads never get mixed up).
+ */
+class LogContextSink : public LogSink
+{
+public:
+	LogContextSink();
+	virtual ~LogContextSink();
+
+	void AddSink(LogSink* sink);
+
+	virtual void Log(Severity severity, const std::string &msg);
+	virtual void Log(Severity severity, const char *format, va_list va);
+
+	void Replay(const std::vector< std::pair<Severity, std::string> >& messages);
+
+protected:
+	std::vector< std::unique_ptr<LogSink> > m_sinks;
+	std::mutex m_mutex;
+};
+
+void EnableLogContexts();
+
+#endif
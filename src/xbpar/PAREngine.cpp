@@ -30,6 +30,10 @@ PAREngine::PAREngine(PARGraph* netlist, PARGraph* device)
 	, m_device(device)
 	, m_temperature(0)
 	, m_maxTemperature(1000)	//max number of iterations allowed
+	, m_initialTemperature(1000)
+	, m_placementAlgorithm(PLACER_ANNEAL)
+	, m_exactNodeLimit(10000000)
+	, m_exactFallback(false)
 	, m_randomState(0)
 {
 
@@ -69,7 +73,8 @@ uint32_t PAREngine::RandomNumber()
 bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 {
 	LogVerbose("\nXBPAR initializing...\n");
-	m_temperature = m_maxTemperature;
+	m_temperature = m_initialTemperature;
+	m_stats = PARStatistics();
 
 	m_randomState = 0;
 	RandomNumber();
@@ -77,15 +82,48 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 	RandomNumber();
 
 	//Detect obviously impossible-to-route designs
-	if(!SanityCheck(label_names))
+	m_stats.BeginPhase("sanity");
+	bool ok = SanityCheck(label_names);
+	m_stats.EndPhase();
+	if(!ok)
 		return false;
 
 	//Do an initial valid, but not necessarily routable, placement
-	if(!InitialPlacement(label_names))
+	m_stats.BeginPhase("initial_placement");
+	ok = InitialPlacement(label_names);
+	m_stats.EndPhase();
+	if(!ok)
 		return false;
 
-	//Converge until we get a passing placement
+	//Search for the best placement outright if asked to
+	if(m_placementAlgorithm == PLACER_EXACT)
+	{
+		m_stats.BeginPhase("exact");
+		ok = ExactPlacement();
+		m_stats.EndPhase();
+		if(!ok)
+			return false;
+	}
+
+	//Converge until we get a passing placement, unless the exact placer found the best one
+	if( (m_placementAlgorithm != PLACER_EXACT) || m_exactFallback )
+	{
+		if(!AnnealPlacement(label_names))
+			return false;
+	}
+
+	return CheckFinalRouting();
+}
+
+/**
+	@brief Optimizes the placement by simulated annealing
+
+	@return true on success, false if the best placement found could not be restored
+ */
+bool PAREngine::AnnealPlacement(map<uint32_t, string>& label_names)
+{
 	LogNotice("\nOptimizing placement...\n");
+	PARPhaseTimer anneal_timer(m_stats, "anneal");
 
 	uint32_t iteration = 0;
 	vector<const PARGraphEdge*> unroutes;
@@ -108,6 +146,7 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 			newcost = ComputeAndPrintScore(unroutes, iteration);
 		time_since_best_cost ++;
 		iteration ++;
+		m_stats.m_iterations ++;
 
 		LogIndenter li2;
 
@@ -141,6 +180,7 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 			LogVerbose("No improvements for %d iterations on current path, restarting from previous best\n",
 				false_path_max);
 			RestorePreviousBestPlacement();
+			m_stats.m_restarts ++;
 			time_since_best_cost = 0;
 			made_change = true;
 			continue;
@@ -174,14 +214,60 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 	LogVerbose("Took %u iterations to converge (optimal solution found at iteration %u)\n",
 		iteration, best_iteration);
 
+	return true;
+}
+
+/**
+	@brief Runs the exact placer and reports the outcome
+
+	@return true if placement can continue, false if the design provably can't be placed
+ */
+bool PAREngine::ExactPlacement()
+{
+	LogNotice("\nSearching for an optimal placement...\n");
+	LogIndenter li;
+
+	PARExactPlacer placer(this);
+	m_exactFallback = false;
+	switch(placer.Run(m_exactNodeLimit))
+	{
+		case PARExactPlacer::RESULT_OPTIMAL:
+			LogNotice("Placement is optimal (cost %u)\n", ComputeCost());
+			break;
+
+		case PARExactPlacer::RESULT_FEASIBLE:
+			LogNotice("Search limit reached, refining best placement found (cost %u) by annealing\n", ComputeCost());
+			m_exactFallback = true;
+			break;
+
+		case PARExactPlacer::RESULT_INFEASIBLE:
+			LogError("No routable placement of this design exists in this device\n");
+			return false;
+
+		case PARExactPlacer::RESULT_UNKNOWN:
+			LogNotice("Search limit reached without finding a placement, falling back to annealing\n");
+			m_exactFallback = true;
+			break;
+	}
+
+	return true;
+}
+
+/**
+	@brief Final check that the placement we ended up with can be routed and committed
+ */
+bool PAREngine::CheckFinalRouting() const
+{
 	//Check for any remaining unroutable nets
-	unroutes.clear();
+	vector<const PARGraphEdge*> unroutes;
 	if(0 != ComputeUnroutableCost(unroutes))
 	{
 		LogError("Some nets could not be completely routed!\n");
 		PrintUnroutes(unroutes);
 		return false;
 	}
+	if(!CheckFinalPlacement())
+		return false;
 
 	return true;
 }
@@ -280,6 +366,7 @@ bool PAREngine::InitialPlacement(map<uint32_t, string>& label_names)
 	//Do the actual placement (technology specific)
 	if(!InitialPlacement_core())
 		return false;
+	OnPlacementReset();
 
 	//Post-placement sanity check
 	LogVerbose("Running post-placement sanity checks...\n");
@@ -332,6 +419,7 @@ void PAREngine::RestorePreviousBestPlacement()
 		auto node = m_netlist->GetNodeByIndex(i);
 		node->MateWith(m_bestPlacementFound[node]);
 	}
+	OnPlacementReset();
 }
 
 /**
@@ -354,6 +442,7 @@ bool PAREngine::OptimizePlacement(
 	PARGraphNode* new_mate = GetNewPlacementForNode(pivot);
 	if(new_mate == NULL)
 		return false;
+	m_stats.m_movesProposed ++;
 
 	//SANITY CHECK: Make sure the OLD placement was legal (if not, something is seriously wrong)
 	if(!old_mate->MatchesLabel(pivot->GetLabel()))
@@ -371,7 +460,10 @@ bool PAREngine::OptimizePlacement(
 	//If not, do nothing as the swap is impossible.
 	//Fixes github issue #9.
 	if(!CanMoveNode(pivot, old_mate, new_mate))
+	{
+		m_stats.m_movesIllegal ++;
 		return false;
+	}
 
 	//Do the swap, and measure the old/new scores
 	uint32_t original_cost = ComputeCost();
@@ -385,12 +477,19 @@ bool PAREngine::OptimizePlacement(
 	//If new cost is less, or greater with temperature-dependent probability, accept it
 	//TODO: make probability depend on dCost?
 	if(new_cost < original_cost)
+	{
+		m_stats.m_movesAcceptedDownhill ++;
 		return true;
+	}
 	if( (RandomNumber() % m_maxTemperature) < m_temperature )
+	{
+		m_stats.m_movesAcceptedUphill ++;
 		return true;
+	}
 
 	//If we don't like the change, revert
 	MoveNode(pivot, old_mate, label_names);
+	m_stats.m_movesReverted ++;
 	return false;
 }
 
@@ -436,9 +535,9 @@ void PAREngine::MoveNode(
 	}
 
 	//If the new position is already used by a netlist node, we have to fix that
-	if(newpos->GetMate() != NULL)
+	PARGraphNode* other_net = newpos->GetMate();
+	if(other_net != NULL)
 	{
-		PARGraphNode* other_net = newpos->GetMate();
 		PARGraphNode* old_pos = node->GetMate();
 
 		//Verify the labels match in the reverse direction of the swap
@@ -459,6 +558,76 @@ void PAREngine::MoveNode(
 
 	//Now that the new node has no mate, just hook them up
 	node->MateWith(newpos);
+
+	//Report both halves of a swap only once it's complete
+	if(other_net != NULL)
+		OnNodeMoved(other_net);
+	OnNodeMoved(node);
+}
+
+/**
+	@brief Called after MoveNode() changes the mate of a netlist node (once for each node, after the whole swap)
+ */
+void PAREngine::OnNodeMoved(PARGraphNode* /*node*/)
+{
+}
+
+/**
+	@brief Called after the placement of any number of nodes was changed at once (initial placement, restoring the
+	best placement)
+ */
+void PAREngine::OnPlacementReset()
+{
+}
+
+/**
+	@brief Technology-specific checks that a fully routed placement can actually be committed
+
+	Default is to accept everything.
+ */
+bool PAREngine::CheckFinalPlacement() const
+{
+	return true;
+}
+
+/**
+	@brief Technology-specific part of the key deciding which sites the exact placer may treat as interchangeable
+
+	Sites are only considered interchangeable if they have the same labels, the same class, and swapping them maps
+	the device graph onto itself. Default is to rely on the labels and graph alone.
+ */
+string PAREngine::GetSiteClass(PARGraphNode* /*site*/) const
+{
+	return "";
+}
+
+/**
+	@brief Lower bound on the cost of any complete placement extending the current partial one.
+
+	Called by the exact placer with some netlist nodes unplaced, and must not decrease as more nodes are placed.
+	Default is zero (no pruning).
+ */
+uint32_t PAREngine::ComputeCostLowerBound() const
+{
+	return 0;
+}
+
+/**
+	@brief Checks if the current (possibly partial) placement already uses more of some shared resource than exists.
+
+	Must stay true as more nodes are placed. Default is false.
+ */
+bool PAREngine::ExceedsCapacity() const
+{
+	return false;
+}
+
+/**
+	@brief Checks if a netlist node must stay where InitialPlacement_core() put it (e.g. due to a LOC constraint)
+ */
+bool PAREngine::IsNodeFixed(PARGraphNode* /*node*/) const
+{
+	return false;
 }
 
 /**
@@ -478,6 +647,8 @@ std::string PAREngine::GetNodeTypes(PARGraphNode* node, std::map<uint32_t, std::
  */
 uint32_t PAREngine::ComputeCost() const
 {
+	m_stats.m_costEvaluations ++;
+
 	vector<const PARGraphEdge*> unroutes;
 	return
 		ComputeUnroutableCost(unroutes)*10 +	//weight unroutability above everything else
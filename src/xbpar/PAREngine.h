@@ -35,12 +35,47 @@ public:
 
 	virtual uint32_t ComputeCost() const;
 
+	enum PlacementAlgorithm
+	{
+		///Simulated annealing (fast, but may give up on hard designs)
+		PLACER_ANNEAL,
+
+		///Exhaustive branch-and-bound search, finished off by annealing if it runs out of budget
+		PLACER_EXACT
+	};
+
+	void SetPlacementAlgorithm(PlacementAlgorithm algorithm)
+	{ m_placementAlgorithm = algorithm; }
+
+	void SetExactNodeLimit(uint64_t limit)
+	{ m_exactNodeLimit = limit; }
+
+	const PARStatistics& GetStatistics() const
+	{ return m_stats; }
+
 protected:
+	friend class PARExactPlacer;
+
+	virtual bool AnnealPlacement(std::map<uint32_t, std::string>& label_names);
+	virtual bool ExactPlacement();
+	virtual bool CheckFinalRouting() const;
 
 	virtual bool CanMoveNode(PARGraphNode* node, PARGraphNode* old_mate, PARGraphNode* new_mate) const;
 
 	void MoveNode(PARGraphNode* node, PARGraphNode* newpos, std::map<uint32_t, std::string>& label_names);
 
+	//Notifications so derived classes can keep incremental cost state in sync with the placement
+	virtual void OnNodeMoved(PARGraphNode* node);
+	virtual void OnPlacementReset();
+
+	virtual bool CheckFinalPlacement() const;
+
+	//Hooks for the exact placer
+	virtual std::string GetSiteClass(PARGraphNode* site) const;
+	virtual uint32_t ComputeCostLowerBound() const;
+	virtual bool ExceedsCapacity() const;
+	virtual bool IsNodeFixed(PARGraphNode* node) const;
+
 	virtual PARGraphNode* GetNewPlacementForNode(PARGraphNode* pivot) =0;
 	virtual void FindSubOptimalPlacements(std::vector<PARGraphNode*>& bad_nodes) =0;
 
@@ -75,6 +110,20 @@ protected:
 	uint32_t m_temperature;
 	uint32_t m_maxTemperature;
 
+	//Temperature at the start of the anneal (lower values give a shorter, more local optimization)
+	uint32_t m_initialTemperature;
+
+	PlacementAlgorithm m_placementAlgorithm;
+
+	//Maximum number of partial placements the exact placer may evaluate
+	uint64_t m_exactNodeLimit;
+
+	//Set if the exact placer ran out of budget and we need to anneal after all
+	bool m_exactFallback;
+
+	//Instrumentation for the current run (mutable so const cost functions can count themselves)
+	mutable PARStatistics m_stats;
+
 	//libc-independent RNG
 	//A PCG random number generator
 	//Does not currently generate a k-dimensional equidistribution, but is
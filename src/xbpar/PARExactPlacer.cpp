@@ -0,0 +1,516 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <algorithm>
+#include <set>
+#include <log.h>
+#include <xbpar.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+PARExactPlacer::PARExactPlacer(PAREngine* engine)
+	: m_engine(engine)
+	, m_netlist(engine->m_netlist)
+	, m_device(engine->m_device)
+	, m_nodeLimit(0)
+	, m_aborted(false)
+	, m_done(false)
+	, m_found(false)
+	, m_bestCost(0xffffffff)
+	, m_rootBound(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Indexing
+
+uint32_t PARExactPlacer::InternPort(const string& port)
+{
+	auto it = m_ports.find(port);
+	if(it != m_ports.end())
+		return it->second;
+	uint32_t id = m_ports.size();
+	m_ports[port] = id;
+	return id;
+}
+
+/**
+	@brief Flattens both graphs into index-based tables for the search
+ */
+void PARExactPlacer::BuildIndexes()
+{
+	for(uint32_t i=0; i<m_netlist->GetNumNodes(); i++)
+	{
+		auto node = m_netlist->GetNodeByIndex(i);
+		m_nodeIndexes[node] = i;
+		m_nodes.push_back(node);
+	}
+	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
+	{
+		auto site = m_device->GetNodeByIndex(i);
+		m_siteIndexes[site] = i;
+		m_sites.push_back(site);
+	}
+
+	//Intern every port name before building edge keys, since the key size depends on the port count
+	for(auto node : m_nodes)
+	{
+		for(uint32_t j=0; j<node->GetEdgeCount(); j++)
+		{
+			auto edge = node->GetEdgeByIndex(j);
+			InternPort(edge->m_sourceport);
+			InternPort(edge->m_destport);
+		}
+	}
+	for(auto site : m_sites)
+	{
+		for(uint32_t j=0; j<site->GetEdgeCount(); j++)
+		{
+			auto edge = site->GetEdgeByIndex(j);
+			InternPort(edge->m_sourceport);
+			InternPort(edge->m_destport);
+		}
+	}
+
+	//Device edges
+	m_siteOutEdges.resize(m_sites.size());
+	m_siteInEdges.resize(m_sites.size());
+	for(uint32_t i=0; i<m_sites.size(); i++)
+	{
+		auto site = m_sites[i];
+		for(uint32_t j=0; j<site->GetEdgeCount(); j++)
+		{
+			auto edge = site->GetEdgeByIndex(j);
+			uint32_t dst = m_siteIndexes[edge->m_destnode];
+			uint32_t sport = m_ports[edge->m_sourceport];
+			uint32_t dport = m_ports[edge->m_destport];
+			m_deviceEdges.insert(GetEdgeKey(i, dst, sport, dport));
+			m_siteOutEdges[i].push_back(SiteEdge{dst, sport, dport});
+			m_siteInEdges[dst].push_back(SiteEdge{i, sport, dport});
+		}
+	}
+
+	//Netlist edges become constraints on both ends (self loops only once)
+	m_constraints.resize(m_nodes.size());
+	for(uint32_t i=0; i<m_nodes.size(); i++)
+	{
+		auto node = m_nodes[i];
+		for(uint32_t j=0; j<node->GetEdgeCount(); j++)
+		{
+			auto edge = node->GetEdgeByIndex(j);
+			uint32_t dst = m_nodeIndexes[edge->m_destnode];
+			uint32_t sport = m_ports[edge->m_sourceport];
+			uint32_t dport = m_ports[edge->m_destport];
+			m_constraints[i].push_back(Constraint{dst, true, sport, dport});
+			if(dst != i)
+				m_constraints[dst].push_back(Constraint{i, false, sport, dport});
+		}
+	}
+
+	//Legal sites for each node, grouped by label
+	m_candidates.resize(m_nodes.size());
+	map<uint32_t, uint32_t> groups;
+	for(uint32_t i=0; i<m_nodes.size(); i++)
+	{
+		uint32_t label = m_nodes[i]->GetLabel();
+		auto it = groups.find(label);
+		if(it == groups.end())
+		{
+			LabelGroup group;
+			for(uint32_t j=0; j<m_sites.size(); j++)
+			{
+				if(m_sites[j]->MatchesLabel(label))
+					group.m_sites.push_back(j);
+			}
+			groups[label] = m_labelGroups.size();
+			m_labelGroups.push_back(group);
+			it = groups.find(label);
+		}
+
+		m_labelGroups[it->second].m_nodes.push_back(i);
+		m_candidates[i] = m_labelGroups[it->second].m_sites;
+	}
+
+	//Most connected nodes first
+	for(uint32_t i=0; i<m_nodes.size(); i++)
+		m_order.push_back(i);
+	stable_sort(m_order.begin(), m_order.end(),
+		[this](uint32_t a, uint32_t b) { return m_constraints[a].size() > m_constraints[b].size(); });
+}
+
+/**
+	@brief Partitions the device into classes of interchangeable sites.
+
+	Two sites are interchangeable if they accept the same labels, the engine puts them in the same technology class
+	(so they cost the same), and swapping them maps the device graph onto itself.
+ */
+void PARExactPlacer::BuildSiteClasses()
+{
+	//Representatives of the classes found so far, by label set and technology class
+	map<pair<vector<uint32_t>, string>, vector<uint32_t> > reps;
+
+	m_siteClasses.resize(m_sites.size());
+	uint32_t nclasses = 0;
+	for(uint32_t i=0; i<m_sites.size(); i++)
+	{
+		auto site = m_sites[i];
+		vector<uint32_t> labels;
+		labels.push_back(site->GetLabel());
+		for(uint32_t j=0; j<site->GetAlternateLabelCount(); j++)
+			labels.push_back(site->GetAlternateLabel(j));
+		sort(labels.begin(), labels.end());
+
+		auto& candidates = reps[pair<vector<uint32_t>, string>(labels, m_engine->GetSiteClass(site))];
+		bool found = false;
+		for(auto r : candidates)
+		{
+			if(IsSwappable(r, i))
+			{
+				m_siteClasses[i] = m_siteClasses[r];
+				found = true;
+				break;
+			}
+		}
+		if(!found)
+		{
+			m_siteClasses[i] = nclasses ++;
+			candidates.push_back(i);
+		}
+	}
+
+	LogVerbose("%u sites fall into %u classes of interchangeable sites\n",
+		static_cast<unsigned int>(m_sites.size()), nclasses);
+}
+
+/**
+	@brief Checks if exchanging two sites is an automorphism of the device graph
+ */
+bool PARExactPlacer::IsSwappable(uint32_t a, uint32_t b) const
+{
+	if( (m_siteOutEdges[a].size() != m_siteOutEdges[b].size()) ||
+		(m_siteInEdges[a].size() != m_siteInEdges[b].size()) )
+	{
+		return false;
+	}
+
+	auto swap = [a, b](uint32_t n) -> uint32_t
+	{
+		if(n == a)
+			return b;
+		if(n == b)
+			return a;
+		return n;
+	};
+
+	//Edges not touching a or b map to themselves, so only check edges of a and b
+	uint32_t ends[2] = {a, b};
+	for(auto x : ends)
+	{
+		for(auto& e : m_siteOutEdges[x])
+		{
+			if(!HasDeviceEdge(swap(x), swap(e.m_other), e.m_sport, e.m_dport))
+				return false;
+		}
+		for(auto& e : m_siteInEdges[x])
+		{
+			if(!HasDeviceEdge(swap(e.m_other), swap(x), e.m_sport, e.m_dport))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constraint checking
+
+bool PARExactPlacer::HasDeviceEdge(uint32_t src, uint32_t dst, uint32_t sport, uint32_t dport) const
+{
+	return m_deviceEdges.find(GetEdgeKey(src, dst, sport, dport)) != m_deviceEdges.end();
+}
+
+/**
+	@brief Checks if a node can be placed at a site without breaking routes to any of its placed neighbors
+ */
+bool PARExactPlacer::IsConsistent(uint32_t node, uint32_t site) const
+{
+	for(auto& c : m_constraints[node])
+	{
+		int32_t other = (c.m_other == node) ? static_cast<int32_t>(site) : m_placement[c.m_other];
+		if(other < 0)
+			continue;
+
+		if(c.m_outbound)
+		{
+			if(!HasDeviceEdge(site, other, c.m_sport, c.m_dport))
+				return false;
+		}
+		else if(!HasDeviceEdge(other, site, c.m_sport, c.m_dport))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+	@brief Checks that every label still has enough free sites for its unplaced nodes
+ */
+bool PARExactPlacer::HasFreeSitesForLabels() const
+{
+	for(auto& group : m_labelGroups)
+	{
+		size_t unplaced = 0;
+		for(auto n : group.m_nodes)
+		{
+			if(m_placement[n] < 0)
+				unplaced ++;
+		}
+
+		size_t free = 0;
+		for(auto s : group.m_sites)
+		{
+			if(m_occupants[s] < 0)
+				free ++;
+		}
+
+		if(unplaced > free)
+			return false;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Search
+
+void PARExactPlacer::Place(uint32_t node, uint32_t site)
+{
+	m_nodes[node]->MateWith(m_sites[site]);
+	m_placement[node] = site;
+	m_occupants[site] = node;
+	m_engine->OnNodeMoved(m_nodes[node]);
+}
+
+void PARExactPlacer::Unplace(uint32_t node)
+{
+	m_occupants[m_placement[node]] = -1;
+	m_placement[node] = -1;
+	m_nodes[node]->MateWith(NULL);
+	m_engine->OnNodeMoved(m_nodes[node]);
+}
+
+/**
+	@brief Searches for the lowest cost routable placement.
+
+	On return the engine's best placement holds the result (or the initial placement, if nothing better was found)
+	and has been restored.
+
+	@param nodeLimit	Maximum number of partial placements to evaluate before giving up
+ */
+PARExactPlacer::Result PARExactPlacer::Run(uint64_t nodeLimit)
+{
+	LogVerbose("Exact placement of %u instances into %u sites...\n",
+		m_netlist->GetNumNodes(),
+		m_device->GetNumNodes());
+	LogIndenter li;
+
+	m_nodeLimit = nodeLimit;
+	BuildIndexes();
+	BuildSiteClasses();
+
+	//Use the initial placement as a starting bound, if it's good enough to ship
+	vector<const PARGraphEdge*> unroutes;
+	if( (0 == m_engine->ComputeUnroutableCost(unroutes)) && !m_engine->ExceedsCapacity() )
+	{
+		m_found = true;
+		m_bestCost = m_engine->ComputeCost();
+		LogVerbose("Initial placement is routable (cost %u)\n", m_bestCost);
+	}
+
+	//Start from nothing but the fixed nodes
+	m_placement.resize(m_nodes.size(), -1);
+	m_occupants.resize(m_sites.size(), -1);
+	m_fixed.resize(m_nodes.size(), false);
+	uint32_t nfixed = 0;
+	for(uint32_t i=0; i<m_nodes.size(); i++)
+	{
+		auto node = m_nodes[i];
+		if(m_engine->IsNodeFixed(node))
+		{
+			uint32_t site = m_siteIndexes[node->GetMate()];
+			m_fixed[i] = true;
+			m_placement[i] = site;
+			m_occupants[site] = i;
+			nfixed ++;
+		}
+		else
+			node->MateWith(NULL);
+	}
+	m_engine->OnPlacementReset();
+
+	bool feasible = !m_engine->ExceedsCapacity();
+	for(uint32_t i=0; i<m_nodes.size(); i++)
+	{
+		if(m_fixed[i] && !IsConsistent(i, m_placement[i]))
+		{
+			LogVerbose("Fixed placement of %u instances can't be routed\n", nfixed);
+			feasible = false;
+			break;
+		}
+	}
+
+	if(feasible)
+	{
+		m_rootBound = m_engine->ComputeCostLowerBound();
+		LogVerbose("%u instances fixed, lower bound on cost is %u\n", nfixed, m_rootBound);
+
+		if(m_found && (m_bestCost <= m_rootBound))
+			m_done = true;
+		else
+			Search(nfixed);
+	}
+
+	//Put the best placement back (or the initial one, if we didn't find anything)
+	m_engine->RestorePreviousBestPlacement();
+
+	LogVerbose("Evaluated %lu partial placements (%lu pruned)\n",
+		(unsigned long)m_engine->m_stats.m_exactNodes,
+		(unsigned long)m_engine->m_stats.m_exactPruned);
+
+	if(m_aborted)
+		return m_found ? RESULT_FEASIBLE : RESULT_UNKNOWN;
+	return m_found ? RESULT_OPTIMAL : RESULT_INFEASIBLE;
+}
+
+/**
+	@brief Places the most constrained remaining node at each distinct site it can go, and recurses
+ */
+void PARExactPlacer::Search(uint32_t nplaced)
+{
+	//Complete placement? See if it's the best yet
+	if(nplaced == m_nodes.size())
+	{
+		uint32_t cost = m_engine->ComputeCost();
+		if(!m_found || (cost < m_bestCost))
+		{
+			m_found = true;
+			m_bestCost = cost;
+			m_engine->SaveNewBestPlacement();
+			LogVerbose("Found placement with cost %u\n", cost);
+
+			if(m_bestCost <= m_rootBound)
+				m_done = true;
+		}
+		return;
+	}
+
+	if(!HasFreeSitesForLabels())
+		return;
+
+	//Bound every distinct site each unplaced node could still go to. Any completion has to put each node somewhere,
+	//so the cheapest option of the worst-off node bounds the whole branch. Branch on the node with the fewest
+	//options left (preferring the one with the most expensive options), since that gives the smallest tree.
+	int32_t pivot = -1;
+	uint32_t pivotBound = 0;
+	uint32_t branchBound = 0;
+	vector< pair<uint32_t, uint32_t> > options;
+	vector< pair<uint32_t, uint32_t> > children;
+	vector<uint32_t> classes;
+	for(auto i : m_order)
+	{
+		if(m_placement[i] >= 0)
+			continue;
+
+		options.clear();
+		classes.clear();
+		uint32_t nodeBound = 0xffffffff;
+		for(auto s : m_candidates[i])
+		{
+			if( (m_occupants[s] >= 0) || !IsConsistent(i, s) )
+				continue;
+
+			//Only try one site from each class of interchangeable sites
+			if(find(classes.begin(), classes.end(), m_siteClasses[s]) != classes.end())
+				continue;
+			classes.push_back(m_siteClasses[s]);
+
+			if(m_engine->m_stats.m_exactNodes >= m_nodeLimit)
+			{
+				m_aborted = true;
+				return;
+			}
+			m_engine->m_stats.m_exactNodes ++;
+
+			Place(i, s);
+			bool over = m_engine->ExceedsCapacity();
+			uint32_t bound = m_engine->ComputeCostLowerBound();
+			Unplace(i);
+
+			if(over || (m_found && (bound >= m_bestCost)))
+			{
+				m_engine->m_stats.m_exactPruned ++;
+				continue;
+			}
+			options.push_back(pair<uint32_t, uint32_t>(bound, s));
+			nodeBound = min(nodeBound, bound);
+		}
+
+		//Nowhere left to put this node, so this branch is dead
+		if(options.empty())
+			return;
+
+		branchBound = max(branchBound, nodeBound);
+		if( (pivot < 0) ||
+			(options.size() < children.size()) ||
+			( (options.size() == children.size()) && (nodeBound > pivotBound) ) )
+		{
+			pivot = i;
+			pivotBound = nodeBound;
+			children.swap(options);
+		}
+	}
+
+	if(m_found && (branchBound >= m_bestCost))
+	{
+		m_engine->m_stats.m_exactPruned ++;
+		return;
+	}
+
+	//Cheapest first, so we find good placements (and tight bounds) early
+	stable_sort(children.begin(), children.end(),
+		[](const pair<uint32_t, uint32_t>& a, const pair<uint32_t, uint32_t>& b) { return a.first < b.first; });
+	for(auto& child : children)
+	{
+		//Bound may have improved since we looked at this child
+		if(m_found && (child.first >= m_bestCost))
+		{
+			m_engine->m_stats.m_exactPruned ++;
+			continue;
+		}
+
+		Place(pivot, child.second);
+		Search(nplaced + 1);
+		Unplace(pivot);
+
+		if(m_aborted || m_done)
+			return;
+	}
+}
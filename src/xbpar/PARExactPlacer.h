@@ -0,0 +1,155 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef PARExactPlacer_h
+#define PARExactPlacer_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class PAREngine;
+class PARGraph;
+class PARGraphNode;
+
+/**
+	@brief Exact placement by depth-first branch-and-bound, for devices small enough to search exhaustively.
+
+	Routability is treated as a hard constraint: a node may only be placed at a site which has every edge it needs to
+	and from its already-placed neighbors. The node with the fewest legal sites left is placed next, so dead ends are
+	found as early as possible.
+
+	Sites which are interchangeable (same labels, same technology site class, and swapping them is an automorphism
+	of the device graph) are only tried once per node. Partial placements are pruned using the engine's
+	ComputeCostLowerBound() and ExceedsCapacity() hooks.
+ */
+class PARExactPlacer
+{
+public:
+	PARExactPlacer(PAREngine* engine);
+
+	enum Result
+	{
+		///Search completed, the best placement found is optimal
+		RESULT_OPTIMAL,
+
+		///Search completed, no routable placement exists
+		RESULT_INFEASIBLE,
+
+		///Ran out of search budget; a placement was found but may not be optimal
+		RESULT_FEASIBLE,
+
+		///Ran out of search budget before finding anything
+		RESULT_UNKNOWN
+	};
+
+	Result Run(uint64_t nodeLimit);
+
+protected:
+	void BuildIndexes();
+	void BuildSiteClasses();
+	bool IsSwappable(uint32_t a, uint32_t b) const;
+
+	uint32_t InternPort(const std::string& port);
+	uint64_t GetEdgeKey(uint32_t src, uint32_t dst, uint32_t sport, uint32_t dport) const
+	{ return ((static_cast<uint64_t>(src) * m_sites.size() + dst) * m_ports.size() + sport) * m_ports.size() + dport; }
+
+	bool HasDeviceEdge(uint32_t src, uint32_t dst, uint32_t sport, uint32_t dport) const;
+	bool IsConsistent(uint32_t node, uint32_t site) const;
+
+	void Place(uint32_t node, uint32_t site);
+	void Unplace(uint32_t node);
+
+	bool HasFreeSitesForLabels() const;
+
+	void Search(uint32_t nplaced);
+
+	PAREngine* m_engine;
+	PARGraph* m_netlist;
+	PARGraph* m_device;
+
+	///Interned port names
+	std::unordered_map<std::string, uint32_t> m_ports;
+
+	///Netlist and device nodes, and their indexes
+	std::vector<PARGraphNode*> m_nodes;
+	std::vector<PARGraphNode*> m_sites;
+	std::unordered_map<PARGraphNode*, uint32_t> m_nodeIndexes;
+	std::unordered_map<PARGraphNode*, uint32_t> m_siteIndexes;
+
+	///A routing requirement between a netlist node and one of its neighbors
+	struct Constraint
+	{
+		uint32_t m_other;
+		bool m_outbound;
+		uint32_t m_sport;
+		uint32_t m_dport;
+	};
+
+	///Routing requirements of each netlist node
+	std::vector< std::vector<Constraint> > m_constraints;
+
+	///Sites each netlist node's label allows
+	std::vector< std::vector<uint32_t> > m_candidates;
+
+	///Netlist nodes sharing a label, and the sites they compete for
+	struct LabelGroup
+	{
+		std::vector<uint32_t> m_nodes;
+		std::vector<uint32_t> m_sites;
+	};
+	std::vector<LabelGroup> m_labelGroups;
+
+	///Order in which ties between equally constrained nodes are broken (highest degree first)
+	std::vector<uint32_t> m_order;
+
+	///Every edge of the device graph (see GetEdgeKey())
+	std::unordered_set<uint64_t> m_deviceEdges;
+
+	///Inbound and outbound edges of each device node, as (other site, sport, dport)
+	struct SiteEdge
+	{
+		uint32_t m_other;
+		uint32_t m_sport;
+		uint32_t m_dport;
+	};
+	std::vector< std::vector<SiteEdge> > m_siteOutEdges;
+	std::vector< std::vector<SiteEdge> > m_siteInEdges;
+
+	///Interchangeable-site class of each device node
+	std::vector<uint32_t> m_siteClasses;
+
+	///Current placement: site of each node and node at each site (-1 if none)
+	std::vector<int32_t> m_placement;
+	std::vector<int32_t> m_occupants;
+
+	///Nodes which stay where InitialPlacement() put them
+	std::vector<bool> m_fixed;
+
+	///Search state
+	uint64_t m_nodeLimit;
+	bool m_aborted;
+	bool m_done;
+	bool m_found;
+	uint32_t m_bestCost;
+	uint32_t m_rootBound;
+};
+
+#endif
@@ -0,0 +1,224 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <log.h>
+#include <xbpar.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+PARStatistics::PARStatistics()
+	: m_costEvaluations(0)
+	, m_iterations(0)
+	, m_movesProposed(0)
+	, m_movesIllegal(0)
+	, m_movesAcceptedDownhill(0)
+	, m_movesAcceptedUphill(0)
+	, m_movesReverted(0)
+	, m_restarts(0)
+	, m_exactNodes(0)
+	, m_exactPruned(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clocks
+
+/**
+	@brief Monotonic wall-clock time, in seconds, from an arbitrary epoch
+ */
+double PARStatistics::GetWallTime()
+{
+	auto now = chrono::steady_clock::now().time_since_epoch();
+	return chrono::duration_cast<chrono::duration<double>>(now).count();
+}
+
+/**
+	@brief CPU time consumed by this process, in seconds
+ */
+double PARStatistics::GetCPUTime()
+{
+	return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+/**
+	@brief Peak resident set size of this process, in kB (or zero if not available on this platform)
+ */
+uint64_t PARStatistics::GetPeakRSS()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if(0 != getrusage(RUSAGE_SELF, &usage))
+		return 0;
+
+	//ru_maxrss is in bytes on OSX and kB everywhere else
+	#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+	#else
+		return usage.ru_maxrss;
+	#endif
+#else
+	return 0;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Phase timing
+
+/**
+	@brief Starts timing a new phase.
+
+	Phases may be nested; each one must be closed by a matching call to EndPhase().
+ */
+void PARStatistics::BeginPhase(string name)
+{
+	Phase p;
+	p.m_name = name;
+	if(!m_activePhases.empty())
+		p.m_name = m_activePhases.back().m_name + "/" + name;
+	p.m_wallTime = GetWallTime();
+	p.m_cpuTime = GetCPUTime();
+	m_activePhases.push_back(p);
+}
+
+/**
+	@brief Stops timing the most recently started phase
+ */
+void PARStatistics::EndPhase()
+{
+	if(m_activePhases.empty())
+	{
+		LogWarning("PARStatistics::EndPhase() called with no active phase\n");
+		return;
+	}
+
+	Phase p = m_activePhases.back();
+	m_activePhases.pop_back();
+	p.m_wallTime = GetWallTime() - p.m_wallTime;
+	p.m_cpuTime = GetCPUTime() - p.m_cpuTime;
+	m_phases.push_back(p);
+}
+
+/**
+	@brief Adds the counters and phases from another run (e.g. a PAREngine's private statistics) to ours.
+
+	Phases from rhs are nested under whichever phase we currently have open.
+ */
+void PARStatistics::Merge(const PARStatistics& rhs)
+{
+	string prefix;
+	if(!m_activePhases.empty())
+		prefix = m_activePhases.back().m_name + "/";
+	for(auto p : rhs.m_phases)
+	{
+		p.m_name = prefix + p.m_name;
+		m_phases.push_back(p);
+	}
+
+	m_costEvaluations		+= rhs.m_costEvaluations;
+	m_iterations			+= rhs.m_iterations;
+	m_movesProposed			+= rhs.m_movesProposed;
+	m_movesIllegal			+= rhs.m_movesIllegal;
+	m_movesAcceptedDownhill	+= rhs.m_movesAcceptedDownhill;
+	m_movesAcceptedUphill	+= rhs.m_movesAcceptedUphill;
+	m_movesReverted			+= rhs.m_movesReverted;
+	m_restarts				+= rhs.m_restarts;
+	m_exactNodes			+= rhs.m_exactNodes;
+	m_exactPruned			+= rhs.m_exactPruned;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Output
+
+/**
+	@brief Prints a human-readable summary to the log at verbose level
+ */
+void PARStatistics::Print() const
+{
+	LogVerbose("\nPAR statistics:\n");
+	LogIndenter li;
+
+	for(auto& p : m_phases)
+		LogVerbose("%-30s %8.3f s wall, %8.3f s CPU\n", p.m_name.c_str(), p.m_wallTime, p.m_cpuTime);
+
+	LogVerbose("Peak RSS:               %lu kB\n", (unsigned long)GetPeakRSS());
+	LogVerbose("Iterations:             %lu\n", (unsigned long)m_iterations);
+	LogVerbose("Cost evaluations:       %lu\n", (unsigned long)m_costEvaluations);
+	LogVerbose("Moves proposed:         %lu\n", (unsigned long)m_movesProposed);
+	LogVerbose("    illegal:            %lu\n", (unsigned long)m_movesIllegal);
+	LogVerbose("    accepted downhill:  %lu\n", (unsigned long)m_movesAcceptedDownhill);
+	LogVerbose("    accepted uphill:    %lu\n", (unsigned long)m_movesAcceptedUphill);
+	LogVerbose("    reverted:           %lu\n", (unsigned long)m_movesReverted);
+	LogVerbose("Restarts from best:     %lu\n", (unsigned long)m_restarts);
+	LogVerbose("Exact search nodes:     %lu\n", (unsigned long)m_exactNodes);
+	LogVerbose("    pruned:             %lu\n", (unsigned long)m_exactPruned);
+}
+
+/**
+	@brief Writes the statistics to a JSON file for consumption by benchmarking scripts
+ */
+bool PARStatistics::WriteToJSON(string fname) const
+{
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"phases\": [\n");
+	for(size_t i=0; i<m_phases.size(); i++)
+	{
+		auto& p = m_phases[i];
+		fprintf(fp, "    { \"name\": \"%s\", \"wall_s\": %.6f, \"cpu_s\": %.6f }%s\n",
+			p.m_name.c_str(),
+			p.m_wallTime,
+			p.m_cpuTime,
+			(i+1 == m_phases.size()) ? "" : ",");
+	}
+	fprintf(fp, "  ],\n");
+	fprintf(fp, "  \"peak_rss_kb\": %lu,\n", (unsigned long)GetPeakRSS());
+	fprintf(fp, "  \"iterations\": %lu,\n", (unsigned long)m_iterations);
+	fprintf(fp, "  \"cost_evaluations\": %lu,\n", (unsigned long)m_costEvaluations);
+	fprintf(fp, "  \"moves\": {\n");
+	fprintf(fp, "    \"proposed\": %lu,\n", (unsigned long)m_movesProposed);
+	fprintf(fp, "    \"illegal\": %lu,\n", (unsigned long)m_movesIllegal);
+	fprintf(fp, "    \"accepted_downhill\": %lu,\n", (unsigned long)m_movesAcceptedDownhill);
+	fprintf(fp, "    \"accepted_uphill\": %lu,\n", (unsigned long)m_movesAcceptedUphill);
+	fprintf(fp, "    \"reverted\": %lu\n", (unsigned long)m_movesReverted);
+	fprintf(fp, "  },\n");
+	fprintf(fp, "  \"restarts\": %lu,\n", (unsigned long)m_restarts);
+	fprintf(fp, "  \"exact\": {\n");
+	fprintf(fp, "    \"nodes\": %lu,\n", (unsigned long)m_exactNodes);
+	fprintf(fp, "    \"pruned\": %lu\n", (unsigned long)m_exactPruned);
+	fprintf(fp, "  }\n");
+	fprintf(fp, "}\n");
+
+	fclose(fp);
+	return true;
+}
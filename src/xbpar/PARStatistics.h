@@ -0,0 +1,117 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef PARStatistics_h
+#define PARStatistics_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+	@brief Instrumentation counters and phase timers collected during a single place-and-route run
+ */
+class PARStatistics
+{
+public:
+	PARStatistics();
+
+	/**
+		@brief Elapsed time for one named phase of the run
+	 */
+	class Phase
+	{
+	public:
+		std::string m_name;
+
+		///Wall-clock time, in seconds
+		double m_wallTime;
+
+		///Process CPU time, in seconds
+		double m_cpuTime;
+	};
+
+	void BeginPhase(std::string name);
+	void EndPhase();
+
+	void Merge(const PARStatistics& rhs);
+
+	bool WriteToJSON(std::string fname) const;
+	void Print() const;
+
+	static double GetWallTime();
+	static double GetCPUTime();
+	static uint64_t GetPeakRSS();
+
+	///Completed phases, in the order they finished. Nested phases are named "outer/inner".
+	std::vector<Phase> m_phases;
+
+	///Number of calls to PAREngine::ComputeCost()
+	uint64_t m_costEvaluations;
+
+	///Number of annealing iterations run
+	uint64_t m_iterations;
+
+	///Number of moves for which a candidate site was found
+	uint64_t m_movesProposed;
+
+	///Number of proposed moves rejected by CanMoveNode() before being tried
+	uint64_t m_movesIllegal;
+
+	///Number of moves accepted because they reduced the cost
+	uint64_t m_movesAcceptedDownhill;
+
+	///Number of moves accepted despite not reducing the cost
+	uint64_t m_movesAcceptedUphill;
+
+	///Number of moves that were tried and then undone
+	uint64_t m_movesReverted;
+
+	///Number of times we backtracked to the best placement found so far
+	uint64_t m_restarts;
+
+	///Number of partial placements evaluated by the exact placer
+	uint64_t m_exactNodes;
+
+	///Number of partial placements the exact placer discarded without searching below them
+	uint64_t m_exactPruned;
+
+protected:
+
+	///Phases which have been started but not yet ended (start times are stored in the time fields)
+	std::vector<Phase> m_activePhases;
+};
+
+/**
+	@brief Scoped helper that times a phase for the lifetime of the object
+ */
+class PARPhaseTimer
+{
+public:
+	PARPhaseTimer(PARStatistics& stats, std::string name)
+	: m_stats(stats)
+	{ m_stats.BeginPhase(name); }
+
+	~PARPhaseTimer()
+	{ m_stats.EndPhase(); }
+
+protected:
+	PARStatistics& m_stats;
+};
+
+#endif
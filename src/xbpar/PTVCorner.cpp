@@ -57,13 +57,11 @@ string PTVCorner::GetSpeedAsString() const
 //Comparison operator for STL collections
 bool PTVCorner::operator<(const PTVCorner& rhs) const
 {
-	if(m_speed < rhs.m_speed)
-		return true;
-	if(m_dieTemp < rhs.m_dieTemp)
-		return true;
-	if(m_voltage < rhs.m_voltage)
-		return true;
-	return false;
+	if(m_speed != rhs.m_speed)
+		return m_speed < rhs.m_speed;
+	if(m_dieTemp != rhs.m_dieTemp)
+		return m_dieTemp < rhs.m_dieTemp;
+	return m_voltage < rhs.m_voltage;
 }
 
 bool PTVCorner::operator!=(const PTVCorner& rhs) const
@@ -0,0 +1,383 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <algorithm>
+#include "xbpar.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+PTVDelayTable::PTVDelayTable()
+	: m_count(0)
+	, m_delayData(NULL)
+	, m_validData(NULL)
+	, m_attached(false)
+{
+}
+
+PTVDelayTable::PTVDelayTable(const PTVDelayTable& rhs)
+	: m_ports(rhs.m_ports)
+	, m_temps(rhs.m_temps)
+	, m_voltages(rhs.m_voltages)
+	, m_delays(rhs.m_delays)
+	, m_valid(rhs.m_valid)
+	, m_count(rhs.m_count)
+	, m_delayData(rhs.m_delayData)
+	, m_validData(rhs.m_validData)
+	, m_attached(rhs.m_attached)
+{
+	Bind();
+}
+
+PTVDelayTable& PTVDelayTable::operator=(const PTVDelayTable& rhs)
+{
+	m_ports = rhs.m_ports;
+	m_temps = rhs.m_temps;
+	m_voltages = rhs.m_voltages;
+	m_delays = rhs.m_delays;
+	m_valid = rhs.m_valid;
+	m_count = rhs.m_count;
+	m_delayData = rhs.m_delayData;
+	m_validData = rhs.m_validData;
+	m_attached = rhs.m_attached;
+	Bind();
+	return *this;
+}
+
+/**
+	@brief Points queries at our own arrays, unless we're attached to external storage
+ */
+void PTVDelayTable::Bind()
+{
+	if(m_attached)
+		return;
+	m_delayData = m_delays.data();
+	m_validData = m_valid.data();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Ports
+
+/**
+	@brief Gets the ID of a port, adding it to the table if it's new
+ */
+unsigned int PTVDelayTable::GetPortID(const string& name)
+{
+	int id = LookupPort(name);
+	if(id >= 0)
+		return id;
+
+	Resize(m_ports.size() + 1, m_temps, m_voltages);
+	m_ports[m_ports.size() - 1] = name;
+	return m_ports.size() - 1;
+}
+
+/**
+	@brief Gets the ID of a port, or -1 if we have no data for it
+ */
+int PTVDelayTable::LookupPort(const string& name) const
+{
+	for(size_t i=0; i<m_ports.size(); i++)
+	{
+		if(m_ports[i] == name)
+			return i;
+	}
+	return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+
+/**
+	@brief Changes the shape of the table, keeping every entry already in it.
+
+	Ports may only be added at the end, and the new axes must be supersets of the old ones.
+ */
+void PTVDelayTable::Resize(unsigned int nports, const vector<int>& temps, const vector<int>& voltages)
+{
+	PTVDelayTable old(*this);
+
+	m_ports.resize(nports);
+	m_temps = temps;
+	m_voltages = voltages;
+	m_delays.clear();
+	m_delays.resize(nports * nports * GetNumCorners());
+	m_valid.clear();
+	m_valid.resize(m_delays.size(), 0);
+
+	//Copy old data to its new home
+	for(unsigned int src=0; src<old.m_ports.size(); src++)
+	{
+		for(unsigned int dst=0; dst<old.m_ports.size(); dst++)
+		{
+			unsigned int obase = old.GetArcBase(src, dst);
+			unsigned int nbase = GetArcBase(src, dst);
+			for(unsigned int speed=0; speed<NUM_SPEEDS; speed++)
+			{
+				for(unsigned int t=0; t<old.m_temps.size(); t++)
+				{
+					unsigned int nt = lower_bound(m_temps.begin(), m_temps.end(), old.m_temps[t]) - m_temps.begin();
+					for(unsigned int v=0; v<old.m_voltages.size(); v++)
+					{
+						unsigned int nv = lower_bound(m_voltages.begin(), m_voltages.end(), old.m_voltages[v]) -
+							m_voltages.begin();
+
+						unsigned int from = obase + old.GetCornerIndex(speed, t, v);
+						unsigned int to = nbase + GetCornerIndex(speed, nt, nv);
+						m_delays[to] = old.m_delayData[from];
+						m_valid[to] = old.m_validData[from];
+					}
+				}
+			}
+		}
+	}
+
+	//Whatever we were looking at before, we own our data now
+	m_attached = false;
+	Bind();
+}
+
+/**
+	@brief Borrows a table's contents from external storage, replacing anything already in it.
+
+	@param ports		Port names, in ID order
+	@param temps		Characterized temperatures, sorted
+	@param voltages		Characterized voltages, sorted
+	@param delays		ports^2 * 3 * temps * voltages delays, in the same layout as our own arrays
+	@param valid		Nonzero for each characterized entry in delays
+	@param count		Number of nonzero entries in valid
+ */
+void PTVDelayTable::Attach(
+	const vector<string>& ports,
+	const vector<int>& temps,
+	const vector<int>& voltages,
+	const CombinatorialDelay* delays,
+	const uint8_t* valid,
+	unsigned int count)
+{
+	m_ports = ports;
+	m_temps = temps;
+	m_voltages = voltages;
+	m_delays.clear();
+	m_valid.clear();
+	m_count = count;
+	m_delayData = delays;
+	m_validData = valid;
+	m_attached = true;
+}
+
+void PTVDelayTable::SetDelay(unsigned int src, unsigned int dst, const PTVCorner& corner, CombinatorialDelay delay)
+{
+	//Grow the grid if this is a temperature or voltage we haven't seen yet
+	bool newtemp = !binary_search(m_temps.begin(), m_temps.end(), corner.GetTemp());
+	bool newvoltage = !binary_search(m_voltages.begin(), m_voltages.end(), corner.GetVoltage());
+	if(m_attached && !newtemp && !newvoltage)
+		Resize(m_ports.size(), m_temps, m_voltages);
+	else if(newtemp || newvoltage)
+	{
+		vector<int> temps = m_temps;
+		vector<int> voltages = m_voltages;
+		if(newtemp)
+			temps.insert(lower_bound(temps.begin(), temps.end(), corner.GetTemp()), corner.GetTemp());
+		if(newvoltage)
+			voltages.insert(lower_bound(voltages.begin(), voltages.end(), corner.GetVoltage()), corner.GetVoltage());
+		Resize(m_ports.size(), temps, voltages);
+	}
+
+	unsigned int t = lower_bound(m_temps.begin(), m_temps.end(), corner.GetTemp()) - m_temps.begin();
+	unsigned int v = lower_bound(m_voltages.begin(), m_voltages.end(), corner.GetVoltage()) - m_voltages.begin();
+	unsigned int i = GetArcBase(src, dst) + GetCornerIndex(corner.GetSpeed(), t, v);
+	if(!m_valid[i])
+		m_count ++;
+	m_delays[i] = delay;
+	m_valid[i] = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries
+
+/**
+	@brief Finds the grid points on either side of a value, and how far between them it is (clamped to the grid)
+ */
+void PTVDelayTable::FindBracket(const vector<int>& axis, int value, unsigned int& lo, unsigned int& hi, float& frac)
+{
+	unsigned int i = lower_bound(axis.begin(), axis.end(), value) - axis.begin();
+	if(i == axis.size())
+	{
+		lo = hi = axis.size() - 1;
+		frac = 0;
+	}
+	else if( (axis[i] == value) || (i == 0) )
+	{
+		lo = hi = i;
+		frac = 0;
+	}
+	else
+	{
+		lo = i - 1;
+		hi = i;
+		frac = static_cast<float>(value - axis[lo]) / (axis[hi] - axis[lo]);
+	}
+}
+
+/**
+	@brief Locates an operating point in the grid
+
+	@return false if we have no data at all
+ */
+bool PTVDelayTable::GetPoint(const PTVCorner& corner, Point& point) const
+{
+	point.m_count = 0;
+	if(m_temps.empty() || m_voltages.empty())
+		return false;
+
+	unsigned int t[2];
+	unsigned int v[2];
+	float tfrac;
+	float vfrac;
+	FindBracket(m_temps, corner.GetTemp(), t[0], t[1], tfrac);
+	FindBracket(m_voltages, corner.GetVoltage(), v[0], v[1], vfrac);
+
+	float tweights[2] = {1 - tfrac, tfrac};
+	float vweights[2] = {1 - vfrac, vfrac};
+	for(unsigned int i=0; i<2; i++)
+	{
+		for(unsigned int j=0; j<2; j++)
+		{
+			//Skip points that don't contribute (including the duplicates when we're on a grid line)
+			float weight = tweights[i] * vweights[j];
+			if(weight == 0)
+				continue;
+
+			point.m_corners[point.m_count] = GetCornerIndex(corner.GetSpeed(), t[i], v[j]);
+			point.m_weights[point.m_count] = weight;
+			point.m_count ++;
+		}
+	}
+
+	return true;
+}
+
+/**
+	@brief Gets the delay of an arc at a precomputed operating point
+
+	@return false if any of the surrounding grid points wasn't characterized
+ */
+bool PTVDelayTable::GetDelay(unsigned int src, unsigned int dst, const Point& point, CombinatorialDelay& delay) const
+{
+	if( (src >= m_ports.size()) || (dst >= m_ports.size()) || (point.m_count == 0) )
+		return false;
+
+	unsigned int base = GetArcBase(src, dst);
+	CombinatorialDelay sum(0, 0);
+	for(unsigned int i=0; i<point.m_count; i++)
+	{
+		unsigned int n = base + point.m_corners[i];
+		if(!m_validData[n])
+			return false;
+		sum.m_rising += m_delayData[n].m_rising * point.m_weights[i];
+		sum.m_falling += m_delayData[n].m_falling * point.m_weights[i];
+	}
+
+	delay = sum;
+	return true;
+}
+
+/**
+	@brief Gets the delay between two named ports at any operating point
+ */
+bool PTVDelayTable::GetDelay(const string& src, const string& dst, const PTVCorner& corner, CombinatorialDelay& delay)
+	const
+{
+	int nsrc = LookupPort(src);
+	int ndst = LookupPort(dst);
+	if( (nsrc < 0) || (ndst < 0) )
+		return false;
+
+	Point point;
+	if(!GetPoint(corner, point))
+		return false;
+	return GetDelay(nsrc, ndst, point, delay);
+}
+
+/**
+	@brief Gets the delay at a characterized corner, without interpolation
+ */
+bool PTVDelayTable::GetExactDelay(unsigned int src, unsigned int dst, const PTVCorner& corner, CombinatorialDelay& delay)
+	const
+{
+	if( (src >= m_ports.size()) || (dst >= m_ports.size()) )
+		return false;
+
+	auto tit = lower_bound(m_temps.begin(), m_temps.end(), corner.GetTemp());
+	auto vit = lower_bound(m_voltages.begin(), m_voltages.end(), corner.GetVoltage());
+	if( (tit == m_temps.end()) || (*tit != corner.GetTemp()) )
+		return false;
+	if( (vit == m_voltages.end()) || (*vit != corner.GetVoltage()) )
+		return false;
+
+	unsigned int n = GetArcBase(src, dst) + GetCornerIndex(corner.GetSpeed(), tit - m_temps.begin(),
+		vit - m_voltages.begin());
+	if(!m_validData[n])
+		return false;
+	delay = m_delayData[n];
+	return true;
+}
+
+bool PTVDelayTable::GetExactDelay(
+	const string& src,
+	const string& dst,
+	const PTVCorner& corner,
+	CombinatorialDelay& delay) const
+{
+	int nsrc = LookupPort(src);
+	int ndst = LookupPort(dst);
+	if( (nsrc < 0) || (ndst < 0) )
+		return false;
+	return GetExactDelay(nsrc, ndst, corner, delay);
+}
+
+/**
+	@brief Gets every corner with at least one characterized arc, in (process, temperature, voltage) order
+ */
+void PTVDelayTable::GetCorners(vector<PTVCorner>& corners) const
+{
+	unsigned int ncorners = GetNumCorners();
+	unsigned int narcs = m_ports.size() * m_ports.size();
+	for(unsigned int speed=0; speed<NUM_SPEEDS; speed++)
+	{
+		for(unsigned int t=0; t<m_temps.size(); t++)
+		{
+			for(unsigned int v=0; v<m_voltages.size(); v++)
+			{
+				unsigned int corner = GetCornerIndex(speed, t, v);
+				for(unsigned int arc=0; arc<narcs; arc++)
+				{
+					if(m_validData[arc*ncorners + corner])
+					{
+						corners.push_back(PTVCorner(
+							static_cast<PTVCorner::ProcessSpeed>(speed), m_temps[t], m_voltages[v]));
+						break;
+					}
+				}
+			}
+		}
+	}
+}
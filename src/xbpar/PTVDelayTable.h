@@ -0,0 +1,167 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016-2017 Andrew Zonenberg and contributors                                                           *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef PTVDelayTable_h
+#define PTVDelayTable_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+	@brief Dense table of pin-to-pin delays, indexed by (source port, destination port, corner).
+
+	Characterized corners form a grid over (process, temperature, voltage). Queries at any temperature and voltage
+	are answered by bilinear interpolation between the surrounding grid points (clamped at the edges of the grid);
+	process corners are discrete and must match exactly.
+
+	Port names are interned to small integer IDs. Lookups by ID against a precomputed Point don't touch any strings
+	or trees, so repeated queries at one operating point are O(1).
+
+	The delay and valid arrays can also be borrowed from external storage (e.g. a memory-mapped timing database)
+	with Attach(). The storage must outlive the table; the first SetDelay() on an attached table takes a private copy.
+ */
+class PTVDelayTable
+{
+public:
+	PTVDelayTable();
+	PTVDelayTable(const PTVDelayTable& rhs);
+	PTVDelayTable& operator=(const PTVDelayTable& rhs);
+
+	/**
+		@brief Precomputed location of an operating point in the grid. Invalidated by adding data to the table.
+	 */
+	class Point
+	{
+	public:
+		Point()
+		: m_count(0)
+		{}
+
+		///Number of grid points contributing
+		unsigned int m_count;
+
+		///Corner index and weight of each contributing grid point
+		unsigned int m_corners[4];
+		float m_weights[4];
+	};
+
+	//Ports
+	unsigned int GetPortID(const std::string& name);
+	int LookupPort(const std::string& name) const;
+
+	unsigned int GetPortCount() const
+	{ return m_ports.size(); }
+
+	const std::string& GetPortName(unsigned int id) const
+	{ return m_ports[id]; }
+
+	//Loading
+	void SetDelay(unsigned int src, unsigned int dst, const PTVCorner& corner, CombinatorialDelay delay);
+	void SetDelay(const std::string& src, const std::string& dst, const PTVCorner& corner, CombinatorialDelay delay)
+	{ SetDelay(GetPortID(src), GetPortID(dst), corner, delay); }
+
+	//Queries
+	bool GetPoint(const PTVCorner& corner, Point& point) const;
+
+	bool GetDelay(unsigned int src, unsigned int dst, const Point& point, CombinatorialDelay& delay) const;
+	bool GetDelay(const std::string& src, const std::string& dst, const PTVCorner& corner, CombinatorialDelay& delay)
+		const;
+
+	bool GetExactDelay(unsigned int src, unsigned int dst, const PTVCorner& corner, CombinatorialDelay& delay) const;
+	bool GetExactDelay(const std::string& src, const std::string& dst, const PTVCorner& corner, CombinatorialDelay& delay)
+		const;
+
+	void GetCorners(std::vector<PTVCorner>& corners) const;
+
+	bool empty() const
+	{ return m_count == 0; }
+
+	//Raw storage, for serialization
+	const std::vector<int>& GetTemps() const
+	{ return m_temps; }
+
+	const std::vector<int>& GetVoltages() const
+	{ return m_voltages; }
+
+	unsigned int GetEntryCount() const
+	{ return m_ports.size() * m_ports.size() * GetNumCorners(); }
+
+	unsigned int GetValidCount() const
+	{ return m_count; }
+
+	const CombinatorialDelay* GetDelayData() const
+	{ return m_delayData; }
+
+	const uint8_t* GetValidData() const
+	{ return m_validData; }
+
+	void Attach(
+		const std::vector<std::string>& ports,
+		const std::vector<int>& temps,
+		const std::vector<int>& voltages,
+		const CombinatorialDelay* delays,
+		const uint8_t* valid,
+		unsigned int count);
+
+	bool IsAttached() const
+	{ return m_attached; }
+
+	///Number of process corners
+	static const unsigned int NUM_SPEEDS = 3;
+
+protected:
+	void Resize(
+		unsigned int nports,
+		const std::vector<int>& temps,
+		const std::vector<int>& voltages);
+
+	unsigned int GetNumCorners() const
+	{ return NUM_SPEEDS * m_temps.size() * m_voltages.size(); }
+
+	unsigned int GetCornerIndex(unsigned int speed, unsigned int temp, unsigned int voltage) const
+	{ return (speed * m_temps.size() + temp) * m_voltages.size() + voltage; }
+
+	unsigned int GetArcBase(unsigned int src, unsigned int dst) const
+	{ return (src * m_ports.size() + dst) * GetNumCorners(); }
+
+	static void FindBracket(const std::vector<int>& axis, int value, unsigned int& lo, unsigned int& hi, float& frac);
+
+	void Bind();
+
+	///Interned port names
+	std::vector<std::string> m_ports;
+
+	///Characterized temperatures (degC) and voltages (mV), sorted
+	std::vector<int> m_temps;
+	std::vector<int> m_voltages;
+
+	///Delay for each (src, dst, corner), and whether it's been characterized
+	std::vector<CombinatorialDelay> m_delays;
+	std::vector<uint8_t> m_valid;
+
+	///Number of characterized entries
+	unsigned int m_count;
+
+	///The arrays queries actually read: either m_delays/m_valid, or external storage if attached
+	const CombinatorialDelay* m_delayData;
+	const uint8_t* m_validData;
+	bool m_attached;
+};
+
+#endif
@@ -19,12 +19,29 @@
 #ifndef xbpar_h
 #define xbpar_h
 
+/**
+	@file
+	@brief Master include file for the crossbar place-and-route library
+
+	Thread safety: the library keeps no global mutable state. Separate PARGraph and PAREngine instances (each
+	engine has its own random number generator and statistics) may be used concurrently from different threads.
+	A single graph or engine must not be touched by more than one thread at a time.
+
+	Logging still goes through the process-wide sinks. To keep concurrent jobs' output apart, call
+	EnableLogContexts() once at startup and run each job inside a LogContext::Scope.
+ */
+
 #include "CombinatorialDelay.h"
 #include "PTVCorner.h"
+#include "PTVDelayTable.h"
 
 #include "PARGraph.h"
 #include "PARGraphNode.h"
 
+#include "PARStatistics.h"
 #include "PAREngine.h"
+#include "PARExactPlacer.h"
+
+#include "LogContext.h"
 
 #endif